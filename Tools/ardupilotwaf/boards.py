@@ -526,6 +526,19 @@ class Board:
                         fname = fname[1:]
                     env.ROMFS_FILES += [(fname,root+"/"+f)]
 
+    def configure_heap_accounting(self, cfg, env):
+        '''account heap usage, see AP_Common/AP_HeapAccounting.h. The
+        allocator is wrapped so plain malloc/calloc/realloc/free calls
+        are seen as well as new'''
+        env.DEFINES.update(
+            AP_HEAP_ACCOUNTING_ENABLED = 1,
+        )
+        env.LINKFLAGS += [
+            '-Wl,--wrap,calloc',
+            '-Wl,--wrap,realloc',
+            '-Wl,--wrap,free',
+        ]
+
     def pre_build(self, bld):
         '''pre-build hook that gets called before dynamic sources'''
         if bld.env.ROMFS_FILES:
@@ -756,6 +769,11 @@ class sitl(Board):
         # don't do this on MacOS as ld doesn't support --wrap
         if platform.system() != 'Darwin':
             env.LINKFLAGS += ['-Wl,--wrap,malloc']
+
+        if cfg.options.enable_heap_accounting:
+            if platform.system() == 'Darwin':
+                cfg.fatal("--enable-heap-accounting needs ld --wrap, which MacOS doesn't have")
+            self.configure_heap_accounting(cfg, env)
         
         if cfg.options.enable_sfml:
             if not cfg.check_SFML(env):
@@ -1348,6 +1366,9 @@ class linux(Board):
         # wrap malloc to ensure memory is zeroed
         env.LINKFLAGS += ['-Wl,--wrap,malloc']
 
+        if cfg.options.enable_heap_accounting:
+            self.configure_heap_accounting(cfg, env)
+
         if cfg.options.force_32bit:
             env.DEFINES.update(
                 HAL_FORCE_32BIT = 1,
@@ -2459,6 +2459,41 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
         self.reboot_sitl()
         self.assert_receive_message('ADSB_VEHICLE', timeout=30)
 
+    def ADSBTrafficLoad(self):
+        '''Track a large amount of simulated ADSB traffic with avoidance enabled'''
+        self.set_parameters({
+            "SIM_ADSB_COUNT": 400,
+            "SIM_ADSB_RADIUS": 20000,
+            "ADSB_TYPE": 1,
+            "ADSB_LIST_MAX": 400,
+            "ADSB_LIST_RADIUS": 50000,
+            "ADSB_LIST_ALT": 0,
+            "AVD_ENABLE": 1,
+            "AVD_OBS_MAX": 100,
+            "SR0_ADSB": 50,
+        })
+        self.reboot_sitl()
+        self.wait_ready_to_arm()
+
+        seen = set()
+        load = []
+        tstart = self.get_sim_time()
+        while self.get_sim_time_cached() - tstart < 60:
+            m = self.mav.recv_match(type=['ADSB_VEHICLE', 'SYS_STATUS'], blocking=True, timeout=1)
+            if m is None:
+                continue
+            if m.get_type() == 'ADSB_VEHICLE':
+                seen.add(m.ICAO_address)
+            else:
+                load.append(m.load * 0.1)
+        if len(load) == 0:
+            raise NotAchievedException("No SYS_STATUS received")
+        self.progress("Tracked %u aircraft, load mean %.1f%% max %.1f%%" %
+                      (len(seen), sum(load)/len(load), max(load)))
+        # the simulated ICAO addresses are random so a few collide
+        if len(seen) < 300:
+            raise NotAchievedException("Only saw %u aircraft" % len(seen))
+
     def ADSB(self):
         '''Test ADSB'''
         self.ADSB_f_action_rtl()
@@ -5433,6 +5468,7 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
             self.FenceDisableUnderAction,
             self.ADSB,
             self.SimADSB,
+            self.ADSBTrafficLoad,
             self.Button,
             self.FRSkySPort,
             self.FRSkyPassThroughStatustext,
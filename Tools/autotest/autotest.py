@@ -373,7 +373,7 @@ supplementary_test_binary_map = {
 
 
 def run_specific_test(step, *args, **kwargs):
-    """Run a specific test."""
+    """Run specific tests, e.g. test.Copter.Name or test.Copter.Name1,Name2"""
     t = split_specific_test_step(step)
     if t is None:
         return []
@@ -384,14 +384,19 @@ def run_specific_test(step, *args, **kwargs):
     tester = tester_class(*args, **kwargs)
 
     # print("Got %s" % str(tester))
+    available = {}
     for a in tester.tests():
         if not isinstance(a, Test):
             a = Test(a)
         print("Got %s" % (a.name))
-        if a.name == test:
-            return tester.autotest(tests=[a], allow_skips=False, step_name=step), tester
-    print("Failed to find test %s on %s" % (test, testname))
-    sys.exit(1)
+        available[a.name] = a
+    to_run = []
+    for name in test.split(","):
+        if name not in available:
+            print("Failed to find test %s on %s" % (name, testname))
+            sys.exit(1)
+        to_run.append(available[name])
+    return tester.autotest(tests=to_run, allow_skips=False, step_name=step), tester
 
 
 def run_step(step):
@@ -514,6 +519,7 @@ def run_step(step):
         "logs_dir": buildlogs_dirpath(),
         "sup_binaries": supplementary_binaries,
         "reset_after_every_test": opts.reset_after_every_test,
+        "fast_reset": opts.fast_reset,
         "build_opts": copy.copy(build_opts),
         "generate_junit": opts.junit,
     }
@@ -1027,6 +1033,10 @@ if __name__ == "__main__":
                                 action='store_true',
                                 default=False,
                                 help='reset everything after every test run')
+    group_completion.add_option("--fast-reset",
+                                action='store_true',
+                                default=False,
+                                help='reset between tests from an in-process SITL snapshot rather than rebooting')
     parser.add_option_group(group_completion)
 
     opts, args = parser.parse_args()
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+
+'''
+Run the tests of an autotest step over several autotest.py processes
+at once
+
+  ./Tools/autotest/autotest.py build.Copter
+  ./Tools/autotest/autotest_sharded.py --jobs 8 test.Copter -- --fast-reset
+
+The tests are cut into batches which are handed to the next free job,
+so a job only pays for starting SITL once per batch.  Each batch runs
+in its own directory under --output with its own BUILDLOGS, and in
+its own network namespace (see unshare(1)) so every SITL can keep
+the default ports.  Arguments after -- are passed to autotest.py.
+
+AP_FLAKE8_CLEAN
+'''
+
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import threading
+import time
+
+import autotest
+
+
+class ShardedAutoTest(object):
+    def __init__(self, step, jobs, batch_size, output, netns=True, tests=None, autotest_args=[]):
+        self.step = step
+        self.jobs = jobs
+        self.batch_size = batch_size
+        self.output = os.path.realpath(output)
+        self.netns = netns
+        self.tests = tests
+        self.autotest_args = autotest_args
+        self.lock = threading.Lock()
+        self.results = []
+
+    def progress(self, message):
+        with self.lock:
+            print("PROGRESS: %s" % (message,))
+            sys.stdout.flush()
+
+    def test_names(self):
+        '''returns names of the tests in our step, less disabled ones'''
+        if self.step not in autotest.tester_class_map:
+            raise ValueError("Unknown step (%s)" % self.step)
+        tester = autotest.tester_class_map[self.step]("/bin/true", None)
+        disabled = tester.disabled_tests()
+        ret = []
+        for t in tester.tests():
+            if not isinstance(t, autotest.Test):
+                t = autotest.Test(t)
+            if t.name in disabled:
+                continue
+            ret.append(t.name)
+        return ret
+
+    def netns_available(self):
+        try:
+            subprocess.check_call(["unshare", "--user", "--map-root-user", "--net", "true"])
+        except (OSError, subprocess.CalledProcessError):
+            return False
+        return True
+
+    def command_for_batch(self, names):
+        cmd = [
+            sys.executable,
+            os.path.join(os.path.dirname(os.path.realpath(__file__)), "autotest.py"),
+        ]
+        cmd.extend(self.autotest_args)
+        cmd.append("%s.%s" % (self.step, ",".join(names)))
+        if not self.netns:
+            return cmd
+        # a private loopback interface, so each SITL gets the default ports
+        return [
+            "unshare", "--user", "--map-root-user", "--net", "--",
+            "sh", "-c", 'ip link set lo up && exec "$@"', "sh",
+        ] + cmd
+
+    def run_batch(self, batch_num, names):
+        dirpath = os.path.join(self.output, "batch-%03u" % batch_num)
+        if os.path.exists(dirpath):
+            shutil.rmtree(dirpath)
+        os.makedirs(dirpath)
+        env = dict(os.environ)
+        env["BUILDLOGS"] = dirpath
+        logpath = os.path.join(dirpath, "output.txt")
+        self.progress("batch %u: starting %s" % (batch_num, " ".join(names)))
+        tstart = time.time()
+        with open(logpath, "w") as log:
+            returncode = subprocess.call(self.command_for_batch(names),
+                                         cwd=dirpath,
+                                         env=env,
+                                         stdin=subprocess.DEVNULL,
+                                         stdout=log,
+                                         stderr=subprocess.STDOUT)
+        failed = []
+        with open(logpath, "r", errors="replace") as log:
+            for line in log:
+                if line.startswith("AT-") and "FAILED: " in line:
+                    failed.append(line.strip())
+        self.progress("batch %u: %s in %.0fs" %
+                      (batch_num, "passed" if returncode == 0 else "FAILED", time.time() - tstart))
+        with self.lock:
+            self.results.append((batch_num, names, returncode, failed, logpath))
+
+    def run(self):
+        if self.jobs > 1 and self.netns and not self.netns_available():
+            raise RuntimeError("network namespaces are not available; run with --jobs 1 or --no-netns")
+
+        names = self.test_names()
+        if self.tests is not None:
+            names = [n for n in names if n in self.tests]
+        if len(names) == 0:
+            raise ValueError("No tests to run")
+        batches = [names[i:i+self.batch_size] for i in range(0, len(names), self.batch_size)]
+        self.progress("%u tests in %u batches over %u jobs" % (len(names), len(batches), self.jobs))
+
+        pending = list(enumerate(batches))
+
+        def worker():
+            while True:
+                with self.lock:
+                    if len(pending) == 0:
+                        return
+                    (batch_num, batch) = pending.pop(0)
+                self.run_batch(batch_num, batch)
+
+        tstart = time.time()
+        threads = [threading.Thread(target=worker) for i in range(min(self.jobs, len(batches)))]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        failures = sorted([r for r in self.results if r[2] != 0])
+        print("%u batches run in %.0fs, %u failed" % (len(self.results), time.time() - tstart, len(failures)))
+        for (batch_num, names, returncode, failed, logpath) in failures:
+            print("batch %u (%s):" % (batch_num, logpath))
+            for line in failed:
+                print("  %s" % line)
+            if len(failed) == 0:
+                print("  autotest.py exited with %d" % returncode)
+        return len(failures) == 0
+
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser(
+        "autotest_sharded.py [options] STEP [-- AUTOTEST_ARGS]",
+        description="run the tests of an autotest step, e.g. test.Copter, in parallel")
+    parser.add_option("-j", "--jobs",
+                      type='int',
+                      default=os.cpu_count(),
+                      help="number of autotest.py processes to run at once")
+    parser.add_option("--batch-size",
+                      type='int',
+                      default=5,
+                      help="number of tests each autotest.py process runs")
+    parser.add_option("--output",
+                      type='string',
+                      default=autotest.buildlogs_path("sharded"),
+                      help="directory for the batch directories")
+    parser.add_option("--tests",
+                      type='string',
+                      default=None,
+                      help="comma separated list of tests to run rather than all of them")
+    parser.add_option("--no-netns",
+                      action='store_true',
+                      default=False,
+                      help="don't isolate batches in network namespaces")
+
+    argv = sys.argv[1:]
+    autotest_args = []
+    if "--" in argv:
+        autotest_args = argv[argv.index("--")+1:]
+        argv = argv[:argv.index("--")]
+    (opts, args) = parser.parse_args(argv)
+    if len(args) != 1:
+        parser.print_help()
+        sys.exit(1)
+
+    sharded = ShardedAutoTest(
+        args[0],
+        jobs=max(opts.jobs, 1),
+        batch_size=max(opts.batch_size, 1),
+        output=opts.output,
+        netns=not opts.no_netns,
+        tests=opts.tests.split(",") if opts.tests is not None else None,
+        autotest_args=autotest_args,
+    )
+    if not sharded.run():
+        sys.exit(1)
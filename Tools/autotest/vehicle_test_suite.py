@@ -1702,6 +1702,7 @@ class TestSuite(ABC):
                  replay=False,
                  sup_binaries=[],
                  reset_after_every_test=False,
+                 fast_reset=False,
                  force_32bit=False,
                  ubsan=False,
                  ubsan_abort=False,
@@ -1731,6 +1732,7 @@ class TestSuite(ABC):
             self.speedup = self.default_speedup()
         self.sup_binaries = sup_binaries
         self.reset_after_every_test = reset_after_every_test
+        self.fast_reset = fast_reset
         self.force_32bit = force_32bit
         self.ubsan = ubsan
         self.ubsan_abort = ubsan_abort
@@ -2188,6 +2190,74 @@ class TestSuite(ABC):
                                        0,
                                        0)
 
+    def sitl_snapshot_command(self, param4, prefix, timeout=30):
+        '''send one of SITL's snapshot commands, returning the
+        STATUSTEXT starting with prefix which reports the outcome, or a
+        description of the failed COMMAND_ACK if SITL refused it'''
+        outcome = []
+
+        def hook(mav, m):
+            if m.get_type() == 'STATUSTEXT':
+                if m.text.startswith(prefix):
+                    outcome.append(m.text)
+                return
+            # don't wait out the timeout if the command was refused
+            if (m.get_type() == 'COMMAND_ACK' and
+                    m.command == mavutil.mavlink.MAV_CMD_PREFLIGHT_REBOOT_SHUTDOWN and
+                    m.result != mavutil.mavlink.MAV_RESULT_ACCEPTED):
+                outcome.append("SITL command %u refused (result=%u)" % (param4, m.result))
+        self.install_message_hook(hook)
+        try:
+            self.mav.mav.command_long_send(self.sysid_thismav(),
+                                           1,
+                                           mavutil.mavlink.MAV_CMD_PREFLIGHT_REBOOT_SHUTDOWN,
+                                           1,  # confirmation
+                                           42,
+                                           24,
+                                           71,
+                                           param4,
+                                           0,
+                                           0,
+                                           0)
+            tstart = time.time()
+            while len(outcome) == 0:
+                if time.time() - tstart > timeout:
+                    raise AutoTestTimeoutException("No response to SITL command %u" % param4)
+                self.mav.recv_match(type=['STATUSTEXT', 'COMMAND_ACK'], blocking=True, timeout=1)
+        finally:
+            self.remove_message_hook(hook)
+        self.progress("Got (%s)" % outcome[0])
+        return outcome[0]
+
+    def sitl_snapshot(self, restore=False, timeout=30):
+        '''record the parameters and physics state of SITL, or return to
+        the recorded state.  Returns False if SITL refused'''
+        self.progress("%s SITL snapshot" % ("Restoring" if restore else "Taking"))
+        outcome = self.sitl_snapshot_command(102 if restore else 101, "SITL: snapshot", timeout=timeout)
+        return outcome == "SITL: snapshot taken" or outcome.startswith("SITL: snapshot restored")
+
+    def sitl_checkpoint(self, path, timeout=30):
+        '''write a checkpoint of the running vehicle to path; may be
+        done in flight.  Start SITL with --resume=path to carry on
+        from it, e.g. through customise_SITL_commandline'''
+        self.progress("Writing SITL checkpoint to %s" % path)
+        outcome = self.sitl_snapshot_command(103, "SITL: checkpoint", timeout=timeout)
+        if outcome != "SITL: checkpoint saved":
+            raise NotAchievedException("SITL checkpoint failed")
+        # SITL writes into its working directory, which is ours
+        os.rename("checkpoint.dat", path)
+
+    def reset_sitl_after_test(self):
+        '''put SITL back the way it was before the test; a snapshot
+        restore if we can, a reboot if not'''
+        if self.fast_reset and self.sitl_snapshot(restore=True):
+            self.do_timesync_roundtrip(timeout_in_wallclock=True)
+            return
+        self.reboot_sitl()
+        if self.fast_reset:
+            # any earlier snapshot died with the old process
+            self.sitl_snapshot()
+
     def reboot_sitl(self, required_bootcount=None, force=False, check_position=True):
         """Reboot SITL instance and wait for it to reconnect."""
         if self.armed() and not force:
@@ -8517,11 +8587,11 @@ Also, ignores heartbeats not from our target system'''
             else:
                 self.progress("Force-rebooting SITL")
                 self.zero_throttle()
-                self.reboot_sitl() # that'll learn it
+                self.reset_sitl_after_test() # that'll learn it
             passed = False
         elif ardupilot_alive and not passed:  # implicit reboot after a failed test:
             self.progress("Test failed but ArduPilot process alive; rebooting")
-            self.reboot_sitl() # that'll learn it
+            self.reset_sitl_after_test() # that'll learn it
 
         if self._mavproxy is not None:
             self.progress("Stopping auto-started mavproxy")
@@ -8578,10 +8648,16 @@ Also, ignores heartbeats not from our target system'''
                 self.mavproxy.interact()
 
         if self.reset_after_every_test:
-            reset_needed = True
+            if self.fast_reset and ardupilot_alive and not reset_needed:
+                if passed:
+                    self.reset_sitl_after_test()
+            else:
+                reset_needed = True
 
         if reset_needed:
             self.reset_SITL_commandline()
+            if self.fast_reset:
+                self.sitl_snapshot()
 
         if not self.is_tracker(): # FIXME - more to the point, fix Tracker's mission handling
             self.clear_mission(mavutil.mavlink.MAV_MISSION_TYPE_ALL)
@@ -11811,6 +11887,8 @@ switch value'''
             self.wait_for_mode_switch_poll()
             if not self.is_tracker(): # FIXME - more to the point, fix Tracker's mission handling
                 self.clear_mission(mavutil.mavlink.MAV_MISSION_TYPE_ALL)
+            if self.fast_reset:
+                self.sitl_snapshot()
 
             for test in tests:
                 self.drain_mav_unparsed()
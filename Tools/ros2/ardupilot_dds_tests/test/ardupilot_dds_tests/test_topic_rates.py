@@ -0,0 +1,148 @@
+# Copyright 2023 ArduPilot.org.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+"""Bring up ArduPilot SITL and measure the rate and latency of the fast topics."""
+import launch_pytest
+import pytest
+import rclpy
+import rclpy.node
+import threading
+import time
+
+from launch import LaunchDescription
+
+from launch_pytest.tools import process as process_tools
+
+from rclpy.qos import QoSProfile
+from rclpy.qos import QoSReliabilityPolicy
+from rclpy.qos import QoSHistoryPolicy
+
+from geometry_msgs.msg import PoseStamped
+from sensor_msgs.msg import Imu
+
+# topic, type, expected rate with the default DDS_RATE_* parameters
+TOPICS = [
+    ("ap/imu/experimental/data", Imu, 200),
+    ("ap/pose/filtered", PoseStamped, 30),
+]
+
+MEASURE_TIME_S = 10.0
+
+
+class RateListener(rclpy.node.Node):
+    """Record arrival times and stamps for a set of topics."""
+
+    def __init__(self):
+        """Initialise the node."""
+        super().__init__("rate_listener")
+        self.lock = threading.Lock()
+        self.samples = {topic: [] for topic, _, _ in TOPICS}
+
+    def start_subscriber(self):
+        """Start the subscribers."""
+        qos_profile = QoSProfile(
+            reliability=QoSReliabilityPolicy.BEST_EFFORT,
+            history=QoSHistoryPolicy.KEEP_LAST,
+            depth=10,
+        )
+        self.subscriptions_ = []
+        for topic, msg_type, _ in TOPICS:
+            self.subscriptions_.append(
+                self.create_subscription(
+                    msg_type, topic, lambda msg, topic=topic: self.subscriber_callback(topic, msg), qos_profile
+                )
+            )
+
+        # Add a spin thread.
+        self.ros_spin_thread = threading.Thread(target=lambda node: rclpy.spin(node), args=(self,))
+        self.ros_spin_thread.start()
+
+    def subscriber_callback(self, topic, msg):
+        """Record the receive time and the stamp of a message."""
+        stamp = msg.header.stamp.sec + msg.header.stamp.nanosec * 1.0e-9
+        with self.lock:
+            self.samples[topic].append((time.time(), stamp))
+
+    def clear(self):
+        """Forget everything received so far."""
+        with self.lock:
+            for topic in self.samples:
+                self.samples[topic] = []
+
+    def results(self, topic):
+        """Return the rate in Hz and the 95th percentile of the latency above the best seen, in seconds."""
+        with self.lock:
+            samples = list(self.samples[topic])
+        if len(samples) < 2:
+            return 0.0, None
+        rate = (len(samples) - 1) / (samples[-1][0] - samples[0][0])
+        # the SITL clock and ours may be offset, so judge the latency
+        # of each sample against the quickest one
+        offsets = sorted(rx - stamp for rx, stamp in samples)
+        excess = [o - offsets[0] for o in offsets]
+        return rate, excess[int(0.95 * (len(excess) - 1))]
+
+
+@launch_pytest.fixture
+def launch_sitl_copter_dds_udp(sitl_copter_dds_udp):
+    """Fixture to create the launch description."""
+    sitl_ld, sitl_actions = sitl_copter_dds_udp
+
+    ld = LaunchDescription(
+        [
+            sitl_ld,
+            launch_pytest.actions.ReadyToTest(),
+        ]
+    )
+    actions = sitl_actions
+    yield ld, actions
+
+
+@pytest.mark.launch(fixture=launch_sitl_copter_dds_udp)
+def test_dds_udp_topic_rates(launch_context, launch_sitl_copter_dds_udp):
+    """Test the fast topics are published at their configured rates."""
+    _, actions = launch_sitl_copter_dds_udp
+    micro_ros_agent = actions["micro_ros_agent"].action
+    mavproxy = actions["mavproxy"].action
+    sitl = actions["sitl"].action
+
+    # Wait for process to start.
+    process_tools.wait_for_start_sync(launch_context, micro_ros_agent, timeout=2)
+    process_tools.wait_for_start_sync(launch_context, mavproxy, timeout=2)
+    process_tools.wait_for_start_sync(launch_context, sitl, timeout=2)
+
+    rclpy.init()
+    try:
+        node = RateListener()
+        node.start_subscriber()
+
+        # let the session come up before measuring
+        deadline = time.time() + 20.0
+        while time.time() < deadline and not all(node.samples[topic] for topic, _, _ in TOPICS):
+            time.sleep(0.1)
+        node.clear()
+        time.sleep(MEASURE_TIME_S)
+
+        for topic, _, expected_rate in TOPICS:
+            rate, latency = node.results(topic)
+            assert latency is not None, "Did not receive '{}' msgs.".format(topic)
+            node.get_logger().info(
+                "{}: {:.1f} Hz (expected {}), p95 latency {:.1f} ms".format(topic, rate, expected_rate, latency * 1000)
+            )
+            assert rate > 0.8 * expected_rate, "'{}' rate {:.1f} Hz too low".format(topic, rate)
+            assert latency < 0.02, "'{}' latency {:.1f} ms too high".format(topic, latency * 1000)
+    finally:
+        rclpy.shutdown()
+    yield
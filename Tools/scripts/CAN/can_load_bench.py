@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+'''
+load a DroneCAN bus as a vehicle with many ESCs would see it, and
+measure how well the vehicle keeps up
+
+  ./Tools/scripts/CAN/can_load_bench.py --port mcast:0 --escs 8 --rate 400 --noise 2000
+
+Pretends to be a set of ESCs broadcasting esc.Status, optionally with
+extra frames of data types nobody subscribes to, and reports the rate
+of esc.RawCommand from the vehicle alongside the frame rate offered
+'''
+
+import dronecan
+import time
+
+from argparse import ArgumentParser
+parser = ArgumentParser(description=__doc__)
+parser.add_argument("--port", default="mcast:0", type=str, help="CAN port, e.g. mcast:0 or vcan0")
+parser.add_argument("--node-id", default=100, type=int, help="our node ID")
+parser.add_argument("--escs", default=8, type=int, help="number of ESCs to pretend to be")
+parser.add_argument("--rate", default=400, type=float, help="esc.Status rate per ESC in Hz")
+parser.add_argument("--noise", default=0, type=float, help="rate of unwanted frames in Hz")
+parser.add_argument("--duration", default=20, type=float, help="seconds to run for")
+args = parser.parse_args()
+
+# unused data type ID for the noise frames, and the priority to send them at
+NOISE_DTID = 20123
+NOISE_PRIORITY = 24
+
+node = dronecan.make_node(args.port, node_id=args.node_id, bitrate=1000000)
+
+raw_commands = 0
+frames_sent = 0
+
+
+def handle_raw_command(msg):
+    global raw_commands
+    raw_commands += 1
+
+
+node.add_handler(dronecan.uavcan.equipment.esc.RawCommand, handle_raw_command)
+
+
+def send_noise(transfer_id):
+    '''
+    send a frame of an unwanted type. Alternate between single frame
+    transfers and the middle of multi-frame ones, which the vehicle has
+    to check again on every frame
+    '''
+    can_id = (NOISE_PRIORITY << 24) | (NOISE_DTID << 8) | args.node_id
+    tail = transfer_id & 0x1F
+    if transfer_id & 1:
+        tail |= 0xC0
+    node.can_driver.send(can_id, bytearray([transfer_id & 0xFF] * 7 + [tail]), extended=True, canfd=False)
+
+
+status_interval = 1.0 / (args.rate * args.escs) if args.rate > 0 and args.escs > 0 else None
+noise_interval = 1.0 / args.noise if args.noise > 0 else None
+
+t0 = time.time()
+next_status = t0
+next_noise = t0
+next_report = t0 + 1
+esc_index = 0
+noise_tid = 0
+last_commands = 0
+last_frames = 0
+
+while time.time() - t0 < args.duration:
+    now = time.time()
+    if status_interval is not None and now >= next_status:
+        msg = dronecan.uavcan.equipment.esc.Status()
+        msg.esc_index = esc_index
+        msg.voltage = 16.0
+        msg.current = 2.0
+        msg.temperature = 300
+        msg.rpm = 5000
+        msg.power_rating_pct = 20
+        node.broadcast(msg)
+        # 14 byte payload plus CRC, in three frames
+        frames_sent += 3
+        esc_index = (esc_index + 1) % args.escs
+        next_status += status_interval
+    if noise_interval is not None and now >= next_noise:
+        send_noise(noise_tid)
+        noise_tid += 1
+        frames_sent += 1
+        next_noise += noise_interval
+    if now >= next_report:
+        dt = now - next_report + 1
+        print("RawCommand %6.1f Hz   frames offered %7.1f/s" % (
+            (raw_commands - last_commands) / dt, (frames_sent - last_frames) / dt))
+        last_commands = raw_commands
+        last_frames = frames_sent
+        next_report = now + 1
+    node.spin(0)
+
+dt = time.time() - t0
+print("average: RawCommand %.1f Hz, frames offered %.1f/s" % (raw_commands / dt, frames_sent / dt))
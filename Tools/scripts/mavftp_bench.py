@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+'''
+measure MAVLink FTP download speed, for example of logs from SITL
+
+  ./Tools/scripts/mavftp_bench.py --master tcp:127.0.0.1:5760 logs/00000001.BIN logs/00000002.BIN
+
+Each file is fetched with burst reads on its own session, all sessions
+at once. Gaps are filled with further bursts from the first missing
+byte. Prints the rate for each file and for all files together
+'''
+
+import os
+import struct
+import sys
+import time
+
+from argparse import ArgumentParser
+from pymavlink import mavutil
+
+parser = ArgumentParser(description=__doc__)
+parser.add_argument("--master", default="tcp:127.0.0.1:5760", help="MAVLink connection")
+parser.add_argument("--source-system", type=int, default=250, help="our system ID")
+parser.add_argument("--timeout", type=float, default=60, help="give up after this many seconds")
+parser.add_argument("--repeat", type=int, default=1, help="fetch the files this many times")
+parser.add_argument("--check", default=None, help="compare with the local copy in this directory")
+parser.add_argument("files", nargs="+", help="paths on the vehicle")
+args = parser.parse_args()
+
+OP_TerminateSession = 1
+OP_ResetSessions = 2
+OP_OpenFileRO = 4
+OP_BurstReadFile = 15
+OP_Ack = 128
+OP_Nack = 129
+
+ERR_EndOfFile = 6
+
+MAX_DATA = 239
+HDR_FORMAT = "<HBBBBBBI"
+HDR_LEN = struct.calcsize(HDR_FORMAT)
+
+
+class Transfer(object):
+    '''one file being fetched on its own session'''
+    def __init__(self, mav, session, path):
+        self.mav = mav
+        self.session = session
+        self.path = path
+        self.seq = 0
+        self.size = None
+        self.data = None
+        self.have = None
+        self.burst_ofs = 0
+        self.done = False
+        self.error = None
+        self.packets = 0
+        self.duplicates = 0
+        self.bursts = 0
+        self.t_start = time.time()
+        self.t_end = None
+        self.last_rx = time.time()
+        self.send(OP_OpenFileRO, path.encode('utf-8'))
+
+    def send(self, opcode, data=b'', offset=0, size=None, resend=False):
+        '''send a request, or with resend the last request again with the
+        same sequence number so the vehicle answers with its saved reply'''
+        if size is None:
+            size = len(data)
+        if not resend:
+            self.seq = (self.seq + 1) % 65536
+        hdr = struct.pack(HDR_FORMAT, self.seq, self.session, opcode, size, 0, 0, 0, offset)
+        payload = bytearray(hdr + data)
+        payload.extend(bytearray(251 - len(payload)))
+        self.mav.mav.file_transfer_protocol_send(0, self.mav.target_system, self.mav.target_component, payload)
+
+    def request_burst(self):
+        '''ask for a burst from the first byte we don't have'''
+        gap = self.have.find(0)
+        if gap == -1:
+            self.finish()
+            return
+        self.burst_ofs = gap
+        self.bursts += 1
+        self.send(OP_BurstReadFile, offset=gap, size=MAX_DATA)
+
+    def finish(self, error=None):
+        self.done = True
+        self.error = error
+        self.t_end = time.time()
+        self.send(OP_TerminateSession)
+
+    def handle(self, opcode, req_opcode, size, burst_complete, offset, data):
+        self.last_rx = time.time()
+        if req_opcode == OP_OpenFileRO:
+            if opcode != OP_Ack:
+                self.finish("open failed")
+                return
+            self.size, = struct.unpack("<I", data[0:4])
+            self.data = bytearray(self.size)
+            self.have = bytearray(self.size)
+            self.t_start = time.time()
+            self.request_burst()
+            return
+        if req_opcode != OP_BurstReadFile or self.data is None:
+            return
+        if opcode == OP_Nack:
+            if data[0] == ERR_EndOfFile and self.have.find(0) != -1:
+                # a short stat, or data lost at the end
+                self.request_burst()
+            elif data[0] == ERR_EndOfFile:
+                self.finish()
+            else:
+                self.finish("read failed %u" % data[0])
+            return
+        self.packets += 1
+        end = min(offset + size, self.size)
+        if offset < end:
+            if self.have[offset:end].find(0) == -1:
+                self.duplicates += 1
+            self.data[offset:end] = data[:end-offset]
+            self.have[offset:end] = b'\x01' * (end - offset)
+        if self.have.find(0) == -1:
+            self.finish()
+        elif burst_complete:
+            self.request_burst()
+
+    def check_timeout(self):
+        if self.done or time.time() - self.last_rx < 0.5:
+            return
+        self.last_rx = time.time()
+        if self.data is None:
+            # the session is already open if only the reply was lost
+            self.send(OP_OpenFileRO, self.path.encode('utf-8'), resend=True)
+        else:
+            self.request_burst()
+
+    def elapsed(self):
+        return (self.t_end or time.time()) - self.t_start
+
+
+def fetch_all(mav, paths):
+    mav.mav.file_transfer_protocol_send(0, mav.target_system, mav.target_component,
+                                        bytearray(struct.pack(HDR_FORMAT, 0, 0, OP_ResetSessions, 0, 0, 0, 0, 0)) +
+                                        bytearray(251 - HDR_LEN))
+    transfers = {}
+    for i, path in enumerate(paths):
+        transfers[i+1] = Transfer(mav, i+1, path)
+    t0 = time.time()
+    while not all(t.done for t in transfers.values()):
+        if time.time() - t0 > args.timeout:
+            for t in transfers.values():
+                if not t.done:
+                    t.finish("timed out")
+            break
+        m = mav.recv_match(type='FILE_TRANSFER_PROTOCOL', blocking=True, timeout=0.1)
+        if m is not None and m.target_system == args.source_system:
+            payload = bytearray(m.payload)
+            seq, session, opcode, size, req_opcode, burst_complete, pad, offset = struct.unpack(HDR_FORMAT, payload[0:HDR_LEN])
+            t = transfers.get(session, None)
+            if t is not None and not t.done:
+                t.handle(opcode, req_opcode, size, burst_complete, offset, payload[HDR_LEN:HDR_LEN+size])
+        for t in transfers.values():
+            t.check_timeout()
+    return list(transfers.values()), time.time() - t0
+
+
+mav = mavutil.mavlink_connection(args.master, source_system=args.source_system)
+mav.wait_heartbeat()
+print("Connected to system %u" % mav.target_system)
+
+ok = True
+for r in range(args.repeat):
+    transfers, total_time = fetch_all(mav, args.files)
+    total_bytes = 0
+    for t in transfers:
+        if t.error is not None:
+            print("%s: %s" % (t.path, t.error))
+            ok = False
+            continue
+        total_bytes += t.size
+        rate = t.size / max(t.elapsed(), 1.0e-6) / 1.0e6
+        print("%-32s %9u bytes %7.2fs %7.3f MB/s packets=%u dups=%u bursts=%u" % (
+            t.path, t.size, t.elapsed(), rate, t.packets, t.duplicates, t.bursts))
+        if args.check is not None:
+            local = open(os.path.join(args.check, t.path), 'rb').read()
+            if local != bytes(t.data):
+                print("%s: content mismatch" % t.path)
+                ok = False
+    print("total %u bytes in %.2fs: %.3f MB/s" % (total_bytes, total_time, total_bytes / max(total_time, 1.0e-6) / 1.0e6))
+
+sys.exit(0 if ok else 1)
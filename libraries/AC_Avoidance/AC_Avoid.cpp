@@ -831,6 +831,49 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
     // for backing away
     Vector2f quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel;
 
+#if AP_AVOIDANCE_FENCE_CACHE_ENABLED
+    Vector2f position_xy;
+    if (!AP::ahrs().get_relative_position_NE_origin(position_xy)) {
+        // boundary is in earth frame but we have no idea where we are
+        return;
+    }
+    position_xy = position_xy * 100.0f;  // m to cm
+
+    // no edge further away than the stopping point plus margin can
+    // limit velocity. get_max_speed() also limits to one step of
+    // travel per dt, so look at least that far
+    const float speed = desired_vel_cms.length();
+    const float lookahead_cm = 2.0f + MAX(fence->get_margin() * 100.0f, 0.0f) + MAX(get_stopping_distance(kP, accel_cmss, speed), speed * dt);
+    if (is_positive(accel_cmss) && update_fence_cache(*fence, position_xy, lookahead_cm)) {
+        for (uint8_t i = 0; i < _fence_cache.num_polygons; i++) {
+            const FenceCachePolygon &polygon = _fence_cache.polygons[i];
+            if (!polygon.active) {
+                // already breached
+                continue;
+            }
+            PolygonLimit limit;
+            init_polygon_limit(kP, accel_cmss, desired_vel_cms, position_xy, fence->get_margin(), limit);
+            bool on_edge = false;
+            for (uint16_t e = polygon.first_edge; e < polygon.first_edge + polygon.num_edges; e++) {
+                const FenceCacheEdge &edge = _fence_cache.edges[e];
+                if (!limit_velocity_polygon_edge(kP, accel_cmss, desired_vel_cms, edge.start, edge.end, limit, dt)) {
+                    on_edge = true;
+                    break;
+                }
+            }
+            if (on_edge) {
+                continue;
+            }
+            Vector2f backup_vel_polygon;
+            finish_polygon_limit(limit, desired_vel_cms, backup_vel_polygon);
+            find_max_quadrant_velocity(backup_vel_polygon, quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel);
+        }
+        // desired backup velocity is sum of maximum velocity component in each quadrant
+        backup_vel = quad_1_back_vel + quad_2_back_vel + quad_3_back_vel + quad_4_back_vel;
+        return;
+    }
+#endif
+
     // iterate through inclusion polygons
     const uint8_t num_inclusion_polygons = fence->polyfence().get_inclusion_polygon_count();
     for (uint8_t i = 0; i < num_inclusion_polygons; i++) {
@@ -856,6 +899,110 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
     backup_vel = quad_1_back_vel + quad_2_back_vel + quad_3_back_vel + quad_4_back_vel;
 }
 
+#if AP_AVOIDANCE_FENCE_CACHE_ENABLED
+/*
+ * Check the cache of nearby polygon fence edges covers every edge
+ * within lookahead_cm of the vehicle, rebuilding it if not
+ */
+bool AC_Avoid::update_fence_cache(const AC_Fence &fence, const Vector2f &position_xy, float lookahead_cm)
+{
+    const AC_PolyFence_loader &polyfence = fence.polyfence();
+    const float moved_cm = (position_xy - _fence_cache.build_pos).length();
+
+    bool rebuild = !_fence_cache.built ||
+        _fence_cache.load_ms != polyfence.get_inclusion_polygon_update_ms() ||
+        !is_equal(_fence_cache.margin_m, fence.get_margin()) ||
+        moved_cm + lookahead_cm > _fence_cache.radius_cm;
+
+    if (!rebuild && !_fence_cache.overflow) {
+        // crossing an edge may change which polygons we are inside
+        for (uint16_t i = 0; i < _fence_cache.num_edges; i++) {
+            Vector2f intersection;
+            if (Vector2f::segment_intersection(_fence_cache.build_pos, position_xy, _fence_cache.edges[i].start, _fence_cache.edges[i].end, intersection)) {
+                rebuild = true;
+                break;
+            }
+        }
+    }
+
+    if (!rebuild) {
+        return !_fence_cache.overflow;
+    }
+
+    // cover twice the current lookahead so the vehicle can move some
+    // way before the next rebuild
+    _fence_cache.built = true;
+    _fence_cache.overflow = false;
+    _fence_cache.build_pos = position_xy;
+    _fence_cache.radius_cm = MAX(AC_AVOID_FENCE_CACHE_RADIUS_CM, 2.0f * lookahead_cm);
+    _fence_cache.margin_m = fence.get_margin();
+    _fence_cache.load_ms = polyfence.get_inclusion_polygon_update_ms();
+    _fence_cache.num_polygons = 0;
+    _fence_cache.num_edges = 0;
+
+    const uint8_t num_inclusion_polygons = polyfence.get_inclusion_polygon_count();
+    for (uint8_t i = 0; i < num_inclusion_polygons; i++) {
+        uint16_t num_points;
+        const Vector2f* boundary = polyfence.get_inclusion_polygon(i, num_points);
+        if (!add_fence_cache_polygon(boundary, num_points, true)) {
+            _fence_cache.overflow = true;
+            return false;
+        }
+    }
+    const uint8_t num_exclusion_polygons = polyfence.get_exclusion_polygon_count();
+    for (uint8_t i = 0; i < num_exclusion_polygons; i++) {
+        uint16_t num_points;
+        const Vector2f* boundary = polyfence.get_exclusion_polygon(i, num_points);
+        if (!add_fence_cache_polygon(boundary, num_points, false)) {
+            _fence_cache.overflow = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AC_Avoid::add_fence_cache_polygon(const Vector2f *boundary, uint16_t num_points, bool stay_inside)
+{
+    if (boundary == nullptr || num_points == 0) {
+        return true;
+    }
+
+    const Vector2f &pos = _fence_cache.build_pos;
+    const float radius_sq = sq(_fence_cache.radius_cm);
+    const uint16_t first_edge = _fence_cache.num_edges;
+
+    // keep edges in the same order as adjust_velocity_polygon walks them
+    for (uint16_t i = 0; i < num_points; i++) {
+        uint16_t j = i+1;
+        if (j >= num_points) {
+            j = 0;
+        }
+        if (Vector2f::closest_distance_between_line_and_point_squared(boundary[j], boundary[i], pos) > radius_sq) {
+            continue;
+        }
+        if (_fence_cache.num_edges >= AC_AVOID_FENCE_CACHE_EDGES) {
+            return false;
+        }
+        _fence_cache.edges[_fence_cache.num_edges++] = FenceCacheEdge { boundary[j], boundary[i] };
+    }
+
+    if (_fence_cache.num_edges == first_edge) {
+        // nothing near enough to limit velocity
+        return true;
+    }
+    if (_fence_cache.num_polygons >= AC_AVOID_FENCE_CACHE_POLYGONS) {
+        return false;
+    }
+    const bool inside_polygon = !Polygon_outside(pos, boundary, num_points);
+    _fence_cache.polygons[_fence_cache.num_polygons++] = FenceCachePolygon {
+        first_edge,
+        uint16_t(_fence_cache.num_edges - first_edge),
+        inside_polygon == stay_inside,
+    };
+    return true;
+}
+#endif  // AP_AVOIDANCE_FENCE_CACHE_ENABLED
+
 /*
  * Adjusts the desired velocity for the inclusion circles
  */
@@ -1165,6 +1312,11 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
     }
 
     AP_Proximity &_proximity = *proximity;
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+    adjust_velocity_proximity_voxels(kP, accel_cmss, desired_vel_cms, kP_z, accel_cmss_z, dt);
+#endif
+
     // get total number of obstacles
     const uint8_t obstacle_num = _proximity.get_obstacle_count();
     if (obstacle_num == 0) {
@@ -1292,6 +1444,37 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
 #endif // HAL_PROXIMITY_ENABLED
 }
 
+#if AP_PROXIMITY_VOXEL_ENABLED
+/*
+ * Adjusts the desired velocity to stop short of obstacles in the proximity voxel map
+ * The map gives the distance to the nearest obstacle roughly along the velocity vector
+ */
+void AC_Avoid::adjust_velocity_proximity_voxels(float kP, float accel_cmss, Vector3f &desired_vel_cms, float kP_z, float accel_cmss_z, float dt)
+{
+    const AP_Proximity *proximity = AP::proximity();
+    if (desired_vel_cms.is_zero() || proximity == nullptr || !proximity->voxels.enabled()) {
+        return;
+    }
+
+    Vector3f current_pos;
+    if (!AP::ahrs().get_relative_position_NED_origin(current_pos)) {
+        return;
+    }
+
+    // desired velocity is NEU, the map is NED
+    const Vector3f dir_ned{desired_vel_cms.x, desired_vel_cms.y, -desired_vel_cms.z};
+    float distance_m;
+    if (!proximity->voxels.get_distance_along(current_pos, dir_ned, distance_m)) {
+        return;
+    }
+
+    // treat the obstacle as lying straight ahead along the velocity vector
+    const float margin_cm = MAX(_margin * 100.0f, 0.0f);
+    const Vector3f obstacle_vector = desired_vel_cms.normalized() * (distance_m * 100.0f);
+    limit_velocity_3D(kP, accel_cmss, desired_vel_cms, obstacle_vector, margin_cm, kP_z, accel_cmss_z, dt);
+}
+#endif  // AP_PROXIMITY_VOXEL_ENABLED
+
 /*
  * Adjusts the desired velocity for the polygon fence.
  */
@@ -1320,93 +1503,115 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
         return;
     }
 
+    PolygonLimit limit;
+    init_polygon_limit(kP, accel_cmss, desired_vel_cms, position_xy, margin, limit);
+
+    for (uint16_t i=0; i<num_points; i++) {
+        uint16_t j = i+1;
+        if (j >= num_points) {
+            j = 0;
+        }
+        // end points of current edge
+        if (!limit_velocity_polygon_edge(kP, accel_cmss, desired_vel_cms, boundary[j], boundary[i], limit, dt)) {
+            return;
+        }
+    }
+
+    finish_polygon_limit(limit, desired_vel_cms, backup_vel);
+}
+
+void AC_Avoid::init_polygon_limit(float kP, float accel_cmss, const Vector2f &desired_vel_cms, const Vector2f &position_xy, float margin, PolygonLimit &limit) const
+{
+    limit.position_xy = position_xy;
+
     // Safe_vel will be adjusted to remain within fence.
     // We need a separate vector in case adjustment fails,
     // e.g. if we are exactly on the boundary.
-    Vector2f safe_vel(desired_vel_cms);
-    Vector2f desired_back_vel_cms;
+    limit.safe_vel = desired_vel_cms;
 
     // calc margin in cm
-    const float margin_cm = MAX(margin * 100.0f, 0.0f);
+    limit.margin_cm = MAX(margin * 100.0f, 0.0f);
 
     // for stopping
-    const float speed = safe_vel.length();
-    Vector2f stopping_point_plus_margin; 
+    const float speed = limit.safe_vel.length();
+    limit.stopping_point_plus_margin.zero();
     if (!desired_vel_cms.is_zero()) {
-        stopping_point_plus_margin = position_xy + safe_vel*((2.0f + margin_cm + get_stopping_distance(kP, accel_cmss, speed))/speed);
+        limit.stopping_point_plus_margin = position_xy + limit.safe_vel*((2.0f + limit.margin_cm + get_stopping_distance(kP, accel_cmss, speed))/speed);
     }
 
     // for backing away
-    Vector2f quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel;
-   
-    for (uint16_t i=0; i<num_points; i++) {
-        uint16_t j = i+1;
-        if (j >= num_points) {
-            j = 0;
-        }
-        // end points of current edge
-        Vector2f start = boundary[j];
-        Vector2f end = boundary[i];
-        Vector2f vector_to_boundary = Vector2f::closest_point(position_xy, start, end) - position_xy;
-        // back away if vehicle has breached margin
-        if (is_negative(vector_to_boundary.length() - margin_cm)) {
-            calc_backup_velocity_2D(kP, accel_cmss, quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel, margin_cm-vector_to_boundary.length(), vector_to_boundary, dt);
-        }
-        
-        // exit immediately if no desired velocity
-        if (desired_vel_cms.is_zero()) {
-            continue;
+    for (Vector2f &quad_back_vel : limit.quad_back_vel) {
+        quad_back_vel.zero();
+    }
+}
+
+bool AC_Avoid::limit_velocity_polygon_edge(float kP, float accel_cmss, const Vector2f &desired_vel_cms, const Vector2f &start, const Vector2f &end, PolygonLimit &limit, float dt)
+{
+    const Vector2f &position_xy = limit.position_xy;
+    const float margin_cm = limit.margin_cm;
+
+    Vector2f vector_to_boundary = Vector2f::closest_point(position_xy, start, end) - position_xy;
+    // back away if vehicle has breached margin
+    if (is_negative(vector_to_boundary.length() - margin_cm)) {
+        calc_backup_velocity_2D(kP, accel_cmss, limit.quad_back_vel[0], limit.quad_back_vel[1], limit.quad_back_vel[2], limit.quad_back_vel[3], margin_cm-vector_to_boundary.length(), vector_to_boundary, dt);
+    }
+
+    // exit immediately if no desired velocity
+    if (desired_vel_cms.is_zero()) {
+        return true;
+    }
+
+    switch (_behavior) {
+    case (BEHAVIOR_SLIDE): {
+        // vector from current position to closest point on current edge
+        Vector2f limit_direction = vector_to_boundary;
+        // distance to closest point
+        const float limit_distance_cm = limit_direction.length();
+        if (is_zero(limit_distance_cm)) {
+            // We are exactly on the edge - treat this as a fence breach.
+            // i.e. do not adjust velocity.
+            return false;
         }
+        // We are strictly inside the given edge.
+        // Adjust velocity to not violate this edge.
+        limit_direction /= limit_distance_cm;
+        limit_velocity_2D(kP, accel_cmss, limit.safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
+        break;
+    }
 
-        switch (_behavior) {
-        case (BEHAVIOR_SLIDE): {
-            // vector from current position to closest point on current edge
-            Vector2f limit_direction = vector_to_boundary;
-            // distance to closest point
+    case (BEHAVIOR_STOP): {
+        // find intersection with line segment
+        Vector2f intersection;
+        if (Vector2f::segment_intersection(position_xy, limit.stopping_point_plus_margin, start, end, intersection)) {
+            // vector from current position to point on current edge
+            Vector2f limit_direction = intersection - position_xy;
             const float limit_distance_cm = limit_direction.length();
             if (is_zero(limit_distance_cm)) {
                 // We are exactly on the edge - treat this as a fence breach.
                 // i.e. do not adjust velocity.
-                return;
+                return false;
             }
-            // We are strictly inside the given edge.
-            // Adjust velocity to not violate this edge.
-            limit_direction /= limit_distance_cm;
-            limit_velocity_2D(kP, accel_cmss, safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
-            break;
-        } 
-        
-        case (BEHAVIOR_STOP): {
-            // find intersection with line segment
-            Vector2f intersection;
-            if (Vector2f::segment_intersection(position_xy, stopping_point_plus_margin, start, end, intersection)) {
-                // vector from current position to point on current edge
-                Vector2f limit_direction = intersection - position_xy;
-                const float limit_distance_cm = limit_direction.length();
-                if (is_zero(limit_distance_cm)) {
-                    // We are exactly on the edge - treat this as a fence breach.
-                    // i.e. do not adjust velocity.
-                    return;
-                }
-                if (limit_distance_cm <= margin_cm) {
-                    // we are within the margin so stop vehicle
-                    safe_vel.zero();
-                } else {
-                    // vehicle inside the given edge, adjust velocity to not violate this edge
-                    limit_direction /= limit_distance_cm;
-                    limit_velocity_2D(kP, accel_cmss, safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
-                }
+            if (limit_distance_cm <= margin_cm) {
+                // we are within the margin so stop vehicle
+                limit.safe_vel.zero();
+            } else {
+                // vehicle inside the given edge, adjust velocity to not violate this edge
+                limit_direction /= limit_distance_cm;
+                limit_velocity_2D(kP, accel_cmss, limit.safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
             }
-        break;
-        }
         }
+        break;
     }
-    // desired backup velocity is sum of maximum velocity component in each quadrant 
-    desired_back_vel_cms = quad_1_back_vel + quad_2_back_vel + quad_3_back_vel + quad_4_back_vel;
+    }
+    return true;
+}
 
+void AC_Avoid::finish_polygon_limit(const PolygonLimit &limit, Vector2f &desired_vel_cms, Vector2f &backup_vel) const
+{
     // set modified desired velocity vector or back away velocity vector
-    desired_vel_cms = safe_vel;
-    backup_vel = desired_back_vel_cms;
+    desired_vel_cms = limit.safe_vel;
+    // desired backup velocity is sum of maximum velocity component in each quadrant
+    backup_vel = limit.quad_back_vel[0] + limit.quad_back_vel[1] + limit.quad_back_vel[2] + limit.quad_back_vel[3];
 }
 
 /*
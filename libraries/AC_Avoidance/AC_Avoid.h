@@ -7,8 +7,11 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Proximity/AP_Proximity_config.h>
 #include <AC_AttitudeControl/AC_AttitudeControl.h> // Attitude controller library for sqrt controller
 
+class AC_Fence;
+
 #define AC_AVOID_ACCEL_CMSS_MAX         100.0f  // maximum acceleration/deceleration in cm/s/s used to avoid hitting fence
 
 // bit masks for enabled fence types.
@@ -25,6 +28,11 @@
 #define AC_AVOID_ACTIVE_LIMIT_TIMEOUT_MS    500     // if limiting is active if last limit is happened in the last x ms
 #define AC_AVOID_ACCEL_TIMEOUT_MS           200     // stored velocity used to calculate acceleration will be reset if avoidance is active after this many ms
 
+// definitions for the cache of polygon fence edges near the vehicle
+#define AC_AVOID_FENCE_CACHE_EDGES          64      // maximum number of cached edges, the full fence is used if more are nearby
+#define AC_AVOID_FENCE_CACHE_POLYGONS       16      // maximum number of polygons the cached edges may belong to
+#define AC_AVOID_FENCE_CACHE_RADIUS_CM      3000.0f // minimum radius around the vehicle covered by the cached edges
+
 /*
  * This class prevents the vehicle from leaving a polygon fence or hitting proximity-based obstacles
  * Additionally the vehicle may back up if the margin to obstacle is breached
@@ -154,6 +162,13 @@ private:
      */
     void adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &desired_vel_cms, Vector3f &backup_vel, float kP_z, float accel_cmss_z, float dt);
 
+#if AP_PROXIMITY_VOXEL_ENABLED
+    /*
+     * Adjusts the desired velocity to stop short of obstacles in the proximity voxel map
+     */
+    void adjust_velocity_proximity_voxels(float kP, float accel_cmss, Vector3f &desired_vel_cms, float kP_z, float accel_cmss_z, float dt);
+#endif
+
     /*
      * Adjusts the desired velocity given an array of boundary points
      * The boundary must be in Earth Frame
@@ -162,6 +177,65 @@ private:
      */
     void adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, Vector2f &backup_vel, const Vector2f* boundary, uint16_t num_points, float margin, float dt, bool stay_inside);
 
+    // state carried across the edges of one polygon by adjust_velocity_polygon
+    struct PolygonLimit {
+        Vector2f position_xy;                   // vehicle position in cm from the EKF origin
+        Vector2f stopping_point_plus_margin;    // furthest point the vehicle may reach, used by BEHAVIOR_STOP
+        Vector2f safe_vel;                      // desired velocity limited by the edges so far
+        Vector2f quad_back_vel[4];              // maximum backup velocity in each quadrant
+        float margin_cm;
+    };
+
+    // set up limit for a polygon given the vehicle position in cm and margin in meters
+    void init_polygon_limit(float kP, float accel_cmss, const Vector2f &desired_vel_cms, const Vector2f &position_xy, float margin, PolygonLimit &limit) const;
+
+    // limit velocity for one polygon edge. Returns false if the vehicle
+    // is exactly on the edge, in which case the polygon is treated as breached
+    bool limit_velocity_polygon_edge(float kP, float accel_cmss, const Vector2f &desired_vel_cms, const Vector2f &start, const Vector2f &end, PolygonLimit &limit, float dt);
+
+    // copy the limited and backup velocities out of limit
+    void finish_polygon_limit(const PolygonLimit &limit, Vector2f &desired_vel_cms, Vector2f &backup_vel) const;
+
+#if AP_AVOIDANCE_FENCE_CACHE_ENABLED
+    /*
+     * Polygon fence edges near the vehicle. Only edges within
+     * radius_cm of build_pos are kept, so while the vehicle's stopping
+     * distance plus the distance moved since the build fits in that
+     * radius every edge that could limit velocity is in the cache and
+     * the rest of the fence need not be walked. The cache is rebuilt
+     * once that no longer holds, when the fence is reloaded or the
+     * margin changes, and when the vehicle crosses a cached edge so
+     * that which polygons it is inside is tested again.
+     */
+    struct FenceCachePolygon {
+        uint16_t first_edge;
+        uint16_t num_edges;
+        bool active;                // vehicle was inside an inclusion or outside an exclusion polygon at the build
+    };
+    struct FenceCacheEdge {
+        Vector2f start;             // cm from the EKF origin
+        Vector2f end;
+    };
+    struct {
+        FenceCachePolygon polygons[AC_AVOID_FENCE_CACHE_POLYGONS];
+        FenceCacheEdge edges[AC_AVOID_FENCE_CACHE_EDGES];
+        uint8_t num_polygons;
+        uint16_t num_edges;
+        Vector2f build_pos;         // vehicle position in cm at the build
+        float radius_cm;
+        float margin_m;             // fence margin at the build
+        uint32_t load_ms;           // fence load time at the build
+        bool built;                 // build_pos, radius_cm, margin_m and load_ms are set
+        bool overflow;              // too many edges nearby, the full fence is walked
+    } _fence_cache;
+
+    // true if the cached edges can be used at position_xy (cm), rebuilding the cache if needed
+    bool update_fence_cache(const AC_Fence &fence, const Vector2f &position_xy, float lookahead_cm);
+
+    // add the edges of one polygon near the vehicle to the cache, returns false if it is full
+    bool add_fence_cache_polygon(const Vector2f *boundary, uint16_t num_points, bool stay_inside);
+#endif
+
     /*
      * Computes distance required to stop, given current speed.
      */
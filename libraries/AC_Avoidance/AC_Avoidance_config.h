@@ -7,6 +7,10 @@
 #define AP_AVOIDANCE_ENABLED AP_FENCE_ENABLED
 #endif
 
+#ifndef AP_AVOIDANCE_FENCE_CACHE_ENABLED
+#define AP_AVOIDANCE_FENCE_CACHE_ENABLED AP_AVOIDANCE_ENABLED && AP_FENCE_ENABLED && BOARD_FLASH_SIZE > 1024
+#endif
+
 #ifndef AP_OAPATHPLANNER_ENABLED
 #define AP_OAPATHPLANNER_ENABLED AP_FENCE_ENABLED
 #endif
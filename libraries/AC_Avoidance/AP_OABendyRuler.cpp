@@ -20,6 +20,7 @@
 #include "AP_OABendyRuler.h"
 #include <AC_Avoidance/AP_OADatabase.h>
 #include <AC_Fence/AC_Fence.h>
+#include <AP_Proximity/AP_Proximity.h>
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_Logger/AP_Logger.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
@@ -426,6 +427,12 @@ float AP_OABendyRuler::calc_avoidance_margin(const Location &start, const Locati
     if (calc_margin_from_object_database(start, end, latest_margin)) {
         margin_min = MIN(margin_min, latest_margin);
     }
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+    if (calc_margin_from_voxel_map(start, end, latest_margin)) {
+        margin_min = MIN(margin_min, latest_margin);
+    }
+#endif
     
     if (proximity_only) {
         // only need margin from proximity data
@@ -713,4 +720,27 @@ bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, co
     return false;
 }
 
+#if AP_PROXIMITY_VOXEL_ENABLED
+// calculate minimum distance between a path and obstacles in the proximity voxel map
+// on success returns true and updates margin
+bool AP_OABendyRuler::calc_margin_from_voxel_map(const Location &start, const Location &end, float &margin) const
+{
+    const AP_Proximity *proximity = AP::proximity();
+    if (proximity == nullptr || !proximity->voxels.enabled()) {
+        return false;
+    }
+
+    // convert start and end to offsets (in cm) from EKF origin
+    Vector3f start_NEU,end_NEU;
+    if (!start.get_vector_from_origin_NEU(start_NEU) || !end.get_vector_from_origin_NEU(end_NEU)) {
+        return false;
+    }
+
+    // map is NED in meters
+    const Vector3f start_NED{start_NEU.x * 0.01f, start_NEU.y * 0.01f, start_NEU.z * -0.01f};
+    const Vector3f end_NED{end_NEU.x * 0.01f, end_NEU.y * 0.01f, end_NEU.z * -0.01f};
+    return proximity->voxels.get_segment_clearance(start_NED, end_NED, margin);
+}
+#endif  // AP_PROXIMITY_VOXEL_ENABLED
+
 #endif  // AP_OAPATHPLANNER_BENDYRULER_ENABLED
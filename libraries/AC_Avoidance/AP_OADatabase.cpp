@@ -21,6 +21,7 @@
 #include <GCS_MAVLink/GCS.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
+#include <AP_Common/AP_HeapAccounting.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -122,6 +123,8 @@ AP_OADatabase::AP_OADatabase()
 
 void AP_OADatabase::init()
 {
+    HEAP_TAG_SCOPE(OADATABASE);
+
     init_database();
     init_queue();
 
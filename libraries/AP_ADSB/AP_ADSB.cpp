@@ -77,7 +77,7 @@ const AP_Param::GroupInfo AP_ADSB::var_info[] = {
     // @Param: LIST_MAX
     // @DisplayName: ADSB vehicle list size
     // @Description: ADSB list size of nearest vehicles. Longer lists take longer to refresh with lower SRx_ADSB values.
-    // @Range: 1 100
+    // @Range: 1 500
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("LIST_MAX",   2, AP_ADSB, in_state.list_size_param, ADSB_VEHICLE_LIST_SIZE_DEFAULT),
@@ -205,9 +205,16 @@ void AP_ADSB::init(void)
         in_state.list_size_param.set(constrain_int16(in_state.list_size_param, 1, INT16_MAX));
 
         in_state.vehicle_list = NEW_NOTHROW adsb_vehicle_t[in_state.list_size_param];
+        in_state.vehicle_distance = NEW_NOTHROW float[in_state.list_size_param];
 
-        if (in_state.vehicle_list == nullptr) {
+        if (in_state.vehicle_list == nullptr ||
+            in_state.vehicle_distance == nullptr ||
+            !in_state.icao_index.init(in_state.list_size_param)) {
             // dynamic RAM allocation of in_state.vehicle_list[] failed
+            delete[] in_state.vehicle_list;
+            in_state.vehicle_list = nullptr;
+            delete[] in_state.vehicle_distance;
+            in_state.vehicle_distance = nullptr;
             _init_failed = true; // this keeps us from constantly trying to init forever in main update
             GCS_SEND_TEXT(MAV_SEVERITY_INFO, "ADSB: Unable to initialize ADSB vehicle list");
             return;
@@ -440,7 +447,8 @@ void AP_ADSB::update(const AP_ADSB::Loc &loc)
 
 /*
  * determine index and distance of furthest vehicle. This is
- * used to bump it off when a new closer aircraft is detected
+ * used to bump it off when a new closer aircraft is detected. The
+ * distances are those from each vehicle's last update
  */
 void AP_ADSB::determine_furthest_aircraft(void)
 {
@@ -451,7 +459,7 @@ void AP_ADSB::determine_furthest_aircraft(void)
         if (is_special_vehicle(in_state.vehicle_list[index].info.ICAO_address)) {
             continue;
         }
-        const float distance = _my_loc.get_distance(get_location(in_state.vehicle_list[index]));
+        const float distance = in_state.vehicle_distance[index];
         if (max_distance < distance || index == 0) {
             max_distance = distance;
             max_distance_index = index;
@@ -492,8 +500,11 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
         in_state.furthest_vehicle_distance = 0;
         in_state.furthest_vehicle_index = 0;
     }
+    in_state.icao_index.remove(in_state.vehicle_list[index].info.ICAO_address);
     if (index != (in_state.vehicle_count-1)) {
         in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+        in_state.vehicle_distance[index] = in_state.vehicle_distance[in_state.vehicle_count-1];
+        in_state.icao_index.insert(in_state.vehicle_list[index].info.ICAO_address, index);
     }
     // TODO: is memset needed? When we decrement the index we essentially forget about it
     memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
@@ -507,13 +518,7 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
-            *index = i;
-            return true;
-        }
-    }
-    return false;
+    return in_state.icao_index.find(vehicle.info.ICAO_address, *index);
 }
 
 /*
@@ -556,12 +561,12 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
     } else if (is_tracked_in_list) {
 
         // found, update it
-        set_vehicle(index, vehicle);
+        set_vehicle(index, vehicle, my_loc_distance_to_vehicle);
 
     } else if (in_state.vehicle_count < in_state.list_size_allocated) {
 
         // not found and there's room, add it to the end of the list
-        set_vehicle(in_state.vehicle_count, vehicle);
+        set_vehicle(in_state.vehicle_count, vehicle, my_loc_distance_to_vehicle);
         in_state.vehicle_count++;
 
     } else {
@@ -580,7 +585,7 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
 
             if (my_loc_distance_to_vehicle < in_state.furthest_vehicle_distance) { // is closer than the furthest
                 // replace with the furthest vehicle
-                set_vehicle(in_state.furthest_vehicle_index, vehicle);
+                set_vehicle(in_state.furthest_vehicle_index, vehicle, my_loc_distance_to_vehicle);
 
                 // in_state.furthest_vehicle_index is now invalid because the vehicle was overwritten, need
                 // to run determine_furthest_aircraft() to determine a new one next time
@@ -604,13 +609,20 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
 /*
  * Copy a vehicle's data into the list
  */
-void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
+void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle, const float distance_m)
 {
     if (index >= in_state.list_size_allocated) {
         // out of range
         return;
     }
+    if (index < in_state.vehicle_count &&
+        in_state.vehicle_list[index].info.ICAO_address != vehicle.info.ICAO_address) {
+        // replacing a different vehicle
+        in_state.icao_index.remove(in_state.vehicle_list[index].info.ICAO_address);
+    }
     in_state.vehicle_list[index] = vehicle;
+    in_state.vehicle_distance[index] = distance_m;
+    in_state.icao_index.insert(vehicle.info.ICAO_address, index);
 
 #if HAL_LOGGING_ENABLED
     write_log(vehicle);
@@ -29,6 +29,7 @@
 #include <AP_Common/Location.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_GPS/AP_GPS_FixType.h>
+#include "AP_ADSB_TrafficIndex.h"
 
 #define ADSB_MAX_INSTANCES             1   // Maximum number of ADSB sensor instances available on this platform
 
@@ -236,13 +237,14 @@ private:
     // compares current vector against vehicle_list to detect threats
     void determine_furthest_aircraft(void);
 
-    // return index of given vehicle if ICAO_ADDRESS matches. return -1 if no match
+    // find index of given vehicle if ICAO_ADDRESS matches. return false if no match
     bool find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const;
 
     // remove a vehicle from the list
     void delete_vehicle(const uint16_t index);
 
-    void set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle);
+    // store a vehicle at index, distance_m is its distance from us
+    void set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle, const float distance_m);
 
     // Generates pseudorandom ICAO from gps time, lat, and lon
     uint32_t genICAO(const Location &loc) const;
@@ -272,6 +274,13 @@ private:
         uint16_t    list_size_allocated;
         adsb_vehicle_t *vehicle_list;
         uint16_t    vehicle_count;
+
+        // position in vehicle_list by ICAO address
+        AP_ADSB_TrafficIndex icao_index;
+
+        // distance from us to each vehicle when it was last updated,
+        // used to pick the furthest to drop when the list is full
+        float       *vehicle_distance;
         AP_Int32    list_radius;
         AP_Int16    list_altitude;
 
@@ -0,0 +1,130 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_ADSB_TrafficIndex.h"
+
+#if HAL_ADSB_ENABLED
+
+AP_ADSB_TrafficIndex::~AP_ADSB_TrafficIndex()
+{
+    delete[] _slots;
+}
+
+bool AP_ADSB_TrafficIndex::init(uint16_t max_entries)
+{
+    delete[] _slots;
+    _slots = nullptr;
+    _mask = 0;
+    _count = 0;
+    _max_entries = 0;
+
+    // power of two with room for twice the entries
+    uint32_t size = 8;
+    while (size < 2U * max_entries) {
+        size *= 2;
+    }
+    _slots = NEW_NOTHROW Slot[size];
+    if (_slots == nullptr) {
+        return false;
+    }
+    _mask = size - 1;
+    _max_entries = max_entries;
+    clear();
+    return true;
+}
+
+void AP_ADSB_TrafficIndex::clear()
+{
+    if (_slots == nullptr) {
+        return;
+    }
+    for (uint32_t i=0; i<=_mask; i++) {
+        _slots[i].index = EMPTY;
+    }
+    _count = 0;
+}
+
+bool AP_ADSB_TrafficIndex::find(uint32_t key, uint16_t &index) const
+{
+    if (_slots == nullptr) {
+        return false;
+    }
+    for (uint32_t i=home(key); _slots[i].index != EMPTY; i = (i+1) & _mask) {
+        if (_slots[i].key == key) {
+            index = _slots[i].index;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AP_ADSB_TrafficIndex::insert(uint32_t key, uint16_t index)
+{
+    if (_slots == nullptr || index == EMPTY) {
+        return false;
+    }
+    uint32_t i = home(key);
+    for (; _slots[i].index != EMPTY; i = (i+1) & _mask) {
+        if (_slots[i].key == key) {
+            _slots[i].index = index;
+            return true;
+        }
+    }
+    if (_count >= _max_entries) {
+        return false;
+    }
+    _slots[i].key = key;
+    _slots[i].index = index;
+    _count++;
+    return true;
+}
+
+void AP_ADSB_TrafficIndex::remove(uint32_t key)
+{
+    if (_slots == nullptr) {
+        return;
+    }
+    uint32_t i = home(key);
+    while (true) {
+        if (_slots[i].index == EMPTY) {
+            // not present
+            return;
+        }
+        if (_slots[i].key == key) {
+            break;
+        }
+        i = (i+1) & _mask;
+    }
+
+    // move later entries of the probe run back into the hole when
+    // their home slot is not between the hole and where they are now
+    uint32_t j = i;
+    while (true) {
+        j = (j+1) & _mask;
+        if (_slots[j].index == EMPTY) {
+            break;
+        }
+        const uint32_t k = home(_slots[j].key);
+        const bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            _slots[i] = _slots[j];
+            i = j;
+        }
+    }
+    _slots[i].index = EMPTY;
+    _count--;
+}
+
+#endif  // HAL_ADSB_ENABLED
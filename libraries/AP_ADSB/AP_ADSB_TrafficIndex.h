@@ -0,0 +1,81 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  hash index from a 32 bit key, such as an ICAO address, to a
+  position in a traffic list
+
+  Open addressing with linear probing, sized to at least twice the
+  number of entries so probe runs stay short. Removal shifts the
+  following entries back rather than leaving tombstones, so lookups
+  never slow down as traffic comes and goes.
+ */
+#pragma once
+
+#include "AP_ADSB_config.h"
+
+#if HAL_ADSB_ENABLED
+
+#include <AP_Common/AP_Common.h>
+
+class AP_ADSB_TrafficIndex
+{
+public:
+    AP_ADSB_TrafficIndex() {}
+    ~AP_ADSB_TrafficIndex();
+
+    CLASS_NO_COPY(AP_ADSB_TrafficIndex);
+
+    // allocate for up to max_entries keys. Returns false if the
+    // allocation failed
+    bool init(uint16_t max_entries);
+
+    // true if init() succeeded
+    bool enabled() const { return _slots != nullptr; }
+
+    // find the position stored for key
+    bool find(uint32_t key, uint16_t &index) const;
+
+    // store the position for key, replacing any already stored.
+    // Returns false if the table is full
+    bool insert(uint32_t key, uint16_t index);
+
+    // forget key, if present
+    void remove(uint32_t key);
+
+    // forget all keys
+    void clear();
+
+private:
+    static constexpr uint16_t EMPTY = UINT16_MAX;
+
+    struct Slot {
+        uint32_t key;
+        uint16_t index;     // EMPTY if the slot is free
+    };
+
+    // preferred slot for key
+    uint32_t home(uint32_t key) const {
+        // multiplicative hashing, skipping the low bits of the
+        // product which mix poorly
+        return ((key * 2654435761U) >> 8) & _mask;
+    }
+
+    Slot *_slots = nullptr;
+    uint32_t _mask;
+    uint16_t _max_entries;
+    uint16_t _count;
+};
+
+#endif  // HAL_ADSB_ENABLED
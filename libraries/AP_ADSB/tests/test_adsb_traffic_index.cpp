@@ -0,0 +1,96 @@
+#include <AP_gtest.h>
+
+#include <AP_ADSB/AP_ADSB_TrafficIndex.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(ADSBTrafficIndex, InsertFindRemove)
+{
+    AP_ADSB_TrafficIndex index;
+    uint16_t pos;
+    EXPECT_FALSE(index.find(0xABCDEF, pos));
+    EXPECT_FALSE(index.insert(0xABCDEF, 0));
+
+    ASSERT_TRUE(index.init(4));
+    EXPECT_FALSE(index.find(0xABCDEF, pos));
+
+    EXPECT_TRUE(index.insert(0xABCDEF, 2));
+    EXPECT_TRUE(index.find(0xABCDEF, pos));
+    EXPECT_EQ(pos, 2);
+
+    // updating an existing key doesn't use up space
+    EXPECT_TRUE(index.insert(0xABCDEF, 3));
+    EXPECT_TRUE(index.find(0xABCDEF, pos));
+    EXPECT_EQ(pos, 3);
+
+    EXPECT_TRUE(index.insert(1, 0));
+    EXPECT_TRUE(index.insert(2, 1));
+    EXPECT_TRUE(index.insert(3, 2));
+    EXPECT_FALSE(index.insert(4, 4));
+    EXPECT_FALSE(index.find(4, pos));
+
+    index.remove(2);
+    EXPECT_FALSE(index.find(2, pos));
+    EXPECT_TRUE(index.insert(4, 1));
+    EXPECT_TRUE(index.find(4, pos));
+    EXPECT_EQ(pos, 1);
+
+    index.clear();
+    EXPECT_FALSE(index.find(0xABCDEF, pos));
+    EXPECT_FALSE(index.find(4, pos));
+}
+
+/*
+  random churn against a plain array, as traffic appears, moves in the
+  list and times out
+ */
+TEST(ADSBTrafficIndex, Churn)
+{
+    const uint16_t max_entries = 300;
+    AP_ADSB_TrafficIndex index;
+    ASSERT_TRUE(index.init(max_entries));
+
+    uint32_t keys[max_entries];
+    uint16_t count = 0;
+
+    for (uint32_t n=0; n<200000; n++) {
+        const uint32_t r = get_random16();
+        if (count < max_entries && (r & 1)) {
+            // new aircraft, from a small key space so neighbours collide
+            const uint32_t key = get_random16() & 0x3FF;
+            uint16_t pos;
+            if (index.find(key, pos)) {
+                ASSERT_LT(pos, count);
+                ASSERT_EQ(keys[pos], key);
+                continue;
+            }
+            ASSERT_TRUE(index.insert(key, count));
+            keys[count++] = key;
+        } else if (count > 0) {
+            // drop one, moving the last into its place
+            const uint16_t i = r % count;
+            index.remove(keys[i]);
+            if (i != count-1) {
+                keys[i] = keys[count-1];
+                ASSERT_TRUE(index.insert(keys[i], i));
+            }
+            count--;
+        }
+    }
+
+    for (uint16_t i=0; i<count; i++) {
+        uint16_t pos;
+        ASSERT_TRUE(index.find(keys[i], pos));
+        EXPECT_EQ(pos, i);
+    }
+    for (uint32_t key=0; key<0x400; key++) {
+        uint16_t pos;
+        if (index.find(key, pos)) {
+            ASSERT_LT(pos, count);
+            EXPECT_EQ(keys[pos], key);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
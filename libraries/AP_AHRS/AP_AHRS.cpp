@@ -358,8 +358,80 @@ void AP_AHRS::update_state(void)
     _getCorrectedDeltaVelocityNED(state.corrected_dv, state.corrected_dv_dt);
     state.origin_ok = _get_origin(state.origin);
     state.velocity_NED_ok = _get_velocity_NED(state.velocity_NED);
+    state.relative_position_NED_origin_ok = _get_relative_position_NED_origin(state.relative_position_NED_origin);
+    state.relative_position_NE_origin_ok = _get_relative_position_NE_origin(state.relative_position_NE_origin);
+    state.relative_position_D_origin_ok = _get_relative_position_D_origin(state.relative_position_D_origin);
+
+#if AP_AHRS_SNAPSHOT_ENABLED
+    publish_snapshot();
+#endif
+}
+
+#if AP_AHRS_SNAPSHOT_ENABLED
+void AP_AHRS::publish_snapshot(void)
+{
+    // mark the write as in progress before touching the buffer, so
+    // a reader that sees any of it also sees the counter move on
+    const uint32_t seq = _snapshot_seq.load(std::memory_order_relaxed);
+    _snapshot_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // readers copy the latest complete buffer, so fill in the other one
+    Snapshot &snap = _snapshot[((seq >> 1) + 1) & 1];
+
+    snap.time_us = AP_HAL::micros64();
+    snap.active_EKF = active_EKF_type();
+    snap.roll = roll;
+    snap.pitch = pitch;
+    snap.yaw = yaw;
+    snap.quat = state.quat;
+    snap.quat_ok = state.quat_ok;
+    snap.dcm_matrix = state.dcm_matrix;
+    snap.gyro = state.gyro_estimate;
+    snap.accel_ef = state.accel_ef;
+    snap.location = state.location;
+    snap.location_ok = state.location_ok;
+    snap.origin = state.origin;
+    snap.origin_ok = state.origin_ok;
+    snap.velocity_NED = state.velocity_NED;
+    snap.velocity_NED_ok = state.velocity_NED_ok;
+    snap.relative_position_NED_origin = state.relative_position_NED_origin;
+    snap.relative_position_NED_origin_ok = state.relative_position_NED_origin_ok;
+    snap.relative_position_NED_home_ok = _home_is_set && state.location_ok;
+    if (snap.relative_position_NED_home_ok) {
+        snap.relative_position_NED_home = _home.get_distance_NED(state.location);
+    }
+    snap.groundspeed_vector = state.ground_speed_vec;
+    snap.groundspeed = state.ground_speed;
+    snap.wind_estimate = state.wind_estimate;
+
+    _snapshot_seq.store(seq + 2, std::memory_order_release);
 }
 
+/*
+  copy out the latest complete snapshot. If update() starts
+  overwriting the buffer while we are copying it then the copy is
+  retried
+ */
+bool AP_AHRS::get_snapshot(Snapshot &snap) const
+{
+    for (uint8_t tries = 0; tries < 4; tries++) {
+        const uint32_t published = _snapshot_seq.load(std::memory_order_acquire) >> 1;
+        if (published == 0) {
+            return false;
+        }
+        snap = _snapshot[published & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // this buffer is next written by the publish after the one in
+        // progress, which first sets the counter to 2*published+3
+        if (_snapshot_seq.load(std::memory_order_relaxed) - 2*published < 3) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif  // AP_AHRS_SNAPSHOT_ENABLED
+
 void AP_AHRS::update(bool skip_ins_update)
 {
     // periodically checks to see if we should update the AHRS
@@ -1644,7 +1716,7 @@ bool AP_AHRS::get_hagl(float &height) const
 /*
   return a relative NED position from the origin in meters
 */
-bool AP_AHRS::get_relative_position_NED_origin(Vector3f &vec) const
+bool AP_AHRS::_get_relative_position_NED_origin(Vector3f &vec) const
 {
     switch (active_EKF_type()) {
 #if AP_AHRS_DCM_ENABLED
@@ -1712,7 +1784,7 @@ bool AP_AHRS::get_relative_position_NED_home(Vector3f &vec) const
 /*
   return a relative position estimate from the origin in meters
 */
-bool AP_AHRS::get_relative_position_NE_origin(Vector2f &posNE) const
+bool AP_AHRS::_get_relative_position_NE_origin(Vector2f &posNE) const
 {
     switch (active_EKF_type()) {
 #if AP_AHRS_DCM_ENABLED
@@ -1768,7 +1840,7 @@ bool AP_AHRS::get_relative_position_NE_home(Vector2f &posNE) const
 /*
   return a relative ground position from the origin in meters, down
 */
-bool AP_AHRS::get_relative_position_D_origin(float &posD) const
+bool AP_AHRS::_get_relative_position_D_origin(float &posD) const
 {
     switch (active_EKF_type()) {
 #if AP_AHRS_DCM_ENABLED
@@ -25,6 +25,10 @@
 
 #include <AP_HAL/Semaphores.h>
 
+#if AP_AHRS_SNAPSHOT_ENABLED
+#include <atomic>
+#endif
+
 #include "AP_AHRS_Backend.h"
 #include <AP_NavEKF2/AP_NavEKF2.h>
 #include <AP_NavEKF3/AP_NavEKF3.h>
@@ -263,17 +267,26 @@ public:
     // return the relative position NED from either home or origin
     // return true if the estimate is valid
     bool get_relative_position_NED_home(Vector3f &vec) const WARN_IF_UNUSED;
-    bool get_relative_position_NED_origin(Vector3f &vec) const WARN_IF_UNUSED;
+    bool get_relative_position_NED_origin(Vector3f &vec) const WARN_IF_UNUSED {
+        vec = state.relative_position_NED_origin;
+        return state.relative_position_NED_origin_ok;
+    }
 
     // return the relative position NE from home or origin
     // return true if the estimate is valid
     bool get_relative_position_NE_home(Vector2f &posNE) const WARN_IF_UNUSED;
-    bool get_relative_position_NE_origin(Vector2f &posNE) const WARN_IF_UNUSED;
+    bool get_relative_position_NE_origin(Vector2f &posNE) const WARN_IF_UNUSED {
+        posNE = state.relative_position_NE_origin;
+        return state.relative_position_NE_origin_ok;
+    }
 
     // return the relative position down from home or origin
     // baro will be used for the _home relative one if the EKF isn't
     void get_relative_position_D_home(float &posD) const;
-    bool get_relative_position_D_origin(float &posD) const WARN_IF_UNUSED;
+    bool get_relative_position_D_origin(float &posD) const WARN_IF_UNUSED {
+        posD = state.relative_position_D_origin;
+        return state.relative_position_D_origin_ok;
+    }
 
     // return location corresponding to vector relative to the
     // vehicle's origin
@@ -454,6 +467,44 @@ public:
     void set_ekf_type(EKFType ahrs_type) {
         _ekf_type.set(ahrs_type);
     }
+
+#if AP_AHRS_SNAPSHOT_ENABLED
+    /*
+      a consistent copy of the main AHRS outputs, published at the end
+      of each update(). Threads other than the main thread (DDS,
+      scripting, networking) can fetch this without taking the AHRS
+      semaphore and without seeing values from two different updates
+     */
+    struct Snapshot {
+        uint64_t time_us;
+        EKFType active_EKF;
+        float roll;
+        float pitch;
+        float yaw;
+        Quaternion quat;
+        bool quat_ok;
+        Matrix3f dcm_matrix;
+        Vector3f gyro;
+        Vector3f accel_ef;
+        Location location;
+        bool location_ok;
+        Location origin;
+        bool origin_ok;
+        Vector3f velocity_NED;
+        bool velocity_NED_ok;
+        Vector3f relative_position_NED_origin;
+        bool relative_position_NED_origin_ok;
+        Vector3f relative_position_NED_home;
+        bool relative_position_NED_home_ok;
+        Vector2f groundspeed_vector;
+        float groundspeed;
+        Vector3f wind_estimate;
+    };
+
+    // get the most recently published snapshot. Returns false if no
+    // snapshot has been published yet
+    bool get_snapshot(Snapshot &snap) const WARN_IF_UNUSED;
+#endif
     
     // these are only out here so vehicles can reference them for parameters
 #if HAL_NAVEKF2_AVAILABLE
@@ -932,6 +983,11 @@ private:
     // get current location estimate
     bool _get_location(Location &loc) const;
 
+    // return the relative position from the origin from the active backend
+    bool _get_relative_position_NED_origin(Vector3f &vec) const WARN_IF_UNUSED;
+    bool _get_relative_position_NE_origin(Vector2f &posNE) const WARN_IF_UNUSED;
+    bool _get_relative_position_D_origin(float &posD) const WARN_IF_UNUSED;
+
     // return true if a airspeed sensor should be used for the AHRS airspeed estimate
     bool _should_use_airspeed_sensor(uint8_t airspeed_index) const;
     
@@ -940,6 +996,20 @@ private:
      */
     void update_state(void);
 
+#if AP_AHRS_SNAPSHOT_ENABLED
+    /*
+      copy state into the inactive snapshot buffer and make it current
+     */
+    void publish_snapshot(void);
+
+    // double buffered snapshot, guarded by a sequence counter which
+    // is odd while a buffer is being written and even once it is
+    // complete. _snapshot_seq/2 is the number of snapshots published
+    // and _snapshot[(_snapshot_seq/2) & 1] the latest complete one
+    Snapshot _snapshot[2];
+    std::atomic<uint32_t> _snapshot_seq{0};
+#endif
+
     // returns an EKF type to be used as active if we decide the
     // primary is not good enough.
     EKFType fallback_active_EKF_type(void) const;
@@ -986,6 +1056,12 @@ private:
         bool origin_ok;
         Vector3f velocity_NED;
         bool velocity_NED_ok;
+        Vector3f relative_position_NED_origin;
+        bool relative_position_NED_origin_ok;
+        Vector2f relative_position_NE_origin;
+        bool relative_position_NE_origin_ok;
+        float relative_position_D_origin;
+        bool relative_position_D_origin_ok;
     } state;
 
     /*
@@ -41,3 +41,7 @@
 #define AP_AHRS_POSITION_RESET_ENABLED (BOARD_FLASH_SIZE>1024 && AP_AHRS_ENABLED)
 #endif
 
+
+#ifndef AP_AHRS_SNAPSHOT_ENABLED
+#define AP_AHRS_SNAPSHOT_ENABLED AP_AHRS_ENABLED
+#endif
@@ -154,7 +154,10 @@ void AP_Avoidance::init(void)
             return;
         }
         _obstacles_allocated = _obstacles_max;
+        // without the index we fall back to searching the list
+        _obstacle_index.init(_obstacles_allocated);
     }
+    _obstacle_index.clear();
     _obstacle_count = 0;
     _last_state_change_ms = 0;
     _threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
@@ -173,6 +176,7 @@ void AP_Avoidance::deinit(void)
         _obstacles_allocated = 0;
         handle_recovery(RecoveryAction::RTL);
     }
+    _obstacle_index.clear();
     _obstacle_count = 0;
 }
 
@@ -201,39 +205,35 @@ void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
     if (! check_startup()) {
         return;
     }
-    uint32_t oldest_timestamp = std::numeric_limits<uint32_t>::max();
-    uint8_t oldest_index = 255; // avoid compiler warning with initialisation
-    int16_t index = -1;
-    uint8_t i;
-    for (i=0; i<_obstacle_count; i++) {
-        if (_obstacles[i].src_id == src_id &&
-            _obstacles[i].src == src) {
-            // pre-existing obstacle found; we will update its information
-            index = i;
-            break;
-        }
-        if (_obstacles[i].timestamp_ms < oldest_timestamp) {
-            oldest_timestamp = _obstacles[i].timestamp_ms;
-            oldest_index = i;
-        }
-    }
+    int16_t index = find_obstacle(src, src_id);
     WITH_SEMAPHORE(_rsem);
-    
+
     if (index == -1) {
         // existing obstacle not found.  See if we can store it anyway:
-        if (i <_obstacles_allocated) {
+        if (_obstacle_count < _obstacles_allocated) {
             // have room to store more vehicles...
             index = _obstacle_count++;
-        } else if (oldest_timestamp < obstacle_timestamp_ms) {
+        } else {
+            uint32_t oldest_timestamp = std::numeric_limits<uint32_t>::max();
+            uint8_t oldest_index = 255; // avoid compiler warning with initialisation
+            for (uint8_t i=0; i<_obstacle_count; i++) {
+                if (_obstacles[i].timestamp_ms < oldest_timestamp) {
+                    oldest_timestamp = _obstacles[i].timestamp_ms;
+                    oldest_index = i;
+                }
+            }
+            if (oldest_timestamp >= obstacle_timestamp_ms) {
+                // no room for this (old?!) data
+                return;
+            }
             // replace this very old entry with this new data
             index = oldest_index;
-        } else {
-            // no room for this (old?!) data
-            return;
+            _obstacle_index.remove(obstacle_key(_obstacles[index].src, _obstacles[index].src_id));
         }
 
         _obstacles[index].src = src;
         _obstacles[index].src_id = src_id;
+        _obstacle_index.insert(obstacle_key(src, src_id), index);
     }
 
     _obstacles[index]._location = loc;
@@ -257,6 +257,31 @@ void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
     return add_obstacle(obstacle_timestamp_ms, src, src_id, loc, vel);
 }
 
+// return the position of an obstacle in the list, or -1 if we don't have it
+int16_t AP_Avoidance::find_obstacle(const MAV_COLLISION_SRC src, const uint32_t src_id) const
+{
+    uint16_t index;
+    if (_obstacle_index.enabled()) {
+        if (!_obstacle_index.find(obstacle_key(src, src_id), index)) {
+            return -1;
+        }
+        if (index < _obstacle_count &&
+            _obstacles[index].src_id == src_id &&
+            _obstacles[index].src == src) {
+            return index;
+        }
+        // the key only keeps 24 bits of src_id; fall through to a
+        // search on the rare collision
+    }
+    for (uint8_t i=0; i<_obstacle_count; i++) {
+        if (_obstacles[i].src_id == src_id &&
+            _obstacles[i].src == src) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 uint32_t AP_Avoidance::src_id_for_adsb_vehicle(const AP_ADSB::adsb_vehicle_t &vehicle) const
 {
     // TODO: need to include squawk code and callsign
@@ -342,12 +367,23 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
 
     obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
 
+    // If we haven't heard from a vehicle then assume it is no threat.
+    // The caller skips these, so don't spend time on the geometry
     const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-    float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
+    if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
+        return;
+    }
+
+    // relative position and velocity are shared by both time horizons
+    // and the current distance, so work them out once
+    const Vector2f delta_pos_ne = obstacle_loc.get_distance_NE(my_loc);
+    const Vector2f delta_vel_ne = Vector2f(obstacle_vel[0] - my_vel[0], obstacle_vel[1] - my_vel[1]);
+
+    float closest_xy = Vector2f::closest_distance_between_radial_and_point(delta_vel_ne * (_fail_time_horizon + obstacle_age/1000), delta_pos_ne);
     if (closest_xy < _fail_distance_xy) {
         obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
     } else {
-        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
+        closest_xy = Vector2f::closest_distance_between_radial_and_point(delta_vel_ne * (_warn_time_horizon + obstacle_age/1000), delta_pos_ne);
         if (closest_xy < _warn_distance_xy) {
             obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
         }
@@ -367,22 +403,17 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
         }
     }
 
-    // If we haven't heard from a vehicle then assume it is no threat
-    if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
-        obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
-    }
-
     // could optimise this to not calculate a lot of this if threat
     // level is none - but only *once the GCS has been informed*!
     obstacle.closest_approach_xy = closest_xy;
     obstacle.closest_approach_z = closest_z;
-    float current_distance = my_loc.get_distance(obstacle_loc);
+    const float current_distance = delta_pos_ne.length();
     obstacle.distance_to_closest_approach = current_distance - closest_xy;
-    Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
+    const float net_speed_ne = delta_vel_ne.length();
     obstacle.time_to_closest_approach = 0.0f;
     if (!is_zero(obstacle.distance_to_closest_approach) &&
-        ! is_zero(net_velocity_ne.length())) {
-        obstacle.time_to_closest_approach = obstacle.distance_to_closest_approach / net_velocity_ne.length();
+        !is_zero(net_speed_ne)) {
+        obstacle.time_to_closest_approach = obstacle.distance_to_closest_approach / net_speed_ne;
     }
 }
 
@@ -490,6 +521,7 @@ void AP_Avoidance::check_for_threats()
         if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
             // shrink list if this is the last entry:
             if (i == _obstacle_count-1) {
+                _obstacle_index.remove(obstacle_key(obstacle.src, obstacle.src_id));
                 _obstacle_count -= 1;
             }
             continue;
@@ -167,6 +167,15 @@ private:
     // free _obstacle_list
     void deinit();
 
+    // key for an obstacle in _obstacle_index. ICAO addresses and
+    // MAVLink system IDs both fit in the low 24 bits
+    static uint32_t obstacle_key(const MAV_COLLISION_SRC src, const uint32_t src_id) {
+        return (uint32_t(src) << 24) | (src_id & 0xFFFFFF);
+    }
+
+    // return the position of an obstacle in the list, or -1
+    int16_t find_obstacle(const MAV_COLLISION_SRC src, const uint32_t src_id) const;
+
     // get unique id for adsb
     uint32_t src_id_for_adsb_vehicle(const AP_ADSB::adsb_vehicle_t &vehicle) const;
 
@@ -186,6 +195,7 @@ private:
     AP_Avoidance::Obstacle *_obstacles;
     uint8_t _obstacles_allocated;
     uint8_t _obstacle_count;
+    AP_ADSB_TrafficIndex _obstacle_index;
     int8_t _current_most_serious_threat;
     MAV_COLLISION_ACTION _latest_action = MAV_COLLISION_ACTION_NONE;
 
@@ -0,0 +1,421 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  heap accounting
+ */
+
+#include "AP_HeapAccounting.h"
+
+#if AP_HEAP_ACCOUNTING_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Logger/AP_Logger.h>
+
+#include <pthread.h>
+#include <string.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  the number of allocations which can be live at once and still be
+  accounted for; a power of two. The table is kept at most 3/4 full,
+  and allocations beyond that are counted as untracked
+ */
+#ifndef AP_HEAP_ACCOUNTING_MAX_LIVE
+#define AP_HEAP_ACCOUNTING_MAX_LIVE (1U<<16)
+#endif
+
+// distinct call sites, a power of two. Sites beyond 3/4 of this are
+// lumped together
+#define MAX_SITES 1024U
+#define OTHER_SITE MAX_SITES
+
+// distinct thread names. Threads beyond this are lumped together in
+// slot 0
+#define MAX_THREADS 32U
+
+// call sites listed in the report
+#define REPORT_SITES 20U
+
+#if !defined(__APPLE__)
+// start of the executable image, from the linker
+extern "C" char __executable_start;
+#endif
+
+namespace {
+
+struct Usage {
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    uint32_t live_count;
+    uint32_t total_count;
+
+    void add(size_t size) {
+        live_bytes += size;
+        live_count++;
+        total_count++;
+        if (live_bytes > peak_bytes) {
+            peak_bytes = live_bytes;
+        }
+    }
+    void remove(size_t size) {
+        live_bytes -= size;
+        live_count--;
+    }
+};
+
+struct LiveAllocation {
+    void *ptr;
+    size_t size;
+    uint16_t site;
+    uint8_t thread;
+    HeapTag tag;
+};
+
+struct Site {
+    const void *caller;
+    Usage usage;
+};
+
+struct Thread {
+    char name[16];
+    Usage usage;
+};
+
+/*
+  everything here is zero initialised, and the mutex statically
+  initialised, so allocations made by constructors before main() are
+  accounted for
+ */
+pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+LiveAllocation live[AP_HEAP_ACCOUNTING_MAX_LIVE];
+uint32_t num_live;
+uint32_t untracked;
+uint32_t unseen_frees;
+
+Usage total;
+Usage tags[uint8_t(HeapTag::NUM_TAGS)];
+
+Site sites[MAX_SITES+1];
+uint16_t num_sites;
+
+Thread threads[MAX_THREADS];
+uint8_t num_threads = 1;
+
+thread_local HeapTag tls_tag;
+thread_local uint8_t tls_thread;
+thread_local char tls_thread_name[16];
+
+const char *const tag_names[] {
+    "untagged",
+    "logger",
+    "terrain",
+    "oadatabase",
+    "scripting",
+    "ekf",
+};
+static_assert(ARRAY_SIZE(tag_names) == uint8_t(HeapTag::NUM_TAGS), "tag_names must match HeapTag");
+
+uint32_t hash_ptr(const void *ptr)
+{
+    return uint32_t((uint64_t(uintptr_t(ptr) >> 3) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/*
+  find the slot holding ptr in the live table, or the empty slot it
+  would go in
+ */
+uint32_t live_slot(const void *ptr)
+{
+    const uint32_t mask = AP_HEAP_ACCOUNTING_MAX_LIVE - 1;
+    uint32_t i = hash_ptr(ptr) & mask;
+    while (live[i].ptr != nullptr && live[i].ptr != ptr) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/*
+  empty slot i of the live table, moving up any later entries in its
+  probe run so lookups never need to step over a hole
+ */
+void live_remove(uint32_t i)
+{
+    const uint32_t mask = AP_HEAP_ACCOUNTING_MAX_LIVE - 1;
+    uint32_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (live[j].ptr == nullptr) {
+            break;
+        }
+        const uint32_t home = hash_ptr(live[j].ptr) & mask;
+        const bool in_place = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!in_place) {
+            live[i] = live[j];
+            i = j;
+        }
+    }
+    live[i].ptr = nullptr;
+    num_live--;
+}
+
+void unaccount(const LiveAllocation &a)
+{
+    total.remove(a.size);
+    tags[uint8_t(a.tag)].remove(a.size);
+    sites[a.site].usage.remove(a.size);
+    threads[a.thread].usage.remove(a.size);
+}
+
+uint16_t site_index(const void *caller)
+{
+    const uint32_t mask = MAX_SITES - 1;
+    uint32_t i = hash_ptr(caller) & mask;
+    while (sites[i].caller != nullptr) {
+        if (sites[i].caller == caller) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+    if (num_sites >= (MAX_SITES*3)/4) {
+        return OTHER_SITE;
+    }
+    sites[i].caller = caller;
+    num_sites++;
+    return i;
+}
+
+/*
+  slot for the calling thread, looked up by name as threads are
+  often named after their first allocation. Called with the lock held
+ */
+uint8_t thread_index(const char *name)
+{
+    for (uint8_t i=1; i<num_threads; i++) {
+        if (strncmp(threads[i].name, name, sizeof(threads[i].name)) == 0) {
+            return i;
+        }
+    }
+    if (num_threads >= MAX_THREADS) {
+        return 0;
+    }
+    const uint8_t i = num_threads++;
+    strncpy(threads[i].name, name, sizeof(threads[i].name)-1);
+    return i;
+}
+
+}  // namespace
+
+HeapTag AP_HeapAccounting::current_tag(void)
+{
+    return tls_tag;
+}
+
+void AP_HeapAccounting::set_current_tag(HeapTag tag)
+{
+    tls_tag = tag;
+}
+
+const char *AP_HeapAccounting::tag_name(HeapTag tag)
+{
+    if (uint8_t(tag) >= ARRAY_SIZE(tag_names)) {
+        return "?";
+    }
+    return tag_names[uint8_t(tag)];
+}
+
+void AP_HeapAccounting::allocated(void *ptr, size_t size, const void *caller)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    // pthread_getname_np() on the calling thread doesn't allocate
+    char name[sizeof(tls_thread_name)] {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    const bool renamed = tls_thread == 0 || strncmp(name, tls_thread_name, sizeof(name)) != 0;
+
+    pthread_mutex_lock(&lock);
+
+    if (renamed) {
+        memcpy(tls_thread_name, name, sizeof(name));
+        tls_thread = thread_index(name);
+    }
+
+    if (num_live >= (AP_HEAP_ACCOUNTING_MAX_LIVE*3)/4) {
+        untracked++;
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+    const uint32_t i = live_slot(ptr);
+    if (live[i].ptr != nullptr) {
+        // the allocator has handed out memory we think is still in
+        // use, so it was freed without going through freed()
+        unaccount(live[i]);
+        unseen_frees++;
+    } else {
+        num_live++;
+    }
+
+    LiveAllocation &a = live[i];
+    a.ptr = ptr;
+    a.size = size;
+    a.site = site_index(caller);
+    a.thread = tls_thread;
+    a.tag = tls_tag;
+
+    total.add(size);
+    tags[uint8_t(a.tag)].add(size);
+    sites[a.site].usage.add(size);
+    threads[a.thread].usage.add(size);
+
+    pthread_mutex_unlock(&lock);
+}
+
+void AP_HeapAccounting::freed(void *ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+
+    const uint32_t i = live_slot(ptr);
+    if (live[i].ptr == ptr) {
+        unaccount(live[i]);
+        live_remove(i);
+    }
+
+    pthread_mutex_unlock(&lock);
+}
+
+static void print_usage(ExpandingString &str, const char *name, const Usage &u)
+{
+    str.printf("%-18s %10lu %8lu %10lu %8lu\n",
+               name,
+               (unsigned long)u.live_bytes,
+               (unsigned long)u.live_count,
+               (unsigned long)u.peak_bytes,
+               (unsigned long)u.total_count);
+}
+
+void AP_HeapAccounting::mem_info(ExpandingString &str)
+{
+    // take a copy so that nothing is allocated with the lock held
+    Usage tags_copy[ARRAY_SIZE(tags)];
+    Thread threads_copy[MAX_THREADS];
+    Site top[REPORT_SITES] {};
+
+    pthread_mutex_lock(&lock);
+    const Usage total_copy = total;
+    const uint32_t untracked_copy = untracked;
+    const uint32_t unseen_frees_copy = unseen_frees;
+    const uint8_t num_threads_copy = num_threads;
+    memcpy(tags_copy, tags, sizeof(tags_copy));
+    memcpy(threads_copy, threads, sizeof(threads_copy));
+    uint8_t num_top = 0;
+    for (uint16_t i=0; i<ARRAY_SIZE(sites); i++) {
+        const Site &s = sites[i];
+        if (s.usage.live_bytes == 0) {
+            continue;
+        }
+        // insertion into the list of the largest, biggest first
+        uint8_t j = MIN(num_top, REPORT_SITES-1);
+        if (num_top == REPORT_SITES && s.usage.live_bytes <= top[j].usage.live_bytes) {
+            continue;
+        }
+        while (j > 0 && top[j-1].usage.live_bytes < s.usage.live_bytes) {
+            top[j] = top[j-1];
+            j--;
+        }
+        top[j] = s;
+        if (num_top < REPORT_SITES) {
+            num_top++;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+
+    str.printf("%-18s %10s %8s %10s %8s\n", "Tag", "Live", "Count", "Peak", "Allocs");
+    for (uint8_t i=0; i<ARRAY_SIZE(tags_copy); i++) {
+        print_usage(str, tag_name(HeapTag(i)), tags_copy[i]);
+    }
+    print_usage(str, "total", total_copy);
+    str.printf("untracked allocations: %lu, unseen frees: %lu\n",
+               (unsigned long)untracked_copy,
+               (unsigned long)unseen_frees_copy);
+
+    str.printf("\n%-18s %10s %8s %10s %8s\n", "Thread", "Live", "Count", "Peak", "Allocs");
+    for (uint8_t i=0; i<num_threads_copy; i++) {
+        const Thread &t = threads_copy[i];
+        if (i == 0 && t.usage.total_count == 0) {
+            continue;
+        }
+        print_usage(str, i == 0 ? "other" : t.name, t.usage);
+    }
+
+#if !defined(__APPLE__)
+    str.printf("\nCall sites by live bytes, executable at %p\n", &__executable_start);
+#else
+    str.printf("\nCall sites by live bytes\n");
+#endif
+    str.printf("%-18s %10s %8s %10s %8s\n", "Caller", "Live", "Count", "Peak", "Allocs");
+    for (uint8_t i=0; i<num_top; i++) {
+        char caller[19];
+        if (top[i].caller == nullptr) {
+            strncpy(caller, "other", sizeof(caller));
+        } else {
+            hal.util->snprintf(caller, sizeof(caller), "%p", top[i].caller);
+        }
+        print_usage(str, caller, top[i].usage);
+    }
+}
+
+#if HAL_LOGGING_ENABLED
+void AP_HeapAccounting::Write_Log(void)
+{
+    Usage tags_copy[ARRAY_SIZE(tags)];
+    pthread_mutex_lock(&lock);
+    memcpy(tags_copy, tags, sizeof(tags_copy));
+    pthread_mutex_unlock(&lock);
+
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<ARRAY_SIZE(tags_copy); i++) {
+        const Usage &u = tags_copy[i];
+        if (u.total_count == 0) {
+            continue;
+        }
+// @LoggerMessage: HEAP
+// @Description: Heap usage by subsystem
+// @Field: TimeUS: Time since system startup
+// @Field: Tag: subsystem the memory is charged to
+// @Field: Live: bytes currently allocated
+// @Field: Cnt: allocations currently live
+// @Field: Peak: most bytes allocated at once
+// @Field: Allocs: allocations made since boot
+        AP::logger().Write("HEAP", "TimeUS,Tag,Live,Cnt,Peak,Allocs", "QNIIII",
+                           now_us,
+                           tag_name(HeapTag(i)),
+                           uint32_t(u.live_bytes),
+                           u.live_count,
+                           uint32_t(u.peak_bytes),
+                           u.total_count);
+    }
+}
+#endif  // HAL_LOGGING_ENABLED
+
+#endif  // AP_HEAP_ACCOUNTING_ENABLED
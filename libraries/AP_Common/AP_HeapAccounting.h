@@ -0,0 +1,109 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  heap accounting
+
+  Attributes the memory allocated through new, malloc_type() and the
+  C allocator to the subsystem that asked for it, to the thread it
+  was allocated on and to the code that allocated it, keeping the
+  bytes and allocations live, the peak bytes and the total number of
+  allocations for each. The subsystem is a tag set for the duration of
+  a HEAP_TAG_SCOPE(); anything allocated outside one is UNTAGGED.
+
+  This is a debugging aid for SITL and Linux only, enabled by
+  configuring with --enable-heap-accounting, which also wraps the C
+  allocator at link time. Allocations made inside the C library, such
+  as by strdup() or fopen(), are not seen. The report is in
+  @SYS/mem.txt and the per-tag figures are logged as HEAP messages
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#if AP_HEAP_ACCOUNTING_ENABLED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Logger/AP_Logger_config.h>
+
+class ExpandingString;
+
+enum class HeapTag : uint8_t {
+    UNTAGGED = 0,
+    LOGGER,
+    TERRAIN,
+    OADATABASE,
+    SCRIPTING,
+    EKF,
+    NUM_TAGS
+};
+
+class AP_HeapAccounting {
+public:
+    // record an allocation of size bytes at ptr, made from caller
+    static void allocated(void *ptr, size_t size, const void *caller);
+
+    // allocate size bytes of zeroed memory, charged to caller rather
+    // than to the function calling this
+    static void *calloc(size_t size, const void *caller);
+
+    // record that ptr has been freed. Pointers which were not
+    // recorded are ignored
+    static void freed(void *ptr);
+
+    // fill in the @SYS/mem.txt report
+    static void mem_info(ExpandingString &str);
+
+#if HAL_LOGGING_ENABLED
+    // log the per-tag figures
+    static void Write_Log(void);
+#endif
+
+    static const char *tag_name(HeapTag tag);
+
+    // the tag allocations on this thread are currently charged to
+    static HeapTag current_tag(void);
+    static void set_current_tag(HeapTag tag);
+};
+
+/*
+  charge allocations made on this thread to a tag until the end of
+  the enclosing scope
+ */
+class HeapTagScope {
+public:
+    HeapTagScope(HeapTag tag) :
+        prev(AP_HeapAccounting::current_tag()) {
+        AP_HeapAccounting::set_current_tag(tag);
+    }
+    ~HeapTagScope() {
+        AP_HeapAccounting::set_current_tag(prev);
+    }
+
+    CLASS_NO_COPY(HeapTagScope);
+
+private:
+    const HeapTag prev;
+};
+
+#define HEAP_TAG_SCOPE(tag) HeapTagScope _heap_tag_scope(HeapTag::tag)
+
+#else
+
+#define HEAP_TAG_SCOPE(tag)
+
+#endif  // AP_HEAP_ACCOUNTING_ENABLED
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <new>
 #include <AP_InternalError/AP_InternalError.h>
+#include "AP_HeapAccounting.h"
 
 /*
   globally override new and delete to ensure that we always start with
@@ -33,6 +34,13 @@
   want to avoid
 */
 
+#if AP_HEAP_ACCOUNTING_ENABLED
+// charge the memory to the code calling new rather than to new itself
+#define NEW_CALLOC(size) AP_HeapAccounting::calloc(size, __builtin_return_address(0))
+#else
+#define NEW_CALLOC(size) calloc(size, 1)
+#endif
+
 /*
   variant for new(std::nothrow), which is all that should be used in
   ArduPilot
@@ -42,7 +50,7 @@ void * operator new(size_t size, std::nothrow_t const &nothrow)
     if (size < 1) {
         size = 1;
     }
-    return(calloc(size, 1));
+    return NEW_CALLOC(size);
 }
 
 void * operator new[](size_t size, std::nothrow_t const &nothrow)
@@ -50,7 +58,7 @@ void * operator new[](size_t size, std::nothrow_t const &nothrow)
     if (size < 1) {
         size = 1;
     }
-    return(calloc(size, 1));
+    return NEW_CALLOC(size);
 }
 
 /*
@@ -62,7 +70,7 @@ void * operator new(size_t size)
     if (size < 1) {
         size = 1;
     }
-    return(calloc(size, 1));
+    return NEW_CALLOC(size);
 }
 
 
@@ -71,7 +79,7 @@ void * operator new[](size_t size)
     if (size < 1) {
         size = 1;
     }
-    return(calloc(size, 1));
+    return NEW_CALLOC(size);
 }
 
 void operator delete(void *p)
@@ -100,6 +108,53 @@ void *__wrap_malloc(size_t size)
     if (ret != nullptr) {
         memset(ret, 0, size);
     }
+#if AP_HEAP_ACCOUNTING_ENABLED
+    AP_HeapAccounting::allocated(ret, size, __builtin_return_address(0));
+#endif
     return ret;
 }
 #endif
+
+#if AP_HEAP_ACCOUNTING_ENABLED
+/*
+  the rest of the allocator is wrapped too when accounting for heap
+  usage, see configure_heap_accounting() in boards.py
+ */
+extern "C" {
+    void *__wrap_calloc(size_t nmemb, size_t size);
+    void *__real_calloc(size_t nmemb, size_t size);
+    void *__wrap_realloc(void *ptr, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+    void __wrap_free(void *ptr);
+    void __real_free(void *ptr);
+}
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    void *ret = __real_calloc(nmemb, size);
+    AP_HeapAccounting::allocated(ret, nmemb * size, __builtin_return_address(0));
+    return ret;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    void *ret = __real_realloc(ptr, size);
+    if (ret != nullptr || size == 0) {
+        AP_HeapAccounting::freed(ptr);
+    }
+    AP_HeapAccounting::allocated(ret, size, __builtin_return_address(0));
+    return ret;
+}
+
+void __wrap_free(void *ptr)
+{
+    AP_HeapAccounting::freed(ptr);
+    __real_free(ptr);
+}
+
+void *AP_HeapAccounting::calloc(size_t size, const void *caller)
+{
+    void *ret = __real_calloc(size, 1);
+    allocated(ret, size, caller);
+    return ret;
+}
+#endif  // AP_HEAP_ACCOUNTING_ENABLED
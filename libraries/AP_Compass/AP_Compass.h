@@ -653,7 +653,11 @@ private:
     void try_set_initial_location();
     bool _initial_location_set;
 
+#if AP_COMPASS_CAL_THREAD_PER_COMPASS_ENABLED
+    bool _cal_instance_thread_started[COMPASS_MAX_INSTANCES];
+#else
     bool _cal_thread_started;
+#endif
 
 #if AP_COMPASS_MSP_ENABLED
     uint8_t msp_instance_mask;
@@ -18,6 +18,12 @@
 #define COMPASS_CAL_ENABLED AP_COMPASS_ENABLED && AP_AHRS_DCM_ENABLED
 #endif
 
+// give each compass being calibrated its own thread so the fits run
+// in parallel, rather than stepping them in turn on one thread
+#ifndef AP_COMPASS_CAL_THREAD_PER_COMPASS_ENABLED
+#define AP_COMPASS_CAL_THREAD_PER_COMPASS_ENABLED COMPASS_CAL_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 #ifndef AP_COMPASS_CALIBRATION_FIXED_YAW_ENABLED
 #define AP_COMPASS_CALIBRATION_FIXED_YAW_ENABLED AP_COMPASS_ENABLED && AP_GPS_ENABLED && AP_AHRS_ENABLED
 #endif
@@ -221,6 +221,14 @@ void CompassCalibrator::update()
     }
 }
 
+void CompassCalibrator::thread_main()
+{
+    while (true) {
+        update();
+        hal.scheduler->delay(1);
+    }
+}
+
 void CompassCalibrator::pull_sample()
 {
     CompassSample mag_sample;
@@ -237,11 +245,18 @@ void CompassCalibrator::pull_sample()
     }
     if (_running() && _samples_collected < COMPASS_CAL_NUM_SAMPLES && accept_sample(mag_sample.get())) {
         update_completion_mask(mag_sample.get());
-        _sample_buffer[_samples_collected] = mag_sample;
-        _samples_collected++;
+        add_sample(mag_sample);
     }
 }
 
+void CompassCalibrator::add_sample(const CompassSample &sample)
+{
+    _sample_buffer[_samples_collected] = sample;
+    grid_add(_samples_collected);
+    sphere_sums_add(sample.get());
+    _samples_collected++;
+}
+
 
 void CompassCalibrator::update_cal_settings()
 {
@@ -366,6 +381,8 @@ void CompassCalibrator::reset_state()
     _params.diag = Vector3f(1.0f,1.0f,1.0f);
     _params.offdiag.zero();
     _params.scale_factor = 0;
+    _sphere_sums.count = 0;
+    _grid_cell_size = 0;
 
     memset(_completion_mask, 0, sizeof(_completion_mask));
     initialize_fit();
@@ -385,6 +402,8 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 free(_sample_buffer);
                 _sample_buffer = nullptr;
             }
+            free(_grid);
+            _grid = nullptr;
             return true;
 
         case Status::WAITING_TO_START:
@@ -406,7 +425,10 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
             if (_sample_buffer == nullptr) {
                 _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
             }
-            if (_sample_buffer != nullptr) {
+            if (_grid == nullptr) {
+                _grid = (SampleGrid*)calloc(1, sizeof(SampleGrid));
+            }
+            if (_sample_buffer != nullptr && _grid != nullptr) {
                 initialize_fit();
                 _status = Status::RUNNING_STEP_ONE;
                 return true;
@@ -431,6 +453,8 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 free(_sample_buffer);
                 _sample_buffer = nullptr;
             }
+            free(_grid);
+            _grid = nullptr;
 
             _status = Status::SUCCESS;
             return true;
@@ -458,6 +482,8 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 free(_sample_buffer);
                 _sample_buffer = nullptr;
             }
+            free(_grid);
+            _grid = nullptr;
 
             _status = status;
             return true;
@@ -491,7 +517,6 @@ void CompassCalibrator::thin_samples()
         return;
     }
 
-    _samples_thinned = 0;
     // shuffle the samples http://en.wikipedia.org/wiki/Fisher%E2%80%93Yates_shuffle
     // this is so that adjacent samples don't get sequentially eliminated
     for (uint16_t i=_samples_collected-1; i>=1; i--) {
@@ -501,14 +526,20 @@ void CompassCalibrator::thin_samples()
         _sample_buffer[j] = temp;
     }
 
-    // remove any samples that are close together
-    for (uint16_t i=0; i < _samples_collected; i++) {
-        if (!accept_sample(_sample_buffer[i], i)) {
-            _sample_buffer[i] = _sample_buffer[_samples_collected-1];
-            _samples_collected--;
-            _samples_thinned++;
+    // add the samples back one at a time, keeping those that are not
+    // close to one already kept. The radius has changed, so the grid
+    // and sphere sums are rebuilt as we go
+    const uint16_t count = _samples_collected;
+    _samples_collected = 0;
+    _sphere_sums.count = 0;
+    grid_rebuild();
+    for (uint16_t i=0; i < count; i++) {
+        const CompassSample sample = _sample_buffer[i];
+        if (accept_sample(sample)) {
+            add_sample(sample);
         }
     }
+    _samples_thinned = count - _samples_collected;
 
     update_completion_mask();
 }
@@ -529,32 +560,128 @@ void CompassCalibrator::thin_samples()
  * The above equation was proved after solving for spherical triangular excess
  * and related equations.
  */
-bool CompassCalibrator::accept_sample(const Vector3f& sample, uint16_t skip_index)
+float CompassCalibrator::min_sample_distance() const
 {
     static const uint16_t faces = (2 * COMPASS_CAL_NUM_SAMPLES - 4);
     static const float a = (4.0f * M_PI / (3.0f * faces)) + M_PI / 3.0f;
     static const float theta = 0.5f * acosf(cosf(a) / (1.0f - cosf(a)));
 
-    if (_sample_buffer == nullptr) {
+    return _params.radius * 2*sinf(theta/2);
+}
+
+bool CompassCalibrator::accept_sample(const Vector3f& sample)
+{
+    if (_sample_buffer == nullptr || _grid == nullptr) {
         return false;
     }
 
-    float min_distance = _params.radius * 2*sinf(theta/2);
+    const float min_distance = min_sample_distance();
+    if (!is_equal(min_distance, _grid_cell_size)) {
+        grid_rebuild();
+    }
+    if (!is_positive(_grid_cell_size)) {
+        return true;
+    }
 
-    for (uint16_t i = 0; i<_samples_collected; i++) {
-        if (i != skip_index) {
-            float distance = (sample - _sample_buffer[i].get()).length();
-            if (distance < min_distance) {
-                return false;
+    // with cells of min_distance any sample that is too close is in
+    // one of the 27 cells around this one
+    const int32_t cx = floorf(sample.x / _grid_cell_size);
+    const int32_t cy = floorf(sample.y / _grid_cell_size);
+    const int32_t cz = floorf(sample.z / _grid_cell_size);
+    const float min_distance_sq = sq(min_distance);
+    for (int32_t x = cx-1; x <= cx+1; x++) {
+        for (int32_t y = cy-1; y <= cy+1; y++) {
+            for (int32_t z = cz-1; z <= cz+1; z++) {
+                for (uint16_t i = _grid->head[grid_bucket(x, y, z)]; i != 0; i = _grid->next[i-1]) {
+                    if ((sample - _sample_buffer[i-1].get()).length_squared() < min_distance_sq) {
+                        return false;
+                    }
+                }
             }
         }
     }
     return true;
 }
 
-bool CompassCalibrator::accept_sample(const CompassSample& sample, uint16_t skip_index)
+bool CompassCalibrator::accept_sample(const CompassSample& sample)
+{
+    return accept_sample(sample.get());
+}
+
+uint16_t CompassCalibrator::grid_bucket(int32_t x, int32_t y, int32_t z) const
 {
-    return accept_sample(sample.get(), skip_index);
+    const uint32_t h = (uint32_t(x) * 73856093U) ^ (uint32_t(y) * 19349663U) ^ (uint32_t(z) * 83492791U);
+    return h & (COMPASS_CAL_GRID_BUCKETS - 1);
+}
+
+void CompassCalibrator::grid_add(uint16_t idx)
+{
+    if (_grid == nullptr || !is_positive(_grid_cell_size)) {
+        return;
+    }
+    const Vector3f v = _sample_buffer[idx].get();
+    const uint16_t b = grid_bucket(floorf(v.x / _grid_cell_size),
+                                   floorf(v.y / _grid_cell_size),
+                                   floorf(v.z / _grid_cell_size));
+    _grid->next[idx] = _grid->head[b];
+    _grid->head[b] = idx + 1;
+}
+
+void CompassCalibrator::grid_rebuild()
+{
+    if (_grid == nullptr) {
+        return;
+    }
+    memset(_grid->head, 0, sizeof(_grid->head));
+    _grid_cell_size = min_sample_distance();
+    for (uint16_t i = 0; i < _samples_collected; i++) {
+        grid_add(i);
+    }
+}
+
+void CompassCalibrator::sphere_sums_add(const Vector3f &sample)
+{
+    if (_sphere_sums.count == 0) {
+        memset(_sphere_sums.ATA, 0, sizeof(_sphere_sums.ATA));
+        memset(_sphere_sums.ATb, 0, sizeof(_sphere_sums.ATb));
+        _sphere_sums.origin = sample;
+    }
+    const Vector3f p = sample - _sphere_sums.origin;
+    const float row[4] { 2*p.x, 2*p.y, 2*p.z, 1 };
+    const float b = p.length_squared();
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            _sphere_sums.ATA[i*4+j] += row[i] * row[j];
+        }
+        _sphere_sums.ATb[i] += row[i] * b;
+    }
+    _sphere_sums.count++;
+}
+
+// solve the normal equations for the centre and radius of the sphere
+bool CompassCalibrator::sphere_sums_solve(Vector3f &centre, float &radius) const
+{
+    if (_sphere_sums.count < 4) {
+        return false;
+    }
+    float inv[4*4];
+    if (!mat_inverse(_sphere_sums.ATA, inv, 4)) {
+        return false;
+    }
+    float u[4] {};
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            u[i] += inv[i*4+j] * _sphere_sums.ATb[j];
+        }
+    }
+    // k = r^2 - |c|^2
+    const float r_sq = u[3] + sq(u[0]) + sq(u[1]) + sq(u[2]);
+    if (!(r_sq > 0)) {
+        return false;
+    }
+    centre = _sphere_sums.origin + Vector3f(u[0], u[1], u[2]);
+    radius = sqrtf(r_sq);
+    return !centre.is_nan() && !isnan(radius);
 }
 
 float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const
@@ -583,9 +710,19 @@ float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) cons
     return sum;
 }
 
-// calculate initial offsets by simply taking the average values of the samples
+// calculate initial offsets from a linear sphere fit, falling back to
+// the average value of the samples
 void CompassCalibrator::calc_initial_offset()
 {
+    Vector3f centre;
+    float radius;
+    if (sphere_sums_solve(centre, radius) && radius > FIELD_RADIUS_MIN && radius < FIELD_RADIUS_MAX) {
+        _params.offset = -centre;
+        _params.radius = radius;
+        _fitness = calc_mean_squared_residuals(_params);
+        return;
+    }
+
     // Set initial offset to the average value of the samples
     _params.offset.zero();
     for (uint16_t k = 0; k < _samples_collected; k++) {
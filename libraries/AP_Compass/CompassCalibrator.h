@@ -9,6 +9,7 @@
 #define COMPASS_CAL_NUM_SPHERE_PARAMS       4
 #define COMPASS_CAL_NUM_ELLIPSOID_PARAMS    9
 #define COMPASS_CAL_NUM_SAMPLES             300     // number of samples required before fitting begins
+#define COMPASS_CAL_GRID_BUCKETS            128     // hash buckets for the sample acceptance grid, power of two
 
 class CompassCalibrator {
 public:
@@ -34,6 +35,9 @@ public:
     // update the state machine and calculate offsets, diagonals and offdiagonals
     void update();
 
+    // loop calling update(), for a thread dedicated to this calibrator
+    void thread_main();
+
     // compass calibration states
     enum class Status {
         NOT_STARTED = 0,
@@ -152,8 +156,24 @@ private:
     void pull_sample();
 
     // returns true if sample should be added to buffer
-    bool accept_sample(const Vector3f &sample, uint16_t skip_index = UINT16_MAX);
-    bool accept_sample(const CompassSample &sample, uint16_t skip_index = UINT16_MAX);
+    bool accept_sample(const Vector3f &sample);
+    bool accept_sample(const CompassSample &sample);
+
+    // minimum distance between samples in the buffer
+    float min_sample_distance() const;
+
+    // add a sample to the end of the buffer, the grid and the sphere sums
+    void add_sample(const CompassSample &sample);
+
+    // spatial hash of the sample buffer, so accept_sample() only
+    // compares against samples in the neighbouring cells
+    void grid_rebuild();
+    void grid_add(uint16_t idx);
+    uint16_t grid_bucket(int32_t x, int32_t y, int32_t z) const;
+
+    // linear least squares sphere fit from the running sums
+    void sphere_sums_add(const Vector3f &sample);
+    bool sphere_sums_solve(Vector3f &centre, float &radius) const;
 
     // returns true if fit is acceptable
     bool fit_acceptable() const;
@@ -226,6 +246,25 @@ private:
     uint16_t _samples_collected;            // number of samples in buffer
     uint16_t _samples_thinned;              // number of samples removed by the thin_samples() call (called before step 2 begins)
 
+    struct SampleGrid {
+        uint16_t head[COMPASS_CAL_GRID_BUCKETS];    // first sample index in each bucket plus one, zero if empty
+        uint16_t next[COMPASS_CAL_NUM_SAMPLES];     // next sample index in the same bucket plus one
+    } *_grid;                               // allocated with the sample buffer
+    float _grid_cell_size;                  // cell edge, the min_sample_distance() the grid was built for
+
+    /*
+      sums for the linear sphere fit |p|^2 = 2c.p + k, accumulated as
+      samples are accepted. Samples are taken relative to the first
+      one, which keeps the sums small enough for float to give the
+      centre to well within a milligauss
+     */
+    struct {
+        Vector3f origin;
+        float ATA[4*4];
+        float ATb[4];
+        uint16_t count;
+    } _sphere_sums;
+
     // fit state
     class param_t _params;                  // latest calibration outputs
     uint16_t _fit_step;                     // step during RUNNING_STEP_ONE/TWO which performs sphere fit and ellipsoid fit
@@ -7,6 +7,7 @@
 #include <AP_OpticalFlow/AP_OpticalFlow.h>
 #include <AP_WheelEncoder/AP_WheelEncoder.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
+#include <AP_Common/AP_HeapAccounting.h>
 
 #if APM_BUILD_TYPE(APM_BUILD_Replay)
 #include <AP_NavEKF2/AP_NavEKF2.h>
@@ -269,6 +270,7 @@ int AP_DAL::snprintf(char* str, size_t size, const char *format, ...) const
 
 void *AP_DAL::malloc_type(size_t size, Memory_Type mem_type) const
 {
+    HEAP_TAG_SCOPE(EKF);
     return hal.util->malloc_type(size, AP_HAL::Util::Memory_Type(mem_type));
 }
 
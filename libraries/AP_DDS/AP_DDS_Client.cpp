@@ -30,14 +30,16 @@
 
 // Enable DDS at runtime by default
 static constexpr uint8_t ENABLED_BY_DEFAULT = 1;
-static constexpr uint16_t DELAY_TIME_TOPIC_MS = 10;
-static constexpr uint16_t DELAY_BATTERY_STATE_TOPIC_MS = 1000;
-static constexpr uint16_t DELAY_IMU_TOPIC_MS = 5;
-static constexpr uint16_t DELAY_LOCAL_POSE_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_LOCAL_VELOCITY_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_GEO_POSE_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_CLOCK_TOPIC_MS = 10;
-static constexpr uint16_t DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS = 1000;
+static constexpr uint16_t RATE_TIME_TOPIC_HZ = 100;
+static constexpr uint16_t RATE_BATTERY_STATE_TOPIC_HZ = 1;
+static constexpr uint16_t RATE_IMU_TOPIC_HZ = 200;
+static constexpr uint16_t RATE_LOCAL_POSE_TOPIC_HZ = 30;
+static constexpr uint16_t RATE_LOCAL_VELOCITY_TOPIC_HZ = 30;
+static constexpr uint16_t RATE_GEO_POSE_TOPIC_HZ = 30;
+static constexpr uint16_t RATE_CLOCK_TOPIC_HZ = 100;
+static constexpr uint16_t RATE_GPS_GLOBAL_ORIGIN_TOPIC_HZ = 1;
+// the DDS loop runs at about this rate, so faster topics can't keep up
+static constexpr uint16_t RATE_TOPIC_MAX_HZ = 500;
 static constexpr uint16_t DELAY_PING_MS = 500;
 
 // Define the subscriber data members, which are static class scope.
@@ -74,6 +76,70 @@ const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
 
 #endif
 
+    // @Param: _RATE_IMU
+    // @DisplayName: DDS IMU topic rate
+    // @Description: Rate at which the IMU topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_IMU", 4, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::IMU)].rate_hz, RATE_IMU_TOPIC_HZ),
+
+    // @Param: _RATE_POSE
+    // @DisplayName: DDS local pose topic rate
+    // @Description: Rate at which the filtered local pose topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_POSE", 5, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::LOCAL_POSE)].rate_hz, RATE_LOCAL_POSE_TOPIC_HZ),
+
+    // @Param: _RATE_TWIST
+    // @DisplayName: DDS local velocity topic rate
+    // @Description: Rate at which the filtered local velocity (twist) topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_TWIST", 6, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::LOCAL_VELOCITY)].rate_hz, RATE_LOCAL_VELOCITY_TOPIC_HZ),
+
+    // @Param: _RATE_GEOPOS
+    // @DisplayName: DDS geopose topic rate
+    // @Description: Rate at which the filtered geopose topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GEOPOS", 7, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::GEO_POSE)].rate_hz, RATE_GEO_POSE_TOPIC_HZ),
+
+    // @Param: _RATE_TIME
+    // @DisplayName: DDS time topic rate
+    // @Description: Rate at which the time topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_TIME", 8, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::TIME)].rate_hz, RATE_TIME_TOPIC_HZ),
+
+    // @Param: _RATE_CLOCK
+    // @DisplayName: DDS clock topic rate
+    // @Description: Rate at which the clock topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_CLOCK", 9, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::CLOCK)].rate_hz, RATE_CLOCK_TOPIC_HZ),
+
+    // @Param: _RATE_BATT
+    // @DisplayName: DDS battery topic rate
+    // @Description: Rate at which the battery state topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_BATT", 10, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::BATTERY_STATE)].rate_hz, RATE_BATTERY_STATE_TOPIC_HZ),
+
+    // @Param: _RATE_ORIGIN
+    // @DisplayName: DDS GPS global origin topic rate
+    // @Description: Rate at which the GPS global origin topic is published. 0 disables the topic
+    // @Units: Hz
+    // @Range: 0 500
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ORIGIN", 11, AP_DDS_Client, periodic[uint8_t(PeriodicTopic::GPS_GLOBAL_ORIGIN)].rate_hz, RATE_GPS_GLOBAL_ORIGIN_TOPIC_HZ),
+
     AP_GROUPEND
 };
 
@@ -309,8 +375,13 @@ void AP_DDS_Client::update_topic(geometry_msgs_msg_PoseStamped& msg)
     update_topic(msg.header.stamp);
     strcpy(msg.header.frame_id, BASE_LINK_FRAME_ID);
 
-    auto &ahrs = AP::ahrs();
-    WITH_SEMAPHORE(ahrs.get_semaphore());
+    // use the AHRS snapshot so position and orientation come from the
+    // same AHRS update without holding the AHRS semaphore
+    AP_AHRS::Snapshot snap;
+    if (!AP::ahrs().get_snapshot(snap)) {
+        initialize(msg.pose.orientation);
+        return;
+    }
 
     // ROS REP 103 uses the ENU convention:
     // X - East
@@ -324,8 +395,8 @@ void AP_DDS_Client::update_topic(geometry_msgs_msg_PoseStamped& msg)
     // As a consequence, to follow ROS REP 103, it is necessary to switch X and Y,
     // as well as invert Z
 
-    Vector3f position;
-    if (ahrs.get_relative_position_NED_home(position)) {
+    if (snap.relative_position_NED_home_ok) {
+        const Vector3f &position = snap.relative_position_NED_home;
         msg.pose.position.x = position[1];
         msg.pose.position.y = position[0];
         msg.pose.position.z = -position[2];
@@ -339,8 +410,8 @@ void AP_DDS_Client::update_topic(geometry_msgs_msg_PoseStamped& msg)
     // As a consequence, to follow ROS REP 103, it is necessary to switch X and Y,
     // as well as invert Z (NED to ENU conversion) as well as a 90 degree rotation in the Z axis
     // for x to point forward
-    Quaternion orientation;
-    if (ahrs.get_quaternion(orientation)) {
+    if (snap.quat_ok) {
+        Quaternion orientation = snap.quat;
         Quaternion aux(orientation[0], orientation[2], orientation[1], -orientation[3]); //NED to ENU transformation
         Quaternion transformation (sqrtF(2) * 0.5,0,0,sqrtF(2) * 0.5); // Z axis 90 degree rotation
         orientation = aux * transformation;
@@ -358,8 +429,10 @@ void AP_DDS_Client::update_topic(geometry_msgs_msg_TwistStamped& msg)
     update_topic(msg.header.stamp);
     strcpy(msg.header.frame_id, BASE_LINK_FRAME_ID);
 
-    auto &ahrs = AP::ahrs();
-    WITH_SEMAPHORE(ahrs.get_semaphore());
+    AP_AHRS::Snapshot snap;
+    if (!AP::ahrs().get_snapshot(snap)) {
+        return;
+    }
 
     // ROS REP 103 uses the ENU convention:
     // X - East
@@ -372,8 +445,8 @@ void AP_DDS_Client::update_topic(geometry_msgs_msg_TwistStamped& msg)
     // Z - Down
     // As a consequence, to follow ROS REP 103, it is necessary to switch X and Y,
     // as well as invert Z
-    Vector3f velocity;
-    if (ahrs.get_velocity_NED(velocity)) {
+    if (snap.velocity_NED_ok) {
+        const Vector3f &velocity = snap.velocity_NED;
         msg.twist.linear.x = velocity[1];
         msg.twist.linear.y = velocity[0];
         msg.twist.linear.z = -velocity[2];
@@ -389,7 +462,7 @@ void AP_DDS_Client::update_topic(geometry_msgs_msg_TwistStamped& msg)
     // Y - Right
     // Z - Down
     // As a consequence, to follow ROS REP 103, it is necessary to invert Y and Z
-    Vector3f angular_velocity = ahrs.get_gyro();
+    const Vector3f &angular_velocity = snap.gyro;
     msg.twist.angular.x = angular_velocity[0];
     msg.twist.angular.y = -angular_velocity[1];
     msg.twist.angular.z = -angular_velocity[2];
@@ -400,11 +473,14 @@ void AP_DDS_Client::update_topic(geographic_msgs_msg_GeoPoseStamped& msg)
     update_topic(msg.header.stamp);
     strcpy(msg.header.frame_id, BASE_LINK_FRAME_ID);
 
-    auto &ahrs = AP::ahrs();
-    WITH_SEMAPHORE(ahrs.get_semaphore());
+    AP_AHRS::Snapshot snap;
+    if (!AP::ahrs().get_snapshot(snap)) {
+        initialize(msg.pose.orientation);
+        return;
+    }
 
-    Location loc;
-    if (ahrs.get_location(loc)) {
+    if (snap.location_ok) {
+        const Location &loc = snap.location;
         msg.pose.position.latitude = loc.lat * 1E-7;
         msg.pose.position.longitude = loc.lng * 1E-7;
         // TODO this is assumed to be absolute frame in WGS-84 as per the GeoPose message definition in ROS.
@@ -420,8 +496,8 @@ void AP_DDS_Client::update_topic(geographic_msgs_msg_GeoPoseStamped& msg)
     // As a consequence, to follow ROS REP 103, it is necessary to switch X and Y,
     // as well as invert Z (NED to ENU conversion) as well as a 90 degree rotation in the Z axis
     // for x to point forward
-    Quaternion orientation;
-    if (ahrs.get_quaternion(orientation)) {
+    if (snap.quat_ok) {
+        Quaternion orientation = snap.quat;
         Quaternion aux(orientation[0], orientation[2], orientation[1], -orientation[3]); //NED to ENU transformation
         Quaternion transformation(sqrtF(2) * 0.5, 0, 0, sqrtF(2) * 0.5); // Z axis 90 degree rotation
         orientation = aux * transformation;
@@ -442,14 +518,14 @@ void AP_DDS_Client::update_topic(sensor_msgs_msg_Imu& msg)
     auto &imu = AP::ins();
     auto &ahrs = AP::ahrs();
 
-    WITH_SEMAPHORE(ahrs.get_semaphore());
-
-    Quaternion orientation;
-    if (ahrs.get_quaternion(orientation)) {
-        msg.orientation.x = orientation[0];
-        msg.orientation.y = orientation[1];
-        msg.orientation.z = orientation[2];
-        msg.orientation.w = orientation[3];
+    // orientation from the AHRS snapshot, so we don't hold the AHRS
+    // semaphore at the IMU topic rate
+    AP_AHRS::Snapshot snap;
+    if (ahrs.get_snapshot(snap) && snap.quat_ok) {
+        msg.orientation.x = snap.quat[0];
+        msg.orientation.y = snap.quat[1];
+        msg.orientation.z = snap.quat[2];
+        msg.orientation.w = snap.quat[3];
     } else {
         initialize(msg.orientation);
     }
@@ -482,13 +558,15 @@ void AP_DDS_Client::update_topic(geographic_msgs_msg_GeoPointStamped& msg)
     update_topic(msg.header.stamp);
     strcpy(msg.header.frame_id, BASE_LINK_FRAME_ID);
 
-    auto &ahrs = AP::ahrs();
-    WITH_SEMAPHORE(ahrs.get_semaphore());
+    AP_AHRS::Snapshot snap;
+    if (!AP::ahrs().get_snapshot(snap)) {
+        return;
+    }
 
-    Location ekf_origin;
     // LLA is WGS-84 geodetic coordinate.
     // Altitude converted from cm to m.
-    if (ahrs.get_origin(ekf_origin)) {
+    if (snap.origin_ok) {
+        const Location &ekf_origin = snap.origin;
         msg.position.latitude = ekf_origin.lat * 1E-7;
         msg.position.longitude = ekf_origin.lng * 1E-7;
         msg.position.altitude = ekf_origin.alt * 0.01;
@@ -1093,62 +1171,100 @@ void AP_DDS_Client::write_gps_global_origin_topic()
     }
 }
 
+/*
+  return true if a periodic topic is due for publishing
+ */
+bool AP_DDS_Client::periodic_due(const PeriodicTopic topic, const uint64_t now_us)
+{
+    auto &p = periodic[uint8_t(topic)];
+    const int16_t rate_hz = MIN(p.rate_hz.get(), RATE_TOPIC_MAX_HZ);
+    if (rate_hz <= 0) {
+        return false;
+    }
+    const uint32_t period_us = 1000000UL / rate_hz;
+    if (now_us - p.last_us < period_us) {
+        return false;
+    }
+    p.last_us += period_us;
+    if (now_us - p.last_us >= period_us) {
+        // fallen behind, or just starting; don't try to catch up
+        p.last_us = now_us;
+    }
+    return true;
+}
+
 void AP_DDS_Client::update()
 {
-    WITH_SEMAPHORE(csem);
-    const auto cur_time_ms = AP_HAL::millis64();
+    const uint64_t now_us = AP_HAL::micros64();
 
-    if (cur_time_ms - last_time_time_ms > DELAY_TIME_TOPIC_MS) {
+    // take the samples for everything that is due before taking csem.
+    // They come from AHRS snapshots and the sensor libraries' own
+    // locks, none of which need to be held while we serialise
+    constexpr uint8_t gps_instance = 0;
+    const bool nav_sat_fix_due = update_topic(nav_sat_fix_topic, gps_instance);
+
+    const bool imu_due = periodic_due(PeriodicTopic::IMU, now_us);
+    if (imu_due) {
+        update_topic(imu_topic);
+    }
+    const bool local_pose_due = periodic_due(PeriodicTopic::LOCAL_POSE, now_us);
+    if (local_pose_due) {
+        update_topic(local_pose_topic);
+    }
+    const bool local_velocity_due = periodic_due(PeriodicTopic::LOCAL_VELOCITY, now_us);
+    if (local_velocity_due) {
+        update_topic(tx_local_velocity_topic);
+    }
+    const bool geo_pose_due = periodic_due(PeriodicTopic::GEO_POSE, now_us);
+    if (geo_pose_due) {
+        update_topic(geo_pose_topic);
+    }
+    const bool time_due = periodic_due(PeriodicTopic::TIME, now_us);
+    if (time_due) {
         update_topic(time_topic);
-        last_time_time_ms = cur_time_ms;
-        write_time_topic();
     }
-
-    constexpr uint8_t gps_instance = 0;
-    if (update_topic(nav_sat_fix_topic, gps_instance)) {
-        write_nav_sat_fix_topic();
+    const bool clock_due = periodic_due(PeriodicTopic::CLOCK, now_us);
+    if (clock_due) {
+        update_topic(clock_topic);
     }
-
-    if (cur_time_ms - last_battery_state_time_ms > DELAY_BATTERY_STATE_TOPIC_MS) {
+    const bool battery_state_due = periodic_due(PeriodicTopic::BATTERY_STATE, now_us);
+    if (battery_state_due) {
         constexpr uint8_t battery_instance = 0;
         update_topic(battery_state_topic, battery_instance);
-        last_battery_state_time_ms = cur_time_ms;
-        write_battery_state_topic();
     }
-
-    if (cur_time_ms - last_local_pose_time_ms > DELAY_LOCAL_POSE_TOPIC_MS) {
-        update_topic(local_pose_topic);
-        last_local_pose_time_ms = cur_time_ms;
-        write_local_pose_topic();
+    const bool gps_global_origin_due = periodic_due(PeriodicTopic::GPS_GLOBAL_ORIGIN, now_us);
+    if (gps_global_origin_due) {
+        update_topic(gps_global_origin_topic);
     }
 
-    if (cur_time_ms - last_local_velocity_time_ms > DELAY_LOCAL_VELOCITY_TOPIC_MS) {
-        update_topic(tx_local_velocity_topic);
-        last_local_velocity_time_ms = cur_time_ms;
-        write_tx_local_velocity_topic();
-    }
+    WITH_SEMAPHORE(csem);
 
-    if (cur_time_ms - last_imu_time_ms > DELAY_IMU_TOPIC_MS) {
-        update_topic(imu_topic);
-        last_imu_time_ms = cur_time_ms;
+    // only serialising the samples and flushing the session need csem
+    if (imu_due) {
         write_imu_topic();
     }
-
-    if (cur_time_ms - last_geo_pose_time_ms > DELAY_GEO_POSE_TOPIC_MS) {
-        update_topic(geo_pose_topic);
-        last_geo_pose_time_ms = cur_time_ms;
+    if (local_pose_due) {
+        write_local_pose_topic();
+    }
+    if (local_velocity_due) {
+        write_tx_local_velocity_topic();
+    }
+    if (geo_pose_due) {
         write_geo_pose_topic();
     }
-
-    if (cur_time_ms - last_clock_time_ms > DELAY_CLOCK_TOPIC_MS) {
-        update_topic(clock_topic);
-        last_clock_time_ms = cur_time_ms;
+    if (time_due) {
+        write_time_topic();
+    }
+    if (clock_due) {
         write_clock_topic();
     }
-
-    if (cur_time_ms - last_gps_global_origin_time_ms > DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS) {
-        update_topic(gps_global_origin_topic);
-        last_gps_global_origin_time_ms = cur_time_ms;
+    if (nav_sat_fix_due) {
+        write_nav_sat_fix_topic();
+    }
+    if (battery_state_due) {
+        write_battery_state_topic();
+    }
+    if (gps_global_origin_due) {
         write_gps_global_origin_topic();
     }
 
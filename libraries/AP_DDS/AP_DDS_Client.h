@@ -112,24 +112,31 @@ private:
         .min_pace_period = 0
     };
 
-    // The last ms timestamp AP_DDS wrote a Time message
-    uint64_t last_time_time_ms;
-    // The last ms timestamp AP_DDS wrote a NavSatFix message
+    // The GPS fix time of the last NavSatFix message AP_DDS wrote
     uint64_t last_nav_sat_fix_time_ms;
-    // The last ms timestamp AP_DDS wrote a BatteryState message
-    uint64_t last_battery_state_time_ms;
-    // The last ms timestamp AP_DDS wrote an IMU message
-    uint64_t last_imu_time_ms;
-    // The last ms timestamp AP_DDS wrote a Local Pose message
-    uint64_t last_local_pose_time_ms;
-    // The last ms timestamp AP_DDS wrote a Local Velocity message
-    uint64_t last_local_velocity_time_ms;
-    // The last ms timestamp AP_DDS wrote a GeoPose message
-    uint64_t last_geo_pose_time_ms;
-    // The last ms timestamp AP_DDS wrote a Clock message
-    uint64_t last_clock_time_ms;
-    // The last ms timestamp AP_DDS wrote a gps global origin message
-    uint64_t last_gps_global_origin_time_ms;
+
+    // topics published at a rate set by a parameter, in the order
+    // they are written into the output stream
+    enum class PeriodicTopic : uint8_t {
+        IMU,
+        LOCAL_POSE,
+        LOCAL_VELOCITY,
+        GEO_POSE,
+        TIME,
+        CLOCK,
+        BATTERY_STATE,
+        GPS_GLOBAL_ORIGIN,
+        COUNT
+    };
+    struct {
+        AP_Int16 rate_hz;
+        // when the topic was last due, advanced by whole periods so
+        // the average rate holds even though the loop timing jitters
+        uint64_t last_us;
+    } periodic[uint8_t(PeriodicTopic::COUNT)];
+
+    // true if a periodic topic should be published now
+    bool periodic_due(const PeriodicTopic topic, const uint64_t now_us);
 
     // functions for serial transport
     bool ddsSerialInit();
@@ -186,7 +186,25 @@ bool CanardInterface::shouldAcceptTransfer(const CanardInstance* ins,
                                            CanardTransferType transfer_type,
                                            uint8_t source_node_id) {
     CanardInterface* iface = (CanardInterface*) ins->user_reference;
-    return iface->accept_message(data_type_id, *out_data_type_signature);
+    return iface->accept_message_cached(data_type_id, transfer_type, *out_data_type_signature);
+}
+
+bool CanardInterface::accept_message_cached(uint16_t data_type_id, CanardTransferType transfer_type, uint64_t &signature)
+{
+    AcceptCacheEntry &e = accept_cache[(data_type_id * 3U + uint8_t(transfer_type)) % ACCEPT_CACHE_SIZE];
+    const uint32_t now_ms = AP_HAL::millis();
+    if (e.valid && e.data_type_id == data_type_id && e.transfer_type == uint8_t(transfer_type) &&
+        (e.accept || now_ms - e.checked_ms < ACCEPT_CACHE_REJECT_TIMEOUT_MS)) {
+        signature = e.signature;
+        return e.accept;
+    }
+    e.accept = accept_message(data_type_id, signature);
+    e.signature = signature;
+    e.data_type_id = data_type_id;
+    e.transfer_type = uint8_t(transfer_type);
+    e.checked_ms = now_ms;
+    e.valid = true;
+    return e.accept;
 }
 
 #if AP_TEST_DRONECAN_DRIVERS
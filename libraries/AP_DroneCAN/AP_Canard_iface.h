@@ -81,5 +81,22 @@ private:
 
     // auxillary 11 bit CANSensor
     CANSensor *aux_11bit_driver;
+
+    // results of accept_message() by data type, so the handler lists
+    // aren't walked for every frame received. Rejections expire as
+    // drivers may subscribe after startup. Only used with _sem_rx held
+    struct AcceptCacheEntry {
+        uint64_t signature;
+        uint32_t checked_ms;
+        uint16_t data_type_id;
+        uint8_t transfer_type;
+        bool valid;
+        bool accept;
+    };
+    static constexpr uint8_t ACCEPT_CACHE_SIZE = 64;
+    static constexpr uint32_t ACCEPT_CACHE_REJECT_TIMEOUT_MS = 1000;
+    AcceptCacheEntry accept_cache[ACCEPT_CACHE_SIZE] {};
+
+    bool accept_message_cached(uint16_t data_type_id, CanardTransferType transfer_type, uint64_t &signature);
 };
 #endif // HAL_ENABLE_DRONECAN_DRIVERS
@@ -27,6 +27,7 @@
 #include <ctype.h>
 
 #define PACKED_NAME "param.pck"
+#define HASH_NAME "param.hsh"
 
 extern const AP_HAL::HAL& hal;
 extern int errno;
@@ -38,6 +39,13 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
         return -1;
     }
     bool read_only = ((flags & O_ACCMODE) == O_RDONLY);
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    const bool hash_file = is_hash_file(fname);
+    if (hash_file && !read_only) {
+        errno = EROFS;
+        return -1;
+    }
+#endif
     uint8_t idx;
     for (idx=0; idx<max_open_file; idx++) {
         if (!file[idx].open) {
@@ -49,6 +57,21 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
         return -1;
     }
     struct rfile &r = file[idx];
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    r.hashbuf = nullptr;
+    r.hashbuf_len = 0;
+    if (hash_file) {
+        if (!fill_hashes(r)) {
+            return -1;
+        }
+        r.cursors = nullptr;
+        r.writebuf = nullptr;
+        r.file_ofs = 0;
+        r.file_size = r.hashbuf_len;
+        r.open = true;
+        return idx;
+    }
+#endif
     if (read_only) {
         r.cursors = NEW_NOTHROW cursor[num_cursors];
         if (r.cursors == nullptr) {
@@ -140,6 +163,10 @@ int AP_Filesystem_Param::close(int fd)
     r.cursors = nullptr;
     delete r.writebuf;
     r.writebuf = nullptr;
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    delete [] r.hashbuf;
+    r.hashbuf = nullptr;
+#endif
     return ret;
 }
 
@@ -164,6 +191,73 @@ int AP_Filesystem_Param::close(int fd)
     does not cross a read packet boundary
  */
 
+#if AP_PARAM_BLOCK_HASH_ENABLED
+/*
+  hash file format, for ground stations that keep a copy of the
+  parameters between connections:
+    file header:
+      uint16_t magic = 0x671d
+      uint16_t num_blocks
+      uint16_t total_params
+      uint16_t reserved
+      uint32_t root_hash     // crc32 of all the block entries
+
+    per-block:
+      uint16_t start         // index of first parameter in param.pck order
+      uint16_t count         // number of parameters in the block
+      uint32_t hash          // crc32 of type, name length, name and value of each parameter
+
+  A ground station with a cached copy reads the 12 byte header and
+  stops if root_hash is unchanged. Otherwise it reads the block
+  entries and fetches each block that differs with
+  param.pck?start=S&count=C. The file is a snapshot taken when it is
+  opened
+ */
+bool AP_Filesystem_Param::is_hash_file(const char *name) const
+{
+    return strcmp(name, HASH_NAME) == 0;
+}
+
+/*
+  take a snapshot of the block hashes, setting errno on failure
+ */
+bool AP_Filesystem_Param::fill_hashes(struct rfile &r)
+{
+    const uint16_t max_blocks = AP_Param::block_hash_max_blocks();
+    const uint32_t len = sizeof(hash_header) + max_blocks * sizeof(AP_Param::BlockHash);
+    r.hashbuf = NEW_NOTHROW uint8_t[len];
+    if (r.hashbuf == nullptr) {
+        errno = ENOMEM;
+        return false;
+    }
+    auto *blocks = (AP_Param::BlockHash *)&r.hashbuf[sizeof(hash_header)];
+    uint16_t num_blocks;
+    if (!AP_Param::get_block_hashes(blocks, max_blocks, num_blocks)) {
+        // the parameters changed under us. An empty file would look
+        // like an unchanged empty set, so fail and let the GCS retry
+        // with a fresh count
+        AP_Param::invalidate_count();
+        delete[] r.hashbuf;
+        r.hashbuf = nullptr;
+        errno = EAGAIN;
+        return false;
+    }
+
+    struct hash_header hdr;
+    hdr.num_blocks = num_blocks;
+    hdr.total_params = 0;
+    for (uint16_t i=0; i<num_blocks; i++) {
+        hdr.total_params += blocks[i].count;
+    }
+    hdr.reserved = 0;
+    hdr.root_hash = crc_crc32(0, (const uint8_t *)blocks, num_blocks * sizeof(AP_Param::BlockHash));
+    memcpy(r.hashbuf, &hdr, sizeof(hdr));
+
+    r.hashbuf_len = sizeof(hash_header) + num_blocks * sizeof(AP_Param::BlockHash);
+    return true;
+}
+#endif // AP_PARAM_BLOCK_HASH_ENABLED
+
 /*
   pack a single parameter. The buffer must be at least of size max_pack_len
  */
@@ -329,6 +423,17 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
         errno = EINVAL;
         return -1;
     }
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    if (r.hashbuf != nullptr) {
+        if (r.file_ofs >= r.hashbuf_len) {
+            return 0;
+        }
+        count = MIN(count, r.hashbuf_len - r.file_ofs);
+        memcpy(buf, &r.hashbuf[r.file_ofs], count);
+        r.file_ofs += count;
+        return count;
+    }
+#endif
     size_t header_total = 0;
 
     /*
@@ -474,6 +579,12 @@ int AP_Filesystem_Param::stat(const char *name, struct stat *stbuf)
         return -1;
     }
     memset(stbuf, 0, sizeof(*stbuf));
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    if (is_hash_file(name)) {
+        stbuf->st_size = sizeof(hash_header) + AP_Param::block_hash_max_blocks() * sizeof(AP_Param::BlockHash);
+        return 0;
+    }
+#endif
     // give size estimation to avoid needing to scan entire file
     stbuf->st_size = AP_Param::count_parameters() * 12;
     return 0;
@@ -489,6 +600,11 @@ bool AP_Filesystem_Param::check_file_name(const char *name)
         (name[packed_len] == 0 || name[packed_len] == '?')) {
         return true;
     }
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    if (is_hash_file(name)) {
+        return true;
+    }
+#endif
     return false;
 }
 
@@ -76,12 +76,32 @@ private:
         uint32_t file_size;
         struct cursor *cursors;
         ExpandingString *writebuf; // for upload
+#if AP_PARAM_BLOCK_HASH_ENABLED
+        uint8_t *hashbuf;          // snapshot of block hashes
+        uint32_t hashbuf_len;
+#endif
     } file[max_open_file];
 
     bool token_seek(const struct rfile &r, const uint32_t data_ofs, struct cursor &c);
     uint8_t pack_param(const struct rfile &r, struct cursor &c, uint8_t *buf);
     bool check_file_name(const char *fname);
 
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    static constexpr uint16_t hmagic = 0x671d;
+
+    // header at front of the hash file
+    struct PACKED hash_header {
+        uint16_t magic = hmagic;
+        uint16_t num_blocks;
+        uint16_t total_params;
+        uint16_t reserved;
+        uint32_t root_hash;
+    };
+
+    bool is_hash_file(const char *fname) const;
+    bool fill_hashes(struct rfile &r);
+#endif
+
     // finish uploading parameters
     bool finish_upload(const rfile &r);
     bool param_upload_parse(const rfile &r, bool &need_retry);
@@ -26,6 +26,8 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <StorageManager/StorageManager.h>
+#include <AP_Common/AP_HeapAccounting.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -38,8 +40,13 @@ static const SysFileList sysfs_file_list[] = {
     {"tasks.txt"},
     {"dma.txt"},
     {"memory.txt"},
+#if AP_HEAP_ACCOUNTING_ENABLED
+    {"mem.txt"},
+#endif
     {"uarts.txt"},
     {"timers.txt"},
+    {"spi.txt"},
+    {"storage.txt"},
 #if HAL_MAX_CAN_PROTOCOL_DRIVERS
     {"can_log.txt"},
 #endif
@@ -112,6 +119,11 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "memory.txt") == 0) {
         hal.util->mem_info(*r.str);
     }
+#if AP_HEAP_ACCOUNTING_ENABLED
+    if (strcmp(fname, "mem.txt") == 0) {
+        AP_HeapAccounting::mem_info(*r.str);
+    }
+#endif
 #if HAL_UART_STATS_ENABLED
     if (strcmp(fname, "uarts.txt") == 0) {
         hal.util->uart_info(*r.str);
@@ -120,6 +132,12 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "timers.txt") == 0) {
         hal.util->timer_info(*r.str);
     }
+    if (strcmp(fname, "spi.txt") == 0) {
+        hal.util->spi_info(*r.str);
+    }
+    if (strcmp(fname, "storage.txt") == 0) {
+        StorageManager::storage_info(*r.str);
+    }
 #if HAL_CANMANAGER_ENABLED
     if (strcmp(fname, "can_log.txt") == 0) {
         AP::can().log_retrieve(*r.str);
@@ -18,6 +18,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_FlashStorage/AP_FlashStorage.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
 #include <AP_InternalError/AP_InternalError.h>
 #include <stdio.h>
 
@@ -95,27 +96,60 @@ bool AP_FlashStorage::init(void)
         first_sector = 0;
     }
 
-    // load data from any current sectors
-    for (uint8_t i=0; i<2; i++) {
-        uint8_t sector = (first_sector + i) & 1;
-        if (states[sector] == SECTOR_STATE_IN_USE ||
-            states[sector] == SECTOR_STATE_FULL) {
-            if (!load_sector(sector)) {
-                return erase_all();
-            }
-        }
+    // the newest sector is the one new data is written to
+    const uint8_t newest = states[first_sector^1] == SECTOR_STATE_IN_USE ? (first_sector^1) : first_sector;
+
+    // find the last complete checkpoint in the newest sector. If
+    // there is one then all of storage can be loaded from there,
+    // without replaying anything older
+    uint32_t checkpoint_ofs = 0;
+    if (states[newest] == SECTOR_STATE_IN_USE &&
+        !find_checkpoint(newest, checkpoint_ofs)) {
+        return erase_all();
     }
 
     // clear any write error
     write_error = false;
     reserved_space = 0;
-    
-    // if the first sector is full then write out all data so we can erase it
-    if (states[first_sector] == SECTOR_STATE_FULL) {
-        current_sector = first_sector ^ 1;
-        if (!write_all()) {
+    checkpoint.active = false;
+    checkpoint_complete = false;
+
+    if (checkpoint_ofs != 0) {
+        if (!load_sector(newest, checkpoint_ofs)) {
             return erase_all();
         }
+        current_sector = newest;
+        checkpoint_complete = true;
+    } else {
+        // load data from any current sectors, starting from the last
+        // checkpoint in a full sector if it has one
+        for (uint8_t i=0; i<2; i++) {
+            uint8_t sector = (first_sector + i) & 1;
+            if (states[sector] == SECTOR_STATE_IN_USE ||
+                states[sector] == SECTOR_STATE_FULL) {
+                uint32_t start_ofs = 0;
+                if (states[sector] == SECTOR_STATE_FULL &&
+                    !find_checkpoint(sector, start_ofs)) {
+                    return erase_all();
+                }
+                if (start_ofs == 0) {
+                    start_ofs = sizeof(struct sector_header);
+                }
+                if (!load_sector(sector, start_ofs)) {
+                    return erase_all();
+                }
+            }
+        }
+        current_sector = newest;
+
+        // if the first sector is full then write out all data so we
+        // can erase it
+        if (states[first_sector] == SECTOR_STATE_FULL) {
+            current_sector = first_sector ^ 1;
+            if (!write_checkpoint()) {
+                return erase_all();
+            }
+        }
     }
 
     // erase any sectors marked full
@@ -161,8 +195,10 @@ bool AP_FlashStorage::protected_switch_full_sector(void)
     // clear any write error
     write_error = false;
     reserved_space = 0;
-    
-    if (!write_all()) {
+
+    // the other sector can be erased once all of mem_buffer is in
+    // this one. A complete checkpoint here already holds it
+    if (!checkpoint_complete && !write_checkpoint()) {
         return false;
     }
 
@@ -189,8 +225,10 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
         }
 #endif
 
+        // the reserved space allows for a full write out of
+        // mem_buffer, which isn't needed once there is a checkpoint
         const uint32_t space_available = flash_sector_size - write_offset;
-        const uint32_t space_required = sizeof(struct block_header) + max_write + reserved_space;
+        const uint32_t space_required = sizeof(struct block_header) + max_write + (checkpoint_complete ? 0 : reserved_space);
         if (space_available < space_required) {
             if (!switch_sectors()) {
                 if (!flash_erase_ok()) {
@@ -214,7 +252,11 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
         uint16_t block_ofs = blk.header.block_num*block_size;
         uint16_t block_nbytes = (blk.header.num_blocks_minus_one+1)*block_size;
 
-        memcpy(blk.data, &mem_buffer[block_ofs], block_nbytes);
+        // the last block may extend past the end of storage when the
+        // storage size is not a multiple of the block size
+        const uint16_t copy_nbytes = MIN(block_nbytes, uint16_t(storage_size - block_ofs));
+        memcpy(blk.data, &mem_buffer[block_ofs], copy_nbytes);
+        memset(&blk.data[copy_nbytes], 0, block_nbytes - copy_nbytes);
 
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_F4
         if (!flash_write(current_sector, write_offset, (uint8_t*)&blk.header, sizeof(blk.header))) {
@@ -259,11 +301,11 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
 }
 
 /*
-  load all data from a flash sector into mem_buffer
+  load all data from a flash sector into mem_buffer, starting with the
+  block at ofs
  */
-bool AP_FlashStorage::load_sector(uint8_t sector)
+bool AP_FlashStorage::load_sector(uint8_t sector, uint32_t ofs)
 {
-    uint32_t ofs = sizeof(sector_header);
     while (ofs < flash_sector_size - sizeof(struct block_header)) {
         struct block_header header;
         if (!flash_read(sector, ofs, (uint8_t *)&header, sizeof(header))) {
@@ -295,11 +337,13 @@ bool AP_FlashStorage::load_sector(uint8_t sector)
         case BLOCK_STATE_VALID: {
             uint16_t block_nbytes = (header.num_blocks_minus_one+1)*block_size;
             uint16_t block_ofs = header.block_num*block_size;
-            if (block_ofs + block_nbytes > storage_size) {
+            if (block_ofs + block_nbytes > storage_size + (block_size-1)) {
                 // the data is invalid (out of range)
                 return false;
             }
-            if (!flash_read(sector, ofs+sizeof(header), &mem_buffer[block_ofs], block_nbytes)) {
+            // the last block may be partly past the end of storage
+            const uint16_t copy_nbytes = MIN(block_nbytes, uint16_t(storage_size - block_ofs));
+            if (!flash_read(sector, ofs+sizeof(header), &mem_buffer[block_ofs], copy_nbytes)) {
                 return false;
             }
             //debug("read at %u for %u\n", block_ofs, block_nbytes);
@@ -310,18 +354,200 @@ bool AP_FlashStorage::load_sector(uint8_t sector)
             // invalid state
             return false;
         }
+        ofs = align_block_ofs(ofs);
+    }
+    write_offset = ofs;
+    return true;
+}
+
+/*
+  find the start of the last complete checkpoint in a sector. This
+  only reads block headers and checkpoint markers, so is much quicker
+  than loading the sector. begin_ofs is zero if there is no checkpoint
+ */
+bool AP_FlashStorage::find_checkpoint(uint8_t sector, uint32_t &begin_ofs)
+{
+    begin_ofs = 0;
+    uint32_t ofs = sizeof(sector_header);
+    while (ofs < flash_sector_size - sizeof(struct block_header)) {
+        struct block_header header;
+        if (!flash_read(sector, ofs, (uint8_t *)&header, sizeof(header))) {
+            return false;
+        }
+        switch ((enum BlockState)header.state) {
+        case BLOCK_STATE_AVAILABLE:
+            return true;
+
+        case BLOCK_STATE_WRITING:
+            if (header.block_num == checkpoint_block_num &&
+                header.num_blocks_minus_one == checkpoint_num_blocks-1) {
+                struct checkpoint_marker marker;
+                if (!flash_read(sector, ofs+sizeof(header), (uint8_t *)&marker, sizeof(marker))) {
+                    return false;
+                }
+                if (marker.begin_ofs >= sizeof(sector_header) &&
+                    marker.begin_ofs < ofs &&
+                    marker.crc == checkpoint_crc(marker.begin_ofs, ofs)) {
+                    begin_ofs = marker.begin_ofs;
+                }
+            }
+            break;
+
+        case BLOCK_STATE_VALID:
+            break;
+
+        default:
+            // invalid state
+            return false;
+        }
+        ofs = align_block_ofs(ofs + sizeof(header) + (header.num_blocks_minus_one+1)*block_size);
+    }
+    return true;
+}
+
+// advance a flash offset to where the next block can be written
+uint32_t AP_FlashStorage::align_block_ofs(uint32_t ofs)
+{
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_H7
-        // offsets must be advanced to a multiple of 32 on H7
-        ofs = (ofs + 31U) & ~31U;
+    // offsets must be advanced to a multiple of 32 on H7
+    ofs = (ofs + 31U) & ~31U;
 #elif AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_G4
-        // offsets must be advanced to a multiple of 8 on G4
-        ofs = (ofs + 7U) & ~7U;
+    // offsets must be advanced to a multiple of 8 on G4
+    ofs = (ofs + 7U) & ~7U;
 #endif
+    return ofs;
+}
+
+// check value for a checkpoint marker at marker_ofs
+uint16_t AP_FlashStorage::checkpoint_crc(uint32_t begin_ofs, uint32_t marker_ofs)
+{
+    const uint32_t v[3] { signature, begin_ofs, marker_ofs };
+    return crc16_ccitt((const uint8_t *)v, sizeof(v), 0xFFFF);
+}
+
+/*
+  write a marker saying that all of mem_buffer has been written to the
+  current sector since begin_ofs. The marker is written as blocks in
+  the writing state so firmware that doesn't know about checkpoints
+  skips over it
+ */
+bool AP_FlashStorage::write_checkpoint_marker(uint32_t begin_ofs)
+{
+    // the header and its blocks, padded out to whole flash words
+    // where the flash can only be written that way
+    const uint16_t marker_nbytes = sizeof(struct block_header) + checkpoint_num_blocks*block_size;
+    const uint32_t write_nbytes = align_block_ofs(write_offset + marker_nbytes) - write_offset;
+    uint8_t buf[(marker_nbytes + 31U) & ~31U];
+
+    if (flash_sector_size - write_offset < write_nbytes) {
+        return false;
     }
-    write_offset = ofs;
+
+    memset(buf, 0xFF, sizeof(buf));
+    struct block_header header;
+    header.state = BLOCK_STATE_WRITING;
+    header.block_num = checkpoint_block_num;
+    header.num_blocks_minus_one = checkpoint_num_blocks-1;
+    memcpy(buf, &header, sizeof(header));
+
+    const struct checkpoint_marker marker {
+        begin_ofs,
+        checkpoint_crc(begin_ofs, write_offset)
+    };
+    memcpy(&buf[sizeof(header)], &marker, sizeof(marker));
+
+    if (!flash_write(current_sector, write_offset, buf, write_nbytes)) {
+        return false;
+    }
+    write_offset += write_nbytes;
     return true;
 }
 
+/*
+  write all of mem_buffer to the current sector followed by a
+  checkpoint marker, so a later init() can start loading from here
+ */
+bool AP_FlashStorage::write_checkpoint(void)
+{
+    checkpoint.active = false;
+    const uint8_t sector = current_sector;
+    const uint32_t begin_ofs = write_offset;
+    if (!write_all()) {
+        return false;
+    }
+    // if write_all() moved to the other sector the checkpoint is
+    // incomplete; switch_sectors() has started a new one there
+    if (current_sector == sector && write_checkpoint_marker(begin_ofs)) {
+        checkpoint_complete = true;
+    }
+    return true;
+}
+
+// start an incremental checkpoint in the current sector
+void AP_FlashStorage::start_checkpoint(void)
+{
+    checkpoint.begin_ofs = write_offset;
+    checkpoint.next_ofs = 0;
+    checkpoint.sector = current_sector;
+    checkpoint.active = true;
+}
+
+/*
+  copy the next piece of mem_buffer into an incremental checkpoint
+ */
+bool AP_FlashStorage::checkpoint_step(void)
+{
+    if (!checkpoint.active || write_error) {
+        return false;
+    }
+    if (checkpoint.sector != current_sector) {
+        // the log moved to the other sector, start again there
+        start_checkpoint();
+    }
+    if (checkpoint.next_ofs == 0) {
+        // the copy and its marker have to fit ahead of the space
+        // reserved for a full write out, or it would be started
+        // again in the other sector forever. Small sectors are left
+        // to the write out when the sector fills
+        const uint32_t marker_space = sizeof(struct block_header) + checkpoint_num_blocks*block_size + 31U;
+        if (flash_sector_size - write_offset < reserved_space + reserve_size + marker_space) {
+            checkpoint.active = false;
+            return false;
+        }
+    }
+
+    // chunks that are all zero don't need copying as init() starts
+    // from an all zero mem_buffer
+    while (checkpoint.next_ofs < storage_size) {
+        // local variable needed to overcome problem with MIN() macro and -O0
+        const uint8_t max_write_local = max_write;
+        const uint16_t ofs = checkpoint.next_ofs;
+        const uint8_t n = MIN(max_write_local, storage_size-ofs);
+        if (all_zero(ofs, n)) {
+            checkpoint.next_ofs += n;
+            continue;
+        }
+        const uint8_t sector = current_sector;
+        if (!write(ofs, n)) {
+            // try again next time
+            return true;
+        }
+        // if the write moved to the other sector then a new
+        // checkpoint has been started there
+        if (current_sector == sector) {
+            checkpoint.next_ofs += n;
+        }
+        return true;
+    }
+
+    // all of mem_buffer is now in this sector
+    if (write_checkpoint_marker(checkpoint.begin_ofs)) {
+        checkpoint_complete = true;
+    }
+    checkpoint.active = false;
+    return false;
+}
+
 /*
   erase one sector
  */
@@ -344,6 +570,8 @@ bool AP_FlashStorage::erase_sector(uint8_t sector, bool mark_available)
 bool AP_FlashStorage::erase_all(void)
 {
     write_error = false;
+    checkpoint.active = false;
+    checkpoint_complete = false;
 
     current_sector = 0;
     write_offset = sizeof(struct sector_header);
@@ -443,6 +671,11 @@ bool AP_FlashStorage::switch_sectors(void)
     reserved_space = reserve_size;
     
     write_offset = sizeof(header);
+
+    // copy all of mem_buffer into the new sector in the background,
+    // after which the full sector is no longer needed
+    checkpoint_complete = false;
+    start_checkpoint();
     return true;    
 }
 
@@ -457,7 +690,7 @@ bool AP_FlashStorage::re_initialise(void)
     if (!erase_all()) {
         return false;        
     }
-    return write_all();
+    return write_checkpoint();
 }
 
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_H7
@@ -24,7 +24,15 @@
 
   - write using log based system
 
-  - read requires scan of all log elements. This is expected to be called rarely
+  - read requires scan of all log elements from the last checkpoint.
+    This is expected to be called rarely
+
+  - after switching sectors a copy of all of storage is written to the
+    new sector in the background, followed by a checkpoint marker. Once
+    that is done init() can load from the checkpoint, without reading
+    the full sector or rewriting its data before erasing it. This
+    needs sectors with room for two copies of storage, otherwise the
+    copy is left to the sector switch
 
   - assumes flash that erases to 0xFF and where writing can only clear
     bits, not set them
@@ -130,6 +138,11 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length) WARN_IF_UNUSED;
 
+    // copy the next piece of mem_buffer into a checkpoint in progress.
+    // Should be called regularly when there is nothing else to
+    // write. Returns true while a checkpoint is in progress
+    bool checkpoint_step(void);
+
     // fixed storage size
     static const uint16_t storage_size = HAL_STORAGE_SIZE;
     
@@ -146,6 +159,18 @@ private:
     uint32_t reserved_space;
     bool write_error;
 
+    // incremental checkpoint of mem_buffer into the current sector
+    struct {
+        uint32_t begin_ofs;     // flash offset the checkpoint started at
+        uint16_t next_ofs;      // next storage offset to copy
+        uint8_t sector;
+        bool active;
+    } checkpoint;
+
+    // true when the current sector holds a complete checkpoint, so the
+    // other sector is not needed
+    bool checkpoint_complete;
+
     // 24 bit signature
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_F4
     static const uint32_t signature = 0x51685B;
@@ -214,11 +239,48 @@ private:
         uint16_t num_blocks_minus_one:3;
     };
 
+    /*
+      a checkpoint marker follows a copy of all of mem_buffer starting
+      at begin_ofs. It is written in the writing state, which older
+      firmware skips, with a header no data write can have: the
+      highest block number with a length of two blocks, which would
+      run past the end of storage, or is longer than a single write
+      where writes are one block. The crc covers the signature and
+      the marker's position in the sector as a further check
+     */
+    static const uint16_t checkpoint_block_num = (1U<<11)-1;
+    static const uint8_t checkpoint_num_blocks = 2;
+    static_assert(num_blocks <= checkpoint_block_num + 1 || max_write < checkpoint_num_blocks*block_size,
+                  "checkpoint marker header must not be valid data");
+    struct PACKED checkpoint_marker {
+        uint32_t begin_ofs;
+        uint16_t crc;
+    };
+    static_assert(sizeof(checkpoint_marker) <= checkpoint_num_blocks*block_size, "checkpoint marker must fit in its blocks");
+
     // amount of space needed to write full storage
     static const uint32_t reserve_size = (storage_size / max_write) * (sizeof(block_header) + max_write) + max_write;
         
-    // load data from a sector
-    bool load_sector(uint8_t sector) WARN_IF_UNUSED;
+    // load data from a sector, starting at the given offset
+    bool load_sector(uint8_t sector, uint32_t ofs) WARN_IF_UNUSED;
+
+    // find the start of the last complete checkpoint in a sector
+    bool find_checkpoint(uint8_t sector, uint32_t &begin_ofs) WARN_IF_UNUSED;
+
+    // write all of mem_buffer and a checkpoint marker to current sector
+    bool write_checkpoint(void) WARN_IF_UNUSED;
+
+    // write a checkpoint marker for a copy starting at begin_ofs
+    bool write_checkpoint_marker(uint32_t begin_ofs) WARN_IF_UNUSED;
+
+    // start an incremental checkpoint in the current sector
+    void start_checkpoint(void);
+
+    // check value for a checkpoint marker
+    static uint16_t checkpoint_crc(uint32_t begin_ofs, uint32_t marker_ofs);
+
+    // round up a flash offset to where the next block can be written
+    static uint32_t align_block_ofs(uint32_t ofs);
 
     // erase a sector and write header
     bool erase_sector(uint8_t sector, bool mark_available) WARN_IF_UNUSED;
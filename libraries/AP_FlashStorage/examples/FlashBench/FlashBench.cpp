@@ -0,0 +1,204 @@
+//
+// Boot time and write amplification of AP_FlashStorage
+//
+// Runs a parameter save like workload against a RAM flash stand-in,
+// rebooting every so often, and reports how long init() took and how
+// much flash was read, written and erased. The workload is run twice,
+// without and with background checkpoints
+//
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_FlashStorage/AP_FlashStorage.h>
+#include <stdio.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class FlashBench : public AP_HAL::HAL::Callbacks {
+public:
+    // HAL::Callbacks implementation.
+    void setup() override;
+    void loop() override;
+
+private:
+    static const uint32_t flash_sector_size = 128U * 1024U;
+    static const uint32_t num_writes = 200000;
+    static const uint32_t reboot_interval = 5000;
+
+    uint8_t mem_buffer[AP_FlashStorage::storage_size];
+    uint8_t mem_mirror[AP_FlashStorage::storage_size];
+
+    // flash buffer
+    uint8_t *flash[2];
+
+    struct {
+        uint64_t read_bytes;
+        uint64_t write_bytes;
+        uint32_t erases;
+    } counters;
+
+    bool flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
+    bool flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
+    bool flash_erase(uint8_t sector);
+    bool flash_erase_ok(void);
+
+    AP_FlashStorage *storage;
+
+    AP_FlashStorage *create_storage(void);
+    void run(bool checkpoints);
+};
+
+bool FlashBench::flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length)
+{
+    if (sector > 1 || offset + length > flash_sector_size) {
+        AP_HAL::panic("FATAL: write to sector %u at offset %u length %u\n",
+                      (unsigned)sector, (unsigned)offset, (unsigned)length);
+    }
+    uint8_t *b = &flash[sector][offset];
+    for (uint16_t i=0; i<length; i++) {
+        b[i] &= data[i];
+    }
+    counters.write_bytes += length;
+    return true;
+}
+
+bool FlashBench::flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length)
+{
+    if (sector > 1 || offset + length > flash_sector_size) {
+        AP_HAL::panic("FATAL: read from sector %u at offset %u length %u\n",
+                      (unsigned)sector, (unsigned)offset, (unsigned)length);
+    }
+    memcpy(data, &flash[sector][offset], length);
+    counters.read_bytes += length;
+    return true;
+}
+
+bool FlashBench::flash_erase(uint8_t sector)
+{
+    if (sector > 1) {
+        AP_HAL::panic("FATAL: erase sector %u\n", (unsigned)sector);
+    }
+    memset(&flash[sector][0], 0xFF, flash_sector_size);
+    counters.erases++;
+    return true;
+}
+
+bool FlashBench::flash_erase_ok(void)
+{
+    // as if always disarmed
+    return true;
+}
+
+AP_FlashStorage *FlashBench::create_storage(void)
+{
+    return NEW_NOTHROW AP_FlashStorage(mem_buffer,
+                                       flash_sector_size,
+                                       FUNCTOR_BIND_MEMBER(&FlashBench::flash_write, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
+                                       FUNCTOR_BIND_MEMBER(&FlashBench::flash_read, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
+                                       FUNCTOR_BIND_MEMBER(&FlashBench::flash_erase, bool, uint8_t),
+                                       FUNCTOR_BIND_MEMBER(&FlashBench::flash_erase_ok, bool));
+}
+
+void FlashBench::run(bool checkpoints)
+{
+    memset(flash[0], 0xFF, flash_sector_size);
+    memset(flash[1], 0xFF, flash_sector_size);
+    memset(&counters, 0, sizeof(counters));
+
+    storage = create_storage();
+    if (storage == nullptr || !storage->init()) {
+        AP_HAL::panic("Failed first init()");
+    }
+
+    // parameters use the first part of storage. Fill it once, then
+    // change a few values at a time
+    const uint16_t param_size = AP_FlashStorage::storage_size / 2;
+    for (uint16_t ofs=0; ofs<param_size; ofs++) {
+        mem_buffer[ofs] = get_random16();
+    }
+    if (!storage->write(0, param_size)) {
+        AP_HAL::panic("Failed initial write");
+    }
+
+    uint32_t changed_bytes = 0;
+    uint32_t boots = 0;
+    uint64_t boot_us = 0;
+    uint32_t max_boot_us = 0;
+    uint64_t boot_read_bytes = 0;
+    uint64_t boot_write_bytes = 0;
+
+    for (uint32_t i=0; i<num_writes; i++) {
+        // a parameter is 4 bytes plus a 4 byte header
+        const uint16_t ofs = (get_random16() % (param_size/8)) * 8;
+        for (uint8_t j=0; j<8; j++) {
+            mem_buffer[ofs+j] = get_random16();
+        }
+        changed_bytes += 8;
+        if (!storage->write(ofs, 8)) {
+            AP_HAL::panic("Failed write at %u", (unsigned)i);
+        }
+        if (checkpoints) {
+            storage->checkpoint_step();
+        }
+
+        if (i % reboot_interval == reboot_interval-1) {
+            memcpy(mem_mirror, mem_buffer, sizeof(mem_mirror));
+            delete storage;
+            storage = create_storage();
+            memset(mem_buffer, 0, sizeof(mem_buffer));
+
+            const uint64_t read_bytes0 = counters.read_bytes;
+            const uint64_t write_bytes0 = counters.write_bytes;
+            const uint64_t t0 = AP_HAL::micros64();
+            if (storage == nullptr || !storage->init()) {
+                AP_HAL::panic("Failed init()");
+            }
+            const uint32_t dt = AP_HAL::micros64() - t0;
+            boot_us += dt;
+            max_boot_us = MAX(max_boot_us, dt);
+            boot_read_bytes += counters.read_bytes - read_bytes0;
+            boot_write_bytes += counters.write_bytes - write_bytes0;
+            boots++;
+
+            if (memcmp(mem_mirror, mem_buffer, sizeof(mem_buffer)) != 0) {
+                AP_HAL::panic("FATAL: data mis-match after init()");
+            }
+        }
+    }
+
+    hal.console->printf("checkpoints %s:\n", checkpoints ? "on" : "off");
+    hal.console->printf("  boot: mean %.1fus max %uus, %.1f kB read %.1f kB written\n",
+                        double(boot_us) / boots, (unsigned)max_boot_us,
+                        double(boot_read_bytes) / (boots * 1024), double(boot_write_bytes) / (boots * 1024));
+    hal.console->printf("  flash: %.1f kB written, %u erases, write amplification %.1f\n",
+                        double(counters.write_bytes) / 1024, (unsigned)counters.erases,
+                        double(counters.write_bytes) / changed_bytes);
+
+    delete storage;
+    storage = nullptr;
+}
+
+void FlashBench::setup(void)
+{
+    hal.console->printf("AP_FlashStorage benchmark\n");
+}
+
+void FlashBench::loop(void)
+{
+    flash[0] = (uint8_t *)malloc(flash_sector_size);
+    flash[1] = (uint8_t *)malloc(flash_sector_size);
+    if (flash[0] == nullptr || flash[1] == nullptr) {
+        AP_HAL::panic("Out of memory");
+    }
+
+    run(false);
+    run(true);
+
+    while (true) {
+        hal.scheduler->delay(20000);
+    }
+}
+
+FlashBench flashbench;
+
+AP_HAL_MAIN_CALLBACKS(&flashbench);
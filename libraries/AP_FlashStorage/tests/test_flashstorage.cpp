@@ -0,0 +1,189 @@
+#include <AP_gtest.h>
+
+#include <AP_FlashStorage/AP_FlashStorage.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  two flash sectors in memory which, like real flash, only have bits
+  cleared by writes until they are erased
+ */
+class FlashSim {
+public:
+    FlashSim(uint32_t _sector_size=max_sector_size) :
+        sector_size(_sector_size) {
+        memset(flash, 0xFF, sizeof(flash));
+        memset(mem_buffer, 0, sizeof(mem_buffer));
+        memset(mirror, 0, sizeof(mirror));
+    }
+
+    static const uint32_t max_sector_size = 128U * 1024U;
+    const uint32_t sector_size;
+
+    uint8_t flash[2][max_sector_size];
+    uint8_t mem_buffer[AP_FlashStorage::storage_size];
+    uint8_t mirror[AP_FlashStorage::storage_size];
+
+    // flash writes to allow before the power goes, or -1 for no limit
+    int32_t writes_left = -1;
+
+    AP_FlashStorage storage{mem_buffer,
+            sector_size,
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_write, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_read, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_erase, bool, uint8_t),
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_erase_ok, bool)};
+
+    // change storage and the mirror of what it should hold
+    bool write(uint16_t offset, const uint8_t *data, uint16_t length) {
+        memcpy(&mem_buffer[offset], data, length);
+        memcpy(&mirror[offset], data, length);
+        return storage.write(offset, length);
+    }
+
+    // load storage from flash again, as at boot
+    bool reload(void) {
+        memset(mem_buffer, 0, sizeof(mem_buffer));
+        return storage.init();
+    }
+
+private:
+    bool flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length) {
+        if (sector > 1 || offset + length > sector_size) {
+            return false;
+        }
+        if (writes_left == 0) {
+            // the power has gone, nothing reaches the flash
+            return true;
+        }
+        if (writes_left > 0) {
+            writes_left--;
+        }
+        for (uint16_t i=0; i<length; i++) {
+            flash[sector][offset+i] &= data[i];
+        }
+        return true;
+    }
+    bool flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length) {
+        if (sector > 1 || offset + length > sector_size) {
+            return false;
+        }
+        memcpy(data, &flash[sector][offset], length);
+        return true;
+    }
+    bool flash_erase(uint8_t sector) {
+        if (sector > 1) {
+            return false;
+        }
+        memset(flash[sector], 0xFF, sector_size);
+        return true;
+    }
+    bool flash_erase_ok(void) {
+        return true;
+    }
+};
+
+/*
+  random writes, enough to fill several sectors, checkpointing in the
+  gaps between them as the storage timer does
+ */
+static void checkpoint_round_trip(uint32_t sector_size)
+{
+    FlashSim *f = new FlashSim(sector_size);
+    ASSERT_TRUE(f->storage.init());
+
+    for (uint16_t i=0; i<20000; i++) {
+        uint8_t data[32];
+        const uint16_t length = 1 + get_random16() % sizeof(data);
+        const uint16_t ofs = get_random16() % (AP_FlashStorage::storage_size - length);
+        for (uint8_t j=0; j<length; j++) {
+            data[j] = get_random16();
+        }
+        ASSERT_TRUE(f->write(ofs, data, length));
+        f->storage.checkpoint_step();
+    }
+    while (f->storage.checkpoint_step()) {
+    }
+
+    ASSERT_TRUE(f->reload());
+    EXPECT_EQ(memcmp(f->mem_buffer, f->mirror, sizeof(f->mirror)), 0);
+    delete f;
+}
+
+TEST(AP_FlashStorage, checkpoint_round_trip)
+{
+    checkpoint_round_trip(FlashSim::max_sector_size);
+}
+
+// sectors without room for a checkpoint as well as the space
+// reserved for a full write out
+TEST(AP_FlashStorage, small_sector_round_trip)
+{
+    checkpoint_round_trip(32U * 1024U);
+}
+
+#if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_F4 && HAL_STORAGE_SIZE == 16384
+/*
+  with 16k of storage in 8 byte blocks the last data block is block
+  2047, the block number checkpoint markers use. Lose power while
+  writing it, with data that makes a good marker for an offset part
+  way through the log, and check that it is skipped rather than taken
+  for a marker
+ */
+static uint32_t log_end(const uint8_t *sector)
+{
+    // a 4 byte sector header, then 2 byte block headers
+    uint32_t ofs = 4;
+    while (ofs + 2 < FlashSim::max_sector_size) {
+        const uint16_t header = sector[ofs] | (sector[ofs+1] << 8);
+        if (header == 0xFFFF) {
+            break;
+        }
+        ofs += 2 + ((header >> 13) + 1) * 8;
+    }
+    return ofs;
+}
+
+TEST(AP_FlashStorage, torn_last_block_is_not_a_marker)
+{
+    FlashSim *f = new FlashSim;
+    ASSERT_TRUE(f->storage.init());
+
+    uint8_t data[64];
+    memset(data, 0x11, sizeof(data));
+    ASSERT_TRUE(f->write(0, data, sizeof(data)));
+    memset(data, 0x22, 8);
+    ASSERT_TRUE(f->write(100, data, 8));
+
+    const uint8_t sector = log_end(f->flash[0]) > log_end(f->flash[1]) ? 0 : 1;
+    const uint32_t end_ofs = log_end(f->flash[sector]);
+
+    // a marker claiming the copy of storage began with the second
+    // write, which would lose the first if believed
+    const uint32_t begin_ofs = end_ofs - (2 + 8);
+    const uint32_t v[3] { 0x51685B, begin_ofs, end_ofs };
+    const uint16_t crc = crc16_ccitt((const uint8_t *)v, sizeof(v), 0xFFFF);
+    memset(data, 0xFF, 8);
+    memcpy(&data[0], &begin_ofs, sizeof(begin_ofs));
+    memcpy(&data[4], &crc, sizeof(crc));
+
+    // the header and data reach the flash, the header is never
+    // marked valid
+    f->writes_left = 2;
+    ASSERT_TRUE(f->write(AP_FlashStorage::storage_size-8, data, 8));
+    f->writes_left = -1;
+    memset(&f->mirror[AP_FlashStorage::storage_size-8], 0, 8);
+
+    // block 2047, one block, still in the writing state
+    const uint16_t header = f->flash[sector][end_ofs] | (f->flash[sector][end_ofs+1] << 8);
+    EXPECT_EQ(header, (2047U << 2) | 0x1U);
+
+    ASSERT_TRUE(f->reload());
+    EXPECT_EQ(memcmp(f->mem_buffer, f->mirror, sizeof(f->mirror)), 0);
+    delete f;
+}
+#endif
+
+AP_GTEST_MAIN()
@@ -59,7 +59,23 @@ AP_GPS_NOVA::AP_GPS_NOVA(AP_GPS &_gps,
         port->write((const uint8_t*)init_str, strlen(init_str));
         port->write((const uint8_t*)init_str1, strlen(init_str1));
     }
+
+#if AP_GPS_FRAMER_ENABLED
+    const uint16_t max_frame = sizeof(nova_msg.header) + sizeof(nova_msg.data) + 4;
+    framer = NEW_NOTHROW AP_GPS_Framer(nova_format, max_frame);
+    if (framer != nullptr && !framer->init(max_frame + 512)) {
+        delete framer;
+        framer = nullptr;
+    }
+#endif
+}
+
+#if AP_GPS_FRAMER_ENABLED
+AP_GPS_NOVA::~AP_GPS_NOVA()
+{
+    delete framer;
 }
+#endif
 
 const char* const AP_GPS_NOVA::_initialisation_blob[4] {
     "\r\n\r\nunlogall\r\n", // cleanup enviroment
@@ -87,6 +103,12 @@ AP_GPS_NOVA::read(void)
         }
     }
 
+#if AP_GPS_FRAMER_ENABLED
+    if (framer != nullptr) {
+        return read_frames();
+    }
+#endif
+
     bool ret = false;
     for (uint16_t i=0; i<8192; i++) {
         uint8_t temp;
@@ -102,6 +124,64 @@ AP_GPS_NOVA::read(void)
     return ret;
 }
 
+#if AP_GPS_FRAMER_ENABLED
+const AP_GPS_Framer::Format AP_GPS_NOVA::nova_format {
+    NOVA_PREAMBLE1,
+    NOVA_PREAMBLE2,
+    10,
+    AP_GPS_NOVA::frame_length,
+    AP_GPS_NOVA::frame_check,
+};
+
+// header, message and 32 bit CRC, or zero if the header is not one we
+// can hold
+uint16_t AP_GPS_NOVA::frame_length(const uint8_t *header)
+{
+    const uint8_t headerlength = header[3];
+    const uint16_t messagelength = header[8] | (header[9] << 8);
+    if (header[2] != NOVA_PREAMBLE3 ||
+        headerlength < 10 ||
+        headerlength > sizeof(msgheader) ||
+        messagelength > sizeof(msgbuffer)) {
+        return 0;
+    }
+    return headerlength + messagelength + 4;
+}
+
+bool AP_GPS_NOVA::frame_check(const uint8_t *frame, uint16_t len)
+{
+    const uint8_t *p = &frame[len-4];
+    const uint32_t crc = p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+    return crc_crc32(0, frame, len-4) == crc;
+}
+
+bool
+AP_GPS_NOVA::read_frames(void)
+{
+    bool ret = false;
+    for (uint16_t total = 0; total < 8192; ) {
+        const uint16_t n = framer->fill(*port, 8192 - total);
+        if (n == 0) {
+            break;
+        }
+        total += n;
+#if AP_GPS_DEBUG_LOGGING_ENABLED
+        log_data(framer->last_read(n), n);
+#endif
+        const uint8_t *frame;
+        uint16_t len;
+        while (framer->next_frame(frame, len)) {
+            const uint8_t headerlength = frame[3];
+            memcpy(nova_msg.header.data, frame, headerlength);
+            memcpy(nova_msg.data.bytes, &frame[headerlength], len - headerlength - 4);
+            ret |= process_message();
+        }
+    }
+    crc_error_counter = framer->get_stats().bad_frames;
+    return ret;
+}
+#endif // AP_GPS_FRAMER_ENABLED
+
 bool
 AP_GPS_NOVA::parse(uint8_t temp)
 {
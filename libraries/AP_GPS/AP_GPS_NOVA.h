@@ -21,12 +21,16 @@
 
 #include "AP_GPS.h"
 #include "GPS_Backend.h"
+#include "GPS_Framer.h"
 
 #if AP_GPS_NOVA_ENABLED
 class AP_GPS_NOVA : public AP_GPS_Backend
 {
 public:
     AP_GPS_NOVA(AP_GPS &_gps, AP_GPS::Params &_params, AP_GPS::GPS_State &_state, AP_HAL::UARTDriver *_port);
+#if AP_GPS_FRAMER_ENABLED
+    ~AP_GPS_NOVA() override;
+#endif
 
     AP_GPS::GPS_Status highest_supported_status(void) override { return AP_GPS::GPS_OK_FIX_3D_RTK_FIXED; }
 
@@ -40,6 +44,15 @@ private:
     bool parse(uint8_t temp);
     bool process_message();
 
+#if AP_GPS_FRAMER_ENABLED
+    bool read_frames();
+    static uint16_t frame_length(const uint8_t *header);
+    static bool frame_check(const uint8_t *frame, uint16_t len);
+    static const AP_GPS_Framer::Format nova_format;
+
+    AP_GPS_Framer *framer;
+#endif
+
     static const uint8_t NOVA_PREAMBLE1 = 0xaa;
     static const uint8_t NOVA_PREAMBLE2 = 0x44;
     static const uint8_t NOVA_PREAMBLE3 = 0x12;
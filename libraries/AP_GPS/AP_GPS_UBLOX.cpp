@@ -131,6 +131,22 @@ AP_GPS_UBLOX::AP_GPS_UBLOX(AP_GPS &_gps,
         state.gps_yaw_configured = true;
     }
 #endif
+
+#if AP_GPS_FRAMER_ENABLED
+    // RTCMv3 from a moving baseline base shares the uart with UBX and
+    // has to go through the byte parser
+    bool use_framer = true;
+#if GPS_MOVING_BASELINE
+    use_framer = (rtcm3_parser == nullptr);
+#endif
+    if (use_framer) {
+        _framer = NEW_NOTHROW AP_GPS_Framer(_ubx_format, sizeof(_buffer) + 8);
+        if (_framer != nullptr && !_framer->init(sizeof(_buffer) + 8 + 512)) {
+            delete _framer;
+            _framer = nullptr;
+        }
+    }
+#endif
 }
 
 AP_GPS_UBLOX::~AP_GPS_UBLOX()
@@ -138,6 +154,9 @@ AP_GPS_UBLOX::~AP_GPS_UBLOX()
 #if GPS_MOVING_BASELINE
     delete rtcm3_parser;
 #endif
+#if AP_GPS_FRAMER_ENABLED
+    delete _framer;
+#endif
 }
 
 #if GPS_MOVING_BASELINE
@@ -653,7 +672,6 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
-    bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
     // walk through the gps configuration at 1 message per second
@@ -681,6 +699,72 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
+#if AP_GPS_FRAMER_ENABLED
+    if (_framer != nullptr) {
+        return _read_frames();
+    }
+#endif
+    return _read_bytes();
+}
+
+#if AP_GPS_FRAMER_ENABLED
+const AP_GPS_Framer::Format AP_GPS_UBLOX::_ubx_format {
+    PREAMBLE1,
+    PREAMBLE2,
+    6,
+    AP_GPS_UBLOX::_frame_length,
+    AP_GPS_UBLOX::_frame_check,
+};
+
+// preamble, class, id and length, then payload and two checksum bytes
+uint16_t AP_GPS_UBLOX::_frame_length(const uint8_t *header)
+{
+    return 8 + (header[4] | (header[5] << 8));
+}
+
+// Fletcher checksum over class, id, length and payload
+bool AP_GPS_UBLOX::_frame_check(const uint8_t *frame, uint16_t len)
+{
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < len - 2; i++) {
+        ck_b += (ck_a += frame[i]);
+    }
+    return ck_a == frame[len-2] && ck_b == frame[len-1];
+}
+
+// Process the bytes available from the stream a frame at a time
+bool AP_GPS_UBLOX::_read_frames(void)
+{
+    bool parsed = false;
+    for (uint16_t total = 0; total < 8192; ) {
+        const uint16_t n = _framer->fill(*port, 8192 - total);
+        if (n == 0) {
+            break;
+        }
+        total += n;
+#if AP_GPS_DEBUG_LOGGING_ENABLED
+        log_data(_framer->last_read(n), n);
+#endif
+        const uint8_t *frame;
+        uint16_t len;
+        while (_framer->next_frame(frame, len)) {
+            _class = frame[2];
+            _msg_id = frame[3];
+            _payload_length = len - 8;
+            memcpy(&_buffer, &frame[6], _payload_length);
+            if (_parse_gps()) {
+                parsed = true;
+            }
+        }
+    }
+    return parsed;
+}
+#endif // AP_GPS_FRAMER_ENABLED
+
+// Process bytes available from the stream one at a time
+bool AP_GPS_UBLOX::_read_bytes(void)
+{
+    bool parsed = false;
     const uint16_t numc = MIN(port->available(), 8192U);
     for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
 
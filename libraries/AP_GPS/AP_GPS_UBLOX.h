@@ -26,6 +26,7 @@
 
 #include "AP_GPS.h"
 #include "GPS_Backend.h"
+#include "GPS_Framer.h"
 
 #include <AP_HAL/AP_HAL.h>
 
@@ -802,6 +803,16 @@ private:
 
     // Buffer parse & GPS state update
     bool        _parse_gps();
+    bool        _read_bytes(void);
+#if AP_GPS_FRAMER_ENABLED
+    bool        _read_frames(void);
+    static uint16_t _frame_length(const uint8_t *header);
+    static bool _frame_check(const uint8_t *frame, uint16_t len);
+    static const AP_GPS_Framer::Format _ubx_format;
+
+    // whole frame parsing, used unless RTCMv3 is interleaved with UBX
+    AP_GPS_Framer *_framer;
+#endif
 
     // used to update fix between status and position packets
     AP_GPS::GPS_Status next_fix;
@@ -92,6 +92,11 @@
   #define AP_GPS_UBLOX_ENABLED AP_GPS_BACKEND_DEFAULT_ENABLED
 #endif
 
+// buffered framing for the binary protocol drivers
+#ifndef AP_GPS_FRAMER_ENABLED
+  #define AP_GPS_FRAMER_ENABLED (AP_GPS_UBLOX_ENABLED || AP_GPS_NOVA_ENABLED) && BOARD_FLASH_SIZE > 1024
+#endif
+
 #ifndef AP_GPS_RTCM_DECODE_ENABLED
   #define AP_GPS_RTCM_DECODE_ENABLED BOARD_FLASH_SIZE > 1024
 #endif
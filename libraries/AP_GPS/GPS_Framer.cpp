@@ -0,0 +1,142 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  framing layer for binary GPS protocols
+*/
+
+#include "GPS_Framer.h"
+
+#if AP_GPS_FRAMER_ENABLED
+
+#include <string.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+AP_GPS_Framer::AP_GPS_Framer(const Format &_format, uint16_t _max_frame_len) :
+    format(_format),
+    max_frame_len(_max_frame_len)
+{
+}
+
+AP_GPS_Framer::~AP_GPS_Framer()
+{
+    delete[] buf;
+}
+
+bool AP_GPS_Framer::init(uint16_t buffer_size)
+{
+    if (buf != nullptr) {
+        return true;
+    }
+    buffer_size = MAX(buffer_size, max_frame_len);
+    buf = NEW_NOTHROW uint8_t[buffer_size];
+    if (buf == nullptr) {
+        return false;
+    }
+    size = buffer_size;
+    return true;
+}
+
+uint16_t AP_GPS_Framer::compact(void)
+{
+    if (head == tail) {
+        head = tail = 0;
+    } else if (head > 0) {
+        memmove(buf, &buf[head], tail - head);
+        tail -= head;
+        head = 0;
+    }
+    return size - tail;
+}
+
+uint16_t AP_GPS_Framer::fill(AP_HAL::UARTDriver &port, uint16_t max_bytes)
+{
+    if (buf == nullptr) {
+        return 0;
+    }
+    const uint16_t space = MIN(compact(), max_bytes);
+    if (space == 0) {
+        return 0;
+    }
+    const ssize_t n = port.read(&buf[tail], space);
+    if (n <= 0) {
+        return 0;
+    }
+    tail += n;
+    return n;
+}
+
+uint16_t AP_GPS_Framer::feed(const uint8_t *bytes, uint16_t len)
+{
+    if (buf == nullptr) {
+        return 0;
+    }
+    len = MIN(compact(), len);
+    memcpy(&buf[tail], bytes, len);
+    tail += len;
+    return len;
+}
+
+bool AP_GPS_Framer::next_frame(const uint8_t *&frame, uint16_t &len)
+{
+    while (tail - head >= 2) {
+        const uint8_t *sync = (const uint8_t *)memchr(&buf[head], format.sync1, tail - head);
+        if (sync == nullptr) {
+            stats.skipped += tail - head;
+            head = tail;
+            return false;
+        }
+        const uint16_t ofs = sync - buf;
+        stats.skipped += ofs - head;
+        head = ofs;
+
+        const uint16_t avail = tail - head;
+        if (avail < 2) {
+            return false;
+        }
+        if (buf[head+1] != format.sync2) {
+            head++;
+            stats.skipped++;
+            continue;
+        }
+        if (avail < format.header_len) {
+            return false;
+        }
+        const uint16_t frame_len = format.frame_length(&buf[head]);
+        if (frame_len < format.header_len || frame_len > max_frame_len || frame_len > size) {
+            // not a frame we can hold, look for sync again from the
+            // next byte
+            head++;
+            stats.skipped++;
+            continue;
+        }
+        if (avail < frame_len) {
+            return false;
+        }
+        if (!format.check(&buf[head], frame_len)) {
+            head++;
+            stats.bad_frames++;
+            continue;
+        }
+        frame = &buf[head];
+        len = frame_len;
+        head += frame_len;
+        stats.frames++;
+        return true;
+    }
+    return false;
+}
+
+#endif  // AP_GPS_FRAMER_ENABLED
@@ -0,0 +1,106 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  framing layer for binary GPS protocols
+
+  Bytes are read from the uart in bursts into a linear buffer, and
+  frames are found by searching for the two sync bytes with memchr(),
+  asking the protocol for the frame length from its header and then
+  checking the checksum over the whole frame in one go. Complete frames
+  are handed to the driver as a view into the buffer, so nothing is
+  copied a byte at a time. Protocol structures are PACKED so the view
+  needs no particular alignment.
+*/
+#pragma once
+
+#include "AP_GPS_config.h"
+
+#if AP_GPS_FRAMER_ENABLED
+
+#include <stdint.h>
+#include <AP_Common/AP_Common.h>
+
+namespace AP_HAL {
+    class UARTDriver;
+}
+
+class AP_GPS_Framer {
+public:
+    struct Format {
+        // first two bytes of every frame
+        uint8_t sync1;
+        uint8_t sync2;
+        // number of bytes frame_length() looks at
+        uint8_t header_len;
+        // total length of the frame starting at header, or zero if
+        // the header is not valid
+        uint16_t (*frame_length)(const uint8_t *header);
+        // true if a complete frame passes its checksum
+        bool (*check)(const uint8_t *frame, uint16_t len);
+    };
+
+    // frames longer than max_frame_len are treated as noise
+    AP_GPS_Framer(const Format &_format, uint16_t _max_frame_len);
+    ~AP_GPS_Framer();
+
+    CLASS_NO_COPY(AP_GPS_Framer);
+
+    // allocate the buffer, which must be at least max_frame_len
+    bool init(uint16_t buffer_size);
+
+    // read up to max_bytes from the uart, returning the number read
+    uint16_t fill(AP_HAL::UARTDriver &port, uint16_t max_bytes);
+
+    // add bytes from memory, returning the number taken
+    uint16_t feed(const uint8_t *bytes, uint16_t len);
+
+    /*
+      find the next complete frame with a good checksum. The view is
+      valid until the next call to fill(), feed() or reset()
+     */
+    bool next_frame(const uint8_t *&frame, uint16_t &len);
+
+    // the last n bytes added by fill() or feed()
+    const uint8_t *last_read(uint16_t n) const { return &buf[tail - n]; }
+
+    // discard all buffered bytes
+    void reset(void) { head = tail = 0; }
+
+    // bytes that are not part of a frame returned so far
+    uint16_t pending(void) const { return tail - head; }
+
+    struct Stats {
+        uint32_t frames;
+        uint32_t bad_frames;    // sync and header matched, checksum failed
+        uint32_t skipped;       // bytes dropped looking for sync
+    };
+    const Stats &get_stats(void) const { return stats; }
+
+private:
+    const Format &format;
+    const uint16_t max_frame_len;
+
+    uint8_t *buf = nullptr;
+    uint16_t size = 0;
+    uint16_t head = 0;      // start of unparsed data
+    uint16_t tail = 0;      // end of data
+
+    Stats stats {};
+
+    // move unparsed data to the start of the buffer, returning free space
+    uint16_t compact(void);
+};
+
+#endif  // AP_GPS_FRAMER_ENABLED
@@ -0,0 +1,195 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_GPS/GPS_Framer.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_GPS_FRAMER_ENABLED
+
+/*
+  compare the u-blox byte at a time state machine with the framer on
+  a stream shaped like a 10Hz RTK receiver: NAV-PVT, NAV-DOP,
+  NAV-RELPOSNED and a large RXM-RAWX per epoch
+ */
+static uint8_t stream[8192];
+static uint16_t stream_len;
+
+static uint16_t make_ubx(uint8_t *out, uint8_t msg_class, uint8_t msg_id, uint16_t payload_len)
+{
+    out[0] = 0xB5;
+    out[1] = 0x62;
+    out[2] = msg_class;
+    out[3] = msg_id;
+    out[4] = payload_len & 0xFF;
+    out[5] = payload_len >> 8;
+    for (uint16_t i = 0; i < payload_len; i++) {
+        out[6+i] = uint8_t(i * 13);
+    }
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < 6 + payload_len; i++) {
+        ck_b += (ck_a += out[i]);
+    }
+    out[6+payload_len] = ck_a;
+    out[7+payload_len] = ck_b;
+    return 8 + payload_len;
+}
+
+static void make_stream()
+{
+    if (stream_len != 0) {
+        return;
+    }
+    while (stream_len + 2000U < sizeof(stream)) {
+        stream_len += make_ubx(&stream[stream_len], 0x01, 0x07, 92);
+        stream_len += make_ubx(&stream[stream_len], 0x01, 0x04, 18);
+        stream_len += make_ubx(&stream[stream_len], 0x01, 0x3C, 64);
+        stream_len += make_ubx(&stream[stream_len], 0x02, 0x15, 16 + 32*30);
+    }
+}
+
+static uint16_t ubx_length(const uint8_t *header)
+{
+    return 8 + (header[4] | (header[5] << 8));
+}
+
+static bool ubx_check(const uint8_t *frame, uint16_t len)
+{
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < len - 2; i++) {
+        ck_b += (ck_a += frame[i]);
+    }
+    return ck_a == frame[len-2] && ck_b == frame[len-1];
+}
+
+static const AP_GPS_Framer::Format ubx_format { 0xB5, 0x62, 6, ubx_length, ubx_check };
+
+// the state machine from AP_GPS_UBLOX::_read_bytes()
+struct ByteParser {
+    uint8_t step;
+    uint8_t ck_a, ck_b;
+    uint16_t payload_length, payload_counter;
+    uint8_t buffer[1100];
+    uint32_t frames;
+
+    void parse(uint8_t data) {
+        switch (step) {
+        case 1:
+            if (data == 0x62) {
+                step++;
+                break;
+            }
+            step = 0;
+            FALLTHROUGH;
+        case 0:
+            if (data == 0xB5) {
+                step++;
+            }
+            break;
+        case 2:
+            step++;
+            ck_b = ck_a = data;
+            break;
+        case 3:
+            step++;
+            ck_b += (ck_a += data);
+            break;
+        case 4:
+            step++;
+            ck_b += (ck_a += data);
+            payload_length = data;
+            break;
+        case 5:
+            step++;
+            ck_b += (ck_a += data);
+            payload_length += uint16_t(data << 8);
+            if (payload_length > sizeof(buffer)) {
+                step = 0;
+                break;
+            }
+            payload_counter = 0;
+            if (payload_length == 0) {
+                step++;
+            }
+            break;
+        case 6:
+            ck_b += (ck_a += data);
+            buffer[payload_counter] = data;
+            if (++payload_counter == payload_length) {
+                step++;
+            }
+            break;
+        case 7:
+            step++;
+            if (ck_a != data) {
+                step = 0;
+            }
+            break;
+        case 8:
+            step = 0;
+            if (ck_b == data) {
+                frames++;
+            }
+            break;
+        }
+    }
+};
+
+static void BM_UBX_ByteParser(benchmark::State& state)
+{
+    make_stream();
+    ByteParser parser {};
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < stream_len; i++) {
+            parser.parse(stream[i]);
+        }
+        gbenchmark_escape(&parser);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream_len);
+}
+
+BENCHMARK(BM_UBX_ByteParser);
+
+static void BM_UBX_Framer(benchmark::State& state)
+{
+    make_stream();
+    AP_GPS_Framer framer(ubx_format, 1100);
+    framer.init(state.range(0));
+    uint8_t buffer[1100];
+    uint32_t frames = 0;
+    while (state.KeepRunning()) {
+        for (uint16_t ofs = 0; ofs < stream_len; ) {
+            ofs += framer.feed(&stream[ofs], stream_len - ofs);
+            const uint8_t *frame;
+            uint16_t len;
+            while (framer.next_frame(frame, len)) {
+                // the driver still copies the payload into its union
+                memcpy(buffer, &frame[6], len - 8);
+                frames++;
+            }
+        }
+        gbenchmark_escape(buffer);
+        gbenchmark_escape(&frames);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream_len);
+}
+
+BENCHMARK(BM_UBX_Framer)->Arg(1100+512)->Arg(8192);
+
+#endif  // AP_GPS_FRAMER_ENABLED
+
+BENCHMARK_MAIN();
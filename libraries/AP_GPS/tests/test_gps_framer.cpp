@@ -0,0 +1,208 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_GPS/GPS_Framer.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if AP_GPS_FRAMER_ENABLED
+
+/*
+  UBX and NovAtel framing as used by the drivers, with frames built the
+  way SIM_GPS_UBLOX and SIM_GPS_NOVA send them
+ */
+static uint16_t ubx_length(const uint8_t *header)
+{
+    return 8 + (header[4] | (header[5] << 8));
+}
+
+static bool ubx_check(const uint8_t *frame, uint16_t len)
+{
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < len - 2; i++) {
+        ck_b += (ck_a += frame[i]);
+    }
+    return ck_a == frame[len-2] && ck_b == frame[len-1];
+}
+
+static const AP_GPS_Framer::Format ubx_format { 0xB5, 0x62, 6, ubx_length, ubx_check };
+
+static uint16_t nova_length(const uint8_t *header)
+{
+    if (header[2] != 0x12) {
+        return 0;
+    }
+    return header[3] + (header[8] | (header[9] << 8)) + 4;
+}
+
+static bool nova_check(const uint8_t *frame, uint16_t len)
+{
+    uint32_t crc;
+    memcpy(&crc, &frame[len-4], 4);
+    return crc_crc32(0, frame, len-4) == crc;
+}
+
+static const AP_GPS_Framer::Format nova_format { 0xAA, 0x44, 10, nova_length, nova_check };
+
+static uint16_t make_ubx(uint8_t *out, uint8_t msg_class, uint8_t msg_id, uint16_t payload_len, uint8_t fill)
+{
+    out[0] = 0xB5;
+    out[1] = 0x62;
+    out[2] = msg_class;
+    out[3] = msg_id;
+    out[4] = payload_len & 0xFF;
+    out[5] = payload_len >> 8;
+    for (uint16_t i = 0; i < payload_len; i++) {
+        // include sync bytes in the payload to check we don't resync on them
+        out[6+i] = (i % 5 == 0) ? 0xB5 : uint8_t(fill + i);
+    }
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < 6 + payload_len; i++) {
+        ck_b += (ck_a += out[i]);
+    }
+    out[6+payload_len] = ck_a;
+    out[7+payload_len] = ck_b;
+    return 8 + payload_len;
+}
+
+static uint16_t make_nova(uint8_t *out, uint16_t msgid, uint16_t msglen)
+{
+    const uint8_t headerlength = 28;
+    memset(out, 0, headerlength);
+    out[0] = 0xAA;
+    out[1] = 0x44;
+    out[2] = 0x12;
+    out[3] = headerlength;
+    out[4] = msgid & 0xFF;
+    out[5] = msgid >> 8;
+    out[8] = msglen & 0xFF;
+    out[9] = msglen >> 8;
+    for (uint16_t i = 0; i < msglen; i++) {
+        out[headerlength+i] = uint8_t(i * 7);
+    }
+    const uint32_t crc = crc_crc32(0, out, headerlength + msglen);
+    memcpy(&out[headerlength + msglen], &crc, 4);
+    return headerlength + msglen + 4;
+}
+
+// feed the stream in bursts of the given size, collecting frame lengths
+static uint16_t feed_all(AP_GPS_Framer &framer, const uint8_t *stream, uint16_t len, uint16_t burst,
+                         uint16_t *lengths, uint16_t max_frames)
+{
+    uint16_t count = 0;
+    uint16_t ofs = 0;
+    while (ofs < len) {
+        ofs += framer.feed(&stream[ofs], MIN(burst, uint16_t(len - ofs)));
+        const uint8_t *frame;
+        uint16_t frame_len;
+        while (framer.next_frame(frame, frame_len)) {
+            if (count < max_frames) {
+                lengths[count] = frame_len;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+TEST(AP_GPS_Framer, ubx_bursts)
+{
+    uint8_t stream[2048];
+    uint16_t len = 0;
+    const uint16_t payloads[] { 92, 0, 40, 300, 16 };
+    for (const auto p : payloads) {
+        len += make_ubx(&stream[len], 0x01, 0x07, p, len);
+        // noise between frames, including a lone preamble byte
+        stream[len++] = 0x00;
+        stream[len++] = 0xB5;
+        stream[len++] = 0x13;
+    }
+
+    const uint16_t bursts[] { 1, 7, 64, 2048 };
+    for (const auto burst : bursts) {
+        AP_GPS_Framer framer(ubx_format, 1024);
+        ASSERT_TRUE(framer.init(1024));
+        uint16_t lengths[8];
+        EXPECT_EQ(5, feed_all(framer, stream, len, burst, lengths, ARRAY_SIZE(lengths)));
+        for (uint8_t i = 0; i < ARRAY_SIZE(payloads); i++) {
+            EXPECT_EQ(payloads[i] + 8, lengths[i]);
+        }
+        EXPECT_EQ(5U, framer.get_stats().frames);
+        EXPECT_EQ(0U, framer.get_stats().bad_frames);
+    }
+}
+
+TEST(AP_GPS_Framer, ubx_bad_checksum)
+{
+    uint8_t stream[512];
+    uint16_t len = make_ubx(stream, 0x01, 0x07, 92, 1);
+    const uint16_t bad_ofs = len;
+    len += make_ubx(&stream[len], 0x01, 0x35, 60, 2);
+    stream[bad_ofs + 20] ^= 0x10;
+    len += make_ubx(&stream[len], 0x01, 0x07, 92, 3);
+
+    AP_GPS_Framer framer(ubx_format, 256);
+    ASSERT_TRUE(framer.init(256));
+    uint16_t lengths[4];
+    EXPECT_EQ(2, feed_all(framer, stream, len, 32, lengths, ARRAY_SIZE(lengths)));
+    EXPECT_EQ(100, lengths[0]);
+    EXPECT_EQ(100, lengths[1]);
+    EXPECT_EQ(1U, framer.get_stats().bad_frames);
+}
+
+TEST(AP_GPS_Framer, ubx_oversize)
+{
+    // a header claiming a frame larger than the driver can hold must
+    // not stall the framer waiting for bytes
+    uint8_t stream[256] { 0xB5, 0x62, 0x01, 0x07, 0xFF, 0x7F };
+    uint16_t len = 6;
+    len += make_ubx(&stream[len], 0x01, 0x07, 92, 4);
+
+    AP_GPS_Framer framer(ubx_format, 128);
+    ASSERT_TRUE(framer.init(128));
+    uint16_t lengths[2];
+    EXPECT_EQ(1, feed_all(framer, stream, len, len, lengths, ARRAY_SIZE(lengths)));
+    EXPECT_EQ(100, lengths[0]);
+    EXPECT_EQ(6U, framer.get_stats().skipped);
+}
+
+TEST(AP_GPS_Framer, nova)
+{
+    uint8_t stream[1024];
+    uint16_t len = 0;
+    len += make_nova(&stream[len], 42, 72);
+    stream[len++] = 0xAA;
+    len += make_nova(&stream[len], 99, 44);
+    const uint16_t bad_ofs = len;
+    len += make_nova(&stream[len], 174, 56);
+    stream[bad_ofs + 40] ^= 1;
+    len += make_nova(&stream[len], 42, 72);
+
+    AP_GPS_Framer framer(nova_format, 288);
+    ASSERT_TRUE(framer.init(512));
+    uint16_t lengths[4];
+    EXPECT_EQ(3, feed_all(framer, stream, len, 50, lengths, ARRAY_SIZE(lengths)));
+    EXPECT_EQ(28 + 72 + 4, lengths[0]);
+    EXPECT_EQ(28 + 44 + 4, lengths[1]);
+    EXPECT_EQ(28 + 72 + 4, lengths[2]);
+    EXPECT_EQ(1U, framer.get_stats().bad_frames);
+}
+
+#endif  // AP_GPS_FRAMER_ENABLED
+
+AP_GTEST_MAIN()
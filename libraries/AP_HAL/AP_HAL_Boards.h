@@ -290,6 +290,16 @@
 #define HAL_WITH_MCU_MONITORING 0
 #endif
 
+// attribute heap usage to subsystems, threads and call sites, set by
+// waf --enable-heap-accounting. See AP_Common/AP_HeapAccounting.h
+#ifndef AP_HEAP_ACCOUNTING_ENABLED
+#define AP_HEAP_ACCOUNTING_ENABLED 0
+#endif
+
+#if AP_HEAP_ACCOUNTING_ENABLED && CONFIG_HAL_BOARD != HAL_BOARD_SITL && CONFIG_HAL_BOARD != HAL_BOARD_LINUX
+#error "AP_HEAP_ACCOUNTING_ENABLED is only supported on SITL and Linux"
+#endif
+
 #ifndef AP_CRASHDUMP_ENABLED
 #define AP_CRASHDUMP_ENABLED 0
 #endif
@@ -191,6 +191,12 @@ bool AP_HAL::Device::read_registers(uint8_t first_reg, uint8_t *recv, uint32_t r
     return result;
 }
 
+bool AP_HAL::Device::queue_read_registers(uint8_t first_reg, uint8_t *recv, uint32_t recv_len)
+{
+    first_reg |= _read_flag;
+    return queue_transfer(&first_reg, 1, recv, recv_len);
+}
+
 bool AP_HAL::Device::transfer_bank(uint8_t bank, const uint8_t *send, uint32_t send_len,
                         uint8_t *recv, uint32_t recv_len)
 {
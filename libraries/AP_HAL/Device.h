@@ -118,6 +118,29 @@ public:
     virtual bool transfer(const uint8_t *send, uint32_t send_len,
                           uint8_t *recv, uint32_t recv_len) = 0;
 
+    /*
+     * Queue a transfer to be done on the next call to #transfer_queued(),
+     * for buses which can do several transfers with less overhead than
+     * one at a time. Each transfer is still a separate bus transaction.
+     * The send data is copied, but recv must stay valid until
+     * #transfer_queued() returns. Buses without a queue do the transfer
+     * straight away.
+     *
+     * Return: false if the transfer has already failed.
+     */
+    virtual bool queue_transfer(const uint8_t *send, uint32_t send_len,
+                                uint8_t *recv, uint32_t recv_len) {
+        return transfer(send, send_len, recv, recv_len);
+    }
+
+    /*
+     * Do all transfers queued by #queue_transfer(). The queue is empty
+     * afterwards whatever the result.
+     *
+     * Return: true if all the queued transfers succeeded.
+     */
+    virtual bool transfer_queued() { return true; }
+
 
     /*
      * Sets the required flags before transaction starts
@@ -143,6 +166,15 @@ public:
      */
     bool read_registers(uint8_t first_reg, uint8_t *recv, uint32_t recv_len);
 
+    /**
+     * Like #read_registers(), but through #queue_transfer(), so recv is
+     * only filled in once #transfer_queued() returns. The register read
+     * callback is not called for queued reads.
+     *
+     * Return: false if the transfer has already failed.
+     */
+    bool queue_read_registers(uint8_t first_reg, uint8_t *recv, uint32_t recv_len);
+
     /**
      * Wrapper function over #transfer() to write a byte to the register reg.
      * The transfer is done by sending reg and val in that order.
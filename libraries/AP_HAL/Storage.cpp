@@ -1,6 +1,7 @@
 #include "AP_HAL.h"
 #include "Storage.h"
 #include <AP_Math/AP_Math.h>
+#include <AP_Common/ExpandingString.h>
 
 /*
   default erase method
@@ -15,3 +16,19 @@ bool AP_HAL::Storage::erase(void)
     }
     return true;
 }
+
+/*
+  report write counters. Write amplification is the bytes written to
+  the device for each byte of data that changed
+ */
+void AP_HAL::Storage::storage_info(ExpandingString &str)
+{
+    str.printf("write_block: %u calls %u bytes %u changed\n",
+               unsigned(_stats.write_calls), unsigned(_stats.write_bytes), unsigned(_stats.changed_bytes));
+    str.printf("device: %u writes %u bytes %u erases\n",
+               unsigned(_stats.backend_writes), unsigned(_stats.backend_bytes), unsigned(_stats.erases));
+    if (_stats.changed_bytes > 0) {
+        str.printf("amplification: %.2f\n", double(_stats.backend_bytes) / _stats.changed_bytes);
+    }
+    str.printf("dirty: %u\n", unsigned(is_dirty()));
+}
@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include "AP_HAL_Namespace.h"
 
+class ExpandingString;
+
 class AP_HAL::Storage {
 public:
     virtual void init() = 0;
@@ -12,4 +14,24 @@ public:
     virtual void _timer_tick(void) {};
     virtual bool healthy(void) { return true; }
     virtual bool get_storage_ptr(void *&ptr, size_t &size) { return false; }
+
+    // true if there are writes not yet on the backing device
+    virtual bool is_dirty(void) { return false; }
+
+    // write counters since boot
+    struct Stats {
+        uint32_t write_calls;       // calls to write_block
+        uint32_t write_bytes;       // bytes passed to write_block
+        uint32_t changed_bytes;     // bytes passed in writes that changed the stored data
+        uint32_t backend_writes;    // writes issued to the device
+        uint32_t backend_bytes;     // bytes written to the device
+        uint32_t erases;            // flash sector erases
+    };
+    const Stats &get_stats(void) const { return _stats; }
+
+    // report write counters and write amplification
+    void storage_info(ExpandingString &str);
+
+protected:
+    Stats _stats {};
 };
@@ -1,6 +1,7 @@
 #include "AP_HAL.h"
 #include "Util.h"
 #include "utility/print_vprintf.h"
+#include <AP_Common/AP_HeapAccounting.h>
 #if defined(__APPLE__) && defined(__MACH__)
 #include <sys/time.h>
 #elif CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
@@ -78,3 +79,14 @@ void AP_HAL::Util::set_soft_armed(const bool b)
         }
     }
 }
+
+#if AP_HEAP_ACCOUNTING_ENABLED
+/*
+  out of line so the memory can be charged to our caller rather than
+  to this function
+ */
+void *AP_HAL::Util::malloc_type(size_t size, Memory_Type mem_type)
+{
+    return AP_HeapAccounting::calloc(size, __builtin_return_address(0));
+}
+#endif
@@ -151,7 +151,11 @@ public:
         MEM_FAST,
         MEM_FILESYSTEM
     };
+#if AP_HEAP_ACCOUNTING_ENABLED
+    virtual void *malloc_type(size_t size, Memory_Type mem_type);
+#else
     virtual void *malloc_type(size_t size, Memory_Type mem_type) { return calloc(1, size); }
+#endif
     virtual void free_type(void *ptr, size_t size, Memory_Type mem_type) { return free(ptr); }
 
 #ifdef ENABLE_HEAP
@@ -203,6 +207,9 @@ public:
     // request information on timer frequencies
     virtual void timer_info(ExpandingString &str) {}
 
+    // request information on SPI bus transfers
+    virtual void spi_info(ExpandingString &str) {}
+
     // generate Random values
     virtual bool get_random_vals(uint8_t* data, size_t size) { return false; }
 
@@ -1,7 +1,8 @@
 #pragma once
 
 /*
-  return the number of bytes to send for a packetised connection
+  return the number of bytes to send for a packetised connection,
+  looking at the packet starting offset bytes into the buffer
 */
-uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n);
+uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n, uint16_t offset=0);
 
@@ -236,11 +236,14 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     if ((n > sizeof(_buffer)) || (loc > (sizeof(_buffer) - n))) {
         return;
     }
+    _stats.write_calls++;
+    _stats.write_bytes += n;
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
         WITH_SEMAPHORE(sem);
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _stats.changed_bytes += n;
     }
 }
 
@@ -251,51 +254,70 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+#ifdef STORAGE_FLASH_PAGE
+        if (_initialisedType == StorageBackend::Flash && _flash_erase_ok()) {
+            // use idle time while disarmed to checkpoint flash
+            // storage. Flash writes stall the CPU on some MCUs, so
+            // the checkpoint waits rather than adding stalls in flight
+            EXPECT_DELAY_MS(1);
+            _flash.checkpoint_step();
+        }
+#endif
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint16_t i;
-    for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask.get(i)) {
-            break;
-        }
-    }
-    if (i == CH_STORAGE_NUM_LINES) {
+    // write out the first dirty line, along with any dirty lines
+    // following it for backends that can write a run in one go. We
+    // limit the run length to keep the latency of this call low
+    const int16_t first = _dirty_mask.first_set();
+    if (first < 0) {
         // this shouldn't be possible
         return;
     }
+    const uint16_t i = first;
+    uint16_t nlines = 1;
+    if (_initialisedType != StorageBackend::Flash) {
+        while (nlines < CH_STORAGE_WRITE_LINES &&
+               i + nlines < CH_STORAGE_NUM_LINES &&
+               _dirty_mask.get(i + nlines)) {
+            nlines++;
+        }
+    }
+    const uint32_t offset = CH_STORAGE_LINE_SIZE*i;
+    const uint16_t length = CH_STORAGE_LINE_SIZE*nlines;
 
     {
-        // take a copy of the line we are writing with a semaphore held
+        // take a copy of the lines we are writing with a semaphore held
         WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
+        memcpy(tmpline, &_buffer[offset], length);
     }
 
     bool write_ok = false;
 
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
+        if (fram.write(offset, tmpline, length)) {
             write_ok = true;
+            _stats.backend_writes++;
+            _stats.backend_bytes += length;
         }
     }
 #endif
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
         if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
             return;
         }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
+        if (AP::FS().write(log_fd, tmpline, length) != length) {
             return;
         }
         if (AP::FS().fsync(log_fd) != 0) {
             return;
         }
         write_ok = true;
+        _stats.backend_writes++;
+        _stats.backend_bytes += length;
     }
 #endif
 
@@ -310,14 +332,17 @@ void Storage::_timer_tick(void)
 
     if (write_ok) {
         WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
+        // while holding the semaphore we check if the copy of each
         // line is different from the original line. If it is
         // different then someone has re-dirtied the line while we
         // were writing it, in which case we should not mark it
         // clean. If it matches then we know we can mark the line as
         // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
+        for (uint16_t n=0; n<nlines; n++) {
+            const uint32_t line_ofs = CH_STORAGE_LINE_SIZE*n;
+            if (memcmp(&tmpline[line_ofs], &_buffer[offset+line_ofs], CH_STORAGE_LINE_SIZE) == 0) {
+                _dirty_mask.clear(i+n);
+            }
         }
     }
 }
@@ -370,6 +395,8 @@ bool Storage::_flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *
     for (uint8_t i=0; i<STORAGE_FLASH_RETRIES; i++) {
         EXPECT_DELAY_MS(1);
         if (hal.flash->write(base_address+offset, data, length)) {
+            _stats.backend_writes++;
+            _stats.backend_bytes += length;
             return true;
         }
         hal.scheduler->delay(1);
@@ -430,10 +457,12 @@ bool Storage::_flash_erase_sector(uint8_t sector)
         EXPECT_DELAY_MS(1000);
 #if AP_FLASH_STORAGE_DOUBLE_PAGE
         if (hal.flash->erasepage(_flash_page+sector) && hal.flash->erasepage(_flash_page+sector+1)) {
+            _stats.erases += 2;
             return true;
         }
 #else
         if (hal.flash->erasepage(_flash_page+sector)) {
+            _stats.erases++;
             return true;
         }
 #endif
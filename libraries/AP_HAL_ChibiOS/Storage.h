@@ -47,6 +47,14 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+// FRAM and microSD writes cover runs of contiguous dirty lines up to
+// this many bytes, so a parameter save is not split into many small
+// device writes
+#ifndef CH_STORAGE_MAX_WRITE
+#define CH_STORAGE_MAX_WRITE 128
+#endif
+#define CH_STORAGE_WRITE_LINES (CH_STORAGE_MAX_WRITE > CH_STORAGE_LINE_SIZE ? CH_STORAGE_MAX_WRITE/CH_STORAGE_LINE_SIZE : 1)
+
 /*
   on boards with 8k sector sizes we double up to treat pairs of sectors as one
  */
@@ -64,6 +72,7 @@ public:
     void _timer_tick(void) override;
     bool healthy(void) override;
     bool get_storage_ptr(void *&ptr, size_t &size) override;
+    bool is_dirty(void) override { return !_dirty_mask.empty(); }
 
 private:
     enum class StorageBackend: uint8_t {
@@ -80,7 +89,7 @@ private:
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
     HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    uint8_t tmpline[CH_STORAGE_LINE_SIZE*CH_STORAGE_WRITE_LINES];
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
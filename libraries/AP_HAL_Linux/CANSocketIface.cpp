@@ -36,6 +36,7 @@
 #include <sys/ioctl.h>
 #include <net/if.h>
 #include <linux/can/raw.h>
+#include <algorithm>
 #include <cstring>
 #include "Scheduler.h"
 #include <AP_CANManager/AP_CANManager.h>
@@ -163,12 +164,15 @@ int16_t CANIface::send(const AP_HAL::CANFrame& frame, const uint64_t tx_deadline
         tx_item.abort_on_error = true;
     }
     tx_item.setup = true;
-    tx_item.index = _tx_frame_counter;
     tx_item.deadline = tx_deadline;
-    WITH_SEMAPHORE(sem);
-    _tx_queue.emplace(tx_item);
-    _tx_frame_counter++;
-    stats.tx_requests++;
+    {
+        WITH_SEMAPHORE(sem);
+        tx_item.index = _tx_frame_counter;
+        _tx_queue.emplace(tx_item);
+        _tx_frame_counter++;
+        stats.tx_requests++;
+    }
+    // not holding sem, as _pollWrite() takes tx_sem before it
     _pollRead();     // Read poll is necessary because it can release the pending TX flag
     _pollWrite();
     return AP_HAL::CANIface::send(frame, tx_deadline, flags);
@@ -265,49 +269,117 @@ uint32_t CANIface::getErrorCount() const
     return ec;
 }
 
+/*
+  tx_sem keeps one thread at a time sending, so frames leave in queue
+  order and the socket queue count stays right, while sem, which
+  guards the queues, is only held around the bookkeeping and not
+  across sendmmsg()
+ */
 void CANIface::_pollWrite()
 {
-    while (_hasReadyTx()) {
-        WITH_SEMAPHORE(sem);
-        const CanTxItem tx = _tx_queue.top();
-        uint64_t curr_time = AP_HAL::micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            const int res = _write(tx.frame);
-            if (res == 1) {                   // Transmitted successfully
+    WITH_SEMAPHORE(tx_sem);
+    while (true) {
+        // take as many frames from the head of the queue as the socket
+        // may hold, dropping those past their deadline
+        CanTxItem batch[CAN_IO_BATCH_SIZE];
+        unsigned count = 0;
+        const uint64_t curr_time = AP_HAL::micros64();
+        {
+            WITH_SEMAPHORE(sem);
+            if (!_hasReadyTx()) {
+                break;
+            }
+            const unsigned room = std::min(_max_frames_in_socket_tx_queue - _frames_in_socket_tx_queue, unsigned(CAN_IO_BATCH_SIZE));
+            while (count < room && !_tx_queue.empty()) {
+                const CanTxItem tx = _tx_queue.top();
+                (void)_tx_queue.pop();
+                if (tx.deadline >= curr_time) {
+                    batch[count++] = tx;
+                } else {
+                    // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
+                    stats.tx_timedout++;
+                }
+            }
+            // count the frames as in the socket before they are, as
+            // their loopback may be read by another thread as soon as
+            // they are sent
+            for (unsigned i = 0; i < count; i++) {
                 _incrementNumFramesInSocketTxQueue();
-                if (tx.loopback) {
-                    _pending_loopback_ids.insert(tx.frame.id);
+                if (batch[i].loopback) {
+                    _pending_loopback_ids.insert(batch[i].frame.id);
                 }
-                stats.tx_success++;
-                stats.last_transmit_us = curr_time;
-            } else if (res == 0) {            // Not transmitted, nor is it an error
-                stats.tx_overflow++;
-                break;                        // Leaving the loop, the frame remains enqueued for the next retry
-            } else {                          // Transmission error
-                stats.tx_rejected++;
             }
-        } else {
-            // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
-            stats.tx_timedout++;
+        }
+        if (count == 0) {
+            continue;
         }
 
-        // Removing the frame from the queue even if transmission failed
-        (void)_tx_queue.pop();
+        const int res = _writeBatch(batch, count);
+        const unsigned sent = res > 0 ? res : 0;
+
+        WITH_SEMAPHORE(sem);
+        for (unsigned i = sent; i < count; i++) {
+            _confirmSentFrame();
+            if (batch[i].loopback) {
+                const auto it = _pending_loopback_ids.find(batch[i].frame.id);
+                if (it != _pending_loopback_ids.end()) {
+                    _pending_loopback_ids.erase(it);
+                }
+            }
+        }
+        stats.tx_success += sent;
+        if (sent > 0) {
+            stats.last_transmit_us = curr_time;
+        }
+
+        unsigned requeue_from = sent;
+        if (res < 0) {
+            // Transmission error, the frame is dropped
+            stats.tx_rejected++;
+            requeue_from = 1;
+        }
+        // Frames the socket didn't take go back in the queue, where
+        // priority and index put them back at the head for the next retry
+        for (unsigned i = requeue_from; i < count; i++) {
+            _tx_queue.emplace(batch[i]);
+        }
+        if (res >= 0 && sent < count) {
+            // Not transmitted, nor is it an error
+            stats.tx_overflow++;
+            break;
+        }
     }
 }
 
 bool CANIface::_pollRead()
 {
+    // _rx_batch and the loopback bookkeeping are shared by every
+    // thread sending or receiving on this interface
+    WITH_SEMAPHORE(sem);
+    bool received = false;
     uint8_t iterations_count = 0;
     while (iterations_count < CAN_MAX_POLL_ITERATIONS_COUNT)
     {
         iterations_count++;
-        CanRxItem rx;
-        rx.timestamp_us = AP_HAL::micros64();  // Monotonic timestamp is not required to be precise (unlike UTC)
-        bool loopback = false;
-        const int res = _read(rx.frame, rx.timestamp_us, loopback);
-        if (res == 1) {
+        const int res = _readBatch();
+        if (res < 0) {
+            stats.rx_errors++;
+            break;
+        }
+        const uint64_t timestamp_us = AP_HAL::micros64();  // Monotonic timestamp is not required to be precise (unlike UTC)
+        for (int i = 0; i < res; i++) {
+            if (_rx_batch.msgs[i].msg_len != sizeof(can_frame)) {
+                stats.rx_errors++;
+                continue;
+            }
+            const can_frame& sockcan_frame = _rx_batch.frames[i];
+            const bool loopback = (_rx_batch.msgs[i].msg_hdr.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
+            if (!loopback && !_checkHWFilters(sockcan_frame)) {
+                continue;
+            }
+            CanRxItem rx;
+            rx.frame = makeUavcanFrame(sockcan_frame);
+            rx.timestamp_us = timestamp_us;
             bool accept = true;
             if (loopback) {           // We receive loopback for all CAN frames
                 _confirmSentFrame();
@@ -316,93 +388,80 @@ bool CANIface::_pollRead()
                 stats.tx_confirmed++;
             }
             if (accept) {
-                WITH_SEMAPHORE(sem);
                 _rx_queue.push(rx);
                 stats.rx_received++;
-                return true;
+                received = true;
             }
-        } else if (res == 0) {
-            break;
-        } else {
-            stats.rx_errors++;
+        }
+        if (res < CAN_IO_BATCH_SIZE) {
+            // the socket has been drained
             break;
         }
     }
-    return false;
+    return received;
 }
 
-int CANIface::_write(const AP_HAL::CANFrame& frame) const
+int CANIface::_writeBatch(const CanTxItem* items, unsigned count) const
 {
     if (_fd < 0) {
         return -1;
     }
+    can_frame sockcan_frames[CAN_IO_BATCH_SIZE];
+    iovec iov[CAN_IO_BATCH_SIZE];
+    mmsghdr msgs[CAN_IO_BATCH_SIZE] {};
+    count = std::min(count, unsigned(CAN_IO_BATCH_SIZE));
+    for (unsigned i = 0; i < count; i++) {
+        sockcan_frames[i] = makeSocketCanFrame(items[i].frame);
+        iov[i].iov_base = &sockcan_frames[i];
+        iov[i].iov_len = sizeof(can_frame);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
     errno = 0;
 
-    const can_frame sockcan_frame = makeSocketCanFrame(frame);
-
-    const int res = write(_fd, &sockcan_frame, sizeof(sockcan_frame));
+    const int res = sendmmsg(_fd, msgs, count, MSG_DONTWAIT);
     if (res <= 0) {
         if (errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
             return 0;
         }
-        return res;
-    }
-    if (res != sizeof(sockcan_frame)) {
-        return -1;
+        return res < 0 ? res : -1;
     }
-    return 1;
+    return res;
 }
 
-
-int CANIface::_read(AP_HAL::CANFrame& frame, uint64_t& timestamp_us, bool& loopback) const
+int CANIface::_readBatch()
 {
     if (_fd < 0) {
         return -1;
     }
-    auto iov = iovec();
-    auto sockcan_frame = can_frame();
-    iov.iov_base = &sockcan_frame;
-    iov.iov_len  = sizeof(sockcan_frame);
-    union {
-        uint8_t data[CMSG_SPACE(sizeof(::timeval))];
-        struct cmsghdr align;
-    } control;
-
-    auto msg = msghdr();
-    msg.msg_iov    = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = control.data;
-    msg.msg_controllen = sizeof(control.data);
-
-    const int res = recvmsg(_fd, &msg, MSG_DONTWAIT);
-    if (res <= 0) {
-        return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
+    for (unsigned i = 0; i < CAN_IO_BATCH_SIZE; i++) {
+        _rx_batch.iov[i].iov_base = &_rx_batch.frames[i];
+        _rx_batch.iov[i].iov_len  = sizeof(can_frame);
+        auto& msg = _rx_batch.msgs[i].msg_hdr;
+        msg = msghdr();
+        msg.msg_iov    = &_rx_batch.iov[i];
+        msg.msg_iovlen = 1;
+        msg.msg_control = _rx_batch.control[i].data;
+        msg.msg_controllen = sizeof(_rx_batch.control[i].data);
     }
-    /*
-     * Flags
-     */
-    loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
 
-    if (!loopback && !_checkHWFilters(sockcan_frame)) {
-        return 0;
+    const int res = recvmmsg(_fd, _rx_batch.msgs, CAN_IO_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    if (res <= 0) {
+        return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
     }
-
-    frame = makeUavcanFrame(sockcan_frame);
-    /*
-     * Timestamp
-     */
-    timestamp_us = AP_HAL::micros64();
-    return 1;
+    return res;
 }
 
 // Might block forever, only to be used for testing
 void CANIface::flush_tx()
 {
-    WITH_SEMAPHORE(sem);
+    bool pending;
     do {
         _updateDownStatusFromPollResult(_pollfd);
         _poll(true, true);
-    } while(!_tx_queue.empty() && !_down);
+        WITH_SEMAPHORE(sem);
+        pending = !_tx_queue.empty();
+    } while(pending && !_down);
 }
 
 void CANIface::clear_rx()
@@ -40,6 +40,7 @@
 #include <map>
 #include <unordered_set>
 #include <poll.h>
+#include <sys/socket.h>
 
 namespace Linux {
 
@@ -53,6 +54,7 @@ enum class SocketCanError
 #define CAN_MAX_POLL_ITERATIONS_COUNT 100
 #define CAN_MAX_INIT_TRIES_COUNT 100
 #define CAN_FILTER_NUMBER 8
+#define CAN_IO_BATCH_SIZE 16
 
 class CANIface: public AP_HAL::CANIface {
 public:
@@ -120,9 +122,15 @@ private:
 
     bool _pollRead();
 
-    int _write(const AP_HAL::CANFrame& frame) const;
+    // write up to CAN_IO_BATCH_SIZE frames with one system call.
+    // Returns the number the socket took, 0 if it had no room for the
+    // first, or negative if the first failed
+    int _writeBatch(const CanTxItem* items, unsigned count) const;
 
-    int _read(AP_HAL::CANFrame& frame, uint64_t& ts_usec, bool& loopback) const;
+    // read up to CAN_IO_BATCH_SIZE frames into _rx_batch with one
+    // system call. Returns the number read, 0 if none were waiting, or
+    // negative on error
+    int _readBatch();
 
     void _incrementNumFramesInSocketTxQueue();
 
@@ -163,6 +171,17 @@ private:
     std::unordered_multiset<uint32_t> _pending_loopback_ids;
     std::vector<can_filter> _hw_filters_container;
 
+    // buffers for recvmmsg(), kept here to stay off the thread's
+    // stack. Only used with sem held
+    struct {
+        can_frame frames[CAN_IO_BATCH_SIZE];
+        iovec iov[CAN_IO_BATCH_SIZE];
+        mmsghdr msgs[CAN_IO_BATCH_SIZE];
+        struct {
+            alignas(cmsghdr) uint8_t data[CMSG_SPACE(sizeof(::timeval))];
+        } control[CAN_IO_BATCH_SIZE];
+    } _rx_batch;
+
     struct bus_stats : public AP_HAL::CANIface::bus_stats_t {
         uint32_t tx_confirmed;
         uint32_t num_downs;
@@ -183,6 +202,8 @@ protected:
         return _self_index;
     }
     HAL_Semaphore sem;
+    // held by the one thread writing to the socket, see _pollWrite()
+    HAL_Semaphore tx_sem;
 };
 
 }
@@ -64,7 +64,7 @@ ssize_t ConsoleDevice::read(uint8_t *buf, uint16_t n)
         return -EAGAIN;
     }
 
-    return ::read(_rd_fd, buf, n);
+    return _account_rx(::read(_rd_fd, buf, n));
 }
 
 ssize_t ConsoleDevice::write(const uint8_t *buf, uint16_t n)
@@ -73,7 +73,7 @@ ssize_t ConsoleDevice::write(const uint8_t *buf, uint16_t n)
         return -EAGAIN;
     }
 
-    return ::write(_wr_fd, buf, n);
+    return _account_tx(::write(_wr_fd, buf, n));
 }
 
 void ConsoleDevice::set_blocking(bool blocking)
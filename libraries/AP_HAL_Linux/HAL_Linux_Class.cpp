@@ -340,6 +340,13 @@ void _usage(void)
     printf("\tcpu affinity:\n");
     printf("\t                   --cpu-affinity 1 (single cpu) or 1,3 (multiple cpus) or 1-3 (range of cpus)\n");
     printf("\t                   -c 1 (single cpu) or 1,3 (multiple cpus) or 1-3 (range of cpus)\n");
+    printf("\tper-thread cpu affinity and priority (may be repeated):\n");
+    printf("\t                   --thread-config ap-io=2 (pin thread to cpu 2)\n");
+    printf("\t                   --thread-config log_io=3:8 (pin thread to cpu 3 at priority 8)\n");
+    printf("\tnumber of threads running IO processes:\n");
+    printf("\t                   --io-threads 2\n");
+    printf("\tmove an IO process, by registration order, to another IO thread (may be repeated):\n");
+    printf("\t                   --io-proc 3=1 (run the fourth IO process on IO thread 1)\n");
 }
 
 void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
@@ -359,6 +366,9 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         CMDLINE_SERIAL7,
         CMDLINE_SERIAL8,
         CMDLINE_SERIAL9,
+        CMDLINE_THREAD_CONFIG,
+        CMDLINE_IO_THREADS,
+        CMDLINE_IO_PROC,
     };
 
     int opt;
@@ -389,6 +399,9 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"module-directory",    true,  0, 'M'},
         {"defaults",            true,  0, 'd'},
         {"cpu-affinity",        true,  0, 'c'},
+        {"thread-config",       true,  0, CMDLINE_THREAD_CONFIG},
+        {"io-threads",          true,  0, CMDLINE_IO_THREADS},
+        {"io-proc",             true,  0, CMDLINE_IO_PROC},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -458,6 +471,21 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
             }
             Linux::Scheduler::from(scheduler)->set_cpu_affinity(cpu_affinity);
             break;
+        case CMDLINE_THREAD_CONFIG:
+            if (!Linux::Scheduler::from(scheduler)->add_thread_config(gopt.optarg)) {
+                fprintf(stderr, "Could not parse thread config: %s\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+        case CMDLINE_IO_THREADS:
+            Linux::Scheduler::from(scheduler)->set_io_thread_count(atoi(gopt.optarg));
+            break;
+        case CMDLINE_IO_PROC:
+            if (!Linux::Scheduler::from(scheduler)->assign_io_process(gopt.optarg)) {
+                fprintf(stderr, "Could not parse IO process assignment: %s\n", gopt.optarg);
+                exit(1);
+            }
+            break;
         case 'h':
             _usage();
             exit(0);
@@ -107,9 +107,10 @@ public:
     /*
      * Wait for events on all Pollable objects registered with
      * register_pollable(). New Pollable objects can be registered at any
-     * time, including when a thread is sleeping on a poll() call.
+     * time, including when a thread is sleeping on a poll() call. A
+     * @timeout_ms of 0 only collects events that are already pending.
      */
-    int poll() const;
+    int poll(int timeout_ms = -1) const;
 
     /*
      * Wake up the thread sleeping on a poll() call if it is in fact
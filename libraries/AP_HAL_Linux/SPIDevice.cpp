@@ -29,6 +29,7 @@
 
 #include <AP_HAL/AP_HAL.h>
 #include <AP_HAL/utility/OwnPtr.h>
+#include <AP_Common/ExpandingString.h>
 
 #include "GPIO.h"
 #include "PollerThread.h"
@@ -193,10 +194,27 @@ public:
     uint16_t bus;
     int16_t last_mode = -1;
     uint8_t ref;
+
+    struct {
+        uint32_t transfers;
+        uint32_t ioctls;
+        uint32_t errors;
+        uint64_t bytes;
+    } stats;
+
+    // counts at the last report, for rates
+    struct {
+        uint32_t transfers;
+        uint32_t ioctls;
+        uint64_t bytes;
+        uint32_t ms;
+    } last_report;
 };
 
 SPIBus::SPIBus(uint16_t bus_)
     : bus(bus_)
+    , stats{}
+    , last_report{}
 {
     memset(fd, -1, sizeof(fd));
 }
@@ -277,14 +295,14 @@ bool SPIDevice::set_speed(AP_HAL::Device::Speed speed)
     return true;
 }
 
-bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
-                         uint8_t *recv, uint32_t recv_len)
+unsigned SPIDevice::_fill_msgs(struct spi_ioc_transfer *msgs,
+                               const uint8_t *send, uint32_t send_len,
+                               uint8_t *recv, uint32_t recv_len) const
 {
-    struct spi_ioc_transfer msgs[2] = { };
     unsigned nmsgs = 0;
-    int fd = _bus.fd[_desc.subdev];
 
     if (send && send_len != 0) {
+        msgs[nmsgs] = { };
         msgs[nmsgs].tx_buf = (uint64_t) send;
         msgs[nmsgs].rx_buf = 0;
         msgs[nmsgs].len = send_len;
@@ -296,6 +314,7 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     }
 
     if (recv && recv_len != 0) {
+        msgs[nmsgs] = { };
         msgs[nmsgs].tx_buf = 0;
         msgs[nmsgs].rx_buf = (uint64_t) recv;
         msgs[nmsgs].len = recv_len;
@@ -306,10 +325,11 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         nmsgs++;
     }
 
-    if (!nmsgs) {
-        return false;
-    }
+    return nmsgs;
+}
 
+bool SPIDevice::_set_mode(int fd)
+{
 #if DEBUG
     if (_desc.mode == _bus.last_mode) {
         /*
@@ -333,9 +353,8 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     }
 #endif
 
-    int r;
     if (_desc.mode != _bus.last_mode) {
-        r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
+        int r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
         if (r < 0) {
             hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
                                 fd, strerror(errno));
@@ -344,11 +363,26 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         _bus.last_mode = _desc.mode;
     }
 
+    return true;
+}
+
+bool SPIDevice::_submit(struct spi_ioc_transfer *msgs, unsigned nmsgs,
+                        unsigned ntransfers)
+{
+    int fd = _bus.fd[_desc.subdev];
+
+    _bus.stats.transfers += ntransfers;
+    _bus.stats.ioctls++;
+    for (unsigned i = 0; i < nmsgs; i++) {
+        _bus.stats.bytes += msgs[i].len;
+    }
+
     _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), msgs);
     _cs_release();
 
     if (r == -1) {
+        _bus.stats.errors++;
         hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
                             fd, strerror(errno));
         return false;
@@ -357,6 +391,23 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     return true;
 }
 
+bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
+                         uint8_t *recv, uint32_t recv_len)
+{
+    struct spi_ioc_transfer msgs[2];
+    const unsigned nmsgs = _fill_msgs(msgs, send, send_len, recv, recv_len);
+
+    if (!nmsgs) {
+        return false;
+    }
+
+    if (!_set_mode(_bus.fd[_desc.subdev])) {
+        return false;
+    }
+
+    return _submit(msgs, nmsgs, 1);
+}
+
 bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                                     uint32_t len)
 {
@@ -382,17 +433,67 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
         return false;
     }
 
-    _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(1), &msgs);
-    _cs_release();
+    return _submit(msgs, 1, 1);
+}
 
-    if (r == -1) {
-        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
-                            fd, strerror(errno));
+bool SPIDevice::queue_transfer(const uint8_t *send, uint32_t send_len,
+                               uint8_t *recv, uint32_t recv_len)
+{
+    const uint32_t len = send_len + recv_len;
+    if (_queue_ntransfers == QUEUE_MAX_TRANSFERS ||
+        _queue_bytes + len > QUEUE_MAX_BYTES) {
+        /* make room, keeping the transfers in order */
+        const bool ok = transfer_queued();
+        _queue_failed = !ok;
+    }
+
+    if (_desc.cs_pin != SPI_CS_KERNEL || send_len > QUEUE_MAX_SEND ||
+        len > QUEUE_MAX_BYTES) {
+        /*
+         * a userspace chip select can't be released between transfers
+         * of one ioctl, and large sends aren't copied, so these go
+         * straight away after anything already queued
+         */
+        bool ok = transfer_queued();
+        ok = transfer(send, send_len, recv, recv_len) && ok;
+        _queue_failed = !ok;
+        return ok;
+    }
+
+    uint8_t *send_copy = nullptr;
+    if (send && send_len != 0) {
+        send_copy = _queue_send[_queue_ntransfers];
+        memcpy(send_copy, send, send_len);
+    }
+    const unsigned n = _fill_msgs(&_queue_msgs[_queue_nmsgs],
+                                  send_copy, send_len, recv, recv_len);
+    if (n == 0) {
+        _queue_failed = true;
         return false;
     }
+    if (_queue_nmsgs > 0) {
+        /* release the chip select after the previous transfer */
+        _queue_msgs[_queue_nmsgs - 1].cs_change = 1;
+    }
+    _queue_nmsgs += n;
+    _queue_ntransfers++;
+    _queue_bytes += len;
 
-    return true;
+    return !_queue_failed;
+}
+
+bool SPIDevice::transfer_queued()
+{
+    bool ok = !_queue_failed;
+    if (_queue_nmsgs > 0) {
+        ok = _set_mode(_bus.fd[_desc.subdev]) &&
+             _submit(_queue_msgs, _queue_nmsgs, _queue_ntransfers) && ok;
+    }
+    _queue_nmsgs = 0;
+    _queue_ntransfers = 0;
+    _queue_bytes = 0;
+    _queue_failed = false;
+    return ok;
 }
 
 
@@ -496,6 +597,32 @@ const char* SPIDeviceManager::get_device_name(uint8_t idx)
     return _device[idx].name;
 }
 
+void SPIDeviceManager::bus_info(ExpandingString &str)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+
+    str.printf("SPIV1\n");
+    for (SPIBus *b : _buses) {
+        WITH_SEMAPHORE(b->sem);
+        const float dt = (now_ms - b->last_report.ms) * 0.001f;
+        const uint32_t transfers = b->stats.transfers - b->last_report.transfers;
+        const uint32_t ioctls = b->stats.ioctls - b->last_report.ioctls;
+        const uint32_t bytes = b->stats.bytes - b->last_report.bytes;
+        str.printf("SPI%u XFER:%lu IOCTL:%lu ERR:%lu XFER/s:%.0f IOCTL/s:%.0f B/s:%.0f\n",
+                   b->bus,
+                   (unsigned long)b->stats.transfers,
+                   (unsigned long)b->stats.ioctls,
+                   (unsigned long)b->stats.errors,
+                   dt > 0 ? transfers / dt : 0.0f,
+                   dt > 0 ? ioctls / dt : 0.0f,
+                   dt > 0 ? bytes / dt : 0.0f);
+        b->last_report.transfers = b->stats.transfers;
+        b->last_report.ioctls = b->stats.ioctls;
+        b->last_report.bytes = b->stats.bytes;
+        b->last_report.ms = now_ms;
+    }
+}
+
 /* Create a new device increasing the bus reference */
 AP_HAL::OwnPtr<AP_HAL::SPIDevice>
 SPIDeviceManager::_create_device(SPIBus &b, SPIDesc &desc) const
@@ -17,11 +17,14 @@
 #pragma once
 
 #include <inttypes.h>
+#include <linux/spi/spidev.h>
 #include <vector>
 
 #include <AP_HAL/HAL.h>
 #include <AP_HAL/SPIDevice.h>
 
+class ExpandingString;
+
 namespace Linux {
 
 class SPIBus;
@@ -46,6 +49,13 @@ public:
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
 
+    /* See AP_HAL::Device::queue_transfer() */
+    bool queue_transfer(const uint8_t *send, uint32_t send_len,
+                        uint8_t *recv, uint32_t recv_len) override;
+
+    /* See AP_HAL::Device::transfer_queued() */
+    bool transfer_queued() override;
+
     /* See AP_HAL::Device::get_semaphore() */
     AP_HAL::Semaphore *get_semaphore() override;
 
@@ -63,6 +73,40 @@ protected:
     AP_HAL::DigitalSource *_cs;
     uint32_t _speed;
 
+    /*
+     * Transfers queued for a single SPI_IOC_MESSAGE ioctl. Each takes up
+     * to two messages, with the chip select released between them
+     */
+    static constexpr uint8_t QUEUE_MAX_TRANSFERS = 8;
+    static constexpr uint8_t QUEUE_MAX_SEND = 8;
+    /* spidev refuses messages longer than its buffer, 4096 by default */
+    static constexpr uint32_t QUEUE_MAX_BYTES = 4096;
+    struct spi_ioc_transfer _queue_msgs[2 * QUEUE_MAX_TRANSFERS];
+    uint8_t _queue_send[QUEUE_MAX_TRANSFERS][QUEUE_MAX_SEND];
+    uint8_t _queue_nmsgs = 0;
+    uint8_t _queue_ntransfers = 0;
+    uint32_t _queue_bytes = 0;
+    bool _queue_failed = false;
+
+    /*
+     * Fill in up to two messages for a send and receive, returning the
+     * number used
+     */
+    unsigned _fill_msgs(struct spi_ioc_transfer *msgs,
+                        const uint8_t *send, uint32_t send_len,
+                        uint8_t *recv, uint32_t recv_len) const;
+
+    /*
+     * Set the SPI mode if another device on the bus changed it
+     */
+    bool _set_mode(int fd);
+
+    /*
+     * Do the messages as one ioctl, covering ntransfers transfers
+     */
+    bool _submit(struct spi_ioc_transfer *msgs, unsigned nmsgs,
+                 unsigned ntransfers);
+
     /*
      * Select device if using userspace CS
      */
@@ -105,6 +149,11 @@ public:
     /* See AP_HAL::SPIDeviceManager::get_device_name() */
     const char *get_device_name(uint8_t idx) override;
 
+    /*
+     * Transfer and ioctl counts for each bus, for @SYS/spi.txt
+     */
+    void bus_info(ExpandingString &str);
+
 protected:
     void _unregister(SPIBus &b);
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> _create_device(SPIBus &b, SPIDesc &device_desc) const;
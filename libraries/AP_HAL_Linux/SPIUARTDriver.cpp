@@ -114,6 +114,25 @@ int SPIUARTDriver::_write_fd(const uint8_t *buf, uint16_t size)
     return ret;
 }
 
+int SPIUARTDriver::_writev_fd(const struct iovec *iov, int iovcnt)
+{
+    if (_external) {
+        return UARTDriver::_writev_fd(iov, iovcnt);
+    }
+
+    /* one SPI transfer per segment */
+    int ret = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        const int n = _write_fd((const uint8_t *)iov[i].iov_base, iov[i].iov_len);
+        ret += n;
+        if ((size_t)n != iov[i].iov_len) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
 int SPIUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
 {
     static uint8_t ff_stub[100] = {0xff};
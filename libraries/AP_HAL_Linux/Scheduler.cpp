@@ -5,6 +5,7 @@
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -120,8 +121,15 @@ void Scheduler::init()
     init_realtime();
     init_cpu_affinity();
 
+    for (uint8_t i = 0; i < _num_io_threads - 1; i++) {
+        _extra_io_threads[i] = NEW_NOTHROW IOThread(*this, i + 1);
+        if (_extra_io_threads[i] == nullptr) {
+            AP_HAL::panic("Scheduler: failed to allocate IO thread");
+        }
+    }
+
     /* set barrier to N + 1 threads: worker threads + main */
-    unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
+    unsigned n_threads = ARRAY_SIZE(sched_table) + _num_io_threads;
     ret = pthread_barrier_init(&_initialized_barrier, nullptr, n_threads);
     if (ret) {
         AP_HAL::panic("Scheduler: Failed to initialise barrier object: %s",
@@ -136,6 +144,14 @@ void Scheduler::init()
         t->thread->start(t->name, t->policy, t->prio);
     }
 
+    for (uint8_t i = 0; i < _num_io_threads - 1; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "ap-io%u", unsigned(i + 1));
+        _extra_io_threads[i]->set_rate(APM_LINUX_IO_RATE);
+        _extra_io_threads[i]->set_stack_size(1024 * 1024);
+        _extra_io_threads[i]->start(name, SCHED_FIFO, APM_LINUX_IO_PRIORITY);
+    }
+
 #if defined(DEBUG_STACK) && DEBUG_STACK
     register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_stack, void));
 #endif
@@ -224,6 +240,9 @@ void Scheduler::register_io_process(AP_HAL::MemberProc proc)
 
     if (_num_io_procs < LINUX_SCHEDULER_MAX_IO_PROCS) {
         _io_proc[_num_io_procs] = proc;
+        if (_io_proc_thread[_num_io_procs] >= _num_io_threads) {
+            _io_proc_thread[_num_io_procs] = 0;
+        }
         _num_io_procs++;
     } else {
         hal.console->printf("Out of IO processes\n");
@@ -259,18 +278,23 @@ void Scheduler::_timer_task()
     _in_timer_proc = false;
 }
 
-void Scheduler::_run_io(void)
+void Scheduler::_run_io(uint8_t thread_index)
 {
-    _io_semaphore.take_blocking();
+    WITH_SEMAPHORE(_io_semaphore[thread_index]);
 
-    // now call the IO based drivers
+    // now call the IO based drivers assigned to this thread
     for (int i = 0; i < _num_io_procs; i++) {
-        if (_io_proc[i]) {
+        if (_io_proc[i] && _io_proc_thread[i] == thread_index) {
             _io_proc[i]();
         }
     }
+}
 
-    _io_semaphore.give();
+void Scheduler::_run_all_io()
+{
+    for (uint8_t i = 0; i < _num_io_threads; i++) {
+        _run_io(i);
+    }
 }
 
 /*
@@ -278,6 +302,9 @@ void Scheduler::_run_io(void)
  */
 void Scheduler::_run_uarts()
 {
+    // find out which devices are ready with a single epoll_wait()
+    UARTDriver::poll_devices();
+
     // process any pending serial bytes
     for (uint8_t i=0;i<hal.num_serial; i++) {
         hal.serial(i)->_timer_tick();
@@ -300,7 +327,7 @@ void Scheduler::_io_task()
     hal.storage->_timer_tick();
 
     // run registered IO processes
-    _run_io();
+    _run_io(0);
 }
 
 bool Scheduler::in_main_thread() const
@@ -341,7 +368,7 @@ void Scheduler::stop_clock(uint64_t time_usec)
     }
 
     _stopped_clock_usec = time_usec;
-    _run_io();
+    _run_all_io();
 }
 #else
 void Scheduler::stop_clock(uint64_t time_usec)
@@ -370,6 +397,11 @@ void Scheduler::teardown()
     _io_thread.join();
     _rcin_thread.join();
     _uart_thread.join();
+
+    for (uint8_t i = 0; i < _num_io_threads - 1; i++) {
+        _extra_io_threads[i]->stop();
+        _extra_io_threads[i]->join();
+    }
 }
 
 // calculates an integer to be used as the priority for a newly-created thread
@@ -431,3 +463,155 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
 
     return true;
 }
+
+void Scheduler::set_io_thread_count(uint8_t count)
+{
+    _num_io_threads = constrain_int16(count, 1, LINUX_SCHEDULER_MAX_IO_THREADS);
+}
+
+/*
+  parse an IO process assignment of the form proc=thread
+*/
+bool Scheduler::assign_io_process(const char *spec)
+{
+    char *endptr;
+    const long proc = strtol(spec, &endptr, 10);
+    if (endptr == spec || *endptr != '=' ||
+        proc < 0 || proc >= LINUX_SCHEDULER_MAX_IO_PROCS) {
+        return false;
+    }
+
+    const char *thread_str = endptr + 1;
+    const long thread = strtol(thread_str, &endptr, 10);
+    if (endptr == thread_str || *endptr != '\0' ||
+        thread < 0 || thread >= LINUX_SCHEDULER_MAX_IO_THREADS) {
+        return false;
+    }
+
+    _io_proc_thread[proc] = thread;
+
+    return true;
+}
+
+/*
+  parse a thread configuration of the form name=cpus[:priority]
+*/
+bool Scheduler::add_thread_config(const char *spec)
+{
+    if (_num_thread_config >= ARRAY_SIZE(_thread_config)) {
+        return false;
+    }
+
+    const char *eq = strchr(spec, '=');
+    if (eq == nullptr || eq == spec || size_t(eq - spec) >= sizeof(_thread_config[0].name)) {
+        return false;
+    }
+
+    struct thread_config &c = _thread_config[_num_thread_config];
+    memset(&c, 0, sizeof(c));
+    memcpy(c.name, spec, eq - spec);
+
+    char cpus[64];
+    strncpy(cpus, eq + 1, sizeof(cpus) - 1);
+    cpus[sizeof(cpus) - 1] = '\0';
+
+    char *colon = strchr(cpus, ':');
+    if (colon != nullptr) {
+        *colon = '\0';
+        char *endptr;
+        c.prio = strtol(colon + 1, &endptr, 10);
+        if (endptr == colon + 1 || *endptr != '\0' ||
+            c.prio < 1 || c.prio > APM_LINUX_MAX_PRIORITY) {
+            return false;
+        }
+    }
+
+    if (strlen(cpus) > 0 && !Util::from(hal.util)->parse_cpu_set(cpus, &c.cpus)) {
+        return false;
+    }
+
+    _num_thread_config++;
+
+    return true;
+}
+
+void Scheduler::get_thread_config(const char *name, int &prio, cpu_set_t &cpus) const
+{
+    for (uint8_t i = 0; i < _num_thread_config; i++) {
+        const struct thread_config &c = _thread_config[i];
+        if (strncmp(c.name, name, sizeof(c.name)) != 0) {
+            continue;
+        }
+        if (c.prio > 0) {
+            prio = c.prio;
+        }
+        if (CPU_COUNT(&c.cpus) > 0) {
+            cpus = c.cpus;
+        }
+        return;
+    }
+}
+
+void Scheduler::register_thread(Thread *thread)
+{
+    pthread_mutex_lock(&_threads_mtx);
+    thread->_next = _threads;
+    _threads = thread;
+    pthread_mutex_unlock(&_threads_mtx);
+}
+
+void Scheduler::unregister_thread(Thread *thread)
+{
+    pthread_mutex_lock(&_threads_mtx);
+    for (Thread **t = &_threads; *t != nullptr; t = &(*t)->_next) {
+        if (*t == thread) {
+            *t = thread->_next;
+            thread->_next = nullptr;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_threads_mtx);
+}
+
+/*
+  display thread statistics as text buffer for @SYS/threads.txt. LOAD
+  is the CPU use since the last call
+ */
+void Scheduler::thread_info(ExpandingString &str)
+{
+    const uint64_t now_us = AP_HAL::micros64();
+
+    str.printf("ThreadsV2\n");
+
+    pthread_mutex_lock(&_threads_mtx);
+    for (Thread *t = _threads; t != nullptr; t = t->_next) {
+        const uint64_t cpu_us = t->get_cpu_time_us();
+        float load = 0;
+        if (t->_last_info_us != 0 && now_us > t->_last_info_us) {
+            load = 100.0f * float(cpu_us - t->_last_info_cpu_us) / float(now_us - t->_last_info_us);
+        }
+        t->_last_info_cpu_us = cpu_us;
+        t->_last_info_us = now_us;
+
+        uint32_t cpu_mask = 0;
+        for (uint8_t cpu = 0; cpu < 32; cpu++) {
+            if (CPU_ISSET(cpu, &t->get_cpu_set())) {
+                cpu_mask |= 1U << cpu;
+            }
+        }
+
+        const Thread::Stats stats = t->get_stats();
+        const uint64_t count = MAX(stats.run_count, 1U);
+        str.printf("%-13.13s PRI=%3d CPUS=0x%02x STACK=%7u LOAD=%5.1f%% LAT=%u/%uus RUN=%u/%uus\n",
+                   t->get_name(),
+                   t->get_priority(),
+                   unsigned(cpu_mask),
+                   unsigned(t->get_stack_usage()),
+                   load,
+                   unsigned(stats.latency_us / count),
+                   unsigned(stats.latency_max_us),
+                   unsigned(stats.run_time_us / count),
+                   unsigned(stats.run_time_max_us));
+    }
+    pthread_mutex_unlock(&_threads_mtx);
+}
@@ -4,12 +4,16 @@
 
 #include "AP_HAL_Linux.h"
 
+#include <AP_Common/ExpandingString.h>
+
 #include "Semaphores.h"
 #include "Thread.h"
 
 #define LINUX_SCHEDULER_MAX_TIMER_PROCS 10
 #define LINUX_SCHEDULER_MAX_TIMESLICED_PROCS 10
 #define LINUX_SCHEDULER_MAX_IO_PROCS 10
+#define LINUX_SCHEDULER_MAX_IO_THREADS 4
+#define LINUX_SCHEDULER_MAX_THREAD_CONFIG 16
 
 #define AP_LINUX_SENSORS_STACK_SIZE  256 * 1024
 #define AP_LINUX_SENSORS_SCHED_POLICY  SCHED_FIFO
@@ -60,6 +64,47 @@ public:
      */
     void set_cpu_affinity(const cpu_set_t &cpu_affinity) { _cpu_affinity = cpu_affinity; }
 
+    /*
+      add a per-thread scheduling override of the form
+      "name=cpus[:priority]", e.g. "ap-io=2" or "log_io=3:8". cpus uses
+      the same syntax as the cpu affinity option. Must be called before
+      init() to affect the scheduler's own threads.
+     */
+    bool add_thread_config(const char *spec);
+
+    /*
+      apply any override matching the thread name to prio and cpus
+     */
+    void get_thread_config(const char *name, int &prio, cpu_set_t &cpus) const;
+
+    /*
+      set the number of threads used to run IO processes. Must be
+      called before init().
+     */
+    void set_io_thread_count(uint8_t count);
+
+    /*
+      run an IO process on another IO thread, given as
+      "proc=thread" where proc is its index in registration order,
+      e.g. "3=1". IO processes on different threads run at the same
+      time, so only those sharing no state with the processes left on
+      their old thread should be moved. Unassigned processes run on
+      thread 0.
+     */
+    bool assign_io_process(const char *spec);
+
+    /*
+      keep track of started threads for thread_info()
+     */
+    void register_thread(Thread *thread);
+    void unregister_thread(Thread *thread);
+
+    /*
+      display per-thread priority, affinity, stack, load, wakeup
+      latency and run time for @SYS/threads.txt
+     */
+    void thread_info(ExpandingString &str);
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -74,6 +119,23 @@ private:
         Scheduler &_sched;
     };
 
+    /*
+      additional IO thread running the IO processes assigned to it,
+      alongside the other IO threads
+     */
+    class IOThread : public SchedulerThread {
+    public:
+        IOThread(Scheduler &sched, uint8_t index)
+            : SchedulerThread(FUNCTOR_BIND_MEMBER(&IOThread::_io_task, void), sched)
+            , _index(index)
+        { }
+
+    private:
+        void _io_task() { _sched._run_io(_index); }
+
+        uint8_t _index;
+    };
+
     void     init_realtime();
 
     void     init_cpu_affinity();
@@ -92,8 +154,25 @@ private:
     volatile bool _in_timer_proc;
 
     AP_HAL::MemberProc _io_proc[LINUX_SCHEDULER_MAX_IO_PROCS];
+    uint8_t _io_proc_thread[LINUX_SCHEDULER_MAX_IO_PROCS] {};
     uint8_t _num_io_procs;
 
+    // number of threads running IO processes, including _io_thread
+    uint8_t _num_io_threads = 1;
+    IOThread *_extra_io_threads[LINUX_SCHEDULER_MAX_IO_THREADS-1];
+
+    struct thread_config {
+        char name[16];
+        cpu_set_t cpus;
+        int prio;
+    } _thread_config[LINUX_SCHEDULER_MAX_THREAD_CONFIG];
+    uint8_t _num_thread_config = 0;
+
+    // list of started threads. Declared ahead of the scheduler threads
+    // so that it outlives them on destruction
+    Thread *_threads = nullptr;
+    pthread_mutex_t _threads_mtx = PTHREAD_MUTEX_INITIALIZER;
+
     // calculates an integer to be used as the priority for a
     // newly-created thread
     uint8_t calculate_thread_priority(priority_base base, int8_t priority) const;
@@ -108,14 +187,16 @@ private:
     void _rcin_task();
     void _uart_task();
 
-    void _run_io();
+    void _run_io(uint8_t thread_index);
+    void _run_all_io();
     void _run_uarts();
 
     uint64_t _stopped_clock_usec;
     uint64_t _last_stack_debug_msec;
     pthread_t _main_ctx;
 
-    Semaphore _io_semaphore;
+    // held by each IO thread while it runs its IO processes
+    Semaphore _io_semaphore[LINUX_SCHEDULER_MAX_IO_THREADS];
     cpu_set_t _cpu_affinity;
 };
 
@@ -2,11 +2,12 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 
 #include "AP_HAL_Linux.h"
 
 class SerialDevice {
-public: 
+public:
     virtual ~SerialDevice() {}
 
     virtual bool open() = 0;
@@ -23,4 +24,88 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+    /*
+     * File descriptor the uart thread can wait on for both read and write
+     * readiness, or -1 if the device has to be tried on every tick. It may
+     * change while the device is open (e.g. a TCP client connecting).
+     */
+    virtual int get_fd() const { return -1; }
+
+    /*
+     * True for devices with packet boundaries. A short read from a stream
+     * device means nothing else is queued, while datagram devices return
+     * whole packets and so need to be read until EAGAIN.
+     */
+    virtual bool is_datagram() const { return false; }
+
+    /*
+     * Gather write, returning the number of bytes written. The default
+     * does one write() per segment; devices backed by a file descriptor
+     * should do it in a single system call.
+     */
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt)
+    {
+        ssize_t total = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            const ssize_t ret = write((const uint8_t *)iov[i].iov_base, iov[i].iov_len);
+            if (ret < 0) {
+                return total > 0 ? total : ret;
+            }
+            total += ret;
+            if ((size_t)ret != iov[i].iov_len) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    /*
+     * Write @count messages, keeping each one a separate packet on
+     * transports with message boundaries. Returns the number of messages
+     * sent, or -1 if none could be sent.
+     */
+    virtual int write_msgs(const struct iovec *msgs, uint8_t count)
+    {
+        int sent = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            const ssize_t ret = write((const uint8_t *)msgs[i].iov_base, msgs[i].iov_len);
+            if (ret < 0 || (size_t)ret != msgs[i].iov_len) {
+                break;
+            }
+            sent++;
+        }
+        return sent > 0 ? sent : -1;
+    }
+
+    struct Stats {
+        uint32_t rx_bytes;
+        uint32_t tx_bytes;
+        uint32_t rx_syscalls;
+        uint32_t tx_syscalls;
+    };
+
+    const Stats &get_stats() const { return _stats; }
+
+protected:
+    /* account for one read/write system call returning @ret */
+    ssize_t _account_rx(ssize_t ret)
+    {
+        _stats.rx_syscalls++;
+        if (ret > 0) {
+            _stats.rx_bytes += ret;
+        }
+        return ret;
+    }
+
+    ssize_t _account_tx(ssize_t ret)
+    {
+        _stats.tx_syscalls++;
+        if (ret > 0) {
+            _stats.tx_bytes += ret;
+        }
+        return ret;
+    }
+
+    Stats _stats {};
 };
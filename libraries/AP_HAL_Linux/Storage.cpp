@@ -208,10 +208,13 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     if (loc >= sizeof(_buffer)-(n-1)) {
         return;
     }
+    _stats.write_calls++;
+    _stats.write_bytes += n;
     if (memcmp(src, &_buffer[loc], n) != 0) {
         init();
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _stats.changed_bytes += n;
     }
 }
 
@@ -257,6 +260,9 @@ void Storage::_timer_tick(void)
             _dirty_mask |= write_mask;
             close(_fd);
             _fd = -1;
+        } else {
+            _stats.backend_writes++;
+            _stats.backend_bytes += n<<LINUX_STORAGE_LINE_SHIFT;
         }
         if (_dirty_mask == 0) {
             if (fsync(_fd) != 0) {
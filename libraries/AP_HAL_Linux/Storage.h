@@ -33,6 +33,7 @@ public:
     void write_block(uint16_t dst, const void* src, size_t n) override;
 
     bool get_storage_ptr(void *&ptr, size_t &size) override;
+    bool is_dirty(void) override { return _dirty_mask != 0; }
 
     virtual void _timer_tick(void) override;
 
@@ -3,6 +3,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
@@ -27,9 +28,25 @@ TCPServerDevice::~TCPServerDevice()
 ssize_t TCPServerDevice::write(const uint8_t *buf, uint16_t n)
 {
     if (sock == nullptr) {
+        errno = ENOTCONN;
         return -1;
     }
-    return sock->send(buf, n);
+    return _account_tx(sock->send(buf, n));
+}
+
+/*
+  send both halves of the ring buffer with a single sendmsg()
+ */
+ssize_t TCPServerDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    if (sock == nullptr) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    struct msghdr msg {};
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return _account_tx(::sendmsg(sock->get_read_fd(), &msg, MSG_NOSIGNAL | MSG_DONTWAIT));
 }
 
 /*
@@ -45,18 +62,33 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
         }
     }
     if (sock == nullptr) {
+        errno = EAGAIN;
         return -1;
     }
-    ssize_t ret = sock->recv(buf, n, 1);
+    // the uart thread only reads once epoll reports data, so don't
+    // wait in select() here
+    ssize_t ret = _account_rx(::recv(sock->get_read_fd(), buf, n, MSG_DONTWAIT));
     if (ret == 0) {
         // EOF, go back to waiting for a new connection
         delete sock;
         sock = nullptr;
+        errno = ENOTCONN;
         return -1;
     }
     return ret;
 }
 
+/*
+  poll the connected client, or the listener while waiting for one
+ */
+int TCPServerDevice::get_fd() const
+{
+    if (sock != nullptr) {
+        return sock->get_read_fd();
+    }
+    return listener.get_read_fd();
+}
+
 bool TCPServerDevice::open()
 {
     listener.reuseaddress();
@@ -18,6 +18,8 @@ public:
     virtual void set_speed(uint32_t speed) override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt) override;
+    virtual int get_fd() const override;
 
 private:
     SocketAPM_native listener{false};
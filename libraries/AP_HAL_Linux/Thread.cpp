@@ -18,6 +18,8 @@
 
 #include <alloca.h>
 #include <limits.h>
+#include <string.h>
+#include <time.h>
 #include <sys/types.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -34,6 +36,11 @@ extern const AP_HAL::HAL &hal;
 namespace Linux {
 
 
+Thread::~Thread()
+{
+    Scheduler::from(hal.scheduler)->unregister_thread(this);
+}
+
 void *Thread::_run_trampoline(void *arg)
 {
     Thread *thread = static_cast<Thread *>(arg);
@@ -164,12 +171,28 @@ bool Thread::start(const char *name, int policy, int prio)
         return false;
     }
 
+    if (name) {
+        strncpy(_name, name, sizeof(_name) - 1);
+    }
+
+    // allow the command line thread configuration to override the
+    // priority and pin the thread to a set of CPUs
+    CPU_ZERO(&_cpu_set);
+    Scheduler::from(hal.scheduler)->get_thread_config(_name, prio, _cpu_set);
+    _prio = prio;
+
     struct sched_param param = { .sched_priority = prio };
     pthread_attr_t attr;
     int r;
 
     pthread_attr_init(&attr);
 
+    if (CPU_COUNT(&_cpu_set) > 0 &&
+        (r = pthread_attr_setaffinity_np(&attr, sizeof(_cpu_set), &_cpu_set)) != 0) {
+        fprintf(stderr, "Failed to set affinity for thread '%s': %s\n",
+                _name, strerror(r));
+    }
+
     /*
       we need to run as root to get realtime scheduling. Allow it to
       run as non-root for debugging purposes, plus to allow the Replay
@@ -203,9 +226,41 @@ bool Thread::start(const char *name, int policy, int prio)
 
     _started = true;
 
+    Scheduler::from(hal.scheduler)->register_thread(this);
+
     return true;
 }
 
+/*
+  the stats are written by the thread without a lock, so copy them and
+  retry if an update started or finished during the copy
+ */
+Thread::Stats Thread::get_stats() const
+{
+    Stats ret;
+    uint32_t seq;
+    do {
+        seq = _stats_seq.load(std::memory_order_acquire);
+        ret = _stats;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1U) != 0 || seq != _stats_seq.load(std::memory_order_relaxed));
+    return ret;
+}
+
+uint64_t Thread::get_cpu_time_us() const
+{
+    clockid_t cid;
+    struct timespec ts;
+
+    if (_ctx == 0 ||
+        pthread_getcpuclockid(_ctx, &cid) != 0 ||
+        clock_gettime(cid, &ts) != 0) {
+        return 0;
+    }
+
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
 bool Thread::is_current_thread()
 {
     return pthread_equal(pthread_self(), _ctx);
@@ -259,6 +314,7 @@ bool PeriodicThread::_run()
     uint64_t next_run_usec = AP_HAL::micros64() + _period_usec;
 
     while (!_should_exit) {
+        const uint64_t scheduled_usec = next_run_usec;
         uint64_t dt = next_run_usec - AP_HAL::micros64();
         if (dt > _period_usec) {
             // we've lost sync - restart
@@ -268,7 +324,21 @@ bool PeriodicThread::_run()
         }
         next_run_usec += _period_usec;
 
+        const uint64_t start_usec = AP_HAL::micros64();
+        const uint32_t latency_usec = start_usec > scheduled_usec ? start_usec - scheduled_usec : 0;
+
         _task();
+
+        const uint32_t run_usec = AP_HAL::micros64() - start_usec;
+        const uint32_t seq = _stats_seq.load(std::memory_order_relaxed);
+        _stats_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _stats.run_count++;
+        _stats.run_time_us += run_usec;
+        _stats.run_time_max_us = MAX(_stats.run_time_max_us, run_usec);
+        _stats.latency_us += latency_usec;
+        _stats.latency_max_us = MAX(_stats.latency_max_us, latency_usec);
+        _stats_seq.store(seq + 2, std::memory_order_release);
     }
 
     _started = false;
@@ -16,7 +16,9 @@
  */
 #pragma once
 
+#include <atomic>
 #include <pthread.h>
+#include <sched.h>
 #include <inttypes.h>
 #include <stdlib.h>
 
@@ -33,8 +35,13 @@ public:
 
     Thread(task_t t) : _task(t) { }
 
-    virtual ~Thread() { }
+    virtual ~Thread();
 
+    /*
+     * Start the thread. The scheduling priority and CPU affinity may be
+     * overridden by a matching entry in the scheduler's thread
+     * configuration.
+     */
     bool start(const char *name, int policy, int prio);
 
     bool is_current_thread();
@@ -51,7 +58,36 @@ public:
 
     bool join();
 
+    const char *get_name() const { return _name; }
+
+    int get_priority() const { return _prio; }
+
+    const cpu_set_t &get_cpu_set() const { return _cpu_set; }
+
+    /*
+     * Timing statistics, updated by the thread itself. Latency is how
+     * late each wakeup of a periodic thread was relative to its
+     * schedule. get_stats() may be called from any thread and returns
+     * a consistent copy.
+     */
+    struct Stats {
+        uint64_t run_count;
+        uint64_t run_time_us;
+        uint32_t run_time_max_us;
+        uint64_t latency_us;
+        uint32_t latency_max_us;
+    };
+
+    Stats get_stats() const;
+
+    /*
+     * Total CPU time consumed by this thread, 0 if not available.
+     */
+    uint64_t get_cpu_time_us() const;
+
 protected:
+    friend class Scheduler;
+
     static void *_run_trampoline(void *arg);
 
     /*
@@ -75,6 +111,21 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+
+    char _name[16] {};
+    int _prio = 0;
+    cpu_set_t _cpu_set {};
+    Stats _stats {};
+    // odd while _stats is being updated, so readers can retry
+    std::atomic<uint32_t> _stats_seq{0};
+
+    // CPU and wall time at the last call to Scheduler::thread_info(),
+    // used to calculate load
+    uint64_t _last_info_cpu_us = 0;
+    uint64_t _last_info_us = 0;
+
+    // next thread in the scheduler's list of running threads
+    Thread *_next = nullptr;
 };
 
 class PeriodicThread : public Thread {
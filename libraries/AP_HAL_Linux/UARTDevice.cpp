@@ -2,9 +2,9 @@
 
 #include <errno.h>
 #include <fcntl.h>
-#include <poll.h>
 #include <stdio.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <asm/ioctls.h>
 #include <asm/termbits.h>
 #include <unistd.h>
@@ -50,23 +50,21 @@ bool UARTDevice::open()
 
 ssize_t UARTDevice::read(uint8_t *buf, uint16_t n)
 {
-    return ::read(_fd, buf, n);
+    return _account_rx(::read(_fd, buf, n));
 }
 
+/*
+  the port is non-blocking and the uart thread only writes once epoll
+  has reported it writable, so write directly rather than polling first
+ */
 ssize_t UARTDevice::write(const uint8_t *buf, uint16_t n)
 {
-    struct pollfd fds;
-    fds.fd = _fd;
-    fds.events = POLLOUT;
-    fds.revents = 0;
-
-    int ret = 0;
-
-    if (poll(&fds, 1, 0) == 1) {
-        ret = ::write(_fd, buf, n);
-    }
+    return _account_tx(::write(_fd, buf, n));
+}
 
-    return ret;
+ssize_t UARTDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    return _account_tx(::writev(_fd, iov, iovcnt));
 }
 
 void UARTDevice::set_blocking(bool blocking)
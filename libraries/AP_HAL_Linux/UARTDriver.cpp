@@ -6,10 +6,10 @@
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
-#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -18,6 +18,8 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
 
 #include "ConsoleDevice.h"
 #include "TCPServerDevice.h"
@@ -214,6 +216,7 @@ void UARTDriver::_end()
         hal.scheduler->delay(1);
     }
 
+    _drop_pollable();
     _device->close();
     _deallocate_buffers();
 }
@@ -300,24 +303,56 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
 }
 
 /*
-  try writing n bytes, handling an unresponsive port
+  allow for delayed connection. This allows ArduPilot to start
+  before a network interface is available.
  */
-int UARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
+bool UARTDriver::_device_connect()
 {
-    /*
-      allow for delayed connection. This allows ArduPilot to start
-      before a network interface is available.
-     */
     if (!_connected) {
         _connected = _device->open();
+        if (_connected) {
+            _device->set_blocking(false);
+        }
     }
-    if (!_connected) {
+    return _connected;
+}
+
+/*
+  try writing n bytes, handling an unresponsive port
+ */
+int UARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
+{
+    if (!_device_connect()) {
         return 0;
     }
 
     return _device->write(buf, n);
 }
 
+/*
+  try writing a gather list with one call to the device
+ */
+int UARTDriver::_writev_fd(const struct iovec *iov, int iovcnt)
+{
+    if (!_device_connect()) {
+        return 0;
+    }
+
+    return _device->writev(iov, iovcnt);
+}
+
+/*
+  try writing a batch of packets, returning the number sent
+ */
+int UARTDriver::_write_msgs_fd(const struct iovec *msgs, uint8_t count)
+{
+    if (!_device_connect()) {
+        return 0;
+    }
+
+    return _device->write_msgs(msgs, count);
+}
+
 /*
   try reading n bytes, handling an unresponsive port
  */
@@ -326,6 +361,66 @@ int UARTDriver::_read_fd(uint8_t *buf, uint16_t n)
     return _device->read(buf, n);
 }
 
+/*
+  the poller shared by all UARTs, driven from the uart thread
+ */
+Poller &UARTDriver::_device_poller()
+{
+    static Poller poller;
+    return poller;
+}
+
+void UARTDriver::poll_devices(void)
+{
+    _device_poller().poll(0);
+}
+
+/*
+  keep the device descriptor registered with the poller. The
+  descriptor can change while connected, e.g. when a TCP client
+  connects or goes away
+ */
+void UARTDriver::_update_pollable()
+{
+    const int fd = _connected ? _device->get_fd() : -1;
+    if (fd == _pollable.get_fd()) {
+        return;
+    }
+    _drop_pollable();
+    if (fd < 0) {
+        return;
+    }
+    _pollable.set_fd(fd);
+    if (!_device_poller().register_pollable(&_pollable, EPOLLIN | EPOLLOUT | EPOLLET)) {
+        // fall back to trying the device on every tick
+        _pollable.set_fd(-1);
+    }
+}
+
+void UARTDriver::_drop_pollable()
+{
+    if (_pollable.get_fd() >= 0) {
+        _device_poller().unregister_pollable(&_pollable);
+        _pollable.set_fd(-1);
+    }
+    // without a registered descriptor the device is tried on every tick
+    _pollable.readable = true;
+    _pollable.writable = true;
+}
+
+/*
+  return true if a read or write result means the device is drained
+  or full, so the next attempt should wait for epoll to report it
+  ready again. Only EAGAIN and short transfers on stream devices
+  count; other errors have no matching readiness edge
+ */
+static bool would_block(ssize_t ret, size_t requested, bool stream)
+{
+    if (ret < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return stream && (size_t)ret < requested;
+}
 
 /*
   try to push out one lump of pending bytes
@@ -337,39 +432,58 @@ bool UARTDriver::_write_pending_bytes(void)
     uint32_t available_bytes = _writebuf.available();
     uint16_t n = available_bytes;
 
-#if HAL_GCS_ENABLED
-    if (_packetise && n > 0) {
-        // send on MAVLink packet boundaries if possible
-        n = mavlink_packetise(_writebuf, n);
+    if (n == 0) {
+        return false;
     }
-#endif
 
-    if (n > 0) {
-        int ret;
+    const bool polled = _pollable.get_fd() >= 0;
 
-        if (_packetise) {
-            // keep as a single UDP packet
-            uint8_t tmpbuf[n];
-            _writebuf.peekbytes(tmpbuf, n);
-            ret = _write_fd(tmpbuf, n);
-            if (ret > 0)
-                _writebuf.advance(ret);
-        } else {
-            ByteBuffer::IoVec vec[2];
-            const auto n_vec = _writebuf.peekiovec(vec, n);
-            for (int i = 0; i < n_vec; i++) {
-                ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
-                if (ret < 0) {
-                    break;
-                }
-                _writebuf.advance(ret);
-
-                /* We wrote less than we asked for, stop */
-                if ((unsigned)ret != vec[i].len) {
-                    break;
-                }
+#if HAL_GCS_ENABLED
+    if (_packetise) {
+        // send a batch of MAVLink packets, each in its own UDP packet
+        const uint8_t max_msgs = 8;
+        struct iovec msgs[max_msgs];
+        uint8_t tmpbuf[max_msgs * 280];
+        uint16_t len = 0;
+        uint8_t count = 0;
+        while (count < max_msgs && len < n) {
+            const uint16_t pkt_len = mavlink_packetise(_writebuf, n - len, len);
+            if (pkt_len == 0 || len + pkt_len > sizeof(tmpbuf)) {
+                break;
             }
+            msgs[count].iov_base = &tmpbuf[len];
+            msgs[count].iov_len = pkt_len;
+            len += pkt_len;
+            count++;
+        }
+        if (count == 0) {
+            return false;
+        }
+        _writebuf.peekbytes(tmpbuf, len);
+        const int sent = _write_msgs_fd(msgs, count);
+        if (polled && would_block(sent, count, false)) {
+            _pollable.writable = false;
         }
+        for (int i = 0; i < sent; i++) {
+            _writebuf.advance(msgs[i].iov_len);
+        }
+        return _writebuf.available() != available_bytes;
+    }
+#endif
+
+    ByteBuffer::IoVec vec[2];
+    struct iovec iov[2];
+    const auto n_vec = _writebuf.peekiovec(vec, n);
+    for (int i = 0; i < n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+    const int ret = _writev_fd(iov, n_vec);
+    if (polled && would_block(ret, n, !_device->is_datagram())) {
+        _pollable.writable = false;
+    }
+    if (ret > 0) {
+        _writebuf.advance(ret);
     }
 
     return _writebuf.available() != available_bytes;
@@ -378,7 +492,9 @@ bool UARTDriver::_write_pending_bytes(void)
 /*
   push any pending bytes to/from the serial port. This is called at
   1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  overhead in the main task enormously. Devices registered with the
+  poller are only touched once epoll has reported them ready, so idle
+  links cost no system calls at all.
  */
 void UARTDriver::_timer_tick(void)
 {
@@ -386,9 +502,20 @@ void UARTDriver::_timer_tick(void)
 
     _in_timer = true;
 
-    uint8_t num_send = 10;
-    while (num_send != 0 && _write_pending_bytes()) {
-        num_send--;
+    _update_pollable();
+
+    const bool polled = _pollable.get_fd() >= 0;
+
+    if (_pollable.writable) {
+        uint8_t num_send = 10;
+        while (num_send != 0 && _pollable.writable && _write_pending_bytes()) {
+            num_send--;
+        }
+    }
+
+    if (!_pollable.readable) {
+        _in_timer = false;
+        return;
     }
 
     // try to fill the read buffer
@@ -398,6 +525,9 @@ void UARTDriver::_timer_tick(void)
     const auto n_vec = _readbuf.reserve(vec, _readbuf.space());
     for (int i = 0; i < n_vec; i++) {
         ret = _read_fd(vec[i].data, vec[i].len);
+        if (polled && would_block(ret, vec[i].len, !_device->is_datagram())) {
+            _pollable.readable = false;
+        }
         if (ret < 0) {
             break;
         }
@@ -451,3 +581,37 @@ uint32_t UARTDriver::bw_in_bytes_per_second() const
     const uint32_t bitrate = (_connected && _ip != nullptr) ? 10E6 : _baudrate;
     return bitrate/10; // convert bits to bytes minus overhead
 }
+
+#if HAL_UART_STATS_ENABLED
+uint32_t UARTDriver::get_total_tx_bytes() const
+{
+    return _device->get_stats().tx_bytes;
+}
+
+uint32_t UARTDriver::get_total_rx_bytes() const
+{
+    return _device->get_stats().rx_bytes;
+}
+
+// request information on uart I/O for @SYS/uarts.txt for this uart
+void UARTDriver::uart_info(ExpandingString &str, StatsTracker &stats, const uint32_t dt_ms)
+{
+    const SerialDevice::Stats &dev_stats = _device->get_stats();
+    const uint32_t tx_bytes = stats.tx.update(dev_stats.tx_bytes);
+    const uint32_t rx_bytes = stats.rx.update(dev_stats.rx_bytes);
+    const uint32_t tx_calls = _syscall_stats.tx.update(dev_stats.tx_syscalls);
+    const uint32_t rx_calls = _syscall_stats.rx.update(dev_stats.rx_syscalls);
+    const uint32_t dt = MAX(dt_ms, 1U);
+
+    str.printf("TX=%8u RX=%8u TXBD=%6u RXBD=%6u TXSC=%5u RXSC=%5u %s%s (%s)\n",
+               unsigned(tx_bytes),
+               unsigned(rx_bytes),
+               unsigned((tx_bytes * 10000) / dt),
+               unsigned((rx_bytes * 10000) / dt),
+               unsigned((tx_calls * 1000) / dt),
+               unsigned((rx_calls * 1000) / dt),
+               _connected ? "connected    " : "not connected",
+               _pollable.get_fd() >= 0 ? " epoll" : "",
+               device_path != nullptr ? device_path : "console");
+}
+#endif // HAL_UART_STATS_ENABLED
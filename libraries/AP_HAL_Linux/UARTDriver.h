@@ -4,6 +4,7 @@
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 #include "Semaphores.h"
 
@@ -27,6 +28,12 @@ public:
     bool _write_pending_bytes(void);
     virtual void _timer_tick(void) override;
 
+    /*
+      collect readiness for every UART device with a single
+      epoll_wait(). Called from the uart thread before the ticks
+     */
+    static void poll_devices(void);
+
     virtual enum flow_control get_flow_control(void) override
     {
         return _device->get_flow_control();
@@ -58,7 +65,37 @@ public:
 
     virtual uint32_t get_baud_rate() const override { return _baudrate; }
 
+#if HAL_UART_STATS_ENABLED
+    // request information on uart I/O for @SYS/uarts.txt for this uart
+    void uart_info(ExpandingString &str, StatsTracker &stats, const uint32_t dt_ms) override;
+#endif
+
 private:
+    /*
+      edge-triggered readiness of the device file descriptor. The
+      flags are set by poll_devices() and cleared once a read or
+      write finds the device drained or full. The descriptor belongs
+      to the SerialDevice, so it must not be closed here
+     */
+    class DevicePollable : public Pollable {
+    public:
+        ~DevicePollable() { _fd = -1; }
+        void set_fd(int fd) { _fd = fd; }
+        void on_can_read() override { readable = true; }
+        void on_can_write() override { writable = true; }
+        void on_error() override { readable = writable = true; }
+        void on_hang_up() override { readable = writable = true; }
+
+        volatile bool readable = true;
+        volatile bool writable = true;
+    };
+
+    static Poller &_device_poller();
+    void _update_pollable();
+    void _drop_pollable();
+
+    DevicePollable _pollable;
+
     AP_HAL::OwnPtr<SerialDevice> _device;
     bool _console;
     volatile bool _in_timer;
@@ -78,6 +115,11 @@ private:
     uint64_t _receive_timestamp[2];
     uint8_t _receive_timestamp_idx;
 
+#if HAL_UART_STATS_ENABLED
+    // per second system call rates for uart_info()
+    StatsTracker _syscall_stats;
+#endif
+
 protected:
     const char *device_path;
     volatile bool _initialised;
@@ -88,7 +130,15 @@ protected:
     ByteBuffer _writebuf{0};
 
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
+    virtual int _writev_fd(const struct iovec *iov, int iovcnt);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
+    int _write_msgs_fd(const struct iovec *msgs, uint8_t count);
+    bool _device_connect();
+
+#if HAL_UART_STATS_ENABLED
+    uint32_t get_total_tx_bytes() const override;
+    uint32_t get_total_rx_bytes() const override;
+#endif
 
     Linux::Semaphore _write_mutex;
 
@@ -1,10 +1,19 @@
 #include "UDPDevice.h"
 
+#include <arpa/inet.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+// packets per recvmmsg()/sendmmsg() call
+static const uint8_t UDP_MAX_BATCH = 8;
+// receive slot per packet, an ethernet MTU
+static const uint16_t UDP_SLOT_SIZE = 1500;
 
 UDPDevice::UDPDevice(const char *ip, uint16_t port, bool bcast, bool input):
     _ip(ip),
@@ -12,6 +21,9 @@ UDPDevice::UDPDevice(const char *ip, uint16_t port, bool bcast, bool input):
     _bcast(bcast),
     _input(input)
 {
+    // multicast receives on a separate socket and relies on SocketAPM
+    // to filter out our own packets, so it can't use the batched path
+    _multicast = (SocketAPM_native::inet_str_to_addr(_ip) & 0xF0000000U) == 0xE0000000U;
 }
 
 UDPDevice::~UDPDevice()
@@ -20,31 +32,102 @@ UDPDevice::~UDPDevice()
 
 ssize_t UDPDevice::write(const uint8_t *buf, uint16_t n)
 {
-    if (!socket.pollout(0)) {
-        return -1;
-    }
     if (_connected) {
-        return socket.send(buf, n);
+        return _account_tx(socket.send(buf, n));
     }
     if (_input) {
         // can't send yet
+        errno = ENOTCONN;
         return -1;
     }
-    return socket.sendto(buf, n, _ip, _port);
+    return _account_tx(socket.sendto(buf, n, _ip, _port));
 }
 
-ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
+/*
+  send a batch of packets with one sendmmsg() call
+ */
+int UDPDevice::write_msgs(const struct iovec *msgs, uint8_t count)
 {
-    ssize_t ret = socket.recv(buf, n, 0);
-    if (!_connected && ret > 0) {
-        const char *ip;
-        uint16_t port;
-        socket.last_recv_address(ip, port);
-        _connected = socket.connect(ip, port);
+    if (!_connected || _multicast) {
+        return SerialDevice::write_msgs(msgs, count);
+    }
+    struct mmsghdr hdrs[UDP_MAX_BATCH] {};
+    count = MIN(count, UDP_MAX_BATCH);
+    for (uint8_t i = 0; i < count; i++) {
+        hdrs[i].msg_hdr.msg_iov = const_cast<struct iovec *>(&msgs[i]);
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int ret = ::sendmmsg(socket.get_read_fd(), hdrs, count, MSG_NOSIGNAL | MSG_DONTWAIT);
+    _stats.tx_syscalls++;
+    for (int i = 0; i < ret; i++) {
+        _stats.tx_bytes += hdrs[i].msg_len;
     }
     return ret;
 }
 
+/*
+  receive as many packets as fit in buf with one recvmmsg() call. Each
+  packet lands in its own slot of the buffer and is then moved down so
+  the result is contiguous. Packets larger than a slot are truncated,
+  which is far above the largest MAVLink packet
+ */
+ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
+{
+    const uint8_t nslots = MIN(n / UDP_SLOT_SIZE, (int)UDP_MAX_BATCH);
+    if (_multicast || nslots < 2) {
+        ssize_t ret = _account_rx(socket.recv(buf, n, 0));
+        if (!_connected && ret > 0) {
+            const char *ip;
+            uint16_t port;
+            socket.last_recv_address(ip, port);
+            _connected = socket.connect(ip, port);
+        }
+        return ret;
+    }
+
+    struct mmsghdr hdrs[UDP_MAX_BATCH] {};
+    struct iovec iov[UDP_MAX_BATCH];
+    struct sockaddr_in from {};
+    for (uint8_t i = 0; i < nslots; i++) {
+        iov[i].iov_base = &buf[i * UDP_SLOT_SIZE];
+        iov[i].iov_len = UDP_SLOT_SIZE;
+        hdrs[i].msg_hdr.msg_iov = &iov[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    // only the first sender is needed, to connect to it
+    hdrs[0].msg_hdr.msg_name = &from;
+    hdrs[0].msg_hdr.msg_namelen = sizeof(from);
+
+    const int count = ::recvmmsg(socket.get_read_fd(), hdrs, nslots, MSG_DONTWAIT, nullptr);
+    _stats.rx_syscalls++;
+    if (count <= 0) {
+        return count;
+    }
+
+    ssize_t total = 0;
+    for (int i = 0; i < count; i++) {
+        const uint32_t len = MIN(hdrs[i].msg_len, (uint32_t)UDP_SLOT_SIZE);
+        if (total != (ssize_t)(i * UDP_SLOT_SIZE)) {
+            memmove(&buf[total], &buf[i * UDP_SLOT_SIZE], len);
+        }
+        total += len;
+    }
+    _stats.rx_bytes += total;
+
+    if (!_connected) {
+        char ip[INET_ADDRSTRLEN];
+        if (SocketAPM_native::inet_addr_to_str(ntohl(from.sin_addr.s_addr), ip, sizeof(ip)) != nullptr) {
+            _connected = socket.connect(ip, ntohs(from.sin_port));
+        }
+    }
+    return total;
+}
+
+int UDPDevice::get_fd() const
+{
+    return socket.get_read_fd();
+}
+
 bool UDPDevice::open()
 {
     if (_input) {
@@ -14,6 +14,10 @@ public:
     virtual void set_speed(uint32_t speed) override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual int write_msgs(const struct iovec *msgs, uint8_t count) override;
+    virtual int get_fd() const override;
+    virtual bool is_datagram() const override { return true; }
+
 private:
     SocketAPM_native socket{true};
     const char *_ip;
@@ -21,4 +25,5 @@ private:
     bool _bcast;
     bool _input;
     bool _connected = false;
+    bool _multicast;
 };
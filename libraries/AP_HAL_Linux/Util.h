@@ -102,6 +102,17 @@ public:
     // fills data with random values of requested size
     bool get_random_vals(uint8_t* data, size_t size) override;
 
+    // display thread statistics for @SYS/threads.txt
+    void thread_info(ExpandingString &str) override;
+
+    // request information on SPI bus transfers
+    void spi_info(ExpandingString &str) override;
+
+#if HAL_UART_STATS_ENABLED
+    // request information on uart I/O
+    void uart_info(ExpandingString &str) override;
+#endif
+
 private:
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_DISCO
     static ToneAlarm_Disco _toneAlarm;
@@ -117,6 +128,15 @@ private:
     const char *custom_defaults = HAL_PARAM_DEFAULTS_PATH;
     static const char *_hw_names[UTIL_NUM_HARDWARES];
 
+#if HAL_UART_STATS_ENABLED
+    // UART stats tracking helper
+    struct uart_stats {
+        AP_HAL::UARTDriver::StatsTracker serial[AP_HAL::HAL::num_serial];
+        uint32_t last_ms;
+    };
+    uart_stats sys_uart_stats;
+#endif
+
 #ifdef ENABLE_HEAP
     struct heap_allocation_header {
         size_t allocation_size; // size of allocated block, not including this header
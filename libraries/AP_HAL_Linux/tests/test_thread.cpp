@@ -22,6 +22,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_HAL_Linux/Thread.h>
 #include <AP_HAL_Linux/PollerThread.h>
+#include <AP_HAL_Linux/Scheduler.h>
 
 using namespace Linux;
 
@@ -117,4 +118,71 @@ TEST(LinuxThread, periodic_thread)
     EXPECT_TRUE(thr.join());
 }
 
+TEST(LinuxThread, periodic_thread_stats)
+{
+    TestPeriodicThread1 thr;
+    EXPECT_TRUE(thr.set_rate(1000));
+    EXPECT_TRUE(thr.start("test-periodic", 0, 0));
+
+    while (!thr.is_started()) {
+        usleep(1000);
+    }
+
+    usleep(20000);
+
+    EXPECT_TRUE(thr.stop());
+    EXPECT_TRUE(thr.join());
+
+    EXPECT_STREQ(thr.get_name(), "test-periodic");
+    EXPECT_GT(thr.get_stats().run_count, 0U);
+    EXPECT_GE(thr.get_stats().latency_us, thr.get_stats().latency_max_us);
+}
+
+TEST(LinuxScheduler, thread_config)
+{
+    Scheduler sched;
+    EXPECT_TRUE(sched.add_thread_config("ap-io=1-2:8"));
+    EXPECT_TRUE(sched.add_thread_config("log_io=3"));
+    EXPECT_FALSE(sched.add_thread_config("=3"));
+    EXPECT_FALSE(sched.add_thread_config("ftp=1:0"));
+    EXPECT_FALSE(sched.add_thread_config("ftp"));
+
+    int prio = 10;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    sched.get_thread_config("ap-io", prio, cpus);
+    EXPECT_EQ(prio, 8);
+    EXPECT_EQ(CPU_COUNT(&cpus), 2);
+    EXPECT_TRUE(CPU_ISSET(1, &cpus));
+    EXPECT_TRUE(CPU_ISSET(2, &cpus));
+
+    prio = 10;
+    CPU_ZERO(&cpus);
+    sched.get_thread_config("log_io", prio, cpus);
+    EXPECT_EQ(prio, 10);
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+    EXPECT_TRUE(CPU_ISSET(3, &cpus));
+
+    prio = 10;
+    CPU_ZERO(&cpus);
+    sched.get_thread_config("ap-timer", prio, cpus);
+    EXPECT_EQ(prio, 10);
+    EXPECT_EQ(CPU_COUNT(&cpus), 0);
+}
+
+TEST(LinuxScheduler, assign_io_process)
+{
+    Scheduler sched;
+    EXPECT_TRUE(sched.assign_io_process("3=1"));
+    EXPECT_TRUE(sched.assign_io_process("0=0"));
+    EXPECT_TRUE(sched.assign_io_process("9=3"));
+    EXPECT_FALSE(sched.assign_io_process("10=1"));
+    EXPECT_FALSE(sched.assign_io_process("3=4"));
+    EXPECT_FALSE(sched.assign_io_process("-1=1"));
+    EXPECT_FALSE(sched.assign_io_process("3=1x"));
+    EXPECT_FALSE(sched.assign_io_process("3="));
+    EXPECT_FALSE(sched.assign_io_process("=1"));
+    EXPECT_FALSE(sched.assign_io_process("3"));
+}
+
 AP_GTEST_MAIN()
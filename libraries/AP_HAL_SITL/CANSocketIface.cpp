@@ -140,23 +140,34 @@ void CANIface::_pollWrite()
     }
     while (_hasReadyTx()) {
         WITH_SEMAPHORE(sem);
-        const CanTxItem tx = *_tx_queue[0];
         const uint64_t curr_time = AP_HAL::micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            bool ok = transport->send(tx.frame);
-            if (ok) {
-                stats.tx_success++;
-                stats.last_transmit_us = curr_time;
-            } else {
-                break;
-            }
-        } else {
+        if (_tx_queue[0]->deadline < curr_time) {
             stats.tx_timedout++;
+            IGNORE_RETURN(_tx_queue.pop());
+            continue;
         }
 
-        // Removing the frame from the queue
-        IGNORE_RETURN(_tx_queue.pop());
+        // hand the run of unexpired frames at the head of the queue to
+        // the transport in one go
+        AP_HAL::CANFrame frames[CAN_Transport::BATCH_SIZE];
+        uint16_t count = 0;
+        while (count < ARRAY_SIZE(frames) && count < _tx_queue.available() &&
+               _tx_queue[count]->deadline >= curr_time) {
+            frames[count] = _tx_queue[count]->frame;
+            count++;
+        }
+        const uint16_t sent = transport->send_batch(frames, count);
+        for (uint16_t i = 0; i < sent; i++) {
+            // Removing the frame from the queue
+            IGNORE_RETURN(_tx_queue.pop());
+        }
+        if (sent > 0) {
+            stats.tx_success += sent;
+            stats.last_transmit_us = curr_time;
+        }
+        if (sent < count) {
+            break;
+        }
     }
 }
 
@@ -165,15 +176,22 @@ bool CANIface::_pollRead()
     if (transport == nullptr) {
         return false;
     }
-    CanRxItem rx {};
-    bool ok = transport->receive(rx.frame);
-    if (!ok) {
+    WITH_SEMAPHORE(sem);
+    // only take what the queue can hold, leaving the rest waiting in
+    // the transport
+    AP_HAL::CANFrame frames[CAN_Transport::BATCH_SIZE];
+    const uint16_t n = transport->receive_batch(frames, MIN(_rx_queue.space(), ARRAY_SIZE(frames)));
+    if (n == 0) {
         return false;
     }
-    rx.timestamp_us = AP_HAL::micros64();
-    WITH_SEMAPHORE(sem);
-    add_to_rx_queue(rx);
-    stats.rx_received++;
+    const uint64_t timestamp_us = AP_HAL::micros64();
+    for (uint16_t i = 0; i < n; i++) {
+        CanRxItem rx {};
+        rx.frame = frames[i];
+        rx.timestamp_us = timestamp_us;
+        add_to_rx_queue(rx);
+    }
+    stats.rx_received += n;
     return true;
 }
 
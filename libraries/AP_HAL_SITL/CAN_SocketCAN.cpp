@@ -10,6 +10,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <linux/can.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -92,4 +93,69 @@ bool CAN_SocketCAN::receive(AP_HAL::CANFrame &frame)
     return true;
 }
 
+/*
+  send CAN frames with one system call
+ */
+uint16_t CAN_SocketCAN::send_batch(const AP_HAL::CANFrame *frames, uint16_t count)
+{
+    struct can_frame transmit_frames[BATCH_SIZE] {};
+    struct iovec iov[BATCH_SIZE];
+    struct mmsghdr msgs[BATCH_SIZE] {};
+    uint16_t n = 0;
+    for (; n < count && n < BATCH_SIZE; n++) {
+        const AP_HAL::CANFrame &frame = frames[n];
+        if (frame.canfd) {
+            // not supported on socketcan
+            break;
+        }
+        transmit_frames[n].can_id = frame.id;
+        transmit_frames[n].can_dlc = frame.dlc;
+        memcpy(transmit_frames[n].data, frame.data, AP_HAL::CANFrame::dlcToDataLength(frame.dlc));
+        iov[n].iov_base = &transmit_frames[n];
+        iov[n].iov_len = sizeof(transmit_frames[n]);
+        msgs[n].msg_hdr.msg_iov = &iov[n];
+        msgs[n].msg_hdr.msg_iovlen = 1;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    const int ret = sendmmsg(fd, msgs, n, 0);
+    return ret > 0 ? ret : 0;
+}
+
+/*
+  receive as many waiting CAN frames as fit with one system call
+ */
+uint16_t CAN_SocketCAN::receive_batch(AP_HAL::CANFrame *frames, uint16_t max)
+{
+    struct can_frame receive_frames[BATCH_SIZE];
+    struct iovec iov[BATCH_SIZE];
+    struct mmsghdr msgs[BATCH_SIZE] {};
+    max = MIN(max, BATCH_SIZE);
+    for (uint16_t i = 0; i < max; i++) {
+        iov[i].iov_base = &receive_frames[i];
+        iov[i].iov_len = sizeof(receive_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int ret = recvmmsg(fd, msgs, max, MSG_DONTWAIT, nullptr);
+    if (ret <= 0) {
+        return 0;
+    }
+    uint16_t received = 0;
+    for (int i = 0; i < ret; i++) {
+        if (msgs[i].msg_len != sizeof(receive_frames[i])) {
+            continue;
+        }
+        const struct can_frame &f = receive_frames[i];
+        // run constructor to initialise
+        new(&frames[received++]) AP_HAL::CANFrame(f.can_id, f.data, f.can_dlc, false);
+    }
+
+    if (received > 0 && sem_handle != nullptr) {
+        sem_handle->signal();
+    }
+    return received;
+}
+
 #endif // HAL_NUM_CAN_IFACES
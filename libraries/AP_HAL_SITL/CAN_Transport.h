@@ -11,12 +11,39 @@
 
 class CAN_Transport {
 public:
+    // most frames passed to send_batch() or receive_batch() in one call
+    static constexpr uint16_t BATCH_SIZE = 16;
+
     virtual ~CAN_Transport() {}
     virtual bool init(uint8_t instance) = 0;
     virtual bool send(const AP_HAL::CANFrame &frame) = 0;
     virtual bool receive(AP_HAL::CANFrame &frame) = 0;
     virtual int get_read_fd(void) const = 0;
 
+    /*
+      send frames in order, stopping at the first that can't be
+      sent. Returns the number sent. Transports which can hand several
+      frames to the OS at once override this
+     */
+    virtual uint16_t send_batch(const AP_HAL::CANFrame *frames, uint16_t count) {
+        uint16_t sent = 0;
+        while (sent < count && send(frames[sent])) {
+            sent++;
+        }
+        return sent;
+    }
+
+    /*
+      receive up to max frames, returning the number received
+     */
+    virtual uint16_t receive_batch(AP_HAL::CANFrame *frames, uint16_t max) {
+        uint16_t received = 0;
+        while (received < max && receive(frames[received])) {
+            received++;
+        }
+        return received;
+    }
+
     void set_event_handle(AP_HAL::BinarySemaphore *handle) {
         sem_handle = handle;
     }
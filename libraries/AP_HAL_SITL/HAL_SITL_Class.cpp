@@ -242,6 +242,16 @@ void HAL_SITL::run(int argc, char * const argv[], Callbacks* callbacks) const
             // don't wipe params on reboot
             continue;
         }
+#if AP_SIM_CHECKPOINT_ENABLED
+        if (!strcmp(argv[i], "--resume")) {
+            // a reboot starts afresh from storage, not the checkpoint
+            i++;
+            continue;
+        }
+        if (!strncmp(argv[i], "--resume=", 9)) {
+            continue;
+        }
+#endif
         new_argv[new_argv_offset++] = argv[i];
     }
     
@@ -288,6 +298,9 @@ void HAL_SITL::run(int argc, char * const argv[], Callbacks* callbacks) const
         }
         callbacks->loop();
         HALSITL::Scheduler::_run_io_procs();
+#if AP_SIM_SNAPSHOT_ENABLED && !defined(HAL_BUILD_AP_PERIPH)
+        _sitl_state->snapshot_update();
+#endif
 
         uint32_t now = AP_HAL::millis();
         if (now - last_watchdog_save >= 100 && using_watchdog) {
@@ -22,7 +22,9 @@
 #include <fcntl.h>
 
 #include <AP_Param/AP_Param.h>
+#include <GCS_MAVLink/GCS.h>
 #include <SITL/SIM_JSBSim.h>
+#include <SITL/SIM_Snapshot.h>
 #include <AP_HAL/utility/Socket_native.h>
 
 extern const AP_HAL::HAL& hal;
@@ -108,6 +110,12 @@ void SITL_State::_sitl_setup()
         // start with non-zero clock
         hal.scheduler->stop_clock(1);
     }
+
+#if AP_SIM_CHECKPOINT_ENABLED
+    if (resume != nullptr) {
+        checkpoint_apply();
+    }
+#endif
 }
 
 
@@ -254,6 +262,9 @@ void SITL_State::_fdm_input_local(void)
     // update the model
     sitl_model->update_home();
     sitl_model->update_model(input);
+#if AP_SIM_CHECKPOINT_ENABLED
+    checkpoint_hold();
+#endif
 
     // get FDM output from the model
     sitl_model->fill_fdm(_sitl->state);
@@ -284,6 +295,56 @@ void SITL_State::_fdm_input_local(void)
     _update_count++;
 }
 
+#if AP_SIM_SNAPSHOT_ENABLED
+void SITL_State::snapshot_update(void)
+{
+    if (_sitl == nullptr || sitl_model == nullptr) {
+        return;
+    }
+#if AP_SIM_CHECKPOINT_ENABLED
+    checkpoint_update();
+#endif
+
+    const auto request = _sitl->snapshot_request;
+    _sitl->snapshot_request = SITL::SIM::SnapshotRequest::NONE;
+
+    switch (request) {
+    case SITL::SIM::SnapshotRequest::NONE:
+        break;
+    case SITL::SIM::SnapshotRequest::TAKE:
+        if (snapshot == nullptr) {
+            snapshot = NEW_NOTHROW SITL::Snapshot();
+        }
+        if (snapshot != nullptr && snapshot->take(*sitl_model)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "SITL: snapshot taken");
+        } else {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "SITL: snapshot failed");
+        }
+        break;
+    case SITL::SIM::SnapshotRequest::RESTORE: {
+        uint16_t changed;
+        if (hal.util->get_soft_armed()) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "SITL: snapshot restore refused, armed");
+        } else if (snapshot != nullptr && snapshot->restore(*sitl_model, changed)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "SITL: snapshot restored, %u parameters changed", unsigned(changed));
+        } else {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "SITL: snapshot restore failed");
+        }
+        break;
+    }
+#if AP_SIM_CHECKPOINT_ENABLED
+    case SITL::SIM::SnapshotRequest::CHECKPOINT:
+        if (checkpoint_save("checkpoint.dat")) {
+            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "SITL: checkpoint saved");
+        } else {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "SITL: checkpoint failed");
+        }
+        break;
+#endif
+    }
+}
+#endif  // AP_SIM_SNAPSHOT_ENABLED
+
 /*
   create sitl_input structure for sending to FDM
  */
@@ -490,16 +551,15 @@ void SITL_State::set_height_agl(void)
 #if AP_TERRAIN_AVAILABLE
     if (_sitl != nullptr &&
         _sitl->terrain_enable) {
-        // get height above terrain from AP_Terrain. This assumes
-        // AP_Terrain is working
+        // get height above terrain from the model's terrain map,
+        // falling back to AP_Terrain
         float terrain_height_amsl;
         Location location;
         location.lat = _sitl->state.latitude*1.0e7;
         location.lng = _sitl->state.longitude*1.0e7;
 
-        AP_Terrain *_terrain = AP_Terrain::get_singleton();
-        if (_terrain != nullptr &&
-            _terrain->height_amsl(location, terrain_height_amsl, false)) {
+        if (sitl_model != nullptr &&
+            sitl_model->terrain_height_amsl(location, terrain_height_amsl)) {
             _sitl->state.height_agl = _sitl->state.altitude - terrain_height_amsl;
             return;
         }
@@ -13,6 +13,10 @@
 
 class HAL_SITL;
 
+namespace SITL {
+class Snapshot;
+}
+
 class HALSITL::SITL_State : public SITL_State_Common {
     friend class HALSITL::Scheduler;
     friend class HALSITL::Util;
@@ -55,6 +59,18 @@ public:
     
     uint8_t get_instance() const { return _instance; }
 
+#if AP_SIM_SNAPSHOT_ENABLED
+    // act on snapshot requests made through SIM::snapshot_request.
+    // Called between iterations of the main loop
+    void snapshot_update(void);
+#endif
+
+#if AP_SIM_CHECKPOINT_ENABLED
+    // true if this process was started from a checkpoint, which the
+    // vehicle treats as a watchdog reset
+    bool resumed_from_checkpoint(void) const { return resume != nullptr; }
+#endif
+
 private:
     void _parse_command_line(int argc, char * const argv[]);
     void _set_param_default(const char *parm);
@@ -128,6 +144,20 @@ private:
 
     uint16_t mc_servo[SITL_NUM_CHANNELS];
     void check_servo_input(void);
+
+#if AP_SIM_SNAPSHOT_ENABLED
+    SITL::Snapshot *snapshot;
+#endif
+
+#if AP_SIM_CHECKPOINT_ENABLED
+    struct Checkpoint;
+    Checkpoint *resume;
+    bool checkpoint_save(const char *path);
+    bool checkpoint_load(const char *path);
+    void checkpoint_apply(void);
+    void checkpoint_hold(void);
+    void checkpoint_update(void);
+#endif
 };
 
 #endif // defined(HAL_BUILD_AP_PERIPH)
@@ -117,6 +117,9 @@ void SITL_State::_usage(void)
            "\t--start-time TIMESTR     set simulation start time in UNIX timestamp\n"
            "\t--sysid ID               set SYSID_THISMAV\n"
            "\t--slave number           set the number of JSON slaves\n"
+#if AP_SIM_CHECKPOINT_ENABLED
+           "\t--resume FILE            resume from a checkpoint written by a SITL of this build\n"
+#endif
         );
 }
 
@@ -277,6 +280,9 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_START_TIME,
         CMDLINE_SYSID,
         CMDLINE_SLAVE,
+#if AP_SIM_CHECKPOINT_ENABLED
+        CMDLINE_RESUME,
+#endif
 #if STORAGE_USE_FLASH
         CMDLINE_SET_STORAGE_FLASH_ENABLED,
 #endif
@@ -337,6 +343,9 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"start-time",      true,   0, CMDLINE_START_TIME},
         {"sysid",           true,   0, CMDLINE_SYSID},
         {"slave",           true,   0, CMDLINE_SLAVE},
+#if AP_SIM_CHECKPOINT_ENABLED
+        {"resume",          true,   0, CMDLINE_RESUME},
+#endif
 #if STORAGE_USE_FLASH
         {"set-storage-flash-enabled", true,   0, CMDLINE_SET_STORAGE_FLASH_ENABLED},
 #endif
@@ -531,6 +540,13 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         case CMDLINE_SET_STORAGE_FRAM_ENABLED:
             storage_fram_enabled = atoi(gopt.optarg);
             break;
+#endif
+#if AP_SIM_CHECKPOINT_ENABLED
+        case CMDLINE_RESUME:
+            if (!checkpoint_load(gopt.optarg)) {
+                exit(1);
+            }
+            break;
 #endif
         case 'h':
             _usage();
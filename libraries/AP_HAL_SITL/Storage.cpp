@@ -153,10 +153,13 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     if (loc >= sizeof(_buffer)-(n-1)) {
         return;
     }
+    _stats.write_calls++;
+    _stats.write_bytes += n;
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _stats.changed_bytes += n;
     }
 }
 
@@ -167,25 +170,43 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+#if STORAGE_USE_FLASH
+        if (_initialisedType == StorageBackend::Flash && _flash_erase_ok()) {
+            // use idle time while disarmed to checkpoint flash
+            // storage, as on real flash
+            _flash.checkpoint_step();
+        }
+#endif
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint16_t i;
-    for (i=0; i<STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask.get(i)) {
-            break;
-        }
-    }
-    if (i == STORAGE_NUM_LINES) {
+    // write out the first dirty line, along with any dirty lines
+    // following it for backends that can write a run in one go. We
+    // limit the run length to keep the latency of this call low
+    const int16_t first = _dirty_mask.first_set();
+    if (first < 0) {
         // this shouldn't be possible
         return;
     }
+    const uint16_t i = first;
+    uint16_t nlines = 1;
+    if (_initialisedType != StorageBackend::Flash) {
+        while (nlines < STORAGE_WRITE_LINES &&
+               i + nlines < STORAGE_NUM_LINES &&
+               _dirty_mask.get(i + nlines)) {
+            nlines++;
+        }
+    }
+    const uint32_t offset = STORAGE_LINE_SIZE*i;
+    const uint16_t length = STORAGE_LINE_SIZE*nlines;
 
 #if STORAGE_USE_FRAM
-        if (fram.write(STORAGE_LINE_SIZE*i, &_buffer[STORAGE_LINE_SIZE*i], STORAGE_LINE_SIZE)) {
-            _dirty_mask.clear(i);
+        if (fram.write(offset, &_buffer[offset], length)) {
+            for (uint16_t n=0; n<nlines; n++) {
+                _dirty_mask.clear(i+n);
+            }
+            _stats.backend_writes++;
+            _stats.backend_bytes += length;
             return;
         }
 #endif
@@ -193,14 +214,14 @@ void Storage::_timer_tick(void)
 #if STORAGE_USE_POSIX
     if (hal.get_storage_posix_enabled()) {
         if (log_fd != -1) {
-            const off_t offset = STORAGE_LINE_SIZE*i;
-            if (lseek(log_fd, offset, SEEK_SET) != offset) {
+            if (pwrite(log_fd, &_buffer[offset], length, offset) != (ssize_t)length) {
                 return;
             }
-            if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE) != STORAGE_LINE_SIZE) {
-                return;
+            for (uint16_t n=0; n<nlines; n++) {
+                _dirty_mask.clear(i+n);
             }
-            _dirty_mask.clear(i);
+            _stats.backend_writes++;
+            _stats.backend_bytes += length;
             return;
         }
     }
@@ -334,6 +355,10 @@ bool Storage::_flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *
 {
     size_t base_address = sitl_flash_getpageaddr(sector);
     bool ret = sitl_flash_write(base_address+offset, data, length);
+    if (ret) {
+        _stats.backend_writes++;
+        _stats.backend_bytes += length;
+    }
     if (!ret && _flash_erase_ok()) {
         // we are getting flash write errors while disarmed. Try
         // re-writing all of flash
@@ -362,7 +387,11 @@ bool Storage::_flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, u
  */
 bool Storage::_flash_erase_sector(uint8_t sector)
 {
-    return sitl_flash_erasepage(sector);
+    if (!sitl_flash_erasepage(sector)) {
+        return false;
+    }
+    _stats.erases++;
+    return true;
 }
 
 /*
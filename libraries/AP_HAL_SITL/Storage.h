@@ -23,6 +23,13 @@
 #define STORAGE_LINE_SIZE (1<<STORAGE_LINE_SHIFT)
 #define STORAGE_NUM_LINES (HAL_STORAGE_SIZE/STORAGE_LINE_SIZE)
 
+// FRAM and POSIX writes cover runs of contiguous dirty lines up to
+// this many bytes
+#ifndef STORAGE_MAX_WRITE
+#define STORAGE_MAX_WRITE 128
+#endif
+#define STORAGE_WRITE_LINES (STORAGE_MAX_WRITE > STORAGE_LINE_SIZE ? STORAGE_MAX_WRITE/STORAGE_LINE_SIZE : 1)
+
 class HALSITL::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -32,6 +39,7 @@ public:
 
     void _timer_tick(void) override;
     bool healthy(void) override;
+    bool is_dirty(void) override { return !_dirty_mask.empty(); }
 
 private:
     enum class StorageBackend: uint8_t {
@@ -6,6 +6,7 @@
 #include "Semaphores.h"
 #include "ToneAlarm_SF.h"
 #include <AP_Logger/AP_Logger_config.h>
+#include <SITL/SIM_config.h>
 
 #if !defined(__CYGWIN__) && !defined(__CYGWIN64__)
 #include <sys/types.h>
@@ -61,7 +62,14 @@ public:
 #endif
 
     // return true if the reason for the reboot was a watchdog reset
-    bool was_watchdog_reset() const override { return getenv("SITL_WATCHDOG_RESET") != nullptr; }
+    bool was_watchdog_reset() const override {
+#if AP_SIM_CHECKPOINT_ENABLED && !defined(HAL_BUILD_AP_PERIPH)
+        if (sitlState->resumed_from_checkpoint()) {
+            return true;
+        }
+#endif
+        return getenv("SITL_WATCHDOG_RESET") != nullptr;
+    }
 
 #if !defined(HAL_BUILD_AP_PERIPH)
     enum safety_state safety_switch_state(void) override;
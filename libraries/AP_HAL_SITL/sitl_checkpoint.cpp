@@ -0,0 +1,267 @@
+/*
+  SITL checkpoints
+
+  A checkpoint holds enough of a running simulation to start a new
+  SITL process from it in flight: simulation time, the rigid body
+  state of the model, the whole of storage (parameters, mission,
+  fence and rally points), the watchdog persistent data (home,
+  attitude, armed state and current waypoint) and the flight mode.
+
+  The new process boots as though it had suffered a watchdog reset at
+  the checkpoint time, which is the path the vehicle code already has
+  for carrying on with a flight after a reboot. The estimators start
+  again from scratch rather than from a copy of their state, so the
+  model is flown along a straight line at its checkpointed velocity
+  until the AHRS has a position; the vehicle is then re-armed, put
+  back in its mode and the model let go. As the simulation is
+  deterministic, every resume from the same checkpoint flies the same
+  way.
+
+  A checkpoint can only be resumed by the build which wrote it.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL && !defined(HAL_BUILD_AP_PERIPH)
+
+#include "AP_HAL_SITL.h"
+#include "AP_HAL_SITL_Namespace.h"
+#include "HAL_SITL_Class.h"
+#include "SITL_State.h"
+
+#if AP_SIM_CHECKPOINT_ENABLED
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Arming/AP_Arming.h>
+#include <AP_Mission/AP_Mission.h>
+#include <AP_Vehicle/AP_Vehicle.h>
+#include <GCS_MAVLink/GCS.h>
+#include <SITL/SITL.h>
+
+extern const AP_HAL::HAL& hal;
+
+using namespace HALSITL;
+
+#define CHECKPOINT_MAGIC 0x4B435053     // "SPCK"
+#define CHECKPOINT_VERSION 1
+
+// give up waiting for the AHRS after this long and let go anyway
+#define CHECKPOINT_HOLD_TIMEOUT_US 60000000ULL
+
+struct PACKED CheckpointHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t storage_size;
+};
+
+// written to the file as is, which is why only the same build can
+// read it back
+struct CheckpointRecord {
+    uint64_t time_us;
+    Location home;
+    float home_yaw;
+    SITL::Aircraft::KinematicState physics;
+    AP_HAL::Util::PersistentData persistent;
+    uint8_t mode;
+};
+
+struct SITL_State::Checkpoint {
+    CheckpointRecord record;
+    uint8_t storage[HAL_STORAGE_SIZE];
+    bool holding;
+    bool released;
+};
+
+static bool write_all(int fd, const void *buf, size_t n)
+{
+    return ::write(fd, buf, n) == ssize_t(n);
+}
+
+static bool read_all(int fd, void *buf, size_t n)
+{
+    return ::read(fd, buf, n) == ssize_t(n);
+}
+
+/*
+  write the current state to path. The file is written alongside and
+  renamed into place so a reader never sees half a checkpoint
+ */
+bool SITL_State::checkpoint_save(const char *path)
+{
+    Checkpoint *cp = NEW_NOTHROW Checkpoint;
+    if (cp == nullptr) {
+        return false;
+    }
+    CheckpointRecord &rec = cp->record;
+    rec.time_us = sitl_model->get_time_us();
+    rec.home = sitl_model->get_home();
+    rec.home_yaw = sitl_model->get_home_yaw();
+    sitl_model->get_kinematic_state(rec.physics);
+    rec.persistent = hal.util->persistent_data;
+    rec.mode = AP::vehicle()->get_mode();
+    hal.storage->read_block(cp->storage, 0, sizeof(cp->storage));
+
+    CheckpointHeader hdr;
+    hdr.magic = CHECKPOINT_MAGIC;
+    hdr.version = CHECKPOINT_VERSION;
+    hdr.record_size = sizeof(CheckpointRecord);
+    hdr.storage_size = sizeof(cp->storage);
+
+    char *tmp_path = nullptr;
+    if (asprintf(&tmp_path, "%s.tmp", path) <= 0) {
+        delete cp;
+        return false;
+    }
+    bool ret = false;
+    const int fd = ::open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+    if (fd != -1) {
+        ret = write_all(fd, &hdr, sizeof(hdr)) &&
+            write_all(fd, &rec, sizeof(rec)) &&
+            write_all(fd, cp->storage, sizeof(cp->storage));
+        ret = (::close(fd) == 0) && ret;
+        ret = ret && ::rename(tmp_path, path) == 0;
+        if (!ret) {
+            ::unlink(tmp_path);
+        }
+    }
+    free(tmp_path);
+    delete cp;
+    return ret;
+}
+
+/*
+  read a checkpoint given with --resume. Nothing is applied until
+  _sitl_setup(), after the model has been created
+ */
+bool SITL_State::checkpoint_load(const char *path)
+{
+    const int fd = ::open(path, O_RDONLY|O_CLOEXEC);
+    if (fd == -1) {
+        ::printf("Failed to open checkpoint %s\n", path);
+        return false;
+    }
+    CheckpointHeader hdr;
+    Checkpoint *cp = NEW_NOTHROW Checkpoint;
+    bool ret = cp != nullptr && read_all(fd, &hdr, sizeof(hdr));
+    if (ret && (hdr.magic != CHECKPOINT_MAGIC ||
+                hdr.version != CHECKPOINT_VERSION ||
+                hdr.record_size != sizeof(CheckpointRecord) ||
+                hdr.storage_size != sizeof(cp->storage))) {
+        ::printf("Checkpoint %s is not from this build\n", path);
+        ret = false;
+    } else if (ret) {
+        ret = read_all(fd, &cp->record, sizeof(cp->record)) &&
+            read_all(fd, cp->storage, sizeof(cp->storage));
+        if (!ret) {
+            ::printf("Checkpoint %s is truncated\n", path);
+        }
+    }
+    ::close(fd);
+    if (!ret) {
+        delete cp;
+        return false;
+    }
+    resume = cp;
+    return true;
+}
+
+/*
+  put the simulation back at the checkpoint time, before the vehicle
+  code is set up
+ */
+void SITL_State::checkpoint_apply(void)
+{
+    const CheckpointRecord &rec = resume->record;
+
+    hal.scheduler->stop_clock(rec.time_us);
+    sitl_model->set_time_us(rec.time_us);
+    sitl_model->set_start_location(rec.home, rec.home_yaw);
+
+    hal.storage->write_block(0, resume->storage, sizeof(resume->storage));
+
+    hal.util->persistent_data = rec.persistent;
+    hal.util->last_persistent_data = rec.persistent;
+
+    resume->holding = true;
+
+    ::printf("Resuming from checkpoint at %.3fs\n", rec.time_us*1.0e-6);
+}
+
+/*
+  while waiting for the vehicle to pick itself up, fly the model along
+  a straight line from where it was at its checkpointed velocity
+ */
+void SITL_State::checkpoint_hold(void)
+{
+    if (resume == nullptr || !resume->holding) {
+        return;
+    }
+    const CheckpointRecord &rec = resume->record;
+    const float dt = (sitl_model->get_time_us() - rec.time_us) * 1.0e-6f;
+
+    SITL::Aircraft::KinematicState state = rec.physics;
+    state.position += (state.velocity_ef * dt).todouble();
+    state.location = state.origin;
+    state.location.offset(state.position.x, state.position.y);
+    state.location.alt = static_cast<int32_t>(rec.home.alt - state.position.z * 100.0f);
+    state.gyro.zero();
+    state.accel_body = state.dcm.transposed() * Vector3f(0, 0, -GRAVITY_MSS);
+
+    sitl_model->set_kinematic_state(state);
+}
+
+/*
+  once the AHRS knows where the vehicle is, arm it again if it was
+  armed, restore the flight mode and mission position and let go of
+  the model. Called between iterations of the main loop
+ */
+void SITL_State::checkpoint_update(void)
+{
+    if (resume == nullptr || resume->released) {
+        return;
+    }
+    const CheckpointRecord &rec = resume->record;
+
+    Location loc;
+    const bool ahrs_ready = AP::ahrs().healthy() && AP::ahrs().get_location(loc);
+    if (!ahrs_ready) {
+        if (sitl_model->get_time_us() - rec.time_us < CHECKPOINT_HOLD_TIMEOUT_US) {
+            return;
+        }
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "SITL: resume timed out waiting for AHRS");
+    }
+
+    if (rec.persistent.armed && !hal.util->get_soft_armed()) {
+        if (!AP::arming().arm(AP_Arming::Method::UNKNOWN, false)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "SITL: resume failed to arm");
+        }
+    }
+    if (!AP::vehicle()->set_mode(rec.mode, ModeReason::UNKNOWN)) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "SITL: resume failed to set mode %u", unsigned(rec.mode));
+    }
+
+#if AP_MISSION_ENABLED
+    // vehicles without watchdog mission recovery of their own start
+    // the mission from its beginning
+    AP_Mission *mission = AP::mission();
+    const uint16_t wp = rec.persistent.waypoint_num;
+    if (mission != nullptr && wp != 0 &&
+        mission->state() == AP_Mission::MISSION_RUNNING &&
+        mission->get_current_nav_index() != wp) {
+        mission->set_current_cmd(wp);
+    }
+#endif
+
+    resume->holding = false;
+    resume->released = true;
+    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "SITL: resumed from checkpoint");
+}
+
+#endif  // AP_SIM_CHECKPOINT_ENABLED
+
+#endif  // CONFIG_HAL_BOARD == HAL_BOARD_SITL && !defined(HAL_BUILD_AP_PERIPH)
@@ -726,8 +726,17 @@ void AP_InertialSensor_Invensense::_read_fifo()
     uint16_t bytes_read;
     uint8_t *rx = _fifo_buffer;
     bool need_reset = false;
+    uint8_t y_ofs = _saved_y_ofs_high;
 
-    if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
+    /*
+      read the ICM20602 Y offset along with the FIFO count, so buses
+      which can queue transfers do both at once
+     */
+    if (_mpu_type == Invensense_ICM20602) {
+        _dev->queue_read_registers(MPUREG_ACC_OFF_Y_H, &y_ofs, 1);
+    }
+    if (!_dev->queue_read_registers(MPUREG_FIFO_COUNTH, rx, 2) ||
+        !_dev->transfer_queued()) {
         goto check_registers;
     }
 
@@ -809,7 +818,6 @@ check_registers:
     // check next register value for correctness
 
     if (_mpu_type == Invensense_ICM20602) {
-        const uint8_t y_ofs = _register_read(MPUREG_ACC_OFF_Y_H);
         if (y_ofs != _saved_y_ofs_high) {
             /*
               we check and restore the ICM20602 Y offset high register
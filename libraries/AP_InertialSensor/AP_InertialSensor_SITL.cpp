@@ -11,7 +11,9 @@ const extern AP_HAL::HAL& hal;
 AP_InertialSensor_SITL::AP_InertialSensor_SITL(AP_InertialSensor &imu, const uint16_t sample_rates[]) :
     AP_InertialSensor_Backend(imu),
     gyro_sample_hz(sample_rates[0]),
-    accel_sample_hz(sample_rates[1])
+    accel_sample_hz(sample_rates[1]),
+    gyro_vibe(random()),
+    accel_vibe(random())
 {
 }
 
@@ -40,11 +42,6 @@ bool AP_InertialSensor_SITL::init_sensor(void)
     return true;
 }
 
-// calculate a noisy noise component
-static float calculate_noise(float noise, float noise_variation) {
-    return noise * (1.0f + noise_variation * rand_float());
-}
-
 float AP_InertialSensor_SITL::get_temperature(void)
 {
 #if HAL_INS_TEMPERATURE_CAL_ENABLE
@@ -75,6 +72,37 @@ void AP_InertialSensor_SITL::generate_accel()
     Vector3f accel_accum;
     uint8_t nsamples = enable_fast_sampling(accel_instance) ? 4 : 1;
 
+    // minimum noise levels are 2 bits, but averaged over many
+    // samples, giving around 0.01 m/s/s
+    float accel_noise = 0.01f;
+
+    // generate the noise and vibration for the whole block up front
+    Vector3f noise[AP_InertialSensor_SITL_Noise::MAX_BLOCK] {};
+    accel_vibe.add_noise(noise, nsamples, accel_noise);
+
+    bool motors_on = sitl->throttle > sitl->ins_noise_throttle_min;
+
+    // on a real 180mm copter gyro noise varies between 0.8-4 m/s/s for throttle 0.2-0.8
+    // giving a accel noise variation of 5.33 m/s/s over the full throttle range
+    if (motors_on) {
+        // add extra noise when the motors are on
+        accel_noise = sitl->accel_noise[accel_instance];
+
+        // VIB_FREQ is a static vibration applied to each axis
+        const Vector3f &vibe_freq = sitl->vibe_freq;
+        if (!vibe_freq.is_zero()) {
+            accel_vibe.add_static(noise, nsamples, accel_sample_hz * nsamples, vibe_freq, accel_noise);
+        }
+
+        // VIB_MOT_MAX is a rpm-scaled vibration applied to each axis
+        if (!is_zero(sitl->vibe_motor)) {
+            accel_vibe.add_motors(noise, nsamples, accel_sample_hz * nsamples,
+                                  sitl->state.motor_mask, sitl->state.rpm,
+                                  uint32_t(sitl->vibe_motor_harmonics),
+                                  accel_noise * sitl->vibe_motor_scale);
+        }
+    }
+
     for (uint8_t j = 0; j < nsamples; j++) {
 
         Vector3f accel = Vector3f(sitl->state.xAccel,
@@ -106,56 +134,8 @@ void AP_InertialSensor_SITL::generate_accel()
         const Vector3f &accel_bias = sitl->accel_bias[accel_instance].get();
         accel += accel_bias;
 
-        // minimum noise levels are 2 bits, but averaged over many
-        // samples, giving around 0.01 m/s/s
-        float accel_noise = 0.01f;
-        float noise_variation = 0.05f;
-        // this smears the individual motor peaks somewhat emulating physical motors
-        float freq_variation = 0.12f;
-
-        // add in sensor noise
-        accel += Vector3f{rand_float(), rand_float(), rand_float()} * accel_noise;
-
-        bool motors_on = sitl->throttle > sitl->ins_noise_throttle_min;
-
-        // on a real 180mm copter gyro noise varies between 0.8-4 m/s/s for throttle 0.2-0.8
-        // giving a accel noise variation of 5.33 m/s/s over the full throttle range
-        if (motors_on) {
-            // add extra noise when the motors are on
-            accel_noise = sitl->accel_noise[accel_instance];
-        }
-
-        // VIB_FREQ is a static vibration applied to each axis
-        const Vector3f &vibe_freq = sitl->vibe_freq;
-
-        if (!vibe_freq.is_zero() && motors_on) {
-            accel.x += sinf(accel_time * 2 * M_PI * vibe_freq.x) * calculate_noise(accel_noise, noise_variation);
-            accel.y += sinf(accel_time * 2 * M_PI * vibe_freq.y) * calculate_noise(accel_noise, noise_variation);
-            accel.z += sinf(accel_time * 2 * M_PI * vibe_freq.z) * calculate_noise(accel_noise, noise_variation);
-            accel_time += 1.0f / (accel_sample_hz * nsamples);
-        }
-
-        // VIB_MOT_MAX is a rpm-scaled vibration applied to each axis
-        if (!is_zero(sitl->vibe_motor) && motors_on) {
-            uint32_t mask = sitl->state.motor_mask;
-            uint8_t mbit;
-            while ((mbit = __builtin_ffs(mask)) != 0) {
-                const uint8_t motor = mbit-1;
-                mask &= ~(1U<<motor);
-                uint32_t harmonics = uint32_t(sitl->vibe_motor_harmonics);
-                const float base_freq = calculate_noise(sitl->state.rpm[motor] / 60.0f, freq_variation);
-                while (harmonics != 0) {
-                    const uint8_t bit = __builtin_ffs(harmonics);
-                    harmonics &= ~(1U<<(bit-1U));
-                    const float phase = accel_motor_phase[motor] * float(bit);
-                    accel.x += sinf(phase) * calculate_noise(accel_noise * sitl->vibe_motor_scale, noise_variation);
-                    accel.y += sinf(phase) * calculate_noise(accel_noise * sitl->vibe_motor_scale, noise_variation);
-                    accel.z += sinf(phase) * calculate_noise(accel_noise * sitl->vibe_motor_scale, noise_variation);
-                }
-                const float phase_incr = base_freq * 2 * M_PI / (accel_sample_hz * nsamples);
-                accel_motor_phase[motor] = wrap_PI(accel_motor_phase[motor] + phase_incr);
-            }
-        }
+        // add in sensor noise and vibration
+        accel += noise[j];
 
         // correct for the acceleration due to the IMU position offset and angular acceleration
         // correct for the centripetal acceleration
@@ -209,68 +189,46 @@ void AP_InertialSensor_SITL::generate_gyro()
     Vector3f gyro_accum;
     uint8_t nsamples = enable_fast_sampling(gyro_instance) ? 8 : 1;
 
-    const float _gyro_drift = gyro_drift();
-    for (uint8_t j = 0; j < nsamples; j++) {
-        float p = radians(sitl->state.rollRate) + _gyro_drift;
-        float q = radians(sitl->state.pitchRate) + _gyro_drift;
-        float r = radians(sitl->state.yawRate) + _gyro_drift;
-
-        // minimum gyro noise is less than 1 bit
-        float gyro_noise = ToRad(0.04f);
-        constexpr float noise_variation = 0.05f;
-        // this smears the individual motor peaks somewhat emulating physical motors
-        constexpr float freq_variation = 0.12f;
-        // add in sensor noise
-        p += gyro_noise * rand_float();
-        q += gyro_noise * rand_float();
-        r += gyro_noise * rand_float();
-
-        bool motors_on = sitl->throttle > sitl->ins_noise_throttle_min;
-        // on a real 180mm copter gyro noise varies between 0.2-0.4 rad/s for throttle 0.2-0.8
-        // giving a gyro noise variation of 0.33 rad/s or 20deg/s over the full throttle range
-        if (motors_on) {
-            // add extra noise when the motors are on
-            gyro_noise = ToRad(sitl->gyro_noise[gyro_instance]) * sitl->throttle;
-        }
+    // minimum gyro noise is less than 1 bit
+    float gyro_noise = ToRad(0.04f);
 
-        // VIB_FREQ is a static vibration applied to each axis
-        const Vector3f &vibe_freq = sitl->vibe_freq;
+    // generate the noise and vibration for the whole block up front
+    Vector3f noise[AP_InertialSensor_SITL_Noise::MAX_BLOCK] {};
+    gyro_vibe.add_noise(noise, nsamples, gyro_noise);
 
-        if (vibe_freq.is_zero() && is_zero(sitl->vibe_motor)) {
-            // no rpm noise, so add in background noise if any
-            p += gyro_noise * rand_float();
-            q += gyro_noise * rand_float();
-            r += gyro_noise * rand_float();
-        }
+    bool motors_on = sitl->throttle > sitl->ins_noise_throttle_min;
+    // on a real 180mm copter gyro noise varies between 0.2-0.4 rad/s for throttle 0.2-0.8
+    // giving a gyro noise variation of 0.33 rad/s or 20deg/s over the full throttle range
+    if (motors_on) {
+        // add extra noise when the motors are on
+        gyro_noise = ToRad(sitl->gyro_noise[gyro_instance]) * sitl->throttle;
+    }
 
-        if (!vibe_freq.is_zero() && motors_on) {
-            p += sinf(gyro_time * 2 * M_PI * vibe_freq.x) * calculate_noise(gyro_noise, noise_variation);
-            q += sinf(gyro_time * 2 * M_PI * vibe_freq.y) * calculate_noise(gyro_noise, noise_variation);
-            r += sinf(gyro_time * 2 * M_PI * vibe_freq.z) * calculate_noise(gyro_noise, noise_variation);
-            gyro_time += 1.0f / (gyro_sample_hz * nsamples);
-        }
+    // VIB_FREQ is a static vibration applied to each axis
+    const Vector3f &vibe_freq = sitl->vibe_freq;
 
-        // VIB_MOT_MAX is a rpm-scaled vibration applied to each axis
-        if (!is_zero(sitl->vibe_motor) && motors_on) {
-            uint32_t mask = sitl->state.motor_mask;
-            uint8_t mbit;
-            while ((mbit = __builtin_ffs(mask)) != 0) {
-                const uint8_t motor = mbit-1;
-                mask &= ~(1U<<motor);
-                uint32_t harmonics = uint32_t(sitl->vibe_motor_harmonics);
-                const float base_freq = calculate_noise(sitl->state.rpm[motor] / 60.0f, freq_variation);
-                while (harmonics != 0) {
-                    const uint8_t bit = __builtin_ffs(harmonics);
-                    harmonics &= ~(1U<<(bit-1U));
-                    const float phase = gyro_motor_phase[motor] * float(bit);
-                    p += sinf(phase) * calculate_noise(gyro_noise * sitl->vibe_motor_scale, noise_variation);
-                    q += sinf(phase) * calculate_noise(gyro_noise * sitl->vibe_motor_scale, noise_variation);
-                    r += sinf(phase) * calculate_noise(gyro_noise * sitl->vibe_motor_scale, noise_variation);
-                }
-                const float phase_incr = base_freq * 2 * M_PI / (gyro_sample_hz * nsamples);
-                gyro_motor_phase[motor] = wrap_PI(gyro_motor_phase[motor] + phase_incr);
-            }
-        }
+    if (vibe_freq.is_zero() && is_zero(sitl->vibe_motor)) {
+        // no rpm noise, so add in background noise if any
+        gyro_vibe.add_noise(noise, nsamples, gyro_noise);
+    }
+
+    if (!vibe_freq.is_zero() && motors_on) {
+        gyro_vibe.add_static(noise, nsamples, gyro_sample_hz * nsamples, vibe_freq, gyro_noise);
+    }
+
+    // VIB_MOT_MAX is a rpm-scaled vibration applied to each axis
+    if (!is_zero(sitl->vibe_motor) && motors_on) {
+        gyro_vibe.add_motors(noise, nsamples, gyro_sample_hz * nsamples,
+                             sitl->state.motor_mask, sitl->state.rpm,
+                             uint32_t(sitl->vibe_motor_harmonics),
+                             gyro_noise * sitl->vibe_motor_scale);
+    }
+
+    const float _gyro_drift = gyro_drift();
+    for (uint8_t j = 0; j < nsamples; j++) {
+        const float p = radians(sitl->state.rollRate) + _gyro_drift + noise[j].x;
+        const float q = radians(sitl->state.pitchRate) + _gyro_drift + noise[j].y;
+        const float r = radians(sitl->state.yawRate) + _gyro_drift + noise[j].z;
 
         Vector3f gyro {p, q, r};
 
@@ -5,6 +5,7 @@
 #if AP_SIM_INS_ENABLED
 
 #include "AP_InertialSensor_Backend.h"
+#include "AP_InertialSensor_SITL_Noise.h"
 
 // simulated sensor rates in Hz. This matches a pixhawk1
 const uint16_t INS_SITL_SENSOR_A[] = { 1000, 1000 };
@@ -49,10 +50,8 @@ private:
     uint8_t accel_instance;
     uint64_t next_gyro_sample;
     uint64_t next_accel_sample;
-    float gyro_time;
-    float accel_time;
-    float gyro_motor_phase[32];
-    float accel_motor_phase[32];
+    AP_InertialSensor_SITL_Noise gyro_vibe;
+    AP_InertialSensor_SITL_Noise accel_vibe;
     uint32_t temp_start_ms;
 #if AP_SIM_INS_FILE_ENABLED
     int gyro_fd = -1;
@@ -0,0 +1,88 @@
+#include "AP_InertialSensor_SITL_Noise.h"
+
+#if AP_SIM_INS_ENABLED
+
+// amplitude jitter on each vibration source
+static constexpr float noise_variation = 0.05f;
+// this smears the individual motor peaks somewhat emulating physical motors
+static constexpr float freq_variation = 0.12f;
+
+AP_InertialSensor_SITL_Noise::AP_InertialSensor_SITL_Noise(uint32_t seed) :
+    rand_state(seed != 0 ? seed : 1)
+{
+}
+
+void AP_InertialSensor_SITL_Noise::add_noise(Vector3f *out, uint8_t n, float amplitude)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        out[i].x += amplitude * rand_float();
+        out[i].y += amplitude * rand_float();
+        out[i].z += amplitude * rand_float();
+    }
+}
+
+void AP_InertialSensor_SITL_Noise::add_static(Vector3f *out, uint8_t n, float sample_hz, const Vector3f &freq, float amplitude)
+{
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        const float step = M_2PI * freq[axis] / sample_hz;
+        const float rc = cosf(step);
+        const float rs = sinf(step);
+        Phasor &ph = static_phase[axis];
+        for (uint8_t i = 0; i < n; i++) {
+            out[i][axis] += ph.s * amplitude * (1.0f + noise_variation * rand_float());
+            ph.rotate(rc, rs);
+        }
+    }
+}
+
+void AP_InertialSensor_SITL_Noise::add_motors(Vector3f *out, uint8_t n, float sample_hz, uint32_t motor_mask,
+                                              const float *rpm, uint32_t harmonics, float amplitude)
+{
+    if (harmonics == 0) {
+        return;
+    }
+    const uint8_t max_harmonic = 32 - __builtin_clz(harmonics);
+
+    uint8_t mbit;
+    while ((mbit = __builtin_ffs(motor_mask)) != 0) {
+        const uint8_t motor = mbit-1;
+        motor_mask &= ~(1U<<motor);
+
+        const float step = M_2PI * (rpm[motor] / 60.0f) / sample_hz;
+        const float rc = cosf(step);
+        const float rs = sinf(step);
+        Phasor &ph = motor_phase[motor];
+
+        for (uint8_t i = 0; i < n; i++) {
+            // sin(h*phase) for each harmonic from the recurrence
+            // sin((h+1)x) = 2cos(x)sin(hx) - sin((h-1)x)
+            const float two_c = 2.0f * ph.c;
+            float s_prev = 0;
+            float s_h = ph.s;
+            float sum = 0;
+            for (uint8_t h = 1; ; h++) {
+                if (harmonics & (1U<<(h-1))) {
+                    sum += s_h;
+                }
+                if (h == max_harmonic) {
+                    break;
+                }
+                const float s_next = two_c * s_h - s_prev;
+                s_prev = s_h;
+                s_h = s_next;
+            }
+            sum *= amplitude;
+            out[i].x += sum * (1.0f + noise_variation * rand_float());
+            out[i].y += sum * (1.0f + noise_variation * rand_float());
+            out[i].z += sum * (1.0f + noise_variation * rand_float());
+
+            // advance with a jittered step. The jitter is a small
+            // angle, so second order sin/cos are close enough
+            const float d = step * freq_variation * rand_float();
+            const float jc = 1.0f - 0.5f * d * d;
+            ph.rotate(rc * jc - rs * d, rs * jc + rc * d);
+        }
+    }
+}
+
+#endif // AP_SIM_INS_ENABLED
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "AP_InertialSensor.h"
+
+#if AP_SIM_INS_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  block generator for simulated IMU vibration and noise
+
+  Each oscillator is a unit phasor rotated by a fixed step once per
+  sample, so a block of samples costs one sincosf() per oscillator
+  rather than one sinf() per sample per harmonic. Motor harmonics come
+  from the Chebyshev recurrence on the base phasor. Frequency and
+  amplitude jitter match the per-sample generator this replaces, using
+  a cheap xorshift source instead of random().
+ */
+class AP_InertialSensor_SITL_Noise
+{
+public:
+    AP_InertialSensor_SITL_Noise(uint32_t seed);
+
+    // largest block the backend asks for, matching fast sampling
+    static constexpr uint8_t MAX_BLOCK = 8;
+    static constexpr uint8_t MAX_MOTORS = 32;
+
+    // add uniform noise of the given amplitude to each axis
+    void add_noise(Vector3f *out, uint8_t n, float amplitude);
+
+    // add a sine on each axis at the given frequencies
+    void add_static(Vector3f *out, uint8_t n, float sample_hz, const Vector3f &freq, float amplitude);
+
+    /*
+      add per-motor vibration at rpm/60 Hz and the harmonics given as
+      a bitmask, bit 0 being the fundamental
+     */
+    void add_motors(Vector3f *out, uint8_t n, float sample_hz, uint32_t motor_mask,
+                    const float *rpm, uint32_t harmonics, float amplitude);
+
+private:
+    struct Phasor {
+        float c = 1;
+        float s = 0;
+
+        // rotate by (rc, rs), then pull the magnitude back towards
+        // one with a Newton step so rounding does not accumulate
+        void rotate(float rc, float rs) {
+            const float c1 = c * rc - s * rs;
+            const float s1 = s * rc + c * rs;
+            const float k = 1.5f - 0.5f * (c1 * c1 + s1 * s1);
+            c = c1 * k;
+            s = s1 * k;
+        }
+    };
+
+    Phasor static_phase[3];
+    Phasor motor_phase[MAX_MOTORS];
+
+    uint32_t rand_state;
+
+    // uniform between -1 and 1
+    float rand_float(void) {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 17;
+        rand_state ^= rand_state << 5;
+        return int32_t(rand_state) * (1.0f / 2147483648.0f);
+    }
+};
+
+#endif // AP_SIM_INS_ENABLED
@@ -0,0 +1,68 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_InertialSensor/AP_InertialSensor_SITL_Noise.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SIM_INS_ENABLED
+
+/*
+  cost of synthesising simulated gyro vibration for a quad with four
+  harmonics, in 8 sample fast sampling blocks. items_per_second is
+  samples per second; divide by INS_GYRO_RATE times the number of IMUs
+  for the headroom available to SITL speedup
+ */
+static const float rpm[4] { 9000, 9300, 8800, 9100 };
+static const uint32_t motor_mask = 0x0F;
+static const uint32_t harmonics = 0x0F;
+static const float sample_hz = 8000;
+
+// the per sample generator the block generator replaced
+static float calculate_noise(float noise, float noise_variation)
+{
+    return noise * (1.0f + noise_variation * rand_float());
+}
+
+static void BM_sitl_noise_per_sample(benchmark::State& state)
+{
+    float phase[4] {};
+    while (state.KeepRunning()) {
+        for (uint8_t j = 0; j < AP_InertialSensor_SITL_Noise::MAX_BLOCK; j++) {
+            Vector3f v;
+            for (uint8_t motor = 0; motor < 4; motor++) {
+                const float base_freq = calculate_noise(rpm[motor] / 60.0f, 0.12f);
+                uint32_t h = harmonics;
+                while (h != 0) {
+                    const uint8_t bit = __builtin_ffs(h);
+                    h &= ~(1U<<(bit-1U));
+                    const float p = phase[motor] * float(bit);
+                    v.x += sinf(p) * calculate_noise(0.1f, 0.05f);
+                    v.y += sinf(p) * calculate_noise(0.1f, 0.05f);
+                    v.z += sinf(p) * calculate_noise(0.1f, 0.05f);
+                }
+                phase[motor] = wrap_PI(phase[motor] + base_freq * 2 * M_PI / sample_hz);
+            }
+            v += Vector3f{rand_float(), rand_float(), rand_float()} * 0.01f;
+            gbenchmark_escape(&v);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * AP_InertialSensor_SITL_Noise::MAX_BLOCK);
+}
+BENCHMARK(BM_sitl_noise_per_sample);
+
+static void BM_sitl_noise_block(benchmark::State& state)
+{
+    AP_InertialSensor_SITL_Noise gen(1);
+    while (state.KeepRunning()) {
+        Vector3f v[AP_InertialSensor_SITL_Noise::MAX_BLOCK] {};
+        gen.add_noise(v, ARRAY_SIZE(v), 0.01f);
+        gen.add_motors(v, ARRAY_SIZE(v), sample_hz, motor_mask, rpm, harmonics, 0.1f);
+        gbenchmark_escape(v);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * AP_InertialSensor_SITL_Noise::MAX_BLOCK);
+}
+BENCHMARK(BM_sitl_noise_block);
+
+#endif // AP_SIM_INS_ENABLED
+
+BENCHMARK_MAIN();
@@ -14,6 +14,7 @@
 #include <AP_BoardConfig/AP_BoardConfig.h>
 #include <AP_Rally/AP_Rally.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
+#include <AP_Common/AP_HeapAccounting.h>
 
 #if HAL_LOGGER_FENCE_ENABLED
     #include <AC_Fence/AC_Fence.h>
@@ -205,6 +206,8 @@ AP_Logger::AP_Logger()
 
 void AP_Logger::init(const AP_Int32 &log_bitmask, const struct LogStructure *structures, uint8_t num_types)
 {
+    HEAP_TAG_SCOPE(LOGGER);
+
     _log_bitmask = &log_bitmask;
 
     // convert from 8 bit to 16 bit LOG_FILE_BUFSIZE
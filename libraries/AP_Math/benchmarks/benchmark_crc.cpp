@@ -0,0 +1,48 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  throughput of each CRC over buffers the size of a short message, a
+  MAVLink FTP burst and a firmware chunk. bytes_per_second is the
+  figure to compare
+ */
+static uint8_t data[65535];
+
+static void fill_data()
+{
+    uint32_t seed = 1;
+    for (auto &b : data) {
+        seed = seed * 1664525U + 1013904223U;
+        b = seed >> 24;
+    }
+}
+
+#define CRC_BENCHMARK(name, expr)                                       \
+static void BM_##name(benchmark::State& state)                          \
+{                                                                       \
+    fill_data();                                                        \
+    const uint32_t len = state.range(0);                                \
+    while (state.KeepRunning()) {                                       \
+        auto crc = expr;                                                \
+        gbenchmark_escape(&crc);                                        \
+    }                                                                   \
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);         \
+}                                                                       \
+BENCHMARK(BM_##name)->Arg(32)->Arg(239)->Arg(4096)
+
+CRC_BENCHMARK(crc_crc32, crc_crc32(0, data, len));
+CRC_BENCHMARK(crc32_small, crc32_small(0, data, len));
+CRC_BENCHMARK(crc16_ccitt, crc16_ccitt(data, len, 0));
+CRC_BENCHMARK(crc16_ccitt_r, crc16_ccitt_r(data, len, 0, 0xFFFF));
+CRC_BENCHMARK(crc_xmodem, crc_xmodem(data, len));
+CRC_BENCHMARK(calc_crc_modbus, calc_crc_modbus(data, len));
+CRC_BENCHMARK(crc_crc24, crc_crc24(data, len));
+CRC_BENCHMARK(crc8_dvb_s2_update, crc8_dvb_s2_update(0, data, len));
+CRC_BENCHMARK(crc8_dvb_update, crc8_dvb_update(0, data, len));
+CRC_BENCHMARK(crc_fletcher16, crc_fletcher16(data, len));
+
+BENCHMARK_MAIN();
@@ -0,0 +1,170 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  bit at a time reference implementations, to check the table driven
+  and hardware assisted versions against
+ */
+static uint32_t ref_crc32(uint32_t crc, const uint8_t *buf, uint32_t size)
+{
+    return crc32_small(crc, buf, size);
+}
+
+static uint8_t ref_crc8_msb(uint8_t crc, const uint8_t *buf, uint32_t len, uint8_t poly)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ poly : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t ref_crc16_msb(uint16_t crc, const uint8_t *buf, uint32_t len, uint16_t poly)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= uint16_t(buf[i]) << 8;
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ poly : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t ref_crc16_lsb(uint16_t crc, const uint8_t *buf, uint32_t len, uint16_t poly)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 1) ? (crc >> 1) ^ poly : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t ref_crc24(const uint8_t *buf, uint32_t len)
+{
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= uint32_t(buf[i]) << 16;
+        for (uint8_t j = 0; j < 8; j++) {
+            crc <<= 1;
+            if (crc & 0x1000000) {
+                crc ^= 0x1864CFB;
+            }
+        }
+    }
+    return crc & 0xFFFFFF;
+}
+
+static uint16_t ref_fletcher16(const uint8_t *buf, uint32_t len)
+{
+    uint16_t c0 = 0, c1 = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        c0 = (c0 + buf[i]) % 255;
+        c1 = (c1 + c0) % 255;
+    }
+    return (c1 << 8) | c0;
+}
+
+class CRCTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        uint32_t seed = 0x12345678;
+        for (auto &b : data) {
+            seed = seed * 1664525U + 1013904223U;
+            b = seed >> 24;
+        }
+    }
+
+    // every length up to a few slices and hardware blocks past the
+    // 64 byte fold, then some large ones, at all alignments
+    template <typename F>
+    void check_all(F check) {
+        for (uint8_t ofs = 0; ofs < 16; ofs++) {
+            for (uint32_t len = 0; len < 300; len++) {
+                check(&data[ofs], len);
+            }
+            check(&data[ofs], 4096 + ofs);
+        }
+        check(data, sizeof(data));
+    }
+
+    uint8_t data[16384];
+};
+
+TEST_F(CRCTest, crc32)
+{
+    check_all([](const uint8_t *p, uint32_t len) {
+        EXPECT_EQ(ref_crc32(0, p, len), crc_crc32(0, p, len)) << "len " << len;
+        EXPECT_EQ(ref_crc32(0xFFFFFFFF, p, len), crc_crc32(0xFFFFFFFF, p, len)) << "len " << len;
+    });
+
+    // check value for "123456789" with the usual inversions
+    const uint8_t check[] { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    EXPECT_EQ(0xCBF43926U, ~crc_crc32(0xFFFFFFFF, check, sizeof(check)));
+
+    // incremental updates match a single pass
+    uint32_t crc = 0;
+    for (uint32_t ofs = 0; ofs < sizeof(data); ofs += 1000) {
+        crc = crc_crc32(crc, &data[ofs], MIN(1000U, sizeof(data) - ofs));
+    }
+    EXPECT_EQ(crc_crc32(0, data, sizeof(data)), crc);
+}
+
+TEST_F(CRCTest, crc8)
+{
+    check_all([](const uint8_t *p, uint32_t len) {
+        EXPECT_EQ(ref_crc8_msb(0, p, len, 0xD5), crc8_dvb_s2_update(0, p, len));
+        EXPECT_EQ(ref_crc8_msb(0x5A, p, len, 0x07), crc8_dvb_update(0x5A, p, uint16_t(len)));
+        EXPECT_EQ(ref_crc8_msb(0, p, MIN(len, 255U), 0x07), crc_crc8(p, uint8_t(MIN(len, 255U))));
+    });
+    for (uint16_t crc = 0; crc < 256; crc++) {
+        for (uint16_t a = 0; a < 256; a++) {
+            const uint8_t byte = a;
+            ASSERT_EQ(ref_crc8_msb(crc, &byte, 1, 0xD5), crc8_dvb_s2(crc, byte));
+        }
+    }
+}
+
+TEST_F(CRCTest, crc16)
+{
+    check_all([](const uint8_t *p, uint32_t len) {
+        const uint16_t len16 = MIN(len, 65535U);
+        EXPECT_EQ(ref_crc16_msb(0, p, len16, 0x1021), crc_xmodem(p, len16));
+        EXPECT_EQ(ref_crc16_msb(0xFFFF, p, len, 0x1021), crc16_ccitt(p, len, 0xFFFF));
+        EXPECT_EQ(ref_crc16_lsb(0, p, len, 0x8408) ^ 0xFFFF, crc16_ccitt_r(p, len, 0, 0xFFFF));
+        EXPECT_EQ(ref_crc16_lsb(0xFFFF, p, len16, 0xA001), calc_crc_modbus(p, len16));
+    });
+    uint16_t crc = 0x1D0F;
+    for (uint16_t i = 0; i < 300; i++) {
+        crc = crc_xmodem_update(crc, data[i]);
+    }
+    EXPECT_EQ(ref_crc16_msb(0x1D0F, data, 300, 0x1021), crc);
+}
+
+TEST_F(CRCTest, crc24)
+{
+    check_all([](const uint8_t *p, uint32_t len) {
+        const uint16_t len16 = MIN(len, 65535U);
+        EXPECT_EQ(ref_crc24(p, len16), crc_crc24(p, len16));
+    });
+}
+
+TEST_F(CRCTest, fletcher16)
+{
+    check_all([](const uint8_t *p, uint32_t len) {
+        EXPECT_EQ(ref_fletcher16(p, len), crc_fletcher16(p, len));
+    });
+    // long runs of 0xFF are the worst case for the deferred modulo
+    uint8_t ff[12000];
+    memset(ff, 0xFF, sizeof(ff));
+    EXPECT_EQ(ref_fletcher16(ff, sizeof(ff)), crc_fletcher16(ff, sizeof(ff)));
+}
+
+AP_GTEST_MAIN()
@@ -34,19 +34,40 @@ void EKFGSF_yaw::update(const Vector3F &delAng,
                         bool runEKF,
                         ftype TAS)
 {
-
-    // copy to class variables
-    delta_angle = delAng;
-    delta_velocity = delVel;
-    angle_dt = delAngDT;
-    velocity_dt = delVelDT;
     run_ekf_gsf = runEKF;
     true_airspeed = TAS;
 
+    // accumulate IMU data until enough samples are available to run the bank
+    delta_angle_sum += delAng;
+    delta_velocity_sum += delVel;
+    angle_dt_sum += delAngDT;
+    velocity_dt_sum += delVelDT;
+    sum_count++;
+
+    if (sum_count < decimation) {
+        return;
+    }
+
+    runPrediction();
+}
+
+void EKFGSF_yaw::runPrediction()
+{
+    // copy accumulated IMU data to class variables
+    delta_angle = delta_angle_sum;
+    delta_velocity = delta_velocity_sum;
+    angle_dt = angle_dt_sum;
+    velocity_dt = velocity_dt_sum;
+    delta_angle_sum.zero();
+    delta_velocity_sum.zero();
+    angle_dt_sum = 0;
+    velocity_dt_sum = 0;
+    sum_count = 0;
+
     // Calculate a low pass filtered acceleration vector that will be used to keep the AHRS tilt aligned
     // The time constant of the filter is a fixed ratio relative to the time constant of the AHRS tilt correction loop
-    const ftype filter_coef = fminF(EKFGSF_accelFiltRatio * delVelDT * EKFGSF_tiltGain, 1.0f);
-    const Vector3F accel = delVel / fmaxF(delVelDT, 0.001f);
+    const ftype filter_coef = fminF(EKFGSF_accelFiltRatio * velocity_dt * EKFGSF_tiltGain, 1.0f);
+    const Vector3F accel = delta_velocity / fmaxF(velocity_dt, 0.001f);
     ahrs_accel = ahrs_accel * (1.0f - filter_coef) + accel * filter_coef;
 
     // Iniitialise states and only when acceleration is close to 1g to prevent vehicle movement casuing a large initial tilt error
@@ -131,6 +152,8 @@ void EKFGSF_yaw::update(const Vector3F &delAng,
         ftype yawDelta = wrap_PI(EKF[mdl_idx].X[2] - GSF.yaw);
         GSF.yaw_variance +=  GSF.weights[mdl_idx] * (EKF[mdl_idx].P[2][2] + sq(yawDelta));
     }
+
+    publish();
 }
 
 void EKFGSF_yaw::fuseVelData(const Vector2F &vel, const ftype velAcc)
@@ -138,6 +161,11 @@ void EKFGSF_yaw::fuseVelData(const Vector2F &vel, const ftype velAcc)
     // convert reported accuracy to a variance, but limit lower value to protect algorithm stability
     const ftype velObsVar = sq(fmaxF(velAcc, 0.5f));
 
+    // bring the bank up to date with any IMU data still being accumulated
+    if (sum_count > 0) {
+        runPrediction();
+    }
+
     // The 3-state EKF models only run when flying to avoid corrupted estimates due to operator handling and GPS interference
     if (run_ekf_gsf) {
         if (!vel_fuse_running) {
@@ -189,6 +217,8 @@ void EKFGSF_yaw::fuseVelData(const Vector2F &vel, const ftype velAcc)
             }
         }
     }
+
+    publish();
 }
 
 void EKFGSF_yaw::predictAHRS(const uint8_t mdl_idx)
@@ -632,31 +662,43 @@ Matrix3F EKFGSF_yaw::updateRotMat(const Matrix3F &R, const Vector3F &g) const
     return ret;
 }
 
+void EKFGSF_yaw::publish()
+{
+    published.valid = vel_fuse_running;
+    if (!vel_fuse_running) {
+        return;
+    }
+    published.yaw = GSF.yaw;
+    published.yaw_variance = GSF.yaw_variance;
+    published.n_clips = n_clips;
+    published.vel_innov_length = 0.0f;
+    for (uint8_t mdl_idx = 0; mdl_idx < N_MODELS_EKFGSF; mdl_idx++) {
+        published.vel_innov_length += GSF.weights[mdl_idx] * sqrtF((sq(EKF[mdl_idx].innov[0]) + sq(EKF[mdl_idx].innov[1])));
+    }
+}
+
 // returns true if a yaw estimate is available.  yaw and its variance
 // is returned, as well as the number of models which are *not* being
 // used to snthesise the yaw.
 bool EKFGSF_yaw::getYawData(ftype &yaw, ftype &yawVariance, uint8_t *_n_clips) const
 {
-    if (!vel_fuse_running) {
+    if (!published.valid) {
         return false;
     }
-    yaw = GSF.yaw;
-    yawVariance = GSF.yaw_variance;
+    yaw = published.yaw;
+    yawVariance = published.yaw_variance;
     if (_n_clips != nullptr) {
-        *_n_clips = n_clips;
+        *_n_clips = published.n_clips;
     }
     return true;
 }
 
 bool EKFGSF_yaw::getVelInnovLength(ftype &velInnovLength) const
 {
-    if (!vel_fuse_running) {
+    if (!published.valid) {
         return false;
     }
-    velInnovLength = 0.0f;
-    for (uint8_t mdl_idx = 0; mdl_idx < N_MODELS_EKFGSF; mdl_idx++) {
-        velInnovLength += GSF.weights[mdl_idx] * sqrtF((sq(EKF[mdl_idx].innov[0]) + sq(EKF[mdl_idx].innov[1])));
-    }
+    velInnovLength = published.vel_innov_length;
     return true;
 }
 
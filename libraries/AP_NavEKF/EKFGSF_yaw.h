@@ -31,6 +31,11 @@ public:
     // set the gyro bias in rad/sec
     void setGyroBias(Vector3f &gyroBias);
 
+    // set the number of IMU samples accumulated before the AHRS and
+    // EKF bank prediction is run. A value of 1 runs the bank on
+    // every call to update()
+    void setDecimation(uint8_t ratio) { decimation = MAX(ratio, 1U); }
+
     // get yaw estimated and corresponding variance return false if
     // yaw estimation is inactive.  n_clips will contain the number of
     // models which were *not* used to create the yaw and yawVariance
@@ -65,6 +70,18 @@ private:
     const ftype EKFGSF_gyroBiasGain{0.04}; // gain applied to integral of gyro correction for complementary filter (1/sec)
     const ftype EKFGSF_accelFiltRatio{10.0}; // ratio  of time constant of AHRS tilt correction to time constant of first order LPF applied to accel data used by ahrs
 
+    // IMU data accumulated across calls to update() when the bank is
+    // being run at a decimated rate
+    Vector3F delta_angle_sum;
+    Vector3F delta_velocity_sum;
+    ftype angle_dt_sum;
+    ftype velocity_dt_sum;
+    uint8_t sum_count;
+    uint8_t decimation;
+
+    // Runs the AHRS and EKF bank prediction using the accumulated IMU data
+    void runPrediction();
+
     // Declarations used by the bank of AHRS complementary filters that use IMU data augmented by true
     // airspeed data when in fixed wing mode to estimate the quaternions that are used to rotate IMU data into a
     // Front, Right, Yaw frame of reference.
@@ -142,4 +159,18 @@ private:
     // number of models whose weights underflowed due to excessive
     // innovation variances:
     uint8_t n_clips;
+
+    // outputs of the last completed prediction or fusion step. These
+    // are what the getters return, so a caller always sees yaw,
+    // variance and innovation length from the same filter step
+    struct {
+        ftype yaw;
+        ftype yaw_variance;
+        ftype vel_innov_length;
+        uint8_t n_clips;
+        bool valid;
+    } published;
+
+    // copy the current GSF outputs into published
+    void publish();
 };
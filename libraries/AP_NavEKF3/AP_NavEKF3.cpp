@@ -741,6 +741,14 @@ const AP_Param::GroupInfo NavEKF3::var_info2[] = {
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  11, NavEKF3, _options, 0),
 
+    // @Param: GSF_DECIM
+    // @DisplayName: EKF-GSF yaw estimator decimation
+    // @Description: Number of EKF prediction steps that IMU data is accumulated over before the EKF-GSF yaw estimator bank is run. Increasing this value reduces the CPU load of the yaw estimator at the cost of a lower update rate for its AHRS and EKF models. A value of 1 runs the yaw estimator at the EKF prediction rate. Changes take effect on the next EKF initialisation.
+    // @Range: 1 4
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("GSF_DECIM", 12, NavEKF3, _gsfDecimation, 1),
+
     AP_GROUPEND
 };
 
@@ -178,6 +178,9 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
             return false;
         }
     }
+    if (yawEstimator != nullptr) {
+        yawEstimator->setDecimation(constrain_int16(frontend->_gsfDecimation, 1, 4));
+    }
 
     return true;
 }
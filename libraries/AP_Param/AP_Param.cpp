@@ -2668,6 +2668,57 @@ uint16_t AP_Param::count_parameters(void)
     return _parameter_count;
 }
 
+#if AP_PARAM_BLOCK_HASH_ENABLED
+/*
+  upper limit on the number of hash blocks. Each top level variable
+  starts a new block, as does every block_hash_max_params parameters
+ */
+uint16_t AP_Param::block_hash_max_blocks(void)
+{
+    return _num_vars + count_parameters() / block_hash_max_params + 1;
+}
+
+/*
+  hash the parameters in blocks. A ground station that has cached the
+  parameters can compare the hashes with its own and fetch only the
+  blocks that differ
+ */
+bool AP_Param::get_block_hashes(BlockHash *blocks, uint16_t max_blocks, uint16_t &num_blocks)
+{
+    ParamToken token {};
+    enum ap_var_type ptype;
+    uint16_t idx = 0;
+    num_blocks = 0;
+    uint16_t last_key = 0;
+
+    for (AP_Param *ap = AP_Param::first(&token, &ptype);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &ptype), idx++) {
+        BlockHash *b = num_blocks > 0 ? &blocks[num_blocks-1] : nullptr;
+        if (b == nullptr || token.key != last_key || b->count >= block_hash_max_params) {
+            if (num_blocks >= max_blocks) {
+                return false;
+            }
+            b = &blocks[num_blocks++];
+            b->start = idx;
+            b->count = 0;
+            b->hash = 0;
+            last_key = token.key;
+        }
+
+        char name[AP_MAX_NAME_SIZE+1];
+        ap->copy_name_token(token, name, sizeof(name), true);
+        name[AP_MAX_NAME_SIZE] = 0;
+        const uint8_t hdr[2] { uint8_t(ptype), uint8_t(strlen(name)) };
+        b->hash = crc_crc32(b->hash, hdr, sizeof(hdr));
+        b->hash = crc_crc32(b->hash, (const uint8_t *)name, hdr[1]);
+        b->hash = crc_crc32(b->hash, (const uint8_t *)ap, type_size(ptype));
+        b->count++;
+    }
+    return true;
+}
+#endif // AP_PARAM_BLOCK_HASH_ENABLED
+
 /*
   invalidate parameter count cache
  */
@@ -570,6 +570,28 @@ public:
     // invalidate parameter count
     static void invalidate_count(void);
 
+#if AP_PARAM_BLOCK_HASH_ENABLED
+    /*
+      content hash of a run of parameters in next_scalar() order. A
+      block never spans two top level variables, so adding or removing
+      parameters only changes the blocks of the group they are in
+     */
+    struct BlockHash {
+        uint16_t start;     // index of first parameter
+        uint16_t count;     // number of parameters
+        uint32_t hash;      // crc32 of the type, name and value of each parameter
+    };
+    static constexpr uint8_t block_hash_max_params = 32;
+
+    // upper limit on the number of blocks from get_block_hashes()
+    static uint16_t block_hash_max_blocks(void);
+
+    // fill in hashes for all parameters, setting the number of
+    // blocks. Returns false if there are more than max_blocks, as
+    // when parameters are added while hashing
+    static bool get_block_hashes(BlockHash *blocks, uint16_t max_blocks, uint16_t &num_blocks) WARN_IF_UNUSED;
+#endif
+
     static void set_hide_disabled_groups(bool value) { _hide_disabled_groups = value; }
 
     // set frame type flags. Used to unhide frame specific parameters
@@ -11,3 +11,8 @@
 #ifndef FORCE_APJ_DEFAULT_PARAMETERS
 #define FORCE_APJ_DEFAULT_PARAMETERS 0
 #endif
+
+// per block hashes of parameter values, served as @PARAM/param.hsh
+#ifndef AP_PARAM_BLOCK_HASH_ENABLED
+#define AP_PARAM_BLOCK_HASH_ENABLED AP_FILESYSTEM_PARAM_ENABLED
+#endif
@@ -33,6 +33,7 @@
 #include "AP_Proximity_MR72_CAN.h"
 
 
+#include <AP_AHRS/AP_AHRS.h>
 #include <AP_Logger/AP_Logger.h>
 
 extern const AP_HAL::HAL &hal;
@@ -79,6 +80,18 @@ const AP_Param::GroupInfo AP_Proximity::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO_FRAME("_ALT_MIN", 25, AP_Proximity, _alt_min, 1.0f, AP_PARAM_FRAME_COPTER | AP_PARAM_FRAME_HELI | AP_PARAM_FRAME_TRICOPTER),
 
+#if AP_PROXIMITY_VOXEL_ENABLED
+    // @Param: _VXL_SIZE
+    // @DisplayName: Proximity voxel map resolution
+    // @Description: Size of each voxel in the vehicle centred occupancy map built from all proximity readings. The map covers 32 voxels horizontally and 8 vertically and is used by simple avoidance and BendyRuler alongside the proximity boundary. Set zero to disable
+    // @Units: m
+    // @Range: 0 2
+    // @Increment: 0.1
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("_VXL_SIZE", 30, AP_Proximity, _voxel_size, 0),
+#endif
+
     // @Group: 1
     // @Path: AP_Proximity_Params.cpp
     AP_SUBGROUPINFO(params[0], "1", 21, AP_Proximity, AP_Proximity_Params),
@@ -287,7 +300,25 @@ void AP_Proximity::update()
 
     // check if any face has valid distance when it should not
     boundary.check_face_timeout();
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+    update_voxels();
+#endif
+}
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+void AP_Proximity::update_voxels()
+{
+    if (!is_positive(_voxel_size) || !voxels.init(_voxel_size)) {
+        return;
+    }
+    Vector3f current_pos;
+    if (!AP::ahrs().get_relative_position_NED_origin(current_pos)) {
+        return;
+    }
+    voxels.update(current_pos, AP_HAL::millis());
 }
+#endif
 
 AP_Proximity::Type AP_Proximity::get_type(uint8_t instance) const
 {
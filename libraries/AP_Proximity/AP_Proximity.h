@@ -24,6 +24,7 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include "AP_Proximity_Params.h"
 #include "AP_Proximity_Boundary_3D.h"
+#include "AP_Proximity_Voxel.h"
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 #include <AP_HAL/Semaphores.h>
@@ -201,6 +202,11 @@ public:
     // 3D boundary
     AP_Proximity_Boundary_3D boundary;
 
+#if AP_PROXIMITY_VOXEL_ENABLED
+    // voxel map of all readings, allocated if PRX_VXL_SIZE is set
+    AP_Proximity_Voxel voxels;
+#endif
+
     // Check if Obstacle defined by body-frame yaw and pitch is near ground
     bool check_obstacle_near_ground(float pitch, float yaw, float distance) const;
 
@@ -228,6 +234,12 @@ private:
     AP_Int8 _ign_gnd_enable;                           // true if land detection should be enabled
     AP_Float _filt_freq;                               // cutoff frequency for low pass filter
     AP_Float _alt_min;                                 // Minimum altitude -in meters- below which proximity should not work.
+#if AP_PROXIMITY_VOXEL_ENABLED
+    AP_Float _voxel_size;                              // voxel map resolution in meters, zero to disable the map
+
+    // allocate and move the voxel map
+    void update_voxels();
+#endif
 
     // get alt from rangefinder in meters. This reading is corrected for vehicle tilt
     bool get_rangefinder_alt(float &alt_m) const;
@@ -88,9 +88,16 @@ bool AP_Proximity_Backend::ignore_reading(float pitch, float yaw, float distance
 // returns true if database is ready to be pushed to and all cached data is ready
 bool AP_Proximity_Backend::database_prepare_for_push(Vector3f &current_pos, Matrix3f &body_to_ned)
 {
+    bool wanted = false;
 #if AP_OADATABASE_ENABLED
     AP_OADatabase *oaDb = AP::oadatabase();
-    if (oaDb == nullptr || !oaDb->healthy()) {
+    wanted = oaDb != nullptr && oaDb->healthy();
+#endif
+#if AP_PROXIMITY_VOXEL_ENABLED
+    const AP_Proximity *proximity = AP::proximity();
+    wanted |= proximity != nullptr && proximity->voxels.enabled();
+#endif
+    if (!wanted) {
         return false;
     }
 
@@ -101,9 +108,6 @@ bool AP_Proximity_Backend::database_prepare_for_push(Vector3f &current_pos, Matr
     body_to_ned = AP::ahrs().get_rotation_body_to_ned();
 
     return true;
-#else
-    return false;
-#endif
 }
 
 // update Object Avoidance database with Earth-frame point
@@ -117,16 +121,10 @@ void AP_Proximity_Backend::database_push(float angle, float pitch, float distanc
     }
 }
 
-// update Object Avoidance database with Earth-frame point
+// update Object Avoidance database and voxel map with Earth-frame point
 // pitch can be optionally provided if needed
 void AP_Proximity_Backend::database_push(float angle, float pitch, float distance, uint32_t timestamp_ms, const Vector3f &current_pos, const Matrix3f &body_to_ned)
 {
-
-#if AP_OADATABASE_ENABLED
-    AP_OADatabase *oaDb = AP::oadatabase();
-    if (oaDb == nullptr || !oaDb->healthy()) {
-        return;
-    }
     if ((pitch > 90.0f) || (pitch < -90.0f)) {
         // sanity check on pitch
         return;
@@ -138,6 +136,19 @@ void AP_Proximity_Backend::database_push(float angle, float pitch, float distanc
 
     //Calculate the position vector from origin
     Vector3f temp_pos = current_pos + rotated_object_3D;
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+    AP_Proximity *proximity = AP::proximity();
+    if (proximity != nullptr) {
+        proximity->voxels.push(current_pos, temp_pos);
+    }
+#endif
+
+#if AP_OADATABASE_ENABLED
+    AP_OADatabase *oaDb = AP::oadatabase();
+    if (oaDb == nullptr || !oaDb->healthy()) {
+        return;
+    }
     //Convert the vector to a NEU frame from NED
     temp_pos.z = temp_pos.z * -1.0f;
 
@@ -0,0 +1,488 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Proximity_Voxel.h"
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+#define PROXIMITY_VOXEL_HIT         64      // occupancy added by a hit
+#define PROXIMITY_VOXEL_MISS        16      // occupancy removed by a ray passing through
+#define PROXIMITY_VOXEL_OCCUPIED    32      // occupancy at which a voxel is an obstacle
+#define PROXIMITY_VOXEL_MAX         128     // limit so a voxel seen many times still decays in a few seconds
+#define PROXIMITY_VOXEL_DECAY       4       // occupancy removed every PROXIMITY_VOXEL_DECAY_MS
+#define PROXIMITY_VOXEL_DECAY_MS    100
+
+// field distances are in half voxels so diagonal steps can be 3
+#define FIELD_STEP_AXIS             2
+#define FIELD_STEP_DIAG             3
+
+static constexpr uint16_t stride_y = PROXIMITY_VOXEL_DIM_XY;
+static constexpr uint16_t stride_z = PROXIMITY_VOXEL_DIM_XY * PROXIMITY_VOXEL_DIM_XY;
+static const uint16_t strides[3] { 1, stride_y, stride_z };
+
+// index into a field, which is laid out by offset from the window corner
+static inline uint16_t field_index(uint8_t x, uint8_t y, uint8_t z)
+{
+    return z * stride_z + y * stride_y + x;
+}
+
+AP_Proximity_Voxel::~AP_Proximity_Voxel()
+{
+    delete[] _occupancy;
+    delete[] _fields;
+}
+
+bool AP_Proximity_Voxel::init(float voxel_size_m)
+{
+    if (!is_positive(voxel_size_m)) {
+        return false;
+    }
+    WITH_SEMAPHORE(_sem);
+    if (enabled() && is_equal(voxel_size_m, _voxel_size)) {
+        return true;
+    }
+    if (_occupancy == nullptr) {
+        _occupancy = NEW_NOTHROW uint8_t[NUM_VOXELS];
+        _fields = NEW_NOTHROW uint8_t[DIR_COUNT * NUM_VOXELS];
+        if (_occupancy == nullptr || _fields == nullptr) {
+            delete[] _occupancy;
+            delete[] _fields;
+            _occupancy = nullptr;
+            _fields = nullptr;
+            return false;
+        }
+    }
+    _voxel_size = voxel_size_m;
+    _voxel_size_inv = 1.0f / voxel_size_m;
+    memset(_occupancy, 0, NUM_VOXELS);
+    _origin_valid = false;
+    _fields_valid = false;
+    _changed = false;
+    _occupied_count = 0;
+    _pending_count = 0;
+    return true;
+}
+
+// storage index of the voxel at the given offsets from the window corner
+uint16_t AP_Proximity_Voxel::index(uint8_t x, uint8_t y, uint8_t z) const
+{
+    const uint16_t px = (_origin[0] + x) & (PROXIMITY_VOXEL_DIM_XY-1);
+    const uint16_t py = (_origin[1] + y) & (PROXIMITY_VOXEL_DIM_XY-1);
+    const uint16_t pz = (_origin[2] + z) & (PROXIMITY_VOXEL_DIM_Z-1);
+    return pz * stride_z + py * stride_y + px;
+}
+
+void AP_Proximity_Voxel::voxel_coords(const Vector3f &pos, int32_t coords[3]) const
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        coords[i] = int32_t(floorf(pos[i] * _voxel_size_inv));
+    }
+}
+
+bool AP_Proximity_Voxel::window_offsets(const int32_t coords[3], uint8_t offsets[3]) const
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        const int32_t ofs = coords[i] - _origin[i];
+        if (ofs < 0 || ofs >= dim(i)) {
+            return false;
+        }
+        offsets[i] = ofs;
+    }
+    return true;
+}
+
+void AP_Proximity_Voxel::push(const Vector3f &sensor_pos, const Vector3f &point)
+{
+    WITH_SEMAPHORE(_sem);
+    if (!enabled()) {
+        return;
+    }
+    if (_pending_count >= ARRAY_SIZE(_pending)) {
+        flush_pending();
+    }
+    _pending[_pending_count].sensor = sensor_pos;
+    _pending[_pending_count].point = point;
+    _pending_count++;
+}
+
+void AP_Proximity_Voxel::add_points(const Vector3f &sensor_pos, const Vector3f *points, uint16_t count)
+{
+    WITH_SEMAPHORE(_sem);
+    if (!enabled() || !_origin_valid) {
+        return;
+    }
+    int32_t sensor[3];
+    voxel_coords(sensor_pos, sensor);
+    for (uint16_t i = 0; i < count; i++) {
+        add_point(sensor, points[i]);
+    }
+}
+
+void AP_Proximity_Voxel::flush_pending()
+{
+    if (_origin_valid) {
+        for (uint16_t i = 0; i < _pending_count; i++) {
+            int32_t sensor[3];
+            voxel_coords(_pending[i].sensor, sensor);
+            add_point(sensor, _pending[i].point);
+        }
+    }
+    _pending_count = 0;
+}
+
+void AP_Proximity_Voxel::add_point(const int32_t sensor[3], const Vector3f &point)
+{
+    int32_t hit[3];
+    voxel_coords(point, hit);
+
+    // clear the voxels between the sensor and the hit, stepping one
+    // voxel at a time along the longest axis
+    const int32_t d[3] { hit[0] - sensor[0], hit[1] - sensor[1], hit[2] - sensor[2] };
+    const int32_t steps = MAX(MAX(abs(d[0]), abs(d[1])), abs(d[2]));
+    for (int32_t s = 1; s < steps; s++) {
+        int32_t v[3];
+        for (uint8_t i = 0; i < 3; i++) {
+            // rounded d*s/steps
+            const int32_t num = d[i] * s;
+            v[i] = sensor[i] + (num >= 0 ? (num + steps/2) / steps : -((-num + steps/2) / steps));
+        }
+        uint8_t ofs[3];
+        if (!window_offsets(v, ofs)) {
+            continue;
+        }
+        uint8_t &occ = _occupancy[index(ofs[0], ofs[1], ofs[2])];
+        if (occ != 0) {
+            set_occupancy(occ, occ > PROXIMITY_VOXEL_MISS ? occ - PROXIMITY_VOXEL_MISS : 0);
+        }
+    }
+
+    uint8_t ofs[3];
+    if (!window_offsets(hit, ofs)) {
+        return;
+    }
+    uint8_t &occ = _occupancy[index(ofs[0], ofs[1], ofs[2])];
+    set_occupancy(occ, MIN(occ + PROXIMITY_VOXEL_HIT, PROXIMITY_VOXEL_MAX));
+}
+
+void AP_Proximity_Voxel::set_occupancy(uint8_t &occ, uint8_t value)
+{
+    if ((occ >= PROXIMITY_VOXEL_OCCUPIED) != (value >= PROXIMITY_VOXEL_OCCUPIED)) {
+        _changed = true;
+    }
+    occ = value;
+}
+
+void AP_Proximity_Voxel::clear_slab(uint8_t axis, uint8_t offset)
+{
+    const uint8_t p = (_origin[axis] + offset) & (dim(axis)-1);
+    const uint8_t u = (axis + 1) % 3;
+    const uint8_t v = (axis + 2) % 3;
+    for (uint8_t a = 0; a < dim(u); a++) {
+        for (uint8_t b = 0; b < dim(v); b++) {
+            _occupancy[p * strides[axis] + a * strides[u] + b * strides[v]] = 0;
+        }
+    }
+}
+
+void AP_Proximity_Voxel::recentre(const Vector3f &pos)
+{
+    int32_t centre[3];
+    voxel_coords(pos, centre);
+
+    if (!_origin_valid) {
+        for (uint8_t i = 0; i < 3; i++) {
+            _origin[i] = centre[i] - dim(i) / 2;
+        }
+        memset(_occupancy, 0, NUM_VOXELS);
+        _origin_valid = true;
+        _changed = true;
+        return;
+    }
+
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        const int32_t shift = centre[axis] - dim(axis) / 2 - _origin[axis];
+        if (shift == 0) {
+            continue;
+        }
+        if (abs(shift) >= dim(axis)) {
+            memset(_occupancy, 0, NUM_VOXELS);
+        } else if (shift > 0) {
+            // the low slabs leave the window and are reused at the top
+            for (int32_t ofs = 0; ofs < shift; ofs++) {
+                clear_slab(axis, ofs);
+            }
+        } else {
+            for (int32_t ofs = dim(axis) + shift; ofs < dim(axis); ofs++) {
+                clear_slab(axis, ofs);
+            }
+        }
+        _origin[axis] += shift;
+        _changed = true;
+    }
+}
+
+void AP_Proximity_Voxel::decay()
+{
+    for (uint16_t i = 0; i < NUM_VOXELS; i++) {
+        uint8_t &occ = _occupancy[i];
+        if (occ != 0) {
+            set_occupancy(occ, occ > PROXIMITY_VOXEL_DECAY ? occ - PROXIMITY_VOXEL_DECAY : 0);
+        }
+    }
+}
+
+void AP_Proximity_Voxel::update(const Vector3f &vehicle_pos, uint32_t now_ms)
+{
+    WITH_SEMAPHORE(_sem);
+    if (!enabled()) {
+        return;
+    }
+    recentre(vehicle_pos);
+    flush_pending();
+
+    if (now_ms - _last_decay_ms >= PROXIMITY_VOXEL_DECAY_MS) {
+        _last_decay_ms = now_ms;
+        decay();
+    }
+
+    if (_changed && now_ms - _last_field_ms >= PROXIMITY_VOXEL_FIELD_MS) {
+        _last_field_ms = now_ms;
+        build_fields();
+        _changed = false;
+    }
+}
+
+void AP_Proximity_Voxel::build_fields()
+{
+    // mark occupied voxels in every field, laid out by window offset
+    _occupied_count = 0;
+    uint8_t *occupied = &_fields[0];
+    for (uint8_t z = 0; z < PROXIMITY_VOXEL_DIM_Z; z++) {
+        for (uint8_t y = 0; y < PROXIMITY_VOXEL_DIM_XY; y++) {
+            for (uint8_t x = 0; x < PROXIMITY_VOXEL_DIM_XY; x++) {
+                const bool occ = _occupancy[index(x, y, z)] >= PROXIMITY_VOXEL_OCCUPIED;
+                occupied[field_index(x, y, z)] = occ ? 0 : FIELD_NONE;
+                _occupied_count += occ;
+            }
+        }
+    }
+    for (uint8_t dir = 1; dir < DIR_COUNT; dir++) {
+        memcpy(&_fields[dir * NUM_VOXELS], occupied, NUM_VOXELS);
+    }
+
+    build_axis_field(DIR_N, 0, 1);
+    build_axis_field(DIR_S, 0, -1);
+    build_axis_field(DIR_E, 1, 1);
+    build_axis_field(DIR_W, 1, -1);
+    build_axis_field(DIR_DOWN, 2, 1);
+    build_axis_field(DIR_UP, 2, -1);
+    build_diagonal_field(DIR_NE, 1, 1);
+    build_diagonal_field(DIR_SE, -1, 1);
+    build_diagonal_field(DIR_SW, -1, -1);
+    build_diagonal_field(DIR_NW, 1, -1);
+
+    memcpy(_field_origin, _origin, sizeof(_field_origin));
+    _fields_valid = true;
+}
+
+uint8_t AP_Proximity_Voxel::field_add(uint8_t dist, uint8_t step)
+{
+    if (dist == FIELD_NONE) {
+        return dist;
+    }
+    return MIN(uint16_t(dist) + step, uint16_t(FIELD_NONE - 1));
+}
+
+/*
+  build the field for a direction along an axis. Each voxel takes the
+  smallest distance from the 3x3 block of voxels one step further
+  along, so the field covers a square cone with 45 degree sides
+ */
+void AP_Proximity_Voxel::build_axis_field(Direction dir, uint8_t axis, int8_t sign)
+{
+    uint8_t *field = &_fields[dir * NUM_VOXELS];
+    const uint8_t u = (axis + 1) % 3;
+    const uint8_t v = (axis + 2) % 3;
+    const int32_t next = sign * strides[axis];
+
+    // the far slab has nothing beyond it
+    const uint8_t n = dim(axis);
+    for (uint8_t step = 1; step < n; step++) {
+        const uint8_t t = sign > 0 ? n - 1 - step : step;
+        for (uint8_t a = 0; a < dim(u); a++) {
+            for (uint8_t b = 0; b < dim(v); b++) {
+                const uint16_t i = t * strides[axis] + a * strides[u] + b * strides[v];
+                if (field[i] == 0) {
+                    continue;
+                }
+                uint8_t best = FIELD_NONE;
+                const uint8_t a0 = a > 0 ? a - 1 : a;
+                const uint8_t a1 = a < dim(u) - 1 ? a + 1 : a;
+                const uint8_t b0 = b > 0 ? b - 1 : b;
+                const uint8_t b1 = b < dim(v) - 1 ? b + 1 : b;
+                for (uint8_t aa = a0; aa <= a1; aa++) {
+                    for (uint8_t bb = b0; bb <= b1; bb++) {
+                        best = MIN(best, field[i + next + (aa - a) * strides[u] + (bb - b) * strides[v]]);
+                    }
+                }
+                field[i] = field_add(best, FIELD_STEP_AXIS);
+            }
+        }
+    }
+}
+
+/*
+  build the field for a horizontal diagonal. Each voxel takes the
+  smallest distance from its neighbours towards the quadrant, allowing
+  a voxel up or down at each step
+ */
+void AP_Proximity_Voxel::build_diagonal_field(Direction dir, int8_t sign_n, int8_t sign_e)
+{
+    uint8_t *field = &_fields[dir * NUM_VOXELS];
+    const int32_t next_n = sign_n;
+    const int32_t next_e = sign_e * stride_y;
+    for (uint8_t sx = 0; sx < PROXIMITY_VOXEL_DIM_XY; sx++) {
+        const uint8_t x = sign_n > 0 ? PROXIMITY_VOXEL_DIM_XY - 1 - sx : sx;
+        const bool has_n = sx > 0;
+        for (uint8_t sy = 0; sy < PROXIMITY_VOXEL_DIM_XY; sy++) {
+            const uint8_t y = sign_e > 0 ? PROXIMITY_VOXEL_DIM_XY - 1 - sy : sy;
+            const bool has_e = sy > 0;
+            if (!has_n && !has_e) {
+                continue;
+            }
+            for (uint8_t z = 0; z < PROXIMITY_VOXEL_DIM_Z; z++) {
+                const uint16_t i = field_index(x, y, z);
+                if (field[i] == 0) {
+                    continue;
+                }
+                uint8_t best_axis = FIELD_NONE;
+                uint8_t best_diag = FIELD_NONE;
+                const uint8_t z0 = z > 0 ? z - 1 : z;
+                const uint8_t z1 = z < PROXIMITY_VOXEL_DIM_Z - 1 ? z + 1 : z;
+                for (uint8_t zz = z0; zz <= z1; zz++) {
+                    const int32_t j = i + (zz - z) * int32_t(stride_z);
+                    if (has_n) {
+                        best_axis = MIN(best_axis, field[j + next_n]);
+                    }
+                    if (has_e) {
+                        best_axis = MIN(best_axis, field[j + next_e]);
+                    }
+                    if (has_n && has_e) {
+                        best_diag = MIN(best_diag, field[j + next_n + next_e]);
+                    }
+                }
+                field[i] = MIN(field_add(best_axis, FIELD_STEP_AXIS), field_add(best_diag, FIELD_STEP_DIAG));
+            }
+        }
+    }
+}
+
+uint8_t AP_Proximity_Voxel::lookup(Direction dir, const int32_t coords[3]) const
+{
+    uint8_t ofs[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        const int32_t o = coords[i] - _field_origin[i];
+        if (o < 0 || o >= dim(i)) {
+            return FIELD_NONE;
+        }
+        ofs[i] = o;
+    }
+    return _fields[dir * NUM_VOXELS + field_index(ofs[0], ofs[1], ofs[2])];
+}
+
+// convert a field value to meters from the voxel centre to the near
+// face of the obstacle voxel
+static inline float field_to_distance(uint8_t dist, float voxel_size)
+{
+    return MAX(dist * 0.5f - 0.5f, 0.0f) * voxel_size;
+}
+
+bool AP_Proximity_Voxel::get_distance_along(const Vector3f &pos, const Vector3f &dir, float &distance_m) const
+{
+    WITH_SEMAPHORE(_sem);
+    if (!_fields_valid || dir.is_zero()) {
+        return false;
+    }
+    int32_t coords[3];
+    voxel_coords(pos, coords);
+
+    // each field's cone extends 45 degrees either side of its
+    // direction, so choosing the nearest direction always leaves the
+    // velocity at least 22.5 degrees inside the cone
+    Direction d;
+    const float horizontal = dir.xy().length();
+    if (fabsf(dir.z) > horizontal) {
+        d = dir.z > 0 ? DIR_DOWN : DIR_UP;
+    } else {
+        const float bearing = wrap_360(degrees(atan2f(dir.y, dir.x)) + 22.5f);
+        d = Direction(uint8_t(bearing / 45.0f) % 8);
+    }
+
+    const uint8_t dist = lookup(d, coords);
+    if (dist == FIELD_NONE) {
+        return false;
+    }
+    distance_m = field_to_distance(dist, _voxel_size);
+    return true;
+}
+
+bool AP_Proximity_Voxel::get_closest_distance(const Vector3f &pos, float &distance_m) const
+{
+    WITH_SEMAPHORE(_sem);
+    if (!_fields_valid) {
+        return false;
+    }
+    int32_t coords[3];
+    voxel_coords(pos, coords);
+
+    // the cones of all the fields together cover every direction
+    uint8_t best = FIELD_NONE;
+    for (uint8_t d = 0; d < DIR_COUNT; d++) {
+        best = MIN(best, lookup(Direction(d), coords));
+    }
+    if (best == FIELD_NONE) {
+        return false;
+    }
+    distance_m = field_to_distance(best, _voxel_size);
+    return true;
+}
+
+bool AP_Proximity_Voxel::get_segment_clearance(const Vector3f &start, const Vector3f &end, float &clearance_m) const
+{
+    WITH_SEMAPHORE(_sem);
+    if (!_fields_valid) {
+        return false;
+    }
+    // sample the segment once per voxel
+    const Vector3f delta = end - start;
+    const uint16_t samples = MIN(uint32_t(delta.length() * _voxel_size_inv), 4U * PROXIMITY_VOXEL_DIM_XY) + 1;
+    bool found = false;
+    float smallest = FLT_MAX;
+    for (uint16_t i = 0; i <= samples; i++) {
+        float dist;
+        if (get_closest_distance(start + delta * (float(i) / samples), dist)) {
+            smallest = MIN(smallest, dist);
+            found = true;
+        }
+    }
+    if (found) {
+        clearance_m = smallest;
+    }
+    return found;
+}
+
+#endif // AP_PROXIMITY_VOXEL_ENABLED
@@ -0,0 +1,175 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  vehicle centred voxel occupancy map
+
+  The map is a fixed size grid of voxels aligned with the NED axes,
+  centred on the vehicle. As the vehicle moves the grid scrolls: the
+  storage is indexed modulo the grid size so only the slabs that leave
+  the window are cleared. Each voxel holds an occupancy count which is
+  raised by hits, lowered along the ray from the sensor to each hit and
+  decays over time.
+
+  Obstacle queries come from ten directional distance fields (the eight
+  horizontal compass directions plus up and down) rebuilt from the
+  occupancy counts at a limited rate. Each field holds, for every
+  voxel, the distance to the nearest occupied voxel inside a 45 degree
+  cone around its direction, so the distance along a velocity vector is
+  a single lookup.
+ */
+#pragma once
+
+#include "AP_Proximity_config.h"
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_HAL/Semaphores.h>
+
+#define PROXIMITY_VOXEL_DIM_XY          32      // voxels along north and east, must be a power of two
+#define PROXIMITY_VOXEL_DIM_Z           8       // voxels along down, must be a power of two
+#define PROXIMITY_VOXEL_PENDING         128     // points queued before they are added to the map
+#define PROXIMITY_VOXEL_FIELD_MS        100     // minimum interval between rebuilds of the distance fields
+
+class AP_Proximity_Voxel
+{
+public:
+    AP_Proximity_Voxel() {}
+    ~AP_Proximity_Voxel();
+
+    CLASS_NO_COPY(AP_Proximity_Voxel);
+
+    // allocate the map with the given voxel size in meters. Changing
+    // the size clears the map
+    bool init(float voxel_size_m);
+
+    // true if the map has been allocated
+    bool enabled() const { return _occupancy != nullptr; }
+
+    // queue a hit at point as seen from a sensor at sensor_pos, both
+    // NED in meters from the EKF origin. Safe to call from any thread
+    void push(const Vector3f &sensor_pos, const Vector3f &point);
+
+    // add a batch of hits seen from sensor_pos
+    void add_points(const Vector3f &sensor_pos, const Vector3f *points, uint16_t count);
+
+    // move the map to the vehicle, add queued points, decay old ones
+    // and rebuild the distance fields if anything changed
+    void update(const Vector3f &vehicle_pos, uint32_t now_ms);
+
+    // distance in meters from pos to the nearest obstacle roughly
+    // along dir (NED, need not be normalised). Returns false if pos is
+    // outside the map or no obstacle is mapped in that direction
+    bool get_distance_along(const Vector3f &pos, const Vector3f &dir, float &distance_m) const;
+
+    // distance in meters from pos to the nearest obstacle in any
+    // direction. Returns false if none is mapped
+    bool get_closest_distance(const Vector3f &pos, float &distance_m) const;
+
+    // smallest distance in meters from any point on the segment to an
+    // obstacle. Returns false if the segment is not in the map or no
+    // obstacle is mapped near it
+    bool get_segment_clearance(const Vector3f &start, const Vector3f &end, float &clearance_m) const;
+
+    // number of occupied voxels at the last rebuild of the fields
+    uint16_t get_occupied_count() const { return _occupied_count; }
+
+private:
+    enum Direction : uint8_t {
+        DIR_N = 0,
+        DIR_NE,
+        DIR_E,
+        DIR_SE,
+        DIR_S,
+        DIR_SW,
+        DIR_W,
+        DIR_NW,
+        DIR_UP,
+        DIR_DOWN,
+        DIR_COUNT
+    };
+
+    static constexpr uint16_t NUM_VOXELS = PROXIMITY_VOXEL_DIM_XY * PROXIMITY_VOXEL_DIM_XY * PROXIMITY_VOXEL_DIM_Z;
+    static constexpr uint8_t FIELD_NONE = UINT8_MAX;    // no obstacle within the map
+
+    static_assert((PROXIMITY_VOXEL_DIM_XY & (PROXIMITY_VOXEL_DIM_XY-1)) == 0, "PROXIMITY_VOXEL_DIM_XY must be a power of two");
+    static_assert((PROXIMITY_VOXEL_DIM_Z & (PROXIMITY_VOXEL_DIM_Z-1)) == 0, "PROXIMITY_VOXEL_DIM_Z must be a power of two");
+
+    // grid size along axis 0 (north), 1 (east) and 2 (down)
+    static uint8_t dim(uint8_t axis) { return axis == 2 ? PROXIMITY_VOXEL_DIM_Z : PROXIMITY_VOXEL_DIM_XY; }
+
+    // index of the voxel at the given offsets from the window corner
+    uint16_t index(uint8_t x, uint8_t y, uint8_t z) const;
+
+    // voxel coordinates of a NED position
+    void voxel_coords(const Vector3f &pos, int32_t coords[3]) const;
+
+    // convert voxel coordinates to offsets from the window corner,
+    // returning false if outside the window
+    bool window_offsets(const int32_t coords[3], uint8_t offsets[3]) const;
+
+    // add queued points. Called with _sem held
+    void flush_pending();
+
+    // add one hit, clearing voxels along the ray to it
+    void add_point(const int32_t sensor[3], const Vector3f &point);
+
+    // set a voxel, noting if it changed between free and occupied
+    void set_occupancy(uint8_t &occ, uint8_t value);
+
+    // move the window so it is centred on pos
+    void recentre(const Vector3f &pos);
+
+    // clear all voxels with the given window offset along axis
+    void clear_slab(uint8_t axis, uint8_t offset);
+
+    // lower every occupancy count
+    void decay();
+
+    // rebuild all the distance fields from the occupancy counts
+    void build_fields();
+    void build_axis_field(Direction dir, uint8_t axis, int8_t sign);
+    void build_diagonal_field(Direction dir, int8_t sign_n, int8_t sign_e);
+
+    // add a step to a field distance, saturating below FIELD_NONE
+    static uint8_t field_add(uint8_t dist, uint8_t step);
+
+    // field value for a direction at pos, FIELD_NONE if not known
+    uint8_t lookup(Direction dir, const int32_t coords[3]) const;
+
+    float _voxel_size = 0;              // meters
+    float _voxel_size_inv = 0;
+    uint8_t *_occupancy = nullptr;      // per voxel occupancy count
+    uint8_t *_fields = nullptr;         // DIR_COUNT fields, in half voxels
+    int32_t _origin[3] {};              // voxel coordinates of the window corner
+    int32_t _field_origin[3] {};        // window corner when the fields were built
+    bool _origin_valid = false;
+    bool _fields_valid = false;
+    bool _changed = false;              // a voxel became free or occupied since the fields were built
+    uint16_t _occupied_count = 0;
+    uint32_t _last_decay_ms = 0;
+    uint32_t _last_field_ms = 0;
+
+    struct PendingPoint {
+        Vector3f sensor;
+        Vector3f point;
+    } _pending[PROXIMITY_VOXEL_PENDING];
+    uint16_t _pending_count = 0;
+
+    mutable HAL_Semaphore _sem;
+};
+
+#endif // AP_PROXIMITY_VOXEL_ENABLED
@@ -73,3 +73,7 @@
 #ifndef AP_PROXIMITY_LD06_ENABLED
 #define AP_PROXIMITY_LD06_ENABLED AP_PROXIMITY_BACKEND_DEFAULT_ENABLED
 #endif
+
+#ifndef AP_PROXIMITY_VOXEL_ENABLED
+#define AP_PROXIMITY_VOXEL_ENABLED HAL_PROXIMITY_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
@@ -0,0 +1,86 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Proximity/AP_Proximity_Voxel.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_PROXIMITY_VOXEL_ENABLED
+
+/*
+  voxel map throughput for a 360 degree lidar scan of a 12m square
+  room with the vehicle in the middle. items_per_second in the ingest
+  benchmark is points added per second
+ */
+static const uint16_t scan_points = 720;
+static Vector3f scan[scan_points];
+static AP_Proximity_Voxel map;
+
+static void setup_scan()
+{
+    for (uint16_t i = 0; i < scan_points; i++) {
+        const float angle = radians(i * 360.0f / scan_points);
+        const Vector3f dir { cosf(angle), sinf(angle), 0.02f * (i % 5) };
+        // distance to the nearest wall along dir
+        const float dist = 6.0f / MAX(fabsf(dir.x), fabsf(dir.y));
+        scan[i] = dir * dist;
+    }
+    map.init(0.5f);
+    map.update(Vector3f{}, 0);
+}
+
+static void BM_voxel_ingest_scan(benchmark::State& state)
+{
+    setup_scan();
+    while (state.KeepRunning()) {
+        map.add_points(Vector3f{}, scan, scan_points);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * scan_points);
+}
+BENCHMARK(BM_voxel_ingest_scan);
+
+static void BM_voxel_push_scan(benchmark::State& state)
+{
+    setup_scan();
+    while (state.KeepRunning()) {
+        for (const auto &p : scan) {
+            map.push(Vector3f{}, p);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * scan_points);
+}
+BENCHMARK(BM_voxel_push_scan);
+
+// rebuild of all the distance fields after the map changed
+static void BM_voxel_rebuild(benchmark::State& state)
+{
+    setup_scan();
+    map.add_points(Vector3f{}, scan, scan_points);
+    uint32_t now_ms = 0;
+    while (state.KeepRunning()) {
+        // alternate between two positions so every update scrolls the
+        // window and rebuilds the fields
+        now_ms += 1000;
+        map.update(Vector3f{(now_ms / 1000) % 2 ? 0.5f : 0.0f, 0, 0}, now_ms);
+    }
+}
+BENCHMARK(BM_voxel_rebuild);
+
+static void BM_voxel_query(benchmark::State& state)
+{
+    setup_scan();
+    map.add_points(Vector3f{}, scan, scan_points);
+    map.update(Vector3f{}, 1000);
+    float angle = 0;
+    while (state.KeepRunning()) {
+        angle += 0.1f;
+        float dist;
+        bool ok = map.get_distance_along(Vector3f{}, Vector3f{cosf(angle), sinf(angle), 0}, dist);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&dist);
+    }
+}
+BENCHMARK(BM_voxel_query);
+
+#endif // AP_PROXIMITY_VOXEL_ENABLED
+
+BENCHMARK_MAIN();
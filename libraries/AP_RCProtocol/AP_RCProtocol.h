@@ -114,6 +114,7 @@ public:
     void process_pulse(uint32_t width_s0, uint32_t width_s1);
     void process_pulse_list(const uint32_t *widths, uint16_t n, bool need_swap);
     bool process_byte(uint8_t byte, uint32_t baudrate);
+    bool process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate);
     void process_handshake(uint32_t baudrate);
     void update(void);
 
@@ -68,6 +68,19 @@ void AP_RCProtocol_Backend::read(uint16_t *pwm, uint8_t n)
     memcpy(pwm, _pwm_values, n*sizeof(pwm[0]));
 }
 
+/*
+  default bulk byte input, one process_byte() call per byte
+ */
+void AP_RCProtocol_Backend::process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate)
+{
+    if (!accepts_baudrate(baudrate)) {
+        return;
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        process_byte(bytes[i], baudrate);
+    }
+}
+
 /*
   provide input from a backend
  */
@@ -32,6 +32,12 @@ public:
     virtual ~AP_RCProtocol_Backend() {}
     virtual void process_pulse(uint32_t width_s0, uint32_t width_s1) {}
     virtual void process_byte(uint8_t byte, uint32_t baudrate) {}
+    // process a burst of bytes received together. Backends that can
+    // sync on whole frames override this, the default feeds each byte
+    // to process_byte()
+    virtual void process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate);
+    // cheap check used to skip a backend for a whole burst of bytes
+    virtual bool accepts_baudrate(uint32_t baudrate) const { return true; }
     virtual void process_handshake(uint32_t baudrate) {}
     uint16_t read(uint8_t chan);
     void read(uint16_t *pwm, uint8_t n);
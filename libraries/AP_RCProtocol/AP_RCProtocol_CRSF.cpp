@@ -212,11 +212,16 @@ uint16_t AP_RCProtocol_CRSF::get_link_rate(ProtocolType protocol) const {
     }
 }
 
+bool AP_RCProtocol_CRSF::accepts_baudrate(uint32_t baudrate) const
+{
+    // reject RC data if we have been configured for standalone mode
+    return (baudrate == CRSF_BAUDRATE || baudrate == CRSF_BAUDRATE_1MBIT || baudrate == CRSF_BAUDRATE_2MBIT) && _uart == nullptr;
+}
+
 // process a byte provided by a uart from rc stack
 void AP_RCProtocol_CRSF::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    // reject RC data if we have been configured for standalone mode
-    if ((baudrate != CRSF_BAUDRATE && baudrate != CRSF_BAUDRATE_1MBIT && baudrate != CRSF_BAUDRATE_2MBIT) || _uart) {
+    if (!AP_RCProtocol_CRSF::accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(byte);
@@ -252,6 +257,69 @@ void AP_RCProtocol_CRSF::_process_byte(uint8_t byte)
     }
 }
 
+// process a burst of bytes provided by a uart from rc stack
+void AP_RCProtocol_CRSF::process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate)
+{
+    if (!AP_RCProtocol_CRSF::accepts_baudrate(baudrate)) {
+        return;
+    }
+    _process_bytes(bytes, len);
+}
+
+/*
+  process a burst of bytes from a uart. This gives the same result as
+  _process_byte() on each byte, but bytes are only looked at when
+  check_frame() can make a decision on them: sync is found with
+  memchr() and the rest of a frame is copied in one go so its CRC is
+  checked over the whole frame
+ */
+void AP_RCProtocol_CRSF::_process_bytes(const uint8_t *bytes, uint16_t len)
+{
+    const uint32_t now = AP_HAL::micros();
+
+    // check for long frame gaps, as in _process_byte()
+    if (_frame_ofs > 0 && (now - _start_frame_time_us) > CRSF_FRAME_TIMEOUT_US) {
+        _frame_ofs = 0;
+    }
+
+    while (len > 0) {
+        if (_frame_ofs >= sizeof(_frame)) {
+            _frame_ofs = 0;
+        }
+
+        if (_frame_ofs == 0) {
+            // anything before a header would be skipped by check_frame()
+            const uint8_t *header = (const uint8_t *)memchr(bytes, DeviceAddress::CRSF_ADDRESS_FLIGHT_CONTROLLER, len);
+            if (header == nullptr) {
+                return;
+            }
+            len -= header - bytes;
+            bytes = header;
+            _start_frame_time_us = now;
+        }
+
+        // take bytes up to the end of the header, then up to the end
+        // of the frame
+        uint16_t want = 1;
+        if (_frame_ofs < CRSF_HEADER_TYPE_LEN) {
+            want = CRSF_HEADER_TYPE_LEN - _frame_ofs;
+        } else if (_frame.length + CRSF_HEADER_LEN > _frame_ofs) {
+            want = _frame.length + CRSF_HEADER_LEN - _frame_ofs;
+        }
+        want = MIN(want, len);
+        want = MIN(want, uint16_t(sizeof(_frame) - _frame_ofs));
+
+        memcpy(&_frame_bytes[_frame_ofs], bytes, want);
+        _frame_ofs += want;
+        bytes += want;
+        len -= want;
+
+        if (!check_frame(now)) {
+            skip_to_next_frame(now);
+        }
+    }
+}
+
 // check if a frame is valid. Return false if the frame is definitely
 // invalid. Return true if we need more bytes
 bool AP_RCProtocol_CRSF::check_frame(uint32_t timestamp_us)
@@ -355,13 +423,15 @@ void AP_RCProtocol_CRSF::update(void)
             start_uart();
             _last_uart_start_time_ms = now;
         }
-        uint32_t n = _uart->available();
-        n = MIN(n, 255U);
-        for (uint8_t i = 0; i < n; i++) {
-            int16_t b = _uart->read();
-            if (b >= 0) {
-                _process_byte(uint8_t(b));
+        // at most 255 bytes per update
+        uint8_t buf[64];
+        for (uint16_t total = 0; total < 255; ) {
+            const ssize_t n = _uart->read(buf, MIN(uint16_t(255 - total), uint16_t(sizeof(buf))));
+            if (n <= 0) {
+                break;
             }
+            _process_bytes(buf, n);
+            total += n;
         }
     }
 
@@ -44,6 +44,8 @@ public:
     AP_RCProtocol_CRSF(AP_RCProtocol &_frontend);
     virtual ~AP_RCProtocol_CRSF();
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    void process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override;
     void process_handshake(uint32_t baudrate) override;
     void update(void) override;
 #if HAL_CRSF_TELEM_ENABLED
@@ -330,6 +332,7 @@ private:
     static AP_RCProtocol_CRSF* _singleton;
 
     void _process_byte(uint8_t byte);
+    void _process_bytes(const uint8_t *bytes, uint16_t len);
     bool check_frame(uint32_t timestamp_us);
     void skip_to_next_frame(uint32_t timestamp_us);
     bool decode_crsf_packet();
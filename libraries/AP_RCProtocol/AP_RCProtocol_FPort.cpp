@@ -319,4 +319,29 @@ void AP_RCProtocol_FPort::process_byte(uint8_t b, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), b);
 }
 
+/*
+  support bulk byte input. Between frames only a frame header can be
+  accepted, so skip straight to the next one
+ */
+void AP_RCProtocol_FPort::process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate)
+{
+    if (baudrate != 115200) {
+        return;
+    }
+    const uint32_t timestamp_us = AP_HAL::micros();
+    while (len > 0) {
+        if (byte_input.ofs == 0) {
+            const uint8_t *head = (const uint8_t *)memchr(bytes, FRAME_HEAD, len);
+            byte_input.last_byte_us = timestamp_us;
+            if (head == nullptr) {
+                return;
+            }
+            len -= head - bytes;
+            bytes = head;
+        }
+        _process_byte(timestamp_us, *bytes++);
+        len--;
+    }
+}
+
 #endif  // AP_RCPROTOCOL_FPORT_ENABLED
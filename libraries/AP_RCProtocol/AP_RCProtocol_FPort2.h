@@ -34,6 +34,7 @@ public:
     AP_RCProtocol_FPort2(AP_RCProtocol &_frontend, bool inverted);
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override { return baudrate == 115200; }
 
 private:
     void decode_control(const FPort2_Frame &frame);
@@ -185,22 +185,28 @@ void AP_RCProtocol_GHST::_process_byte(uint32_t timestamp_us, uint8_t byte)
     
     // decode whatever we got and expect
     if (_frame_ofs == _frame.length + GHST_HEADER_LEN) {
-        log_data(AP_RCProtocol::GHST, timestamp_us, (const uint8_t*)&_frame, _frame_ofs - GHST_HEADER_LEN);
+        _process_frame(timestamp_us);
+    }
+}
 
-        // we consumed the partial frame, reset
-        _frame_ofs = 0;
+// process a complete frame whose CRC has been accumulated in _frame_crc
+void AP_RCProtocol_GHST::_process_frame(uint32_t timestamp_us)
+{
+    log_data(AP_RCProtocol::GHST, timestamp_us, (const uint8_t*)&_frame, _frame.length);
 
-        // bad CRC (payload start is +1 from frame start, so need to subtract that from frame length to get index)
-        if (_frame_crc != _frame.payload[_frame.length - 2]) {
-            return;
-        }
+    // we consumed the partial frame, reset
+    _frame_ofs = 0;
 
-        _last_frame_time_us = _last_rx_frame_time_us = timestamp_us;
-        // decode here
-        if (decode_ghost_packet()) {
-            _last_tx_frame_time_us = timestamp_us;  // we have received a frame from the transmitter
-            add_input(MAX_CHANNELS, _channels, false, _link_status.rssi, _link_status.link_quality);
-        }
+    // bad CRC (payload start is +1 from frame start, so need to subtract that from frame length to get index)
+    if (_frame_crc != _frame.payload[_frame.length - 2]) {
+        return;
+    }
+
+    _last_frame_time_us = _last_rx_frame_time_us = timestamp_us;
+    // decode here
+    if (decode_ghost_packet()) {
+        _last_tx_frame_time_us = timestamp_us;  // we have received a frame from the transmitter
+        add_input(MAX_CHANNELS, _channels, false, _link_status.rssi, _link_status.link_quality);
     }
 }
 
@@ -421,16 +427,68 @@ bool AP_RCProtocol_GHST::is_telemetry_supported() const
            || _link_status.rf_mode == AP_RCProtocol_GHST::GHST_RF_MODE_RACE250;
 }
 
+bool AP_RCProtocol_GHST::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == CRSF_BAUDRATE || baudrate == GHST_BAUDRATE;
+}
+
 // process a byte provided by a uart
 void AP_RCProtocol_GHST::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    // reject RC data if we have been configured for standalone mode
-    if (baudrate != CRSF_BAUDRATE && baudrate != GHST_BAUDRATE) {
+    if (!AP_RCProtocol_GHST::accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), byte);
 }
 
+/*
+  process a burst of bytes. Frames are synced on the flight controller
+  address with memchr(), the header goes through _process_byte() to be
+  validated and the rest of the frame is copied and CRCed in one go
+ */
+void AP_RCProtocol_GHST::process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate)
+{
+    if (!AP_RCProtocol_GHST::accepts_baudrate(baudrate)) {
+        return;
+    }
+    const uint32_t timestamp_us = AP_HAL::micros();
+    uint8_t *frame_bytes = (uint8_t *)&_frame;
+
+    while (len > 0) {
+        if (_frame_ofs == 0) {
+            const uint8_t *header = (const uint8_t *)memchr(bytes, DeviceAddress::GHST_ADDRESS_FLIGHT_CONTROLLER, len);
+            if (header == nullptr) {
+                return;
+            }
+            len -= header - bytes;
+            bytes = header;
+        }
+
+        const uint8_t frame_len = _frame.length + GHST_HEADER_LEN;
+        if (_frame_ofs < GHST_HEADER_TYPE_LEN ||
+            _frame.device_address != DeviceAddress::GHST_ADDRESS_FLIGHT_CONTROLLER ||
+            _frame.length < 2 || frame_len > GHST_FRAMELEN_MAX || _frame_ofs >= frame_len ||
+            (timestamp_us - _start_frame_time_us) > GHST_FRAME_TIMEOUT_US) {
+            // header bytes, and anything unusual, go through the byte parser
+            _process_byte(timestamp_us, *bytes++);
+            len--;
+            continue;
+        }
+
+        // the CRC covers everything up to the CRC byte at the end
+        const uint8_t n = MIN(len, uint16_t(frame_len - _frame_ofs));
+        memcpy(&frame_bytes[_frame_ofs], bytes, n);
+        _frame_crc = crc8_dvb_s2_update(_frame_crc, bytes, MIN(n, uint8_t(frame_len - 1 - _frame_ofs)));
+        _frame_ofs += n;
+        bytes += n;
+        len -= n;
+
+        if (_frame_ofs == frame_len) {
+            _process_frame(timestamp_us);
+        }
+    }
+}
+
 // change the bootstrap baud rate to Ghost standard if configured
 void AP_RCProtocol_GHST::process_handshake(uint32_t baudrate)
 {
@@ -36,6 +36,8 @@ public:
     AP_RCProtocol_GHST(AP_RCProtocol &_frontend);
     virtual ~AP_RCProtocol_GHST();
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    void process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override;
     void process_handshake(uint32_t baudrate) override;
     void update(void) override;
 
@@ -168,6 +170,7 @@ private:
     static AP_RCProtocol_GHST* _singleton;
 
     void _process_byte(uint32_t timestamp_us, uint8_t byte);
+    void _process_frame(uint32_t timestamp_us);
     bool decode_ghost_packet();
     bool process_telemetry(bool check_constraint = true);
     void process_link_stats_frame(const void* data);
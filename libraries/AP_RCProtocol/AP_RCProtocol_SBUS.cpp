@@ -189,19 +189,25 @@ void AP_RCProtocol_SBUS::_process_byte(uint32_t timestamp_us, uint8_t b)
     byte_input.buf[byte_input.ofs++] = b;
 
     if (byte_input.ofs == sizeof(byte_input.buf)) {
-        log_data(AP_RCProtocol::SBUS, timestamp_us, byte_input.buf, byte_input.ofs);
-        uint16_t values[SBUS_INPUT_CHANNELS];
-        uint16_t num_values=0;
-        bool sbus_failsafe = false;
-        if (sbus_decode(byte_input.buf, values, &num_values,
-                        sbus_failsafe, SBUS_INPUT_CHANNELS) &&
-            num_values >= MIN_RCIN_CHANNELS) {
-            add_input(num_values, values, sbus_failsafe);
-        }
-        byte_input.ofs = 0;
+        decode_frame(timestamp_us);
     }
 }
 
+// decode a complete frame in byte_input
+void AP_RCProtocol_SBUS::decode_frame(uint32_t timestamp_us)
+{
+    log_data(AP_RCProtocol::SBUS, timestamp_us, byte_input.buf, byte_input.ofs);
+    uint16_t values[SBUS_INPUT_CHANNELS];
+    uint16_t num_values=0;
+    bool sbus_failsafe = false;
+    if (sbus_decode(byte_input.buf, values, &num_values,
+                    sbus_failsafe, SBUS_INPUT_CHANNELS) &&
+        num_values >= MIN_RCIN_CHANNELS) {
+        add_input(num_values, values, sbus_failsafe);
+    }
+    byte_input.ofs = 0;
+}
+
 // support byte input
 void AP_RCProtocol_SBUS::process_byte(uint8_t b, uint32_t baudrate)
 {
@@ -213,4 +219,27 @@ void AP_RCProtocol_SBUS::process_byte(uint8_t b, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), b);
 }
 
+/*
+  support bulk byte input. All bytes in a burst share a timestamp, so
+  only the first one can follow a frame gap and start a frame; the
+  rest can only complete the frame that is already open
+ */
+void AP_RCProtocol_SBUS::process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate)
+{
+    if (len == 0 || baudrate != ss.baud()) {
+        return;
+    }
+    const uint32_t timestamp_us = AP_HAL::micros();
+    _process_byte(timestamp_us, bytes[0]);
+    if (byte_input.ofs == 0) {
+        return;
+    }
+    const uint16_t n = MIN(uint16_t(len - 1), uint16_t(sizeof(byte_input.buf) - byte_input.ofs));
+    memcpy(&byte_input.buf[byte_input.ofs], &bytes[1], n);
+    byte_input.ofs += n;
+    if (byte_input.ofs == sizeof(byte_input.buf)) {
+        decode_frame(timestamp_us);
+    }
+}
+
 #endif  // AP_RCPROTOCOL_SBUS_ENABLED
@@ -29,12 +29,15 @@ public:
     AP_RCProtocol_SBUS(AP_RCProtocol &_frontend, bool inverted, uint32_t configured_baud);
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    void process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override { return baudrate == ss.baud(); }
 
     static bool sbus_decode(const uint8_t frame[25], uint16_t *values, uint16_t *num_values,
                             bool &sbus_failsafe, uint16_t max_values);
     
 private:
     void _process_byte(uint32_t timestamp_us, uint8_t byte);
+    void decode_frame(uint32_t timestamp_us);
 
     bool inverted;
     SoftSerial ss;
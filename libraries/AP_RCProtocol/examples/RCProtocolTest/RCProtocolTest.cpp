@@ -27,6 +27,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <time.h>
 #endif
 
 void setup();
@@ -152,6 +153,37 @@ static bool test_byte_protocol(const char *name, uint32_t baudrate,
     return ret;
 }
 
+/*
+  test a byte protocol handler with bulk input, one burst per frame
+ */
+static bool test_bulk_protocol(const char *name, uint32_t baudrate,
+                               const uint8_t *bytes, uint8_t nbytes,
+                               const uint16_t *values, uint8_t nvalues,
+                               uint8_t repeats,
+                               uint8_t pause_at)
+{
+    bool ret = true;
+    for (uint8_t repeat=0; repeat<repeats+4; repeat++) {
+        uint8_t ofs = 0;
+        while (ofs < nbytes) {
+            uint8_t n = nbytes - ofs;
+            if (pause_at > 0) {
+                n = MIN(n, pause_at);
+            }
+            if (ofs > 0) {
+                delay_ms(10);
+            }
+            rcprot->process_bytes(&bytes[ofs], n, baudrate);
+            ofs += n;
+        }
+        delay_ms(10);
+        if (repeat > repeats) {
+            ret &= check_result(name, true, values, nvalues);
+        }
+    }
+    return ret;
+}
+
 static void send_bit(uint8_t bit, uint32_t baudrate, bool inverted)
 {
     static uint16_t bits_0, bits_1;
@@ -253,6 +285,11 @@ static bool test_protocol(const char *name, uint32_t baudrate,
     ret &= test_byte_protocol(name, baudrate, bytes, nbytes, values, nvalues, repeats, pause_at);
     delete rcprot;
 
+    rcprot = new AP_RCProtocol();
+    rcprot->init();
+    ret &= test_bulk_protocol(name, baudrate, bytes, nbytes, values, nvalues, repeats, pause_at);
+    delete rcprot;
+
     rcprot = new AP_RCProtocol();
     rcprot->init();
     ret &= test_pulse_protocol(name, baudrate, bytes, nbytes, values, nvalues, repeats, pause_at, inverted);
@@ -278,6 +315,11 @@ static bool test_protocol_bytesonly(const char *name, uint32_t baudrate,
     ret &= test_byte_protocol(name, baudrate, bytes, nbytes, values, nvalues, repeats, pause_at);
     delete rcprot;
 
+    rcprot = new AP_RCProtocol();
+    rcprot->init();
+    ret &= test_bulk_protocol(name, baudrate, bytes, nbytes, values, nvalues, repeats, pause_at);
+    delete rcprot;
+
     rcprot = new AP_RCProtocol();
     rcprot->init();
     ret &= test_pulse_protocol(name, baudrate, bytes, nbytes, nullptr, 0, repeats, pause_at, inverted);
@@ -312,6 +354,16 @@ static void test_random(void)
             rcprot->process_byte(buf[i], b);
         }
         delete rcprot;
+
+        // and again in bursts of varying length
+        rcprot = new AP_RCProtocol();
+        rcprot->init();
+        for (uint32_t i=0; i<test_bytes; ) {
+            const uint16_t n = MIN(uint32_t(1 + buf[i] % 128), test_bytes - i);
+            rcprot->process_bytes(&buf[i], n, b);
+            i += n;
+        }
+        delete rcprot;
         rcprot = nullptr;
     }
     free(buf);
@@ -319,6 +371,58 @@ static void test_random(void)
 #endif
 }
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+static double wall_clock_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1.0e-9;
+}
+#endif
+
+/*
+  replay a recorded stream a frame at a time and report how fast it
+  decodes with byte and bulk input
+ */
+static void test_throughput(const char *name, uint32_t baudrate,
+                            const uint8_t *bytes, uint8_t nbytes,
+                            uint16_t frame_gap_ms)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    const uint32_t frames = 20000;
+    double rate[2];
+    for (uint8_t bulk=0; bulk<2; bulk++) {
+        rcprot = new AP_RCProtocol();
+        rcprot->init();
+        uint32_t decoded = 0;
+        double busy_s = 0;
+        for (uint32_t i=0; i<frames; i++) {
+            delay_ms(frame_gap_ms);
+            const double t0 = wall_clock_s();
+            if (bulk) {
+                rcprot->process_bytes(bytes, nbytes, baudrate);
+            } else {
+                for (uint8_t j=0; j<nbytes; j++) {
+                    rcprot->process_byte(bytes[j], baudrate);
+                }
+            }
+            busy_s += wall_clock_s() - t0;
+            if (rcprot->new_input()) {
+                decoded++;
+            }
+        }
+        rate[bulk] = frames * nbytes / busy_s;
+        if (decoded + 10 < frames) {
+            printf("%s: only decoded %u of %u frames\n", name, unsigned(decoded), unsigned(frames));
+            test_failures++;
+        }
+        delete rcprot;
+        rcprot = nullptr;
+    }
+    printf("%s throughput: %.1f MB/s bytes, %.1f MB/s bulk\n", name, rate[0]*1.0e-6, rate[1]*1.0e-6);
+#endif
+}
+
 //Main loop where the action takes place
 #pragma GCC diagnostic error "-Wframe-larger-than=2000"
 void loop()
@@ -478,6 +582,11 @@ void loop()
                                    0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x0F, 0x6E, };
     const uint16_t crsf_bad_output3[] = {1501, 1500, 989, 1497, 1873, 1136, 2011, 988, 988, 988, 988, 2011, 0, 0, 0, 0, 0, 0};
 
+    // GHST 12 bit channels with channels 5 to 8
+    const uint8_t ghst_bytes[] = {0x82, 0x0C, 0x30, 0x00, 0x08, 0x80, 0x00, 0x00, 0xFA,
+                                  0x80, 0x00, 0xFF, 0x64, 0x2B};
+    const uint16_t ghst_output[] = {1500, 1500, 988, 1988, 1244, 988, 1498, 1188, 0, 0, 0, 0, 0, 0, 0, 0};
+
     // CRSF with a partial frame followed by a full frame
     const uint8_t crsf_bad_bytes4[] = {
                                    0xC8, 0x14, 0x17, 0x20, 0x03, 0x0C, 0xA0, 0x00, 0xF6, 0xB7, 0x6E, 0x94, 0xFC,
@@ -518,11 +627,20 @@ void loop()
     test_protocol("FPORT2_16CH", 115200, fport2_16ch_bytes, sizeof(fport2_16ch_bytes), fport2_16ch_output, ARRAY_SIZE(fport2_16ch_output), 3, 0, true);
     test_protocol("FPORT2_24CH", 115200, fport2_24ch_bytes, sizeof(fport2_24ch_bytes), fport2_24ch_output, ARRAY_SIZE(fport2_24ch_output), 3, 0, true);
 
+    test_protocol_bytesonly("GHST", 420000, ghst_bytes, sizeof(ghst_bytes), ghst_output, ARRAY_SIZE(ghst_output), 1);
+
     /*
       now test with random data to ensure we don't have any logic bugs that can cause a crash of the parser
      */
     test_random();
 
+    if (test_count == 0) {
+        test_throughput("SBUS", 100000, sbus_bytes, sizeof(sbus_bytes), 7);
+        test_throughput("CRSF", 416666, crsf_bytes, sizeof(crsf_bytes), 2);
+        test_throughput("GHST", 420000, ghst_bytes, sizeof(ghst_bytes), 2);
+        test_throughput("FPORT", 115200, fport_bytes, sizeof(fport_bytes), 9);
+    }
+
     if (test_count++ == 10) {
         if (test_failures == 0) {
             printf("Test PASSED\n");
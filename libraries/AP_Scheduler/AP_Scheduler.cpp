@@ -32,6 +32,7 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <AP_InternalError/AP_InternalError.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Common/AP_HeapAccounting.h>
 #include <AP_HAL/SIMState.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
@@ -431,6 +432,9 @@ void AP_Scheduler::update_logging()
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+#if AP_HEAP_ACCOUNTING_ENABLED
+        AP_HeapAccounting::Write_Log();
+#endif
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
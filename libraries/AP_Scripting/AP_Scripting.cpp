@@ -20,6 +20,7 @@
 #include <AP_Scripting/AP_Scripting.h>
 #include <AP_HAL/AP_HAL.h>
 #include <GCS_MAVLink/GCS.h>
+#include <AP_Common/AP_HeapAccounting.h>
 
 #include "lua_scripts.h"
 
@@ -253,6 +254,9 @@ MAV_RESULT AP_Scripting::handle_command_int_packet(const mavlink_command_int_t &
 #pragma GCC optimize ("O0")
 
 void AP_Scripting::thread(void) {
+    // everything the scripts allocate is on this thread
+    HEAP_TAG_SCOPE(SCRIPTING);
+
     while (true) {
         // reset flags
         _stop = false;
@@ -27,6 +27,7 @@
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <AP_Rally/AP_Rally.h>
+#include <AP_Common/AP_HeapAccounting.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -495,6 +496,7 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
+    HEAP_TAG_SCOPE(TERRAIN);
     cache = (struct grid_cache *)calloc(config_cache_size, sizeof(cache[0]));
     if (cache == nullptr) {
         GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
@@ -916,6 +916,9 @@ void AP_Vehicle::reboot(bool hold_in_bootloader)
     // the IO board safety to be forced on, the parameters to flush, ...
     hal.scheduler->delay(200);
 
+    // wait for the storage backend to write out any remaining changes
+    StorageManager::flush(1000);
+
 #if HAL_WITH_IO_MCU
     iomcu.soft_reboot();
 #endif
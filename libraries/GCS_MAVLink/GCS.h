@@ -320,6 +320,9 @@ public:
     }
     static float telemetry_radio_rssi(); // 0==no signal, 1==full signal
     static bool last_txbuf_is_greater(uint8_t txbuf_limit);
+    // as above, for sending on _chan: a radio only reports on the
+    // buffer of the link it is on
+    static bool last_txbuf_is_greater(mavlink_channel_t _chan, uint8_t txbuf_limit);
 
     // mission item index to be sent on queued msg, delayed or not
     uint16_t mission_item_reached_index = AP_MISSION_CMD_INDEX_NONE;
@@ -771,6 +774,7 @@ private:
         uint8_t rssi;
         uint32_t received_ms; // time RADIO_STATUS received
         uint8_t txbuf = 100;
+        mavlink_channel_t chan; // channel RADIO_STATUS received on
     } last_radio_status;
 
     enum class Flags {
@@ -1001,13 +1005,47 @@ private:
         Write,
     };
 
+    // one open file. Sessions are identified by the session number
+    // the GCS picks along with its system and component ID
+    struct ftp_session {
+        int fd = -1;
+        FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
+        uint8_t id;
+        uint8_t sysid;
+        uint8_t compid;
+        mavlink_channel_t chan;
+        uint32_t last_active_ms;
+
+        // burst read in progress, sent a packet at a time between
+        // other requests
+        struct {
+            bool active;
+            uint8_t max_read;
+            uint16_t remaining;
+            uint16_t seq_number;
+            uint32_t offset;
+            uint32_t delay_ms;
+            uint32_t last_send_ms;
+        } burst;
+
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+        // read-ahead buffer for ordinary files
+        uint8_t *rbuf;
+        uint32_t rbuf_size;
+        uint32_t rbuf_ofs;     // file offset of rbuf[0]
+        uint32_t rbuf_len;     // valid bytes in rbuf
+#endif
+    };
+
     struct ftp_state {
         ObjectBuffer<pending_ftp> *requests;
 
-        // session specific info, currently only support a single session over all links
-        int fd = -1;
-        FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
-        int16_t current_session;
+        ftp_session sessions[AP_MAVLINK_FTP_MAX_SESSIONS];
+
+        // the last reply on each session and the last with no
+        // session, resent if the GCS asks again
+        pending_ftp *replies;
+
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
     };
@@ -1016,11 +1054,19 @@ private:
     static void ftp_error(struct pending_ftp &response, FTP_ERROR error); // FTP helper method for packing a NAK
     static int gen_dir_entry(char *dest, size_t space, const char * path, const struct dirent * entry); // FTP helper for emitting a dir response
     static void ftp_list_dir(struct pending_ftp &request, struct pending_ftp &response);
+    static ftp_session *ftp_find_session(const pending_ftp &request);
+    static ftp_session *ftp_alloc_session(const pending_ftp &request, uint32_t now);
+    static void ftp_close_session(ftp_session &session);
+    static ssize_t ftp_read(ftp_session &session, uint32_t offset, uint8_t *buf, uint8_t count);
+    static void ftp_save_reply(const pending_ftp &reply, const ftp_session *session);
 
     bool ftp_init(void);
     void handle_file_transfer_protocol(const mavlink_message_t &msg);
     bool send_ftp_reply(const pending_ftp &reply);
     void ftp_worker(void);
+    void ftp_handle_request(pending_ftp &request);
+    static void ftp_start_burst(ftp_session &session, const pending_ftp &request);
+    bool ftp_burst_step(bool &in_progress);
     void ftp_push_replies(pending_ftp &reply);
 #endif  // AP_MAVLINK_FTP_ENABLED
 
@@ -844,6 +844,15 @@ bool GCS_MAVLINK::last_txbuf_is_greater(uint8_t txbuf_limit)
     return last_radio_status.txbuf > txbuf_limit;
 }
 
+bool GCS_MAVLINK::last_txbuf_is_greater(mavlink_channel_t _chan, uint8_t txbuf_limit)
+{
+    if (last_radio_status.chan != _chan) {
+        // the report is for another link
+        return true;
+    }
+    return last_txbuf_is_greater(txbuf_limit);
+}
+
 void GCS_MAVLINK::handle_radio_status(const mavlink_message_t &msg)
 {
     mavlink_radio_t packet;
@@ -861,6 +870,7 @@ void GCS_MAVLINK::handle_radio_status(const mavlink_message_t &msg)
     }
 
     last_radio_status.txbuf = packet.txbuf;
+    last_radio_status.chan = chan;
 
     // use the state of the transmit buffer in the radio to
     // control the stream rate, giving us adaptive software
@@ -3307,6 +3317,33 @@ MAV_RESULT GCS_MAVLINK::handle_preflight_reboot(const mavlink_command_int_t &pac
 #endif
         }
 #endif
+
+#if AP_SIM_SNAPSHOT_ENABLED
+        // record or return to a snapshot of the simulation, for
+        // resetting the vehicle between autotests. The outcome is
+        // reported in a STATUSTEXT once the main loop has acted on it
+        SITL::SIM *sitl = AP::sitl();
+        if (sitl != nullptr && is_equal(packet.param4, 101.0f)) {
+            sitl->snapshot_request = SITL::SIM::SnapshotRequest::TAKE;
+            return MAV_RESULT_ACCEPTED;
+        }
+        if (sitl != nullptr && is_equal(packet.param4, 102.0f)) {
+            if (hal.util->get_soft_armed()) {
+                send_text(MAV_SEVERITY_ERROR, "SITL: snapshot restore refused, armed");
+                return MAV_RESULT_FAILED;
+            }
+            sitl->snapshot_request = SITL::SIM::SnapshotRequest::RESTORE;
+            return MAV_RESULT_ACCEPTED;
+        }
+#if AP_SIM_CHECKPOINT_ENABLED
+        // write a checkpoint which a new SITL process can be started
+        // from with --resume. Allowed in flight, that being the point
+        if (sitl != nullptr && is_equal(packet.param4, 103.0f)) {
+            sitl->snapshot_request = SITL::SIM::SnapshotRequest::CHECKPOINT;
+            return MAV_RESULT_ACCEPTED;
+        }
+#endif
+#endif  // AP_SIM_SNAPSHOT_ENABLED
     }
 
     // refuse reboot when armed:
@@ -34,6 +34,10 @@ struct GCS_MAVLINK::ftp_state GCS_MAVLINK::ftp;
 // timeout for session inactivity
 #define FTP_SESSION_TIMEOUT 3000
 
+// replies kept for resending: the last on each session, then the
+// last to a request with no session
+#define FTP_NUM_REPLIES (AP_MAVLINK_FTP_MAX_SESSIONS + 1)
+
 bool GCS_MAVLINK::ftp_init(void) {
 
     // check if ftp is disabled for memory savings
@@ -48,11 +52,17 @@ bool GCS_MAVLINK::ftp_init(void) {
         return true;
     }
 
-    ftp.requests = NEW_NOTHROW ObjectBuffer<pending_ftp>(5);
+    // allow for a couple of queued requests per session while bursts are in progress
+    ftp.requests = NEW_NOTHROW ObjectBuffer<pending_ftp>(3 + 2 * AP_MAVLINK_FTP_MAX_SESSIONS);
     if (ftp.requests == nullptr || ftp.requests->get_size() == 0) {
         goto failed;
     }
 
+    ftp.replies = NEW_NOTHROW pending_ftp[FTP_NUM_REPLIES];
+    if (ftp.replies == nullptr) {
+        goto failed;
+    }
+
     if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&GCS_MAVLINK::ftp_worker, void),
                                       "FTP", 2560, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
         goto failed;
@@ -63,6 +73,8 @@ bool GCS_MAVLINK::ftp_init(void) {
 failed:
     delete ftp.requests;
     ftp.requests = nullptr;
+    delete [] ftp.replies;
+    ftp.replies = nullptr;
     gcs().send_text(MAV_SEVERITY_WARNING, "failed to initialize MAVFTP");
 
     return false;
@@ -97,11 +109,11 @@ void GCS_MAVLINK::handle_file_transfer_protocol(const mavlink_message_t &msg) {
 
 bool GCS_MAVLINK::send_ftp_reply(const pending_ftp &reply)
 {
-    if (!last_txbuf_is_greater(33)) { // It helps avoid GCS timeout if this is less than the threshold where we slow down normal streams (<=49)
+    if (!last_txbuf_is_greater(reply.chan, 33)) { // It helps avoid GCS timeout if this is less than the threshold where we slow down normal streams (<=49)
         return false;
     }
     WITH_SEMAPHORE(comm_chan_lock(reply.chan));
-    if (!HAVE_PAYLOAD_SPACE(chan, FILE_TRANSFER_PROTOCOL)) {
+    if (!HAVE_PAYLOAD_SPACE(reply.chan, FILE_TRANSFER_PROTOCOL)) {
         return false;
     }
     uint8_t payload[251] = {};
@@ -167,423 +179,576 @@ void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
     }
 }
 
+/*
+  remember a reply so it can be resent if the GCS missed it. Each
+  session keeps its own last reply, so traffic on other sessions
+  can't push it out before the GCS retries
+ */
+void GCS_MAVLINK::ftp_save_reply(const pending_ftp &reply, const ftp_session *session)
+{
+    const uint8_t idx = (session != nullptr) ? (session - ftp.sessions) : AP_MAVLINK_FTP_MAX_SESSIONS;
+    ftp.replies[idx] = reply;
+}
+
 void GCS_MAVLINK::ftp_worker(void) {
     pending_ftp request;
-    pending_ftp reply = {};
-    reply.session = -1; // flag the reply as invalid for any reuse
 
     while (true) {
-        bool skip_push_reply = false;
+        bool busy = false;
+        if (ftp.requests != nullptr && ftp.requests->pop(request)) {
+            ftp_handle_request(request);
+            busy = true;
+        }
+
+        // send the next packet of each burst read, so that bursts on
+        // several sessions and links run side by side and don't hold
+        // up other requests
+        bool bursting = false;
+        if (ftp_burst_step(bursting)) {
+            busy = true;
+        }
 
-        while (ftp.requests == nullptr || !ftp.requests->pop(request)) {
+        if (!busy) {
             // nothing to handle, delay ourselves a bit then check again. Ideally we'd use conditional waits here
-            hal.scheduler->delay(2);
+            hal.scheduler->delay(bursting ? 1 : 2);
         }
+    }
+}
 
-        // if it's a rerequest and we still have the last response then send it
-        if ((request.sysid == reply.sysid) && (request.compid == reply.compid) &&
-            (request.session == reply.session) && (request.seq_number + 1 == reply.seq_number)) {
-            ftp_push_replies(reply);
-            continue;
+// find the open file for a request
+GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_find_session(const pending_ftp &request)
+{
+    for (auto &s : ftp.sessions) {
+        if (s.fd != -1 && s.id == request.session &&
+            s.sysid == request.sysid && s.compid == request.compid) {
+            return &s;
         }
+    }
+    return nullptr;
+}
 
-        // setup the response
-        memset(&reply, 0, sizeof(reply));
-        reply.req_opcode = request.opcode;
-        reply.session = request.session;
-        reply.seq_number = request.seq_number + 1;
-        reply.chan = request.chan;
-        reply.sysid = request.sysid;
-        reply.compid = request.compid;
-
-        // sanity check the request size
-        if (request.size > sizeof(request.data)) {
-            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-            ftp_push_replies(reply);
-            continue;
+/*
+  get a free session, closing the longest idle one if they are all in
+  use and it has had no activity for FTP_SESSION_TIMEOUT
+ */
+GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_alloc_session(const pending_ftp &request, uint32_t now)
+{
+    ftp_session *ret = nullptr;
+    for (auto &s : ftp.sessions) {
+        if (s.fd == -1) {
+            ret = &s;
+            break;
+        }
+        if (now - s.last_active_ms >= FTP_SESSION_TIMEOUT &&
+            (ret == nullptr || s.last_active_ms < ret->last_active_ms)) {
+            ret = &s;
         }
+    }
+    if (ret == nullptr) {
+        return nullptr;
+    }
+    ftp_close_session(*ret);
+    ret->id = request.session;
+    ret->sysid = request.sysid;
+    ret->compid = request.compid;
+    ret->chan = request.chan;
+    ret->last_active_ms = now;
+    return ret;
+}
 
-        uint32_t now = AP_HAL::millis();
+void GCS_MAVLINK::ftp_close_session(ftp_session &session)
+{
+    if (session.fd != -1) {
+        AP::FS().close(session.fd);
+        session.fd = -1;
+    }
+    session.burst.active = false;
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+    if (session.rbuf != nullptr) {
+        hal.util->free_type(session.rbuf, session.rbuf_size, AP_HAL::Util::MEM_FILESYSTEM);
+        session.rbuf = nullptr;
+    }
+    session.rbuf_size = 0;
+    session.rbuf_len = 0;
+#endif
+}
 
-        // check for session termination
-        if (request.session != ftp.current_session &&
-            (request.opcode == FTP_OP::TerminateSession || request.opcode == FTP_OP::ResetSessions)) {
-            // terminating a different session, just ack
-            reply.opcode = FTP_OP::Ack;
-        } else if (ftp.fd != -1 && request.session != ftp.current_session &&
-                   now - ftp.last_send_ms < FTP_SESSION_TIMEOUT) {
-            // if we have an open file and the session isn't right
-            // then reject. This prevents IO on the wrong file
-            ftp_error(reply, FTP_ERROR::InvalidSession);
-        } else {
-            if (ftp.fd != -1 &&
-                request.session != ftp.current_session &&
-                now - ftp.last_send_ms >= FTP_SESSION_TIMEOUT) {
-                // if a new session appears and the old session has
-                // been idle for more than the timeout then force
-                // close the old session
-                AP::FS().close(ftp.fd);
-                ftp.fd = -1;
-                ftp.current_session = -1;
+/*
+  read from a session's file at offset. Ordinary files are read through
+  the read-ahead buffer so a burst costs one filesystem read per
+  buffer rather than a seek and read per packet
+ */
+ssize_t GCS_MAVLINK::ftp_read(ftp_session &session, uint32_t offset, uint8_t *buf, uint8_t count)
+{
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+    if (session.rbuf != nullptr) {
+        if (offset < session.rbuf_ofs || offset + count > session.rbuf_ofs + session.rbuf_len) {
+            if (AP::FS().lseek(session.fd, offset, SEEK_SET) == -1) {
+                return -1;
             }
-            // dispatch the command as needed
-            switch (request.opcode) {
-                case FTP_OP::None:
-                    reply.opcode = FTP_OP::Ack;
-                    break;
-                case FTP_OP::TerminateSession:
-                case FTP_OP::ResetSessions:
-                    // we already handled this, just listed for completeness
-                    if (ftp.fd != -1) {
-                        AP::FS().close(ftp.fd);
-                        ftp.fd = -1;
-                    }
-                    ftp.current_session = -1;
-                    reply.opcode = FTP_OP::Ack;
-                    break;
-                case FTP_OP::ListDirectory:
-                    ftp_list_dir(request, reply);
-                    break;
-                case FTP_OP::OpenFileRO:
-                    {
-                        // only allow one file to be open per session
-                        if (ftp.fd != -1 && now - ftp.last_send_ms > FTP_SESSION_TIMEOUT) {
-                            // no activity for 3s, assume client has
-                            // timed out receiving open reply, close
-                            // the file
-                            AP::FS().close(ftp.fd);
-                            ftp.fd = -1;
-                            ftp.current_session = -1;
-                        }
-                        if (ftp.fd != -1) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
+            const ssize_t nread = AP::FS().read(session.fd, session.rbuf, session.rbuf_size);
+            if (nread == -1) {
+                session.rbuf_len = 0;
+                return -1;
+            }
+            session.rbuf_ofs = offset;
+            session.rbuf_len = nread;
+        }
+        const uint32_t n = MIN(session.rbuf_ofs + session.rbuf_len - offset, count);
+        memcpy(buf, &session.rbuf[offset - session.rbuf_ofs], n);
+        return n;
+    }
+#endif
+    if (AP::FS().lseek(session.fd, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    return AP::FS().read(session.fd, buf, count);
+}
 
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+void GCS_MAVLINK::ftp_handle_request(pending_ftp &request)
+{
+    // if it's a rerequest and we still have the last response then send it
+    for (uint8_t i=0; i<FTP_NUM_REPLIES; i++) {
+        pending_ftp &last = ftp.replies[i];
+        if (last.sysid != 0 && (request.sysid == last.sysid) && (request.compid == last.compid) &&
+            (request.session == last.session) && (request.seq_number + 1 == last.seq_number)) {
+            ftp_push_replies(last);
+            return;
+        }
+    }
 
-                        // get the file size
-                        struct stat st;
-                        if (AP::FS().stat((char *)request.data, &st)) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        const size_t file_size = st.st_size;
+    // setup the response
+    pending_ftp reply {};
+    reply.req_opcode = request.opcode;
+    reply.session = request.session;
+    reply.seq_number = request.seq_number + 1;
+    reply.chan = request.chan;
+    reply.sysid = request.sysid;
+    reply.compid = request.compid;
+
+    // sanity check the request size
+    if (request.size > sizeof(request.data)) {
+        ftp_error(reply, FTP_ERROR::InvalidDataSize);
+        ftp_push_replies(reply);
+        ftp_save_reply(reply, nullptr);
+        return;
+    }
 
-                        // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data, O_RDONLY);
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        ftp.mode = FTP_FILE_MODE::Read;
-                        ftp.current_session = request.session;
+    const uint32_t now = AP_HAL::millis();
+    ftp_session *session = ftp_find_session(request);
 
-                        reply.opcode = FTP_OP::Ack;
-                        reply.size = sizeof(uint32_t);
-                        put_le32_ptr(reply.data, (uint32_t)file_size);
+    // dispatch the command as needed
+    switch (request.opcode) {
+        case FTP_OP::None:
+            reply.opcode = FTP_OP::Ack;
+            break;
+        case FTP_OP::TerminateSession:
+            if (session != nullptr) {
+                ftp_close_session(*session);
+            }
+            reply.opcode = FTP_OP::Ack;
+            break;
+        case FTP_OP::ResetSessions:
+            // close everything this GCS has open
+            for (auto &s : ftp.sessions) {
+                if (s.fd != -1 && s.sysid == request.sysid && s.compid == request.compid) {
+                    ftp_close_session(s);
+                }
+            }
+            reply.opcode = FTP_OP::Ack;
+            break;
+        case FTP_OP::ListDirectory:
+            ftp_list_dir(request, reply);
+            break;
+        case FTP_OP::OpenFileRO:
+            {
+                // only allow one file to be open per session
+                if (session != nullptr && now - session->last_active_ms > FTP_SESSION_TIMEOUT) {
+                    // no activity for 3s, assume client has
+                    // timed out receiving open reply, close
+                    // the file
+                    ftp_close_session(*session);
+                    session = nullptr;
+                }
+                if (session != nullptr) {
+                    ftp_error(reply, FTP_ERROR::Fail);
+                    break;
+                }
 
-                        // provide compatibility with old protocol banner download
-                        if (strncmp((const char *)request.data, "@PARAM/param.pck", 16) == 0) {
-                            ftp.need_banner_send_mask |= 1U<<reply.chan;
-                        }
-                        break;
-                    }
-                case FTP_OP::ReadFile:
-                    {
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
 
-                        // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                // get the file size
+                struct stat st;
+                if (AP::FS().stat((char *)request.data, &st)) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+                const size_t file_size = st.st_size;
 
-                        // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data),request.size));
-                        if (read_bytes == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        if (read_bytes == 0) {
-                            ftp_error(reply, FTP_ERROR::EndOfFile);
-                            break;
-                        }
+                session = ftp_alloc_session(request, now);
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::NoSessionsAvailable);
+                    break;
+                }
 
-                        reply.opcode = FTP_OP::Ack;
-                        reply.offset = request.offset;
-                        reply.size = (uint8_t)read_bytes;
-                        break;
-                    }
-                case FTP_OP::Ack:
-                case FTP_OP::Nack:
-                    // eat these, we just didn't expect them
-                    continue;
+                // actually open the file
+                session->fd = AP::FS().open((char *)request.data, O_RDONLY);
+                if (session->fd == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
                     break;
-                case FTP_OP::OpenFileWO:
-                case FTP_OP::CreateFile:
-                    {
-                        // only allow one file to be open per session
-                        if (ftp.fd != -1) {
-                            ftp_error(reply, FTP_ERROR::Fail);
+                }
+                session->mode = FTP_FILE_MODE::Read;
+
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+                /*
+                  read-ahead only for ordinary files. The
+                  virtual files under @ pack their contents
+                  to suit the read size the GCS asks for
+                 */
+                if (request.data[0] != '@') {
+                    uint32_t bufsize = MIN(uint32_t(AP_MAVLINK_FTP_READAHEAD_SIZE), uint32_t(file_size));
+                    while (bufsize >= 1024) {
+                        session->rbuf = (uint8_t *)hal.util->malloc_type(bufsize, AP_HAL::Util::MEM_FILESYSTEM);
+                        if (session->rbuf != nullptr) {
+                            session->rbuf_size = bufsize;
                             break;
                         }
+                        bufsize /= 2;
+                    }
+                    session->rbuf_ofs = 0;
+                    session->rbuf_len = 0;
+                }
+#endif
 
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
+                reply.opcode = FTP_OP::Ack;
+                reply.size = sizeof(uint32_t);
+                put_le32_ptr(reply.data, (uint32_t)file_size);
 
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+                // provide compatibility with old protocol banner download
+                if (strncmp((const char *)request.data, "@PARAM/param.pck", 16) == 0) {
+                    ftp.need_banner_send_mask |= 1U<<reply.chan;
+                }
+                break;
+            }
+        case FTP_OP::ReadFile:
+            {
+                // must actually be working on a file
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::FileNotFound);
+                    break;
+                }
+                session->last_active_ms = now;
 
-                        // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data,
-                                               (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        ftp.mode = FTP_FILE_MODE::Write;
-                        ftp.current_session = request.session;
+                // must have the file in read mode
+                if ((session->mode != FTP_FILE_MODE::Read)) {
+                    ftp_error(reply, FTP_ERROR::Fail);
+                    break;
+                }
 
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::WriteFile:
-                    {
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
+                // fill the buffer
+                const ssize_t read_bytes = ftp_read(*session, request.offset, reply.data, MIN(sizeof(reply.data),request.size));
+                if (read_bytes == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+                if (read_bytes == 0) {
+                    ftp_error(reply, FTP_ERROR::EndOfFile);
+                    break;
+                }
 
-                        // must have the file in write mode
-                        if ((ftp.mode != FTP_FILE_MODE::Write)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
+                reply.opcode = FTP_OP::Ack;
+                reply.offset = request.offset;
+                reply.size = (uint8_t)read_bytes;
+                break;
+            }
+        case FTP_OP::Ack:
+        case FTP_OP::Nack:
+            // eat these, we just didn't expect them
+            return;
+        case FTP_OP::OpenFileWO:
+        case FTP_OP::CreateFile:
+            {
+                // only allow one file to be open per session
+                if (session != nullptr) {
+                    ftp_error(reply, FTP_ERROR::Fail);
+                    break;
+                }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
 
-                        // fill the buffer
-                        const ssize_t write_bytes = AP::FS().write(ftp.fd, request.data, request.size);
-                        if (write_bytes == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
-                        reply.opcode = FTP_OP::Ack;
-                        reply.offset = request.offset;
-                        break;
-                    }
-                case FTP_OP::CreateDirectory:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
+                session = ftp_alloc_session(request, now);
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::NoSessionsAvailable);
+                    break;
+                }
 
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+                // actually open the file
+                session->fd = AP::FS().open((char *)request.data,
+                                            (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
+                if (session->fd == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+                session->mode = FTP_FILE_MODE::Write;
 
-                        // actually make the directory
-                        if (AP::FS().mkdir((char *)request.data) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::WriteFile:
+            {
+                // must actually be working on a file
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::FileNotFound);
+                    break;
+                }
+                session->last_active_ms = now;
 
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::RemoveDirectory:
-                case FTP_OP::RemoveFile:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
+                // must have the file in write mode
+                if ((session->mode != FTP_FILE_MODE::Write)) {
+                    ftp_error(reply, FTP_ERROR::Fail);
+                    break;
+                }
 
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+                // seek to requested offset
+                if (AP::FS().lseek(session->fd, request.offset, SEEK_SET) == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
 
-                        // remove the file/dir
-                        if (AP::FS().unlink((char *)request.data) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                // fill the buffer
+                const ssize_t write_bytes = AP::FS().write(session->fd, request.data, request.size);
+                if (write_bytes == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
 
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::CalcFileCRC32:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
+                reply.opcode = FTP_OP::Ack;
+                reply.offset = request.offset;
+                break;
+            }
+        case FTP_OP::CreateDirectory:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
 
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
-                        uint32_t checksum = 0;
-                        if (!AP::FS().crc32((char *)request.data, checksum)) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                // actually make the directory
+                if (AP::FS().mkdir((char *)request.data) == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
 
-                        // reset our scratch area so we don't leak data, and can leverage trimming
-                        memset(reply.data, 0, sizeof(reply.data));
-                        reply.size = sizeof(uint32_t);
-                        put_le32_ptr(reply.data, checksum);
-                        reply.opcode = FTP_OP::Ack;
-                        break;
-                    }
-                case FTP_OP::BurstReadFile:
-                    {
-                        const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::RemoveDirectory:
+        case FTP_OP::RemoveFile:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
 
-                        // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                // remove the file/dir
+                if (AP::FS().unlink((char *)request.data) == -1) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
 
-                        /*
-                          calculate a burst delay so that FTP burst
-                          transfer doesn't use more than 1/3 of
-                          available bandwidth on links that don't have
-                          flow control. This reduces the chance of
-                          lost packets a lot, which results in overall
-                          faster transfers
-                         */
-                        uint32_t burst_delay_ms = 0;
-                        if (valid_channel(request.chan)) {
-                            auto *port = mavlink_comm_port[request.chan];
-                            if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
-                                const uint32_t bw = port->bw_in_bytes_per_second();
-                                const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
-                                burst_delay_ms = 3000 * pkt_size / bw;
-                            }
-                        }
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::CalcFileCRC32:
+            {
+                // sanity check that our the request looks well formed
+                const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                if ((file_name_len != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
 
-                        // this transfer size is enough for a full parameter file with max parameters
-                        const uint32_t transfer_size = 500;
-                        for (uint32_t i = 0; (i < transfer_size); i++) {
-                            // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data), max_read));
-                            if (read_bytes == -1) {
-                                ftp_error(reply, FTP_ERROR::FailErrno);
-                                break;
-                            }
-
-                            if (read_bytes != sizeof(reply.data)) {
-                                // don't send any old data
-                                memset(reply.data + read_bytes, 0, sizeof(reply.data) - read_bytes);
-                            }
-
-                            if (read_bytes == 0) {
-                                ftp_error(reply, FTP_ERROR::EndOfFile);
-                                break;
-                            }
-
-                            reply.opcode = FTP_OP::Ack;
-                            reply.offset = request.offset + i * max_read;
-                            reply.burst_complete = (i == (transfer_size - 1));
-                            reply.size = (uint8_t)read_bytes;
-
-                            ftp_push_replies(reply);
-
-                            if (read_bytes < max_read) {
-                                // ensure the NACK which we send next is at the right offset
-                                reply.offset += read_bytes;
-                            }
-
-                            // prep the reply to be used again
-                            reply.seq_number++;
-
-                            hal.scheduler->delay(burst_delay_ms);
-                        }
+                request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
-                        if (reply.opcode != FTP_OP::Nack) {
-                            // prevent a duplicate packet send for
-                            // normal replies of burst reads
-                            skip_push_reply = true;
-                        }
-                        break;
-                    }
+                uint32_t checksum = 0;
+                if (!AP::FS().crc32((char *)request.data, checksum)) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
 
-                case FTP_OP::Rename: {
-                    // sanity check that the request looks well formed
-                    const char *filename1 = (char*)request.data;
-                    const size_t len1 = strnlen(filename1, sizeof(request.data)-2);
-                    const char *filename2 = (char*)&request.data[len1+1];
-                    const size_t len2 = strnlen(filename2, sizeof(request.data)-(len1+1));
-                    if (filename1[len1] != 0 || (len1+len2+1 != request.size) || (request.size == 0)) {
-                        ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                        break;
-                    }
-                    request.data[sizeof(request.data) - 1] = 0; // ensure the 2nd path is null terminated
-                    // remove the file/dir
-                    if (AP::FS().rename(filename1, filename2) != 0) {
-                        ftp_error(reply, FTP_ERROR::FailErrno);
-                        break;
-                    }
-                    reply.opcode = FTP_OP::Ack;
+                // reset our scratch area so we don't leak data, and can leverage trimming
+                memset(reply.data, 0, sizeof(reply.data));
+                reply.size = sizeof(uint32_t);
+                put_le32_ptr(reply.data, checksum);
+                reply.opcode = FTP_OP::Ack;
+                break;
+            }
+        case FTP_OP::BurstReadFile:
+            {
+                // must actually be working on a file
+                if (session == nullptr) {
+                    ftp_error(reply, FTP_ERROR::FileNotFound);
                     break;
                 }
+                session->last_active_ms = now;
 
-                case FTP_OP::TruncateFile:
-                default:
-                    // this was bad data, just nack it
-                    gcs().send_text(MAV_SEVERITY_DEBUG, "Unsupported FTP: %d", static_cast<int>(request.opcode));
+                // must have the file in read mode
+                if ((session->mode != FTP_FILE_MODE::Read)) {
                     ftp_error(reply, FTP_ERROR::Fail);
                     break;
+                }
+
+                // the replies are sent by ftp_burst_step(). A
+                // new burst replaces any still in progress on
+                // this session, as the GCS has moved on to
+                // filling a gap
+                ftp_start_burst(*session, request);
+                return;
+            }
+
+        case FTP_OP::Rename: {
+            // sanity check that the request looks well formed
+            const char *filename1 = (char*)request.data;
+            const size_t len1 = strnlen(filename1, sizeof(request.data)-2);
+            const char *filename2 = (char*)&request.data[len1+1];
+            const size_t len2 = strnlen(filename2, sizeof(request.data)-(len1+1));
+            if (filename1[len1] != 0 || (len1+len2+1 != request.size) || (request.size == 0)) {
+                ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                break;
+            }
+            request.data[sizeof(request.data) - 1] = 0; // ensure the 2nd path is null terminated
+            // remove the file/dir
+            if (AP::FS().rename(filename1, filename2) != 0) {
+                ftp_error(reply, FTP_ERROR::FailErrno);
+                break;
             }
+            reply.opcode = FTP_OP::Ack;
+            break;
         }
 
-        if (!skip_push_reply) {
-            ftp_push_replies(reply);
+        case FTP_OP::TruncateFile:
+        default:
+            // this was bad data, just nack it
+            gcs().send_text(MAV_SEVERITY_DEBUG, "Unsupported FTP: %d", static_cast<int>(request.opcode));
+            ftp_error(reply, FTP_ERROR::Fail);
+            break;
+    }
+
+    ftp_push_replies(reply);
+    ftp_save_reply(reply, session);
+}
+
+// setup a burst read on a session
+void GCS_MAVLINK::ftp_start_burst(ftp_session &session, const pending_ftp &request)
+{
+    auto &burst = session.burst;
+    burst.max_read = (request.size == 0 || request.size > sizeof(request.data)) ? sizeof(request.data) : request.size;
+    burst.offset = request.offset;
+    burst.seq_number = request.seq_number + 1;
+    // this transfer size is enough for a full parameter file with max parameters
+    burst.remaining = 500;
+    burst.last_send_ms = 0;
+    burst.active = true;
+
+    /*
+      calculate a burst delay so that FTP burst
+      transfer doesn't use more than 1/3 of
+      available bandwidth on links that don't have
+      flow control. This reduces the chance of
+      lost packets a lot, which results in overall
+      faster transfers
+     */
+    burst.delay_ms = 0;
+    if (valid_channel(request.chan)) {
+        auto *port = mavlink_comm_port[request.chan];
+        if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
+            const uint32_t bw = port->bw_in_bytes_per_second();
+            const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(request.data) - burst.max_read);
+            burst.delay_ms = 3000 * pkt_size / bw;
         }
+    }
+}
 
-        continue;
+/*
+  send the next reply of each burst read that is due and has room on
+  its link. Returns true if anything was sent
+ */
+bool GCS_MAVLINK::ftp_burst_step(bool &in_progress)
+{
+    bool sent = false;
+    in_progress = false;
+    for (auto &s : ftp.sessions) {
+        auto &burst = s.burst;
+        if (!burst.active) {
+            continue;
+        }
+        in_progress = true;
+        const uint32_t now = AP_HAL::millis();
+        if (burst.delay_ms != 0 && now - burst.last_send_ms < burst.delay_ms) {
+            continue;
+        }
+
+        pending_ftp reply {};
+        reply.req_opcode = FTP_OP::BurstReadFile;
+        reply.session = s.id;
+        reply.seq_number = burst.seq_number;
+        reply.chan = s.chan;
+        reply.sysid = s.sysid;
+        reply.compid = s.compid;
+        reply.offset = burst.offset;
+
+        const ssize_t read_bytes = ftp_read(s, burst.offset, reply.data, burst.max_read);
+        if (read_bytes == -1) {
+            ftp_error(reply, FTP_ERROR::FailErrno);
+        } else if (read_bytes == 0) {
+            ftp_error(reply, FTP_ERROR::EndOfFile);
+        } else {
+            reply.opcode = FTP_OP::Ack;
+            reply.burst_complete = (burst.remaining == 1);
+            reply.size = (uint8_t)read_bytes;
+        }
+
+        if (!send_ftp_reply(reply)) {
+            // no room on the link, try again next time around
+            continue;
+        }
+        sent = true;
+        ftp.last_send_ms = now;
+        s.last_active_ms = now;
+        burst.last_send_ms = now;
+        burst.seq_number++;
+        burst.remaining--;
+        if (reply.opcode == FTP_OP::Ack) {
+            burst.offset += read_bytes;
+        }
+        if (reply.opcode == FTP_OP::Nack || burst.remaining == 0) {
+            burst.active = false;
+            ftp_save_reply(reply, &s);
+        }
     }
+    return sent;
 }
 
 // calculates how much string length is needed to fit this in a list response
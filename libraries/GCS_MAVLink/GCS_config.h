@@ -108,6 +108,27 @@
 #define AP_MAVLINK_FTP_ENABLED HAL_GCS_ENABLED
 #endif
 
+// number of files that may be open over MAVLink FTP at once
+#ifndef AP_MAVLINK_FTP_MAX_SESSIONS
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MAVLINK_FTP_MAX_SESSIONS 4
+#else
+#define AP_MAVLINK_FTP_MAX_SESSIONS 1
+#endif
+#endif
+
+// size of the per session read-ahead buffer for burst reads of
+// ordinary files, 0 to disable
+#ifndef AP_MAVLINK_FTP_READAHEAD_SIZE
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 16384
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 4096
+#else
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 0
+#endif
+#endif
+
 // GCS should be using MISSION_REQUEST_INT instead; this is a waste of
 // flash.  MISSION_REQUEST was deprecated in June 2020.  We started
 // sending warnings to the GCS in Sep 2022 if this command was used.
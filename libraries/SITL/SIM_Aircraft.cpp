@@ -107,13 +107,11 @@ void Aircraft::set_start_location(const Location &start_loc, const float start_y
 float Aircraft::ground_height_difference() const
 {
 #if AP_TERRAIN_AVAILABLE
-    AP_Terrain *terrain = AP::terrain();
     float h1, h2;
     if (sitl &&
-        terrain != nullptr &&
         sitl->terrain_enable &&
-        terrain->height_amsl(home, h1, false) &&
-        terrain->height_amsl(location, h2, false)) {
+        terrain_height_amsl(home, h1) &&
+        terrain_height_amsl(location, h2)) {
         h2 += local_ground_level;
         return h2 - h1;
     }
@@ -121,6 +119,73 @@ float Aircraft::ground_height_difference() const
     return local_ground_level;
 }
 
+#if AP_TERRAIN_AVAILABLE
+bool Aircraft::terrain_height_amsl(const Location &loc, float &height) const
+{
+#if AP_SIM_TERRAIN_MAP_ENABLED
+    if (terrain_map.height_amsl(loc, height)) {
+        return true;
+    }
+#endif
+    AP_Terrain *terrain = AP::terrain();
+    return terrain != nullptr && terrain->height_amsl(loc, height, false);
+}
+#endif
+
+#if AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
+// half the side of the square the terrain map covers
+#define TERRAIN_MAP_RADIUS_M 10000
+// reload the map around the vehicle when it gets this close to the edge
+#define TERRAIN_MAP_MARGIN_M 2000
+// don't reload the map more often than this, as it is read from disk
+#define TERRAIN_MAP_RELOAD_US 30000000ULL
+// simulation time after starting a background load that its map is used
+#define TERRAIN_MAP_LOAD_US 1000000ULL
+
+void Aircraft::update_terrain_map(void)
+{
+    if (sitl == nullptr || !sitl->terrain_enable) {
+        return;
+    }
+    if (terrain_map_load_pending) {
+        // switch maps at a fixed simulation time, waiting for the
+        // load if need be, so every run sees the same ground
+        if (time_now_us - terrain_map_load_us >= TERRAIN_MAP_LOAD_US) {
+            terrain_map.finish_load();
+            terrain_map_load_pending = false;
+        }
+        return;
+    }
+    float height;
+    if (terrain_map.covers(location, TERRAIN_MAP_MARGIN_M) &&
+        terrain_map.height_amsl(location, height)) {
+        return;
+    }
+    if (terrain_map_load_us != 0 && time_now_us - terrain_map_load_us < TERRAIN_MAP_RELOAD_US) {
+        return;
+    }
+    terrain_map_load_us = MAX(time_now_us, uint64_t(1));
+
+    // the .DAT files are those the vehicle's AP_Terrain keeps, so
+    // share its directory and grid spacing
+    const AP_Terrain *terrain = AP::terrain();
+    if (terrain == nullptr || terrain->get_grid_spacing() == 0) {
+        return;
+    }
+    const char *dir = hal.util->get_custom_terrain_directory();
+    if (dir == nullptr) {
+        dir = HAL_BOARD_TERRAIN_DIRECTORY;
+    }
+    if (!terrain_map.loaded()) {
+        // the first map is loaded before the model moves on
+        terrain_map.load_dat(dir, location, terrain->get_grid_spacing(), TERRAIN_MAP_RADIUS_M);
+        return;
+    }
+    // the old map, then AP_Terrain, answer until the new map is used
+    terrain_map_load_pending = terrain_map.load_dat_background(dir, location, terrain->get_grid_spacing(), TERRAIN_MAP_RADIUS_M);
+}
+#endif
+
 void Aircraft::set_precland(SIM_Precland *_precland) {
     precland = _precland;
     precland->set_default_location(home.lat * 1.0e-7f, home.lng * 1.0e-7f, static_cast<int16_t>(get_home_yaw()));
@@ -621,6 +686,9 @@ void Aircraft::update_home()
         loc.alt = sitl->opos.alt.get() * 1.0e2;
         set_start_location(loc, sitl->opos.hdg.get());
     }
+#if AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
+    update_terrain_map();
+#endif
 }
 
 void Aircraft::update_model(const struct sitl_input &input)
@@ -834,6 +902,38 @@ void Aircraft::update_wind(const struct sitl_input &input)
     wind_ef = -wind_ef;
 }
 
+void Aircraft::get_kinematic_state(KinematicState &state) const
+{
+    state.origin = origin;
+    state.location = location;
+    state.position = position;
+    state.dcm = dcm;
+    state.velocity_ef = velocity_ef;
+    state.gyro = gyro;
+    state.accel_body = accel_body;
+}
+
+/*
+  move the vehicle to a previously recorded state. Simulation time
+  carries on from where it is
+ */
+void Aircraft::set_kinematic_state(const KinematicState &state)
+{
+    origin = state.origin;
+    location = state.location;
+    position = state.position;
+    dcm = state.dcm;
+    velocity_ef = state.velocity_ef;
+    gyro = state.gyro;
+    accel_body = state.accel_body;
+
+    velocity_air_ef = velocity_ef - wind_ef;
+    velocity_air_bf = dcm.transposed() * velocity_air_ef;
+
+    // don't smooth our way there from wherever we were
+    smoothing.last_update_us = 0;
+}
+
 /*
   smooth sensors for kinematic consistancy when we interact with the ground
  */
@@ -38,6 +38,7 @@
 #include <Filter/Filter.h>
 #include "SIM_JSON_Master.h"
 #include "ServoModel.h"
+#include "SIM_TerrainMap.h"
 
 namespace SITL {
 
@@ -57,6 +58,19 @@ public:
     void set_speedup(float speedup);
     float get_speedup() const { return target_speedup; }
 
+    /*
+      step as fast as possible rather than syncing to the wall clock,
+      for running models outside of a vehicle
+     */
+    void disable_time_sync() { use_time_sync = false; }
+
+    // simulation time of the last step
+    uint64_t get_time_us() const { return time_now_us; }
+
+    // carry on from a given simulation time, when resuming a
+    // checkpoint before the first step
+    void set_time_us(uint64_t time_us) { time_now_us = last_time_us = time_us; }
+
     /*
       set instance number
      */
@@ -143,6 +157,29 @@ public:
     const Location &get_home() const { return home; }
     float get_home_yaw() const { return home_yaw; }
 
+#if AP_TERRAIN_AVAILABLE
+    // terrain height at loc, from the terrain map where it has data
+    // and from AP_Terrain where it doesn't
+    bool terrain_height_amsl(const Location &loc, float &height) const;
+#endif
+
+    /*
+      the rigid body state of the vehicle, for snapshots of the
+      simulation. Model specific state such as motor speeds or
+      engine temperatures is not included
+     */
+    struct KinematicState {
+        Location origin;
+        Location location;
+        Vector3d position;                  // meters, NED from origin
+        Matrix3f dcm;
+        Vector3f velocity_ef;
+        Vector3f gyro;
+        Vector3f accel_body;
+    };
+    void get_kinematic_state(KinematicState &state) const;
+    void set_kinematic_state(const KinematicState &state);
+
     void set_buzzer(Buzzer *_buzzer) { buzzer = _buzzer; }
     void set_sprayer(Sprayer *_sprayer) { sprayer = _sprayer; }
     void set_parachute(Parachute *_parachute) { parachute = _parachute; }
@@ -355,6 +392,14 @@ private:
 
     ServoModel servo_filter[16];
 
+#if AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
+    // reload the terrain map around the vehicle as it nears the edge
+    void update_terrain_map(void);
+    TerrainMap terrain_map;
+    uint64_t terrain_map_load_us;
+    bool terrain_map_load_pending;
+#endif
+
     Buzzer *buzzer;
     Sprayer *sprayer;
     Gripper_Servo *gripper;
@@ -0,0 +1,584 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  headless batch runner for the built in physics models
+ */
+
+#include "SIM_BatchRunner.h"
+
+#if AP_SIM_BATCHRUNNER_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+#include "SIM_Multicopter.h"
+#include "SIM_Helicopter.h"
+#include "SIM_SingleCopter.h"
+#include "SIM_Plane.h"
+#include "SIM_Glider.h"
+#include "SIM_QuadPlane.h"
+#include "SIM_Rover.h"
+#include "SIM_BalanceBot.h"
+#include "SIM_Sailboat.h"
+#include "SIM_MotorBoat.h"
+#include "SIM_Blimp.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern const AP_HAL::HAL& hal;
+
+using namespace SITL;
+
+/*
+  models with their own physics, matched by prefix in order as
+  SITL_State does. Anything else is tried as a multicopter frame
+ */
+static const struct {
+    const char *name;
+    Aircraft *(*constructor)(const char *frame_str);
+} batch_models[] = {
+    { "quadplane",          QuadPlane::create },
+    { "firefly",            QuadPlane::create },
+    { "heli",               Helicopter::create },
+    { "singlecopter",       SingleCopter::create },
+    { "coaxcopter",         SingleCopter::create },
+    { "rover",              SimRover::create },
+    { "balancebot",         BalanceBot::create },
+    { "sailboat",           Sailboat::create },
+    { "motorboat",          MotorBoat::create },
+    { "glider",             Glider::create },
+    { "plane",              Plane::create },
+    { "blimp",              Blimp::create },
+};
+
+BatchRunner::~BatchRunner()
+{
+    free(scenarios);
+}
+
+Aircraft *BatchRunner::create_model(const char *model)
+{
+    for (const auto &m : batch_models) {
+        if (strncasecmp(m.name, model, strlen(m.name)) == 0) {
+            return m.constructor(model);
+        }
+    }
+    // exits if the frame is unknown, which only ends this scenario's process
+    return MultiCopter::create(model);
+}
+
+bool BatchRunner::add_scenario(const Scenario &s)
+{
+    if (num_scenarios == max_scenarios) {
+        if (max_scenarios > UINT16_MAX / 2) {
+            ::printf("BatchRunner: too many scenarios\n");
+            return false;
+        }
+        const uint16_t new_max = MAX(16U, max_scenarios * 2U);
+        Scenario *n = (Scenario *)realloc(scenarios, new_max * sizeof(Scenario));
+        if (n == nullptr) {
+            return false;
+        }
+        scenarios = n;
+        max_scenarios = new_max;
+    }
+    scenarios[num_scenarios++] = s;
+    return true;
+}
+
+/*
+  parse one option of a scenario line
+ */
+bool BatchRunner::parse_option(Scenario &s, const char *key, const char *value)
+{
+    char *end;
+
+    if (strncmp(key, "ch", 2) == 0) {
+        const long chan = strtol(key+2, &end, 10);
+        if (*end != 0 || chan < 1 || chan > MAX_CHANNELS) {
+            return false;
+        }
+        s.pwm[chan-1] = strtoul(value, nullptr, 10);
+        s.pwm_mask |= 1U << (chan-1);
+        return true;
+    }
+    if (strncmp(key, "step", 4) == 0) {
+        const long chan = strtol(key+4, &end, 10);
+        if (*end != 0 || chan < 1 || chan > MAX_CHANNELS || s.num_steps == MAX_STEPS) {
+            return false;
+        }
+        const float time_s = strtof(value, &end);
+        if (*end != ':') {
+            return false;
+        }
+        // insert keeping the steps in time order
+        uint8_t i = s.num_steps++;
+        while (i > 0 && s.steps[i-1].time_s > time_s) {
+            s.steps[i] = s.steps[i-1];
+            i--;
+        }
+        s.steps[i].time_s = time_s;
+        s.steps[i].chan = chan-1;
+        s.steps[i].pwm = strtoul(end+1, nullptr, 10);
+        s.pwm_mask |= 1U << (chan-1);
+        return true;
+    }
+    if (strncmp(key, "sine", 4) == 0) {
+        const long chan = strtol(key+4, &end, 10);
+        if (*end != 0 || chan < 1 || chan > MAX_CHANNELS || s.num_sines == MAX_SINES) {
+            return false;
+        }
+        auto &sine = s.sines[s.num_sines];
+        sine.chan = chan-1;
+        sine.amplitude = strtof(value, &end);
+        if (*end != ':') {
+            return false;
+        }
+        sine.freq_hz = strtof(end+1, nullptr);
+        s.num_sines++;
+        s.pwm_mask |= 1U << (chan-1);
+        return true;
+    }
+    if (strcmp(key, "noise") == 0) {
+        s.noise_pwm = strtof(value, nullptr);
+        return true;
+    }
+    if (strcmp(key, "servos") == 0) {
+        strncpy_noterm(s.servo_file, value, sizeof(s.servo_file)-1);
+        return true;
+    }
+    if (strcmp(key, "wind") == 0) {
+        // speed:direction[:turbulence]
+        s.wind_speed = strtof(value, &end);
+        if (*end != ':') {
+            return false;
+        }
+        s.wind_direction = strtof(end+1, &end);
+        if (*end == ':') {
+            s.wind_turbulence = strtof(end+1, nullptr);
+        }
+        return true;
+    }
+    if (strcmp(key, "rate") == 0) {
+        s.rate_hz = strtof(value, nullptr);
+        return is_positive(s.rate_hz);
+    }
+    if (strcmp(key, "out") == 0) {
+        s.out_hz = strtof(value, nullptr);
+        return !is_negative(s.out_hz);
+    }
+    if (strcmp(key, "seed") == 0) {
+        s.seed = strtoul(value, nullptr, 10);
+        return true;
+    }
+    if (strcmp(key, "repeat") == 0) {
+        s.repeat = strtoul(value, nullptr, 10);
+        return s.repeat > 0;
+    }
+    if (strcmp(key, "home") == 0) {
+        // lat,lng,alt,hdg
+        double lat, lng;
+        float alt, hdg;
+        if (sscanf(value, "%lf,%lf,%f,%f", &lat, &lng, &alt, &hdg) != 4) {
+            return false;
+        }
+        s.home = Location(int32_t(lat * 1.0e7), int32_t(lng * 1.0e7), int32_t(alt * 100), Location::AltFrame::ABSOLUTE);
+        s.home_yaw = hdg;
+        s.have_home = true;
+        return true;
+    }
+    return false;
+}
+
+/*
+  parse a scenario line: name model duration [key=value ...]
+ */
+bool BatchRunner::parse_line(char *line, uint32_t lineno)
+{
+    char *saveptr = nullptr;
+    const char *name = strtok_r(line, " \t\r\n", &saveptr);
+    if (name == nullptr || name[0] == '#') {
+        // blank or comment
+        return true;
+    }
+    const char *model = strtok_r(nullptr, " \t\r\n", &saveptr);
+    const char *duration = strtok_r(nullptr, " \t\r\n", &saveptr);
+    if (model == nullptr || duration == nullptr) {
+        ::printf("BatchRunner: line %u: expected name, model and duration\n", unsigned(lineno));
+        return false;
+    }
+
+    Scenario s {};
+    strncpy_noterm(s.name, name, sizeof(s.name)-1);
+    strncpy_noterm(s.model, model, sizeof(s.model)-1);
+    s.duration_s = strtof(duration, nullptr);
+    if (!is_positive(s.duration_s)) {
+        ::printf("BatchRunner: line %u: bad duration %s\n", unsigned(lineno), duration);
+        return false;
+    }
+
+    char *opt;
+    while ((opt = strtok_r(nullptr, " \t\r\n", &saveptr)) != nullptr) {
+        char *eq = strchr(opt, '=');
+        if (eq == nullptr) {
+            ::printf("BatchRunner: line %u: expected key=value, got %s\n", unsigned(lineno), opt);
+            return false;
+        }
+        *eq = 0;
+        if (!parse_option(s, opt, eq+1)) {
+            ::printf("BatchRunner: line %u: bad option %s=%s\n", unsigned(lineno), opt, eq+1);
+            return false;
+        }
+    }
+
+    if (s.repeat == 1) {
+        return add_scenario(s);
+    }
+
+    // Monte-Carlo runs differ only in their seed
+    const uint32_t base_seed = s.seed;
+    for (uint16_t i = 0; i < s.repeat; i++) {
+        Scenario r = s;
+        hal.util->snprintf(r.name, sizeof(r.name), "%.26s-%04u", s.name, unsigned(i));
+        r.seed = base_seed + i;
+        r.repeat = 1;
+        if (!add_scenario(r)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BatchRunner::load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == nullptr) {
+        ::printf("BatchRunner: failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    char line[512];
+    uint32_t lineno = 0;
+    bool ret = true;
+    while (ret && fgets(line, sizeof(line), f) != nullptr) {
+        ret = parse_line(line, ++lineno);
+    }
+    fclose(f);
+    return ret;
+}
+
+/*
+  load a CSV of time_s,pwm1,pwm2,... The first line may be a header
+ */
+bool BatchRunner::load_servo_recording(const char *path, ServoRecording &rec)
+{
+    FILE *f = fopen(path, "r");
+    if (f == nullptr) {
+        ::printf("BatchRunner: failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    uint32_t max_samples = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        max_samples++;
+    }
+    rec.samples = (ServoSample *)calloc(MAX(max_samples, 1U), sizeof(ServoSample));
+    if (rec.samples == nullptr) {
+        fclose(f);
+        return false;
+    }
+    rewind(f);
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        char *end;
+        const float time_s = strtof(line, &end);
+        if (end == line) {
+            // header or blank line
+            continue;
+        }
+        ServoSample &sample = rec.samples[rec.count];
+        sample.time_s = time_s;
+        for (uint8_t chan = 0; chan < MAX_CHANNELS && *end == ','; chan++) {
+            sample.pwm[chan] = strtoul(end+1, &end, 10);
+            rec.mask |= 1U << chan;
+        }
+        rec.count++;
+    }
+    fclose(f);
+    return rec.count > 0;
+}
+
+/*
+  run one scenario to completion. This is called in a child process
+ */
+bool BatchRunner::run_scenario(const Scenario &s, const char *out_dir, int summary_fd) const
+{
+    ServoRecording rec {};
+    if (s.servo_file[0] != 0 && !load_servo_recording(s.servo_file, rec)) {
+        return false;
+    }
+
+    // the models draw their noise from random(), so seeding it makes
+    // each run reproducible
+    srandom(s.seed);
+
+    AP::sitl()->loop_rate_hz.set(s.rate_hz);
+
+    Aircraft *model = create_model(s.model);
+    if (model == nullptr) {
+        return false;
+    }
+    if (s.have_home) {
+        model->set_start_location(s.home, s.home_yaw);
+    } else {
+        // same default as sim_vehicle.py
+        model->set_start_location(Location(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE), 353);
+    }
+    model->disable_time_sync();
+
+    char path[256];
+    hal.util->snprintf(path, sizeof(path), "%s/%s.bin", out_dir, s.name);
+    const int fd = open(path, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+    if (fd == -1) {
+        ::printf("BatchRunner: failed to create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    ResultHeader header {};
+    header.magic = RESULT_MAGIC;
+    header.version = RESULT_VERSION;
+    header.record_size = sizeof(ResultRecord);
+    header.rate_hz = s.rate_hz;
+    header.out_hz = s.out_hz;
+    header.seed = s.seed;
+    strncpy_noterm(header.name, s.name, sizeof(header.name)-1);
+    strncpy_noterm(header.model, s.model, sizeof(header.model)-1);
+    bool ok = write(fd, &header, sizeof(header)) == sizeof(header);
+
+    // buffer records so writes are large
+    ResultRecord records[64];
+    uint8_t num_records = 0;
+
+    sitl_input input {};
+    input.wind.speed = s.wind_speed;
+    input.wind.direction = s.wind_direction;
+    input.wind.turbulence = s.wind_turbulence;
+
+    uint16_t pwm[MAX_CHANNELS];
+    memcpy(pwm, s.pwm, sizeof(pwm));
+    uint8_t next_step = 0;
+    uint32_t next_sample = 0;
+
+    const uint64_t duration_us = uint64_t(s.duration_s * 1.0e6f);
+    const uint64_t out_interval_us = is_positive(s.out_hz) ? uint64_t(1.0e6f / s.out_hz) : 0;
+    uint64_t next_out_us = 0;
+    uint64_t steps = 0;
+
+    float max_tilt_deg = 0;
+    float max_speed = 0;
+    float max_gyro = 0;
+    bool diverged = false;
+
+    struct timespec start_ts;
+    clock_gettime(CLOCK_MONOTONIC, &start_ts);
+
+    struct sitl_fdm fdm {};
+    uint64_t time_us = 0;
+    while (ok && time_us < duration_us) {
+        const float time_s = time_us * 1.0e-6f;
+
+        // scripted steps
+        while (next_step < s.num_steps && s.steps[next_step].time_s <= time_s) {
+            pwm[s.steps[next_step].chan] = s.steps[next_step].pwm;
+            next_step++;
+        }
+
+        // recorded outputs, held until the next sample
+        uint16_t mask = s.pwm_mask;
+        if (rec.count > 0) {
+            while (next_sample+1 < rec.count && rec.samples[next_sample+1].time_s <= time_s) {
+                next_sample++;
+            }
+            const ServoSample &sample = rec.samples[next_sample];
+            for (uint8_t chan = 0; chan < MAX_CHANNELS; chan++) {
+                if ((rec.mask & (1U<<chan)) && !(s.pwm_mask & (1U<<chan))) {
+                    pwm[chan] = sample.pwm[chan];
+                }
+            }
+            mask |= rec.mask;
+        }
+
+        for (uint8_t chan = 0; chan < MAX_CHANNELS; chan++) {
+            if ((mask & (1U<<chan)) == 0) {
+                input.servos[chan] = 0;
+                continue;
+            }
+            float value = pwm[chan];
+            for (uint8_t i = 0; i < s.num_sines; i++) {
+                if (s.sines[i].chan == chan) {
+                    value += s.sines[i].amplitude * sinf(M_2PI * s.sines[i].freq_hz * time_s);
+                }
+            }
+            if (is_positive(s.noise_pwm)) {
+                value += Aircraft::rand_normal(0, s.noise_pwm);
+            }
+            input.servos[chan] = constrain_float(value, 0, UINT16_MAX);
+        }
+
+        model->update_home();
+        model->update_model(input);
+        steps++;
+        time_us = model->get_time_us();
+
+        // keep millis() in step for models that use it
+        hal.scheduler->stop_clock(time_us);
+
+        const Vector3f &gyro = model->get_gyro();
+        const Vector3f &vel = model->get_velocity_ef();
+        if (gyro.is_nan() || vel.is_nan()) {
+            diverged = true;
+            break;
+        }
+        const Matrix3f &dcm = model->get_dcm();
+        // angle between body and earth down axes
+        max_tilt_deg = MAX(max_tilt_deg, degrees(acosf(constrain_float(dcm.c.z, -1, 1))));
+        max_speed = MAX(max_speed, vel.length());
+        max_gyro = MAX(max_gyro, gyro.length());
+
+        if (out_interval_us == 0 || time_us < next_out_us) {
+            continue;
+        }
+        next_out_us += out_interval_us;
+
+        model->fill_fdm(fdm);
+        const Vector3d pos = model->get_position_relhome();
+        ResultRecord &r = records[num_records++];
+        r.time_s = time_us * 1.0e-6;
+        r.pos_ned[0] = pos.x;
+        r.pos_ned[1] = pos.y;
+        r.pos_ned[2] = pos.z;
+        r.vel_ned[0] = fdm.speedN;
+        r.vel_ned[1] = fdm.speedE;
+        r.vel_ned[2] = fdm.speedD;
+        r.euler_deg[0] = fdm.rollDeg;
+        r.euler_deg[1] = fdm.pitchDeg;
+        r.euler_deg[2] = fdm.yawDeg;
+        r.gyro[0] = gyro.x;
+        r.gyro[1] = gyro.y;
+        r.gyro[2] = gyro.z;
+        r.accel_body[0] = fdm.xAccel;
+        r.accel_body[1] = fdm.yAccel;
+        r.accel_body[2] = fdm.zAccel;
+        r.airspeed = fdm.airspeed;
+        r.battery_voltage = fdm.battery_voltage;
+        r.battery_current = fdm.battery_current;
+        if (num_records == ARRAY_SIZE(records)) {
+            ok = write(fd, records, sizeof(records)) == sizeof(records);
+            num_records = 0;
+        }
+    }
+    if (ok && num_records > 0) {
+        const ssize_t len = num_records * sizeof(ResultRecord);
+        ok = write(fd, records, len) == len;
+    }
+    close(fd);
+
+    struct timespec end_ts;
+    clock_gettime(CLOCK_MONOTONIC, &end_ts);
+    const double wall_s = (end_ts.tv_sec - start_ts.tv_sec) + (end_ts.tv_nsec - start_ts.tv_nsec) * 1.0e-9;
+
+    const Vector3d pos = model->get_position_relhome();
+
+    // one write per line so lines from parallel runs do not interleave
+    char line[256];
+    const int len = hal.util->snprintf(line, sizeof(line), "%s,%s,%u,%llu,%.3f,%.3f,%.2f,%.2f,%.2f,%.1f,%.2f,%.3f,%s\n",
+                                       s.name, s.model, unsigned(s.seed),
+                                       (unsigned long long)steps, time_us * 1.0e-6, wall_s,
+                                       pos.x, pos.y, pos.z,
+                                       max_tilt_deg, max_speed, max_gyro,
+                                       diverged ? "diverged" : (ok ? "ok" : "write-failed"));
+    if (len > 0 && write(summary_fd, line, MIN(size_t(len), sizeof(line)-1)) != len) {
+        ok = false;
+    }
+
+    free(rec.samples);
+    return ok && !diverged;
+}
+
+bool BatchRunner::run(const char *out_dir, uint8_t num_jobs)
+{
+    if (mkdir(out_dir, 0755) != 0 && errno != EEXIST) {
+        ::printf("BatchRunner: failed to create %s: %s\n", out_dir, strerror(errno));
+        return false;
+    }
+
+    char path[256];
+    hal.util->snprintf(path, sizeof(path), "%s/summary.csv", out_dir);
+    const int summary_fd = open(path, O_WRONLY|O_CREAT|O_TRUNC|O_APPEND|O_CLOEXEC, 0644);
+    if (summary_fd == -1) {
+        ::printf("BatchRunner: failed to create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    const char *header = "name,model,seed,steps,sim_s,wall_s,final_n,final_e,final_d,max_tilt_deg,max_speed,max_gyro,result\n";
+    if (write(summary_fd, header, strlen(header)) != ssize_t(strlen(header))) {
+        close(summary_fd);
+        return false;
+    }
+
+    num_jobs = MAX(num_jobs, 1U);
+    uint16_t next = 0;
+    uint16_t running = 0;
+    uint16_t failed = 0;
+    while (next < num_scenarios || running > 0) {
+        if (next < num_scenarios && running < num_jobs) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                const bool ok = run_scenario(scenarios[next], out_dir, summary_fd);
+                _exit(ok ? 0 : 1);
+            }
+            if (pid == -1) {
+                ::printf("BatchRunner: fork failed: %s\n", strerror(errno));
+                failed++;
+            } else {
+                running++;
+            }
+            next++;
+            continue;
+        }
+        int status;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        running--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed++;
+        }
+    }
+    close(summary_fd);
+
+    ::printf("BatchRunner: %u scenarios, %u failed\n", unsigned(num_scenarios), unsigned(failed));
+    return failed == 0;
+}
+
+#endif // AP_SIM_BATCHRUNNER_ENABLED
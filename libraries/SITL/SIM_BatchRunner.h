@@ -0,0 +1,147 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  headless batch runner for the built in physics models
+
+  Steps Aircraft models directly with scripted or recorded servo
+  inputs, without the vehicle code, the scheduler or any sync to the
+  wall clock. Each scenario runs in its own forked process, so any
+  number may run in parallel and the static state some models keep
+  (such as the multicopter frame table) never leaks between them.
+
+  See examples/BatchRunner for the scenario file and result formats.
+ */
+
+#pragma once
+
+#include "SIM_config.h"
+
+#if AP_SIM_BATCHRUNNER_ENABLED
+
+#include "SIM_Aircraft.h"
+
+namespace SITL {
+
+class BatchRunner {
+public:
+    BatchRunner() {}
+    ~BatchRunner();
+
+    CLASS_NO_COPY(BatchRunner);
+
+    // load scenarios from a text file, one per line. Returns false
+    // and prints the problem on a parse error
+    bool load(const char *path);
+
+    // run all loaded scenarios with up to num_jobs at once, writing a
+    // result file per scenario and summary.csv into out_dir. Returns
+    // false if any scenario failed
+    bool run(const char *out_dir, uint8_t num_jobs);
+
+    uint16_t get_num_scenarios() const { return num_scenarios; }
+
+    // result files are a ResultHeader followed by ResultRecords
+    static constexpr uint32_t RESULT_MAGIC = 0x52425331; // "1SBR"
+    static constexpr uint16_t RESULT_VERSION = 1;
+
+    struct PACKED ResultHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t record_size;
+        float rate_hz;              // physics rate
+        float out_hz;               // record rate
+        uint32_t seed;
+        char name[32];
+        char model[96];
+    };
+
+    struct PACKED ResultRecord {
+        float time_s;
+        float pos_ned[3];           // m from home
+        float vel_ned[3];           // m/s
+        float euler_deg[3];         // roll, pitch, yaw
+        float gyro[3];              // rad/s, body frame
+        float accel_body[3];        // m/s/s, body frame
+        float airspeed;             // m/s EAS
+        float battery_voltage;
+        float battery_current;
+    };
+
+private:
+    static constexpr uint8_t MAX_CHANNELS = 16;
+    static constexpr uint8_t MAX_STEPS = 16;
+    static constexpr uint8_t MAX_SINES = 4;
+
+    struct Scenario {
+        char name[32];
+        char model[96];
+        char servo_file[96];        // recorded servo outputs, empty if none
+        float duration_s;
+        float rate_hz = 1200;
+        float out_hz = 50;
+        uint16_t pwm[MAX_CHANNELS];
+        uint16_t pwm_mask;          // channels driven by the script
+        struct {
+            float time_s;
+            uint8_t chan;
+            uint16_t pwm;
+        } steps[MAX_STEPS];         // sorted by time
+        uint8_t num_steps;
+        struct {
+            uint8_t chan;
+            float amplitude;        // pwm
+            float freq_hz;
+        } sines[MAX_SINES];
+        uint8_t num_sines;
+        float noise_pwm;            // standard deviation added to driven channels each step
+        float wind_speed;
+        float wind_direction;
+        float wind_turbulence;
+        Location home;
+        float home_yaw;
+        bool have_home;
+        uint32_t seed;
+        uint16_t repeat = 1;
+    };
+
+    // recorded servo outputs, held between samples
+    struct ServoSample {
+        float time_s;
+        uint16_t pwm[MAX_CHANNELS];
+    };
+    struct ServoRecording {
+        ServoSample *samples;
+        uint32_t count;
+        uint16_t mask;              // channels present in the file
+    };
+
+    Scenario *scenarios = nullptr;
+    uint16_t num_scenarios = 0;
+    uint16_t max_scenarios = 0;
+
+    bool parse_line(char *line, uint32_t lineno);
+    bool parse_option(Scenario &s, const char *key, const char *value);
+    bool add_scenario(const Scenario &s);
+
+    // run one scenario in this process, appending to summary_fd
+    bool run_scenario(const Scenario &s, const char *out_dir, int summary_fd) const;
+
+    static bool load_servo_recording(const char *path, ServoRecording &rec);
+    static Aircraft *create_model(const char *model);
+};
+
+} // namespace SITL
+
+#endif // AP_SIM_BATCHRUNNER_ENABLED
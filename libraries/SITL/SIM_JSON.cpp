@@ -23,6 +23,12 @@
 #include <stdio.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#if AP_SIM_JSON_SHM_ENABLED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Logger/AP_Logger.h>
@@ -68,6 +74,18 @@ JSON::JSON(const char *frame_str) :
         target_ip = colon+1;
     }
 
+#if AP_SIM_JSON_SHM_ENABLED
+    // json:shm or json:shm:NAME selects the shared memory transport
+    if (colon && strncmp(colon+1, "shm", 3) == 0 &&
+        (colon[4] == '\0' || colon[4] == ':')) {
+        use_shm = true;
+        if (colon[4] == ':') {
+            snprintf(shm_name, sizeof(shm_name), "/%s", colon+5);
+        }
+        target_ip = "127.0.0.1";
+    }
+#endif
+
     for (uint8_t i=0; i<ARRAY_SIZE(sim_defaults); i++) {
     AP_Param::set_default_by_name(sim_defaults[i].name, sim_defaults[i].value);
         if (sim_defaults[i].save) {
@@ -93,9 +111,137 @@ void JSON::set_interface_ports(const char* address, const int port_in, const int
     }
     control_port = port_out;
 
+#if AP_SIM_JSON_SHM_ENABLED
+    if (use_shm) {
+        if (shm_name[0] == '\0') {
+            // the port includes the instance offset, so parallel
+            // simulations get separate regions
+            snprintf(shm_name, sizeof(shm_name), "/ardupilot_json_%u", control_port);
+        }
+        if (!shm_create()) {
+            AP_HAL::panic("JSON: failed to create shared memory %s", shm_name);
+        }
+        printf("JSON control interface set to shared memory %s\n", shm_name);
+        return;
+    }
+#endif
+
     printf("JSON control interface set to %s:%u\n", target_ip, control_port);
 }
 
+#if AP_SIM_JSON_SHM_ENABLED
+/*
+    Create the shared memory region the physics backend attaches to
+*/
+bool JSON::shm_create(void)
+{
+    const int fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        ((size_t)st.st_size != sizeof(*shm) && (ftruncate(fd, 0) != 0 || ftruncate(fd, sizeof(*shm)) != 0))) {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    shm = (struct sim_json_shm_region *)p;
+
+    // when restarting on an existing region leave the sequence numbers
+    // alone, so a physics backend that is still attached sees new
+    // frames rather than numbers it has already handled
+    if (shm->magic != SIM_JSON_SHM_MAGIC || shm->version != SIM_JSON_SHM_VERSION) {
+        memset(shm, 0, sizeof(*shm));
+    }
+    memset(shm->servos.slot, 0, sizeof(shm->servos.slot));
+    memset(shm->fdm.slot, 0, sizeof(shm->fdm.slot));
+    shm->version = SIM_JSON_SHM_VERSION;
+    shm->region_size = sizeof(*shm);
+    shm->sitl_pid = getpid();
+    shm_fdm_seq = __atomic_load_n(&shm->fdm.seq, __ATOMIC_ACQUIRE);
+    // physics backends wait for the magic before using the region
+    __atomic_store_n(&shm->magic, SIM_JSON_SHM_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+/*
+    Publish servos into the next slot of the servo ring
+*/
+void JSON::shm_output_servos(const struct sitl_input &input)
+{
+    struct sim_json_shm_servo_ring &ring = shm->servos;
+    struct sim_json_shm_servos &pkt = ring.slot[ring.seq % SIM_JSON_SHM_SLOTS];
+    pkt.frame_count = frame_counter;
+    pkt.frame_rate = rate_hz;
+    pkt.num_servos = SRV_Channels::have_32_channels() ? 32 : 16;
+    for (uint8_t i=0; i<pkt.num_servos; i++) {
+        pkt.pwm[i] = input.servos[i];
+    }
+    sim_json_shm_publish(&ring.seq, &ring.waiting);
+}
+
+/*
+    Wait for the physics backend to answer through the fdm ring
+*/
+void JSON::shm_recv_fdm(const struct sitl_input &input)
+{
+    struct sim_json_shm_fdm_ring &ring = shm->fdm;
+    uint32_t seq = sim_json_shm_wait(&ring.seq, &ring.waiting, shm_fdm_seq, UDP_TIMEOUT_MS);
+    uint32_t wait_ms = UDP_TIMEOUT_MS;
+    while (seq == shm_fdm_seq) {
+        seq = sim_json_shm_wait(&ring.seq, &ring.waiting, shm_fdm_seq, UDP_TIMEOUT_MS);
+        wait_ms += UDP_TIMEOUT_MS;
+        // as for UDP, resend servos so a restarted physics backend resyncs
+        if (wait_ms > 1000) {
+            wait_ms = 0;
+            printf("No JSON sensor frame in %s, resending servos\n", shm_name);
+            shm_output_servos(input);
+        }
+    }
+
+    // take the newest state. The slot can only be overwritten if the
+    // backend runs SIM_JSON_SHM_SLOTS frames ahead of us, so retry then
+    struct sim_json_shm_fdm fdm;
+    do {
+        memcpy(&fdm, &ring.slot[(seq - 1) % SIM_JSON_SHM_SLOTS], sizeof(fdm));
+        const uint32_t latest = __atomic_load_n(&ring.seq, __ATOMIC_ACQUIRE);
+        if (latest - seq < SIM_JSON_SHM_SLOTS - 1) {
+            break;
+        }
+        seq = latest;
+    } while (true);
+    shm_fdm_seq = seq;
+
+    // the binary layout always carries the mandatory fields
+    const uint32_t received_bitmask = fdm.fields | TIMESTAMP | GYRO | ACCEL_BODY | POSITION | VELOCITY;
+    if ((received_bitmask & (EULER_ATT | QUAT_ATT)) == 0) {
+        printf("Did not receive attitude or quaternion\n");
+        return;
+    }
+
+    state.timestamp_s = fdm.timestamp_s;
+    state.imu.gyro = Vector3f(fdm.gyro[0], fdm.gyro[1], fdm.gyro[2]);
+    state.imu.accel_body = Vector3f(fdm.accel_body[0], fdm.accel_body[1], fdm.accel_body[2]);
+    state.position = Vector3d(fdm.position[0], fdm.position[1], fdm.position[2]);
+    state.attitude = Vector3f(fdm.attitude[0], fdm.attitude[1], fdm.attitude[2]);
+    state.quaternion = Quaternion(fdm.quaternion[0], fdm.quaternion[1], fdm.quaternion[2], fdm.quaternion[3]);
+    state.velocity = Vector3f(fdm.velocity[0], fdm.velocity[1], fdm.velocity[2]);
+    memcpy(state.rng, fdm.rng, sizeof(state.rng));
+    state.wind_vane_apparent.direction = fdm.wind_vane_direction;
+    state.wind_vane_apparent.speed = fdm.wind_vane_speed;
+    state.airspeed = fdm.airspeed;
+    state.no_time_sync = (received_bitmask & TIME_SYNC) != 0;
+
+    report_received_fields(received_bitmask);
+    apply_state(received_bitmask);
+}
+#endif // AP_SIM_JSON_SHM_ENABLED
+
 /*
     Decode and send servos
 */
@@ -281,6 +427,19 @@ void JSON::recv_fdm(const struct sitl_input &input)
         return;
     }
 
+    report_received_fields(received_bitmask);
+
+    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
+    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
+
+    apply_state(received_bitmask);
+}
+
+/*
+    print the fields received whenever they change
+*/
+void JSON::report_received_fields(uint32_t received_bitmask)
+{
     if (received_bitmask != last_received_bitmask) {
         // some change in the message we have received, print what we got
         printf("\nJSON received:\n");
@@ -298,10 +457,13 @@ void JSON::recv_fdm(const struct sitl_input &input)
         printf("\n");
     }
     last_received_bitmask = received_bitmask;
+}
 
-    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
-    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
-
+/*
+    update the vehicle from the received state, however it arrived
+*/
+void JSON::apply_state(uint32_t received_bitmask)
+{
     accel_body = state.imu.accel_body;
     gyro = state.imu.gyro;
     velocity_ef = state.velocity;
@@ -448,11 +610,19 @@ void JSON::recv_fdm(const struct sitl_input &input)
 */
 void JSON::update(const struct sitl_input &input)
 {
-    // send to JSON model
-    output_servos(input);
+#if AP_SIM_JSON_SHM_ENABLED
+    if (use_shm) {
+        shm_output_servos(input);
+        shm_recv_fdm(input);
+    } else
+#endif
+    {
+        // send to JSON model
+        output_servos(input);
 
-    // receive from JSON model
-    recv_fdm(input);
+        // receive from JSON model
+        recv_fdm(input);
+    }
 
     // update magnetic field
     // as the model does not provide mag feild we calculate it from position and attitude
@@ -20,10 +20,21 @@
 #define HAL_SIM_JSON_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
 #endif
 
+#ifndef AP_SIM_JSON_SHM_ENABLED
+#ifdef __linux__
+#define AP_SIM_JSON_SHM_ENABLED HAL_SIM_JSON_ENABLED
+#else
+#define AP_SIM_JSON_SHM_ENABLED 0
+#endif
+#endif
+
 #if HAL_SIM_JSON_ENABLED
 
 #include <AP_HAL/utility/Socket_native.h>
 #include "SIM_Aircraft.h"
+#if AP_SIM_JSON_SHM_ENABLED
+#include "SIM_JSON_SHM.h"
+#endif
 
 namespace SITL {
 
@@ -71,9 +82,23 @@ private:
 
     void output_servos(const struct sitl_input &input);
     void recv_fdm(const struct sitl_input &input);
+    void report_received_fields(uint32_t received_bitmask);
+    void apply_state(uint32_t received_bitmask);
 
     uint32_t parse_sensors(const char *json);
 
+#if AP_SIM_JSON_SHM_ENABLED
+    // shared memory transport, selected with -f json:shm[:name]
+    bool use_shm;
+    char shm_name[32];
+    struct sim_json_shm_region *shm;
+    uint32_t shm_fdm_seq;
+
+    bool shm_create(void);
+    void shm_output_servos(const struct sitl_input &input);
+    void shm_recv_fdm(const struct sitl_input &input);
+#endif
+
     // buffer for parsing pose data in JSON format
     uint8_t sensor_buffer[65000];
     uint32_t sensor_buffer_len;
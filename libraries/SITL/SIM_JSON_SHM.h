@@ -0,0 +1,139 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  Shared memory layout for the JSON SITL backend.
+
+  SITL creates the region and writes servo frames into the servos
+  ring, the physics backend attaches to it and answers each frame
+  through the fdm ring. Each ring has a single producer which fills
+  slot[seq % SIM_JSON_SHM_SLOTS] and then increments seq, which is
+  also the futex word the consumer sleeps on. The consumer spins for
+  a short while before sleeping, and the producer only makes the wake
+  system call when the consumer has said it is asleep.
+
+  This header only depends on the C library so that physics backends
+  can include it directly. Any change to the layout must bump
+  SIM_JSON_SHM_VERSION.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define SIM_JSON_SHM_MAGIC      0x4d53534aU  // "JSSM"
+#define SIM_JSON_SHM_VERSION    1
+#define SIM_JSON_SHM_SLOTS      4
+#define SIM_JSON_SHM_MAX_SERVOS 32
+#define SIM_JSON_SHM_SPIN       2000
+
+// bits in sim_json_shm_fdm.fields, numbered as the JSON keys are
+#define SIM_JSON_SHM_ATTITUDE     (1U<<4)
+#define SIM_JSON_SHM_QUATERNION   (1U<<5)
+#define SIM_JSON_SHM_RNG(i)       (1U<<(7+(i)))
+#define SIM_JSON_SHM_WIND_DIR     (1U<<13)
+#define SIM_JSON_SHM_WIND_SPD     (1U<<14)
+#define SIM_JSON_SHM_AIRSPEED     (1U<<15)
+#define SIM_JSON_SHM_NO_TIME_SYNC (1U<<16)
+
+struct sim_json_shm_servos {
+    uint32_t frame_count;
+    uint16_t frame_rate;
+    uint16_t num_servos;
+    uint16_t pwm[SIM_JSON_SHM_MAX_SERVOS];
+};
+
+/*
+  vehicle state, units and frames as for the JSON fields of the same
+  name. timestamp, gyro, accel_body, position and velocity are always
+  used, the others only when their bit is set in fields
+ */
+struct sim_json_shm_fdm {
+    uint32_t frame_count;       // servo frame this state answers
+    uint32_t fields;            // SIM_JSON_SHM_* bits
+    double timestamp_s;
+    double position[3];         // m, NED from origin
+    float gyro[3];              // rad/s, body
+    float accel_body[3];        // m/s/s, body
+    float attitude[3];          // rad, roll, pitch, yaw
+    float quaternion[4];
+    float velocity[3];          // m/s, NED
+    float rng[6];               // m
+    float wind_vane_direction;  // rad
+    float wind_vane_speed;      // m/s
+    float airspeed;             // m/s
+    float reserved;
+};
+
+struct sim_json_shm_servo_ring {
+    uint32_t seq;
+    uint32_t waiting;
+    struct sim_json_shm_servos slot[SIM_JSON_SHM_SLOTS];
+};
+
+struct sim_json_shm_fdm_ring {
+    uint32_t seq;
+    uint32_t waiting;
+    struct sim_json_shm_fdm slot[SIM_JSON_SHM_SLOTS];
+};
+
+struct sim_json_shm_region {
+    uint32_t magic;             // written last by SITL once the region is ready
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t region_size;       // sizeof(struct sim_json_shm_region)
+    uint32_t sitl_pid;
+    struct sim_json_shm_servo_ring servos;  // written by SITL
+    struct sim_json_shm_fdm_ring fdm;       // written by the physics backend
+};
+
+#ifdef __linux__
+#include <stddef.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+  make the slot at seq visible to the consumer, waking it if asleep
+ */
+static inline void sim_json_shm_publish(uint32_t *seq, uint32_t *waiting)
+{
+    __atomic_fetch_add(seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+}
+
+/*
+  wait for seq to move on from last_seq, returning the new value, or
+  last_seq on timeout
+ */
+static inline uint32_t sim_json_shm_wait(uint32_t *seq, uint32_t *waiting, uint32_t last_seq, uint32_t timeout_ms)
+{
+    uint32_t now;
+    for (uint32_t i = 0; i < SIM_JSON_SHM_SPIN; i++) {
+        now = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (now != last_seq) {
+            return now;
+        }
+    }
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, seq, FUTEX_WAIT, last_seq, &ts, NULL, 0);
+    __atomic_store_n(waiting, 0, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+}
+#endif // __linux__
@@ -0,0 +1,123 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  snapshot of a running simulation
+ */
+
+#include "SIM_Snapshot.h"
+
+#if AP_SIM_SNAPSHOT_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_AHRS/AP_AHRS.h>
+
+using namespace SITL;
+
+Snapshot::~Snapshot()
+{
+    delete[] params;
+}
+
+uint16_t Snapshot::count_params()
+{
+    AP_Param::ParamToken token;
+    enum ap_var_type ptype;
+    uint16_t count = 0;
+    for (AP_Param *ap = AP_Param::first(&token, &ptype);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &ptype)) {
+        count++;
+    }
+    return count;
+}
+
+bool Snapshot::take(const Aircraft &model)
+{
+    const uint16_t count = count_params();
+    if (count != num_params || params == nullptr) {
+        delete[] params;
+        num_params = 0;
+        params = NEW_NOTHROW ParamValue[count];
+        if (params == nullptr) {
+            return false;
+        }
+        num_params = count;
+    }
+
+    // values are copied raw rather than through a float so large
+    // integers survive the round trip
+    AP_Param::ParamToken token;
+    enum ap_var_type ptype;
+    uint16_t i = 0;
+    for (AP_Param *ap = AP_Param::first(&token, &ptype);
+         ap != nullptr && i < num_params;
+         ap = AP_Param::next_scalar(&token, &ptype), i++) {
+        ParamValue &v = params[i];
+        v.raw = 0;
+        v.type = ptype;
+        memcpy(&v.raw, (const void *)ap, AP_Param::type_size(ptype));
+    }
+
+    model.get_kinematic_state(physics);
+
+    return true;
+}
+
+bool Snapshot::restore(Aircraft &model, uint16_t &changed)
+{
+    if (params == nullptr || count_params() != num_params) {
+        return false;
+    }
+
+    AP_Param::ParamToken token;
+    enum ap_var_type ptype;
+    uint16_t i = 0;
+    for (AP_Param *ap = AP_Param::first(&token, &ptype);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &ptype), i++) {
+        if (params[i].type != ptype) {
+            return false;
+        }
+    }
+
+    changed = 0;
+    i = 0;
+    for (AP_Param *ap = AP_Param::first(&token, &ptype);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &ptype), i++) {
+        const uint8_t size = AP_Param::type_size(ptype);
+        if (memcmp((const void *)ap, &params[i].raw, size) == 0) {
+            continue;
+        }
+        memcpy((void *)ap, &params[i].raw, size);
+        // this updates or adds the stored copy, so the vehicle comes
+        // back the same after a reboot too
+        ap->save_sync(false, false);
+        changed++;
+    }
+
+    model.set_kinematic_state(physics);
+
+#if AP_AHRS_ENABLED
+    // the estimators were tracking the vehicle where it was, so
+    // start them again where it now is
+    AP::ahrs().reset();
+#endif
+
+    return true;
+}
+
+#endif  // AP_SIM_SNAPSHOT_ENABLED
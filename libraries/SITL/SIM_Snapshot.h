@@ -0,0 +1,75 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  snapshot of a running simulation, for putting a vehicle back the
+  way it was without restarting the process
+
+  Records the value of every parameter and the rigid body state of
+  the model. Restoring saves only the parameters which have changed
+  since, puts the model back where it was and restarts the attitude
+  and position estimators there; simulation time keeps running
+  forward throughout.
+
+  Parameters are put back by copying their values, as set() does, and
+  saving them. Nothing else a parameter set from a GCS does happens:
+  no PARAM_VALUE is sent, and parameters only read at boot or when a
+  feature is enabled keep their old effect until the next reboot.
+ */
+
+#pragma once
+
+#include "SIM_config.h"
+
+#if AP_SIM_SNAPSHOT_ENABLED
+
+#include "SIM_Aircraft.h"
+
+namespace SITL {
+
+class Snapshot {
+public:
+    Snapshot() {}
+    ~Snapshot();
+
+    CLASS_NO_COPY(Snapshot);
+
+    // record the current state. Returns false if there is not enough
+    // memory for the parameters
+    bool take(const Aircraft &model);
+
+    // return to the recorded state, giving the number of parameters
+    // changed. Returns false if nothing has been recorded or the
+    // parameter set has changed shape since
+    bool restore(Aircraft &model, uint16_t &changed);
+
+    bool valid() const { return params != nullptr; }
+
+private:
+    struct ParamValue {
+        uint32_t raw;
+        uint8_t type;       // ap_var_type
+    };
+
+    // count the scalar parameters, as take() and restore() walk them
+    static uint16_t count_params();
+
+    ParamValue *params;
+    uint16_t num_params;
+    Aircraft::KinematicState physics;
+};
+
+}  // namespace SITL
+
+#endif  // AP_SIM_SNAPSHOT_ENABLED
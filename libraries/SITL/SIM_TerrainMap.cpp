@@ -0,0 +1,409 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  in-memory terrain heightmap for the physics models
+ */
+
+#include "SIM_TerrainMap.h"
+
+#if AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+#include <AP_Common/AP_Common.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+extern const AP_HAL::HAL& hal;
+
+using namespace SITL;
+
+namespace {
+
+/*
+  the on-disk layout of AP_Terrain's grid_block, which is private to
+  that class
+ */
+struct PACKED DatBlock {
+    uint64_t bitmap;
+    int32_t lat;
+    int32_t lon;
+    uint16_t crc;
+    uint16_t version;
+    uint16_t spacing;
+    int16_t height[TERRAIN_GRID_BLOCK_SIZE_X][TERRAIN_GRID_BLOCK_SIZE_Y];
+    uint16_t grid_idx_x;
+    uint16_t grid_idx_y;
+    int16_t lon_degrees;
+    int8_t lat_degrees;
+};
+
+union DatIOBlock {
+    DatBlock block;
+    uint8_t buffer[2048];
+};
+
+/*
+  reads heights from the .DAT files a block at a time, following the
+  grid arithmetic of AP_Terrain::calculate_grid_info() and
+  AP_Terrain::height_amsl()
+ */
+class DatReader {
+public:
+    DatReader(const char *_dir, uint16_t _spacing) :
+        dir(_dir),
+        spacing(_spacing) {}
+    ~DatReader() {
+        if (fd != -1) {
+            ::close(fd);
+        }
+    }
+
+    bool height_amsl(const Location &loc, float &height);
+
+private:
+    bool read_block(int8_t lat_degrees, int16_t lon_degrees, uint16_t grid_idx_x, uint16_t grid_idx_y);
+    uint32_t east_blocks(int8_t lat_degrees, int16_t lon_degrees) const;
+    bool check_bitmap(uint8_t idx_x, uint8_t idx_y) const;
+
+    const char *dir;
+    const uint16_t spacing;
+
+    int fd = -1;
+    bool have_file = false;
+    int8_t file_lat_degrees;
+    int16_t file_lon_degrees;
+
+    DatIOBlock io;
+    bool have_block = false;
+    bool block_valid = false;
+};
+
+uint32_t DatReader::east_blocks(int8_t lat_degrees, int16_t lon_degrees) const
+{
+    Location loc1, loc2;
+    loc1.lat = lat_degrees*10*1000*1000L;
+    loc1.lng = lon_degrees*10*1000*1000L;
+    loc2.lat = loc1.lat;
+    loc2.lng = (lon_degrees+1)*10*1000*1000L;
+
+    loc2.offset(0, 2*spacing*TERRAIN_GRID_BLOCK_SIZE_Y);
+    const Vector2f offset = loc1.get_distance_NE(loc2);
+    return offset.y / (spacing*TERRAIN_GRID_BLOCK_SPACING_Y);
+}
+
+bool DatReader::read_block(int8_t lat_degrees, int16_t lon_degrees, uint16_t grid_idx_x, uint16_t grid_idx_y)
+{
+    DatBlock &block = io.block;
+    if (have_block &&
+        block.lat_degrees == lat_degrees &&
+        block.lon_degrees == lon_degrees &&
+        block.grid_idx_x == grid_idx_x &&
+        block.grid_idx_y == grid_idx_y) {
+        return block_valid;
+    }
+
+    if (!have_file || file_lat_degrees != lat_degrees || file_lon_degrees != lon_degrees) {
+        if (fd != -1) {
+            ::close(fd);
+        }
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%c%02u%c%03u.DAT",
+                 dir,
+                 lat_degrees<0?'S':'N',
+                 unsigned(MIN(abs(lat_degrees), 99)),
+                 lon_degrees<0?'W':'E',
+                 unsigned(MIN(abs(lon_degrees), 999)));
+        fd = ::open(path, O_RDONLY|O_CLOEXEC);
+        have_file = true;
+        file_lat_degrees = lat_degrees;
+        file_lon_degrees = lon_degrees;
+    }
+
+    const uint32_t blocknum = east_blocks(lat_degrees, lon_degrees) * grid_idx_x + grid_idx_y;
+    block_valid = fd != -1 &&
+        ::pread(fd, &io, sizeof(io), off_t(blocknum) * sizeof(io)) == ssize_t(sizeof(io)) &&
+        block.bitmap != 0 &&
+        block.spacing == spacing &&
+        block.version == TERRAIN_GRID_FORMAT_VERSION &&
+        block.lat_degrees == lat_degrees &&
+        block.lon_degrees == lon_degrees &&
+        block.grid_idx_x == grid_idx_x &&
+        block.grid_idx_y == grid_idx_y;
+    if (block_valid) {
+        const uint16_t crc = block.crc;
+        block.crc = 0;
+        block_valid = crc16_ccitt((const uint8_t *)&block, sizeof(block), 0) == crc;
+        block.crc = crc;
+    }
+
+    // remember what we asked for, even if the file didn't have it
+    have_block = true;
+    block.lat_degrees = lat_degrees;
+    block.lon_degrees = lon_degrees;
+    block.grid_idx_x = grid_idx_x;
+    block.grid_idx_y = grid_idx_y;
+
+    return block_valid;
+}
+
+bool DatReader::check_bitmap(uint8_t idx_x, uint8_t idx_y) const
+{
+    const uint8_t bitnum = (idx_y / TERRAIN_GRID_MAVLINK_SIZE) +
+        TERRAIN_GRID_BLOCK_MUL_Y * (idx_x / TERRAIN_GRID_MAVLINK_SIZE);
+    return (io.block.bitmap & (uint64_t(1U)<<bitnum)) != 0;
+}
+
+bool DatReader::height_amsl(const Location &loc, float &height)
+{
+    const int8_t lat_degrees = (loc.lat<0?(loc.lat-9999999L):loc.lat) / (10*1000*1000L);
+    const int16_t lon_degrees = (loc.lng<0?(loc.lng-9999999L):loc.lng) / (10*1000*1000L);
+
+    Location ref;
+    ref.lat = lat_degrees*10*1000*1000L;
+    ref.lng = lon_degrees*10*1000*1000L;
+    const Vector2f offset = ref.get_distance_NE(loc);
+
+    const uint32_t idx_x = offset.x / spacing;
+    const uint32_t idx_y = offset.y / spacing;
+    const uint16_t grid_idx_x = idx_x / TERRAIN_GRID_BLOCK_SPACING_X;
+    const uint16_t grid_idx_y = idx_y / TERRAIN_GRID_BLOCK_SPACING_Y;
+    const uint8_t x = idx_x % TERRAIN_GRID_BLOCK_SPACING_X;
+    const uint8_t y = idx_y % TERRAIN_GRID_BLOCK_SPACING_Y;
+    const float frac_x = (offset.x - idx_x * spacing) / spacing;
+    const float frac_y = (offset.y - idx_y * spacing) / spacing;
+
+    if (!read_block(lat_degrees, lon_degrees, grid_idx_x, grid_idx_y)) {
+        return false;
+    }
+    if (!check_bitmap(x, y) ||
+        !check_bitmap(x, y+1) ||
+        !check_bitmap(x+1, y) ||
+        !check_bitmap(x+1, y+1)) {
+        return false;
+    }
+
+    const DatBlock &block = io.block;
+    const float avg1 = (1.0f-frac_x) * block.height[x][y]   + frac_x * block.height[x+1][y];
+    const float avg2 = (1.0f-frac_x) * block.height[x][y+1] + frac_x * block.height[x+1][y+1];
+    height = (1.0f-frac_y) * avg1 + frac_y * avg2;
+    return true;
+}
+
+}  // namespace
+
+TerrainMap::~TerrainMap()
+{
+    // the load thread uses this object until it is done
+    while (loading()) {
+        ::usleep(1000);
+    }
+    free_grid(loaded_grid);
+    free_grid(grid);
+}
+
+void TerrainMap::free_grid(Grid *g)
+{
+    if (g != nullptr) {
+        delete[] g->heights;
+        delete g;
+    }
+}
+
+TerrainMap::Grid *TerrainMap::fill_grid(const char *dir, const Location &centre, uint16_t grid_spacing, float radius_m, uint32_t &count)
+{
+    count = 0;
+    if (grid_spacing == 0 || !is_positive(radius_m)) {
+        return nullptr;
+    }
+    Grid *g = NEW_NOTHROW Grid;
+    if (g == nullptr) {
+        return nullptr;
+    }
+    g->size = uint32_t(2 * radius_m / grid_spacing) + 1;
+    g->spacing = grid_spacing;
+    g->origin = centre;
+    g->origin.offset(-radius_m, -radius_m);
+    g->heights = NEW_NOTHROW float[g->size * g->size];
+    if (g->heights == nullptr) {
+        delete g;
+        return nullptr;
+    }
+
+    DatReader reader(dir, grid_spacing);
+    float *p = g->heights;
+    for (uint32_t i=0; i<g->size; i++) {
+        for (uint32_t j=0; j<g->size; j++) {
+            Location loc = g->origin;
+            loc.offset(float(i * grid_spacing), float(j * grid_spacing));
+            if (reader.height_amsl(loc, *p)) {
+                count++;
+            } else {
+                *p = nanf("");
+            }
+            p++;
+        }
+    }
+
+    ::printf("Terrain map %ux%u at %um, %u%% known\n",
+             unsigned(g->size), unsigned(g->size), unsigned(grid_spacing),
+             unsigned((100 * count) / (g->size * g->size)));
+
+    return g;
+}
+
+void TerrainMap::set_grid(Grid *g)
+{
+    Grid *old;
+    {
+        WITH_SEMAPHORE(sem);
+        old = grid;
+        grid = g;
+    }
+    free_grid(old);
+}
+
+uint32_t TerrainMap::load_dat(const char *dir, const Location &centre, uint16_t grid_spacing, float radius_m)
+{
+    uint32_t count;
+    Grid *g = fill_grid(dir, centre, grid_spacing, radius_m, count);
+    if (g != nullptr) {
+        set_grid(g);
+    }
+    return count;
+}
+
+bool TerrainMap::load_dat_background(const char *dir, const Location &centre, uint16_t grid_spacing, float radius_m)
+{
+    WITH_SEMAPHORE(sem);
+    if (load_running || loaded_grid != nullptr) {
+        return false;
+    }
+    strncpy_noterm(load_dir, dir, sizeof(load_dir)-1);
+    load_dir[sizeof(load_dir)-1] = 0;
+    load_centre = centre;
+    load_spacing = grid_spacing;
+    load_radius_m = radius_m;
+    load_running = hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&TerrainMap::load_thread, void),
+                                                "TerrainMap", 8192,
+                                                AP_HAL::Scheduler::PRIORITY_IO, 0);
+    return load_running;
+}
+
+void TerrainMap::load_thread(void)
+{
+    uint32_t count;
+    Grid *g = fill_grid(load_dir, load_centre, load_spacing, load_radius_m, count);
+    WITH_SEMAPHORE(sem);
+    loaded_grid = g;
+    load_running = false;
+}
+
+void TerrainMap::finish_load(void)
+{
+    while (loading()) {
+        ::usleep(1000);
+    }
+    Grid *g;
+    {
+        WITH_SEMAPHORE(sem);
+        g = loaded_grid;
+        loaded_grid = nullptr;
+    }
+    if (g != nullptr) {
+        set_grid(g);
+    }
+}
+
+bool TerrainMap::loading() const
+{
+    WITH_SEMAPHORE(sem);
+    return load_running;
+}
+
+bool TerrainMap::loaded() const
+{
+    WITH_SEMAPHORE(sem);
+    return grid != nullptr;
+}
+
+bool TerrainMap::lookup(const Grid &g, float north, float east, float &height)
+{
+    const float x = north / g.spacing;
+    const float y = east / g.spacing;
+    if (!(x >= 0 && y >= 0 && x < g.size-1 && y < g.size-1)) {
+        return false;
+    }
+    const uint32_t ix = uint32_t(x);
+    const uint32_t iy = uint32_t(y);
+    const float fx = x - ix;
+    const float fy = y - iy;
+    const float *row0 = &g.heights[ix * g.size + iy];
+    const float *row1 = row0 + g.size;
+
+    // a NaN corner makes the result NaN, so one check covers all four
+    const float avg1 = (1.0f-fx) * row0[0] + fx * row1[0];
+    const float avg2 = (1.0f-fx) * row0[1] + fx * row1[1];
+    const float h = (1.0f-fy) * avg1 + fy * avg2;
+    if (isnan(h)) {
+        return false;
+    }
+    height = h;
+    return true;
+}
+
+bool TerrainMap::height_amsl(const Location &loc, float &height) const
+{
+    WITH_SEMAPHORE(sem);
+    if (grid == nullptr) {
+        return false;
+    }
+    const Vector2f ne = grid->origin.get_distance_NE(loc);
+    return lookup(*grid, ne.x, ne.y, height);
+}
+
+uint16_t TerrainMap::height_amsl(const Location *locs, float *heights, uint16_t n) const
+{
+    WITH_SEMAPHORE(sem);
+    uint16_t count = 0;
+    for (uint16_t i=0; i<n; i++) {
+        if (grid != nullptr) {
+            const Vector2f ne = grid->origin.get_distance_NE(locs[i]);
+            if (lookup(*grid, ne.x, ne.y, heights[i])) {
+                count++;
+                continue;
+            }
+        }
+        heights[i] = nanf("");
+    }
+    return count;
+}
+
+bool TerrainMap::covers(const Location &loc, float margin_m) const
+{
+    WITH_SEMAPHORE(sem);
+    if (grid == nullptr) {
+        return false;
+    }
+    const Vector2f ne = grid->origin.get_distance_NE(loc);
+    const float edge = (grid->size - 1) * grid->spacing;
+    return ne.x >= margin_m && ne.y >= margin_m &&
+        ne.x <= edge - margin_m && ne.y <= edge - margin_m;
+}
+
+#endif  // AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
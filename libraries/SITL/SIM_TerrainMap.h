@@ -0,0 +1,115 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  in-memory terrain heightmap for the physics models
+
+  Resamples the terrain .DAT files on disk into one contiguous grid
+  around a point, so the ground height under the vehicle is a few
+  multiplies away rather than a trip through the firmware's AP_Terrain
+  cache, which may have to wait for a disk read or for the GCS to
+  send the data. The .DAT files are read directly; AP_Terrain's
+  state is not touched.
+
+  Filling the map reads a few thousand blocks and resamples
+  (2*radius/spacing)^2 points, which takes too long to do on every
+  physics step. The first map is loaded before the model moves. Later
+  ones are loaded on a thread of its own while the old map is used,
+  and switched to when the caller finishes the load, so that the
+  switch comes at the same simulation time however long the load took.
+ */
+
+#pragma once
+
+#include "SIM_config.h"
+#include <AP_Terrain/AP_Terrain.h>
+
+#if AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
+
+#include <AP_Common/Location.h>
+#include <AP_HAL/Semaphores.h>
+
+namespace SITL {
+
+class TerrainMap {
+public:
+    TerrainMap() {}
+    ~TerrainMap();
+
+    CLASS_NO_COPY(TerrainMap);
+
+    // fill the map from the .DAT files in dir, covering a square of
+    // 2*radius_m a side around centre at the files' grid spacing.
+    // Returns the number of grid points with data; points with none
+    // are left unknown
+    uint32_t load_dat(const char *dir, const Location &centre, uint16_t grid_spacing, float radius_m);
+
+    // as load_dat(), but on a thread of its own. The old map is used
+    // until finish_load() is called. Returns false if a load is
+    // already running or the thread could not be started
+    bool load_dat_background(const char *dir, const Location &centre, uint16_t grid_spacing, float radius_m);
+
+    // wait for a background load and switch to its map
+    void finish_load(void);
+
+    // bilinearly interpolated terrain height at loc. Returns false if
+    // loc is off the map or next to a point with no data
+    bool height_amsl(const Location &loc, float &height) const;
+
+    // heights at n locations, NaN for those not known, all from the
+    // same map. Returns the number known
+    uint16_t height_amsl(const Location *locs, float *heights, uint16_t n) const;
+
+    // true if loc is on the map and at least margin_m from its edges
+    bool covers(const Location &loc, float margin_m) const;
+
+    bool loaded() const;
+    bool loading() const;
+
+private:
+    struct Grid {
+        Location origin;    // SW corner of the grid
+        float spacing;      // metres between grid points
+        uint32_t size;      // grid points along each side
+        float *heights;     // size*size heights, northward rows of eastward points
+    };
+
+    // height at a north/east offset in metres from the SW corner
+    static bool lookup(const Grid &g, float north, float east, float &height);
+
+    // a new grid filled from the .DAT files, nullptr if out of memory
+    static Grid *fill_grid(const char *dir, const Location &centre, uint16_t grid_spacing, float radius_m, uint32_t &count);
+
+    static void free_grid(Grid *g);
+
+    // make g the map
+    void set_grid(Grid *g);
+
+    void load_thread(void);
+
+    mutable HAL_Semaphore sem;  // protects grid and the background load
+    Grid *grid = nullptr;
+
+    // the background load, while load_running, and its map once done
+    bool load_running = false;
+    Grid *loaded_grid = nullptr;
+    char load_dir[128];
+    Location load_centre;
+    uint16_t load_spacing;
+    float load_radius_m;
+};
+
+}  // namespace SITL
+
+#endif  // AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
@@ -27,6 +27,22 @@
 #define AP_SIM_LOWEHEISER_ENABLED AP_SIM_ENABLED && HAL_MAVLINK_BINDINGS_ENABLED
 #endif
 
+#ifndef AP_SIM_BATCHRUNNER_ENABLED
+#define AP_SIM_BATCHRUNNER_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#ifndef AP_SIM_SNAPSHOT_ENABLED
+#define AP_SIM_SNAPSHOT_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#ifndef AP_SIM_TERRAIN_MAP_ENABLED
+#define AP_SIM_TERRAIN_MAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#ifndef AP_SIM_CHECKPOINT_ENABLED
+#define AP_SIM_CHECKPOINT_ENABLED AP_SIM_SNAPSHOT_ENABLED
+#endif
+
 #ifndef AP_SIM_SHIP_ENABLED
 #define AP_SIM_SHIP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
 #endif
@@ -12,6 +12,7 @@
 #include <AP_Compass/AP_Compass.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 
+#include "SIM_config.h"
 #include "SIM_Buzzer.h"
 #include "SIM_Gripper_EPM.h"
 #include "SIM_Gripper_Servo.h"
@@ -573,6 +574,20 @@ public:
     AP_Int16 osd_columns;
 #endif
 
+#if AP_SIM_SNAPSHOT_ENABLED
+    // snapshot requests from the GCS, acted on by the HAL between
+    // iterations of the main loop
+    enum class SnapshotRequest : uint8_t {
+        NONE = 0,
+        TAKE,
+        RESTORE,
+#if AP_SIM_CHECKPOINT_ENABLED
+        CHECKPOINT,     // write the whole vehicle state to a file
+#endif
+    };
+    SnapshotRequest snapshot_request;
+#endif
+
     // Allow inhibiting of SITL only sim state messages over MAVLink
     // This gives more realistic data rates for testing links
     void set_stop_MAVLink_sim_state() { stop_MAVLink_sim_state = true; }
@@ -0,0 +1,89 @@
+/*
+  run the built in physics models headless over a batch of scenarios
+
+  ./waf configure --board sitl
+  ./waf build --targets examples/BatchRunner
+  ./build/sitl/examples/BatchRunner -j 8 -o results scenarios.txt
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <SITL/SIM_BatchRunner.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SIM_BATCHRUNNER_ENABLED
+
+// the models read their SIM_ parameters from here
+static SITL::SIM sitl;
+
+// create fake gcs object
+GCS_Dummy _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+static void usage()
+{
+    ::printf("Usage: BatchRunner [-j JOBS] [-o OUTDIR] SCENARIO_FILE\n");
+}
+
+void setup()
+{
+    uint8_t argc;
+    char * const *argv;
+    hal.util->commandline_arguments(argc, argv);
+
+    const char *out_dir = "batch_results";
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *scenario_file = nullptr;
+
+    for (uint8_t i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i+1 < argc) {
+            jobs = strtol(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "-o") == 0 && i+1 < argc) {
+            out_dir = argv[++i];
+        } else if (argv[i][0] != '-' && scenario_file == nullptr) {
+            scenario_file = argv[i];
+        } else {
+            usage();
+            exit(1);
+        }
+    }
+    if (scenario_file == nullptr) {
+        usage();
+        exit(1);
+    }
+
+    SITL::BatchRunner runner;
+    if (!runner.load(scenario_file)) {
+        exit(1);
+    }
+    ::printf("Running %u scenarios with %ld jobs into %s\n", unsigned(runner.get_num_scenarios()), jobs, out_dir);
+    exit(runner.run(out_dir, constrain_int32(jobs, 1, UINT8_MAX)) ? 0 : 1);
+}
+
+#else
+
+void setup()
+{
+    ::printf("Board not currently supported\n");
+}
+
+#endif // AP_SIM_BATCHRUNNER_ENABLED
+
+void loop()
+{
+    exit(0);
+}
+
+AP_HAL_MAIN();
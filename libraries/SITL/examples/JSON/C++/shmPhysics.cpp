@@ -0,0 +1,285 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Reference physics backend for the JSON shared memory transport. It
+// flies a simple quad X rigid body in lock-step with SITL, mainly to
+// measure how fast the transport can go. Run one per SITL instance:
+//
+//   ./shmPhysics                       # SITL started with -f json:shm
+//   ./shmPhysics /ardupilot_json_9012  # second instance (-I1)
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../../SIM_JSON_SHM.h"
+
+static const double GRAVITY = 9.80665;
+static const double MASS = 1.5;            // kg
+static const double HOVER_THROTTLE = 0.4;
+static const double ARM_LENGTH = 0.2;      // m
+static const double YAW_COEFF = 0.05;      // m, yaw torque per N of thrust
+static const double INERTIA[3] = { 0.015, 0.015, 0.03 };   // kg m^2
+static const double DRAG = 0.1;            // linear drag, 1/s
+
+struct Vec3 {
+    double x, y, z;
+};
+
+struct Body {
+    Vec3 pos;       // NED, m
+    Vec3 vel;       // NED, m/s
+    Vec3 gyro;      // body, rad/s
+    Vec3 accel;     // specific force, body, m/s/s
+    double q[4];    // body to earth
+    double time_s;
+};
+
+static void reset(Body &b)
+{
+    memset(&b, 0, sizeof(b));
+    b.q[0] = 1;
+    b.accel.z = -GRAVITY;
+}
+
+// rotate v from body to earth frame
+static Vec3 body_to_earth(const double q[4], const Vec3 &v)
+{
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    return Vec3{
+        (1-2*(y*y+z*z))*v.x + 2*(x*y-w*z)*v.y + 2*(x*z+w*y)*v.z,
+        2*(x*y+w*z)*v.x + (1-2*(x*x+z*z))*v.y + 2*(y*z-w*x)*v.z,
+        2*(x*z-w*y)*v.x + 2*(y*z+w*x)*v.y + (1-2*(x*x+y*y))*v.z
+    };
+}
+
+static Vec3 earth_to_body(const double q[4], const Vec3 &v)
+{
+    const double qc[4] = { q[0], -q[1], -q[2], -q[3] };
+    return body_to_earth(qc, v);
+}
+
+static void step(Body &b, const sim_json_shm_servos &servos, double dt)
+{
+    // motor thrusts from the first four outputs, ArduPilot quad X order
+    double thrust[4];
+    const double max_thrust = MASS * GRAVITY / (4 * HOVER_THROTTLE);
+    for (int i = 0; i < 4; i++) {
+        double throttle = (servos.pwm[i] - 1000) / 1000.0;
+        throttle = throttle < 0 ? 0 : (throttle > 1 ? 1 : throttle);
+        thrust[i] = throttle * max_thrust;
+    }
+    const double arm = ARM_LENGTH * M_SQRT1_2;
+    const Vec3 torque {
+        arm * (thrust[1] + thrust[2] - thrust[0] - thrust[3]),
+        arm * (thrust[0] + thrust[2] - thrust[1] - thrust[3]),
+        YAW_COEFF * (thrust[0] + thrust[1] - thrust[2] - thrust[3])
+    };
+    const double total = thrust[0] + thrust[1] + thrust[2] + thrust[3];
+
+    b.gyro.x += torque.x / INERTIA[0] * dt;
+    b.gyro.y += torque.y / INERTIA[1] * dt;
+    b.gyro.z += torque.z / INERTIA[2] * dt;
+
+    // integrate attitude
+    double *q = b.q;
+    const double dq[4] = {
+        0.5 * (-q[1]*b.gyro.x - q[2]*b.gyro.y - q[3]*b.gyro.z),
+        0.5 * ( q[0]*b.gyro.x + q[2]*b.gyro.z - q[3]*b.gyro.y),
+        0.5 * ( q[0]*b.gyro.y - q[1]*b.gyro.z + q[3]*b.gyro.x),
+        0.5 * ( q[0]*b.gyro.z + q[1]*b.gyro.y - q[2]*b.gyro.x)
+    };
+    double norm = 0;
+    for (int i = 0; i < 4; i++) {
+        q[i] += dq[i] * dt;
+        norm += q[i] * q[i];
+    }
+    norm = sqrt(norm);
+    for (int i = 0; i < 4; i++) {
+        q[i] /= norm;
+    }
+
+    // specific force in body frame is thrust plus drag
+    const Vec3 drag_bf = earth_to_body(q, Vec3{ -DRAG * b.vel.x, -DRAG * b.vel.y, -DRAG * b.vel.z });
+    b.accel = Vec3{ drag_bf.x, drag_bf.y, drag_bf.z - total / MASS };
+    Vec3 accel_ef = body_to_earth(q, b.accel);
+    accel_ef.z += GRAVITY;
+
+    b.vel.x += accel_ef.x * dt;
+    b.vel.y += accel_ef.y * dt;
+    b.vel.z += accel_ef.z * dt;
+    b.pos.x += b.vel.x * dt;
+    b.pos.y += b.vel.y * dt;
+    b.pos.z += b.vel.z * dt;
+
+    // sitting on the ground
+    if (b.pos.z >= 0) {
+        b.pos.z = 0;
+        b.vel = Vec3{ 0, 0, 0 };
+        b.gyro = Vec3{ 0, 0, 0 };
+        b.accel = earth_to_body(q, Vec3{ 0, 0, -GRAVITY });
+    }
+
+    b.time_s += dt;
+}
+
+static sim_json_shm_region *attach(const char *name, ino_t &ino)
+{
+    printf("Waiting for SITL on %s\n", name);
+    while (true) {
+        const int fd = shm_open(name, O_RDWR, 0);
+        if (fd != -1) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(sim_json_shm_region)) {
+                void *p = mmap(nullptr, sizeof(sim_json_shm_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if (p == MAP_FAILED) {
+                    return nullptr;
+                }
+                auto *shm = (sim_json_shm_region *)p;
+                if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) == SIM_JSON_SHM_MAGIC) {
+                    if (shm->version != SIM_JSON_SHM_VERSION || shm->region_size != sizeof(*shm)) {
+                        printf("Unsupported layout version %u size %u\n",
+                               unsigned(shm->version), unsigned(shm->region_size));
+                        return nullptr;
+                    }
+                    printf("Attached to SITL pid %u\n", unsigned(shm->sitl_pid));
+                    ino = st.st_ino;
+                    return shm;
+                }
+                munmap(p, sizeof(sim_json_shm_region));
+            } else {
+                close(fd);
+            }
+        }
+        usleep(100000);
+    }
+}
+
+// true if name now refers to a different region, e.g. it was removed
+// and a new SITL created it again
+static bool region_replaced(const char *name, ino_t ino)
+{
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    const bool replaced = fstat(fd, &st) == 0 && st.st_ino != ino;
+    close(fd);
+    return replaced;
+}
+
+static double now_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+int main(int argc, const char *argv[])
+{
+    const char *name = argc > 1 ? argv[1] : "/ardupilot_json_9002";
+    ino_t ino;
+    sim_json_shm_region *shm = attach(name, ino);
+    if (shm == nullptr) {
+        return 1;
+    }
+
+    Body body;
+    reset(body);
+
+    // answer the newest frame straight away in case SITL got there first
+    uint32_t servo_seq = 0;
+    uint32_t last_frame = 0;
+    bool started = false;
+    uint32_t frames = 0;
+    double report_s = now_s();
+
+    while (true) {
+        const uint32_t seq = sim_json_shm_wait(&shm->servos.seq, &shm->servos.waiting, servo_seq, 1000);
+        if (seq == servo_seq) {
+            if (region_replaced(name, ino)) {
+                munmap(shm, sizeof(*shm));
+                shm = attach(name, ino);
+                if (shm == nullptr) {
+                    return 1;
+                }
+                servo_seq = 0;
+            }
+            continue;
+        }
+        if (seq < servo_seq) {
+            // SITL restarted and recreated the region
+            printf("SITL restarted\n");
+            reset(body);
+            started = false;
+        }
+        servo_seq = seq;
+
+        sim_json_shm_servos servos;
+        memcpy(&servos, &shm->servos.slot[(seq - 1) % SIM_JSON_SHM_SLOTS], sizeof(servos));
+
+        if (servos.frame_count < last_frame) {
+            printf("Resetting vehicle\n");
+            reset(body);
+        }
+        // a repeated frame count is a resend while SITL waited for us
+        if (servos.frame_count != last_frame || !started) {
+            const double rate = servos.frame_rate > 0 ? servos.frame_rate : 1000;
+            step(body, servos, 1.0 / rate);
+        }
+        last_frame = servos.frame_count;
+        started = true;
+
+        sim_json_shm_fdm_ring &ring = shm->fdm;
+        sim_json_shm_fdm &fdm = ring.slot[ring.seq % SIM_JSON_SHM_SLOTS];
+        memset(&fdm, 0, sizeof(fdm));
+        fdm.frame_count = servos.frame_count;
+        fdm.fields = SIM_JSON_SHM_QUATERNION;
+        fdm.timestamp_s = body.time_s;
+        fdm.position[0] = body.pos.x;
+        fdm.position[1] = body.pos.y;
+        fdm.position[2] = body.pos.z;
+        fdm.gyro[0] = body.gyro.x;
+        fdm.gyro[1] = body.gyro.y;
+        fdm.gyro[2] = body.gyro.z;
+        fdm.accel_body[0] = body.accel.x;
+        fdm.accel_body[1] = body.accel.y;
+        fdm.accel_body[2] = body.accel.z;
+        for (int i = 0; i < 4; i++) {
+            fdm.quaternion[i] = body.q[i];
+        }
+        fdm.velocity[0] = body.vel.x;
+        fdm.velocity[1] = body.vel.y;
+        fdm.velocity[2] = body.vel.z;
+        sim_json_shm_publish(&ring.seq, &ring.waiting);
+
+        frames++;
+        const double t = now_s();
+        if (t - report_s >= 5) {
+            printf("%.0f frames/s, sim time %.1fs\n", frames / (t - report_s), body.time_s);
+            frames = 0;
+            report_s = t;
+        }
+    }
+    return 0;
+}
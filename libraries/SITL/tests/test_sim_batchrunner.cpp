@@ -0,0 +1,134 @@
+#include <AP_gtest.h>
+
+#include <SITL/SIM_BatchRunner.h>
+
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SIM_BATCHRUNNER_ENABLED
+
+// the models read their SIM_ parameters from here
+static SITL::SIM sitl;
+
+GCS_Dummy _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+static void write_file(const char *path, const char *contents)
+{
+    FILE *f = fopen(path, "w");
+    ASSERT_NE(f, nullptr);
+    fputs(contents, f);
+    fclose(f);
+}
+
+static int remove_entry(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+    return remove(path);
+}
+
+// a scratch directory, removed with everything in it at the end of the test
+class TempDir {
+public:
+    TempDir() {
+        ok = mkdtemp(path) != nullptr;
+    }
+    ~TempDir() {
+        if (ok) {
+            nftw(path, remove_entry, 8, FTW_DEPTH | FTW_PHYS);
+        }
+    }
+    char path[24] = "/tmp/batchrunner_XXXXXX";
+    bool ok;
+};
+
+static uint32_t count_lines(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == nullptr) {
+        return 0;
+    }
+    uint32_t lines = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        lines++;
+    }
+    fclose(f);
+    return lines;
+}
+
+TEST(BatchRunner, load_and_run)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+
+    char scenario_file[64];
+    snprintf(scenario_file, sizeof(scenario_file), "%s/scenarios.txt", dir);
+    write_file(scenario_file,
+               "# name model duration options\n"
+               "\n"
+               "hover quad 0.5 ch1=1500 ch2=1500 ch3=1500 ch4=1500 rate=400 out=10\n"
+               "sweep quad 0.5 ch1=1100 ch2=1100 ch3=1100 ch4=1100 step3=0.2:1600 rate=400 seed=7 repeat=3\n");
+
+    // on the stack, as examples/BatchRunner has it
+    SITL::BatchRunner runner;
+    ASSERT_TRUE(runner.load(scenario_file));
+    EXPECT_EQ(runner.get_num_scenarios(), 4U);
+
+    char out_dir[64];
+    snprintf(out_dir, sizeof(out_dir), "%s/out", dir);
+    EXPECT_TRUE(runner.run(out_dir, 2));
+
+    char path[96];
+    snprintf(path, sizeof(path), "%s/summary.csv", out_dir);
+    EXPECT_EQ(count_lines(path), 5U);
+
+    // a header and one record per output interval
+    snprintf(path, sizeof(path), "%s/hover.bin", out_dir);
+    const int fd = open(path, O_RDONLY);
+    ASSERT_NE(fd, -1);
+    SITL::BatchRunner::ResultHeader header;
+    ASSERT_EQ(read(fd, &header, sizeof(header)), ssize_t(sizeof(header)));
+    EXPECT_EQ(header.magic, SITL::BatchRunner::RESULT_MAGIC);
+    EXPECT_EQ(header.record_size, sizeof(SITL::BatchRunner::ResultRecord));
+    EXPECT_STREQ(header.name, "hover");
+    const off_t size = lseek(fd, 0, SEEK_END);
+    close(fd);
+    EXPECT_EQ((size - off_t(sizeof(header))) % off_t(sizeof(SITL::BatchRunner::ResultRecord)), 0);
+    EXPECT_GE((size - off_t(sizeof(header))) / off_t(sizeof(SITL::BatchRunner::ResultRecord)), 4);
+
+    // the repeats are named by index and get consecutive seeds
+    snprintf(path, sizeof(path), "%s/sweep-0002.bin", out_dir);
+    EXPECT_EQ(access(path, R_OK), 0);
+}
+
+TEST(BatchRunner, parse_error)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+
+    char scenario_file[64];
+    snprintf(scenario_file, sizeof(scenario_file), "%s/scenarios.txt", dir);
+    write_file(scenario_file,
+               "good quad 1\n"
+               "bad quad 1 ch17=1500\n");
+
+    SITL::BatchRunner runner;
+    EXPECT_FALSE(runner.load(scenario_file));
+    EXPECT_EQ(runner.get_num_scenarios(), 1U);
+}
+
+#endif  // AP_SIM_BATCHRUNNER_ENABLED
+
+AP_GTEST_MAIN()
@@ -0,0 +1,320 @@
+#include <AP_gtest.h>
+
+#include <SITL/SIM_TerrainMap.h>
+
+#include <AP_Math/crc.h>
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
+
+/*
+  write .DAT files the way AP_Terrain lays them out: the grid_block
+  structure in a 2048 byte slot, blocks numbered east_blocks() *
+  grid_idx_x + grid_idx_y within the file for each whole degree, with
+  the point indices worked out as in AP_Terrain::calculate_grid_info()
+ */
+struct PACKED TestBlock {
+    uint64_t bitmap;
+    int32_t lat;
+    int32_t lon;
+    uint16_t crc;
+    uint16_t version;
+    uint16_t spacing;
+    int16_t height[TERRAIN_GRID_BLOCK_SIZE_X][TERRAIN_GRID_BLOCK_SIZE_Y];
+    uint16_t grid_idx_x;
+    uint16_t grid_idx_y;
+    int16_t lon_degrees;
+    int8_t lat_degrees;
+};
+
+static int remove_entry(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+    return remove(path);
+}
+
+// a scratch directory, removed with everything in it at the end of the test
+class TempDir {
+public:
+    TempDir() {
+        ok = mkdtemp(path) != nullptr;
+    }
+    ~TempDir() {
+        if (ok) {
+            nftw(path, remove_entry, 8, FTW_DEPTH | FTW_PHYS);
+        }
+    }
+    char path[23] = "/tmp/terrainmap_XXXXXX";
+    bool ok;
+};
+
+static const uint16_t SPACING = 100;
+
+// CMAC, well inside S36E149
+static const Location centre(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+
+static Location degree_ref(int8_t lat_degrees, int16_t lon_degrees)
+{
+    Location ref;
+    ref.lat = lat_degrees*10*1000*1000L;
+    ref.lng = lon_degrees*10*1000*1000L;
+    return ref;
+}
+
+/*
+  the terrain is a plane, rising a metre per grid square north and two
+  per grid square east of the degree corner, so every point in the
+  files is a whole number of metres and bilinear interpolation is
+  exact
+ */
+static float plane_height(const Location &loc)
+{
+    const Location ref = degree_ref(-36, 149);
+    const Vector2f ne = ref.get_distance_NE(loc);
+    return 500 + ne.x / SPACING + 2 * ne.y / SPACING;
+}
+
+// the block holding loc, as AP_Terrain::calculate_grid_info() finds it
+static void block_of(const Location &loc, uint16_t &grid_idx_x, uint16_t &grid_idx_y)
+{
+    const Vector2f ne = degree_ref(-36, 149).get_distance_NE(loc);
+    grid_idx_x = uint32_t(ne.x / SPACING) / TERRAIN_GRID_BLOCK_SPACING_X;
+    grid_idx_y = uint32_t(ne.y / SPACING) / TERRAIN_GRID_BLOCK_SPACING_Y;
+}
+
+static uint32_t east_blocks(int8_t lat_degrees, int16_t lon_degrees)
+{
+    Location loc1 = degree_ref(lat_degrees, lon_degrees);
+    Location loc2 = degree_ref(lat_degrees, lon_degrees+1);
+    loc2.offset(0, 2*SPACING*TERRAIN_GRID_BLOCK_SIZE_Y);
+    const Vector2f offset = loc1.get_distance_NE(loc2);
+    return offset.y / (SPACING*TERRAIN_GRID_BLOCK_SPACING_Y);
+}
+
+static void write_block(int fd, uint16_t grid_idx_x, uint16_t grid_idx_y, uint64_t bitmap)
+{
+    union {
+        TestBlock block;
+        uint8_t buffer[2048];
+    } io {};
+    TestBlock &b = io.block;
+    b.bitmap = bitmap;
+    b.version = TERRAIN_GRID_FORMAT_VERSION;
+    b.spacing = SPACING;
+    b.grid_idx_x = grid_idx_x;
+    b.grid_idx_y = grid_idx_y;
+    b.lat_degrees = -36;
+    b.lon_degrees = 149;
+    Location sw = degree_ref(-36, 149);
+    sw.offset(grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * float(SPACING),
+              grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y * float(SPACING));
+    b.lat = sw.lat;
+    b.lon = sw.lng;
+    for (uint8_t x=0; x<TERRAIN_GRID_BLOCK_SIZE_X; x++) {
+        for (uint8_t y=0; y<TERRAIN_GRID_BLOCK_SIZE_Y; y++) {
+            b.height[x][y] = 500 +
+                (grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X + x) +
+                2 * (grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y + y);
+        }
+    }
+    b.crc = crc16_ccitt((const uint8_t *)&b, sizeof(b), 0);
+
+    const uint32_t blocknum = east_blocks(-36, 149) * grid_idx_x + grid_idx_y;
+    ASSERT_EQ(pwrite(fd, &io, sizeof(io), off_t(blocknum) * sizeof(io)), ssize_t(sizeof(io)));
+}
+
+/*
+  write every block within radius_m of centre, leaving out the one
+  holding hole if given
+ */
+static void write_dat(const char *dir, float radius_m, const Location *hole=nullptr)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/S36E149.DAT", dir);
+    const int fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    ASSERT_NE(fd, -1);
+
+    const Location ref = degree_ref(-36, 149);
+    const Vector2f ne = ref.get_distance_NE(centre);
+    const float margin = radius_m + 2 * SPACING;
+    const uint16_t x_min = (ne.x - margin) / (SPACING * TERRAIN_GRID_BLOCK_SPACING_X);
+    const uint16_t x_max = (ne.x + margin) / (SPACING * TERRAIN_GRID_BLOCK_SPACING_X);
+    const uint16_t y_min = (ne.y - margin) / (SPACING * TERRAIN_GRID_BLOCK_SPACING_Y);
+    const uint16_t y_max = (ne.y + margin) / (SPACING * TERRAIN_GRID_BLOCK_SPACING_Y);
+
+    uint16_t hole_x = UINT16_MAX, hole_y = UINT16_MAX;
+    if (hole != nullptr) {
+        block_of(*hole, hole_x, hole_y);
+    }
+
+    // all 7*8 mavlink sub-grids present
+    const uint64_t full = (uint64_t(1U) << (TERRAIN_GRID_BLOCK_MUL_X*TERRAIN_GRID_BLOCK_MUL_Y)) - 1;
+    for (uint16_t x=x_min; x<=x_max; x++) {
+        for (uint16_t y=y_min; y<=y_max; y++) {
+            write_block(fd, x, y, (x == hole_x && y == hole_y) ? 0 : full);
+        }
+    }
+    close(fd);
+}
+
+TEST(TerrainMap, plane)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+    write_dat(dir, 2000);
+
+    SITL::TerrainMap map;
+    EXPECT_FALSE(map.loaded());
+    const uint32_t size = 2*2000/SPACING + 1;
+    EXPECT_EQ(map.load_dat(dir, centre, SPACING, 2000), size*size);
+    EXPECT_TRUE(map.loaded());
+
+    // points between the grid squares, in the middle and near the edges
+    const float offsets[][2] {
+        { 0, 0 }, { 37, 61 }, { -512.5, 1234.25 }, { 1890, -1890 }, { -1950, -1950 },
+    };
+    for (const auto &o : offsets) {
+        Location loc = centre;
+        loc.offset(o[0], o[1]);
+        float height;
+        ASSERT_TRUE(map.height_amsl(loc, height));
+        EXPECT_NEAR(height, plane_height(loc), 0.05);
+    }
+
+    // off the map
+    Location loc = centre;
+    loc.offset(2100, 0);
+    float height;
+    EXPECT_FALSE(map.height_amsl(loc, height));
+}
+
+TEST(TerrainMap, missing_block)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+    write_dat(dir, 2000, &centre);
+
+    SITL::TerrainMap map;
+    const uint32_t size = 2*2000/SPACING + 1;
+    const uint32_t known = map.load_dat(dir, centre, SPACING, 2000);
+    EXPECT_GT(known, 0U);
+    EXPECT_LT(known, size*size);
+
+    float height;
+    EXPECT_FALSE(map.height_amsl(centre, height));
+
+    // blocks are 2400m by 2800m, so one of these is in another block,
+    // which is still there
+    Location loc = centre;
+    loc.offset(1900, 0);
+    uint16_t hole_x, hole_y, x, y;
+    block_of(centre, hole_x, hole_y);
+    block_of(loc, x, y);
+    if (x == hole_x && y == hole_y) {
+        loc = centre;
+        loc.offset(-1900, 0);
+    }
+    ASSERT_TRUE(map.height_amsl(loc, height));
+    EXPECT_NEAR(height, plane_height(loc), 0.05);
+}
+
+TEST(TerrainMap, no_files)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+
+    SITL::TerrainMap map;
+    EXPECT_EQ(map.load_dat(dir, centre, SPACING, 1000), 0U);
+    float height;
+    EXPECT_FALSE(map.height_amsl(centre, height));
+}
+
+TEST(TerrainMap, background)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+    write_dat(dir, 1000);
+
+    SITL::TerrainMap map;
+    ASSERT_TRUE(map.load_dat_background(dir, centre, SPACING, 1000));
+    EXPECT_FALSE(map.load_dat_background(dir, centre, SPACING, 1000));
+    for (uint16_t i=0; i<10000 && map.loading(); i++) {
+        usleep(1000);
+    }
+    ASSERT_FALSE(map.loading());
+
+    // the new map isn't used until the load is finished
+    EXPECT_FALSE(map.loaded());
+    float height;
+    EXPECT_FALSE(map.height_amsl(centre, height));
+    map.finish_load();
+    ASSERT_TRUE(map.loaded());
+    ASSERT_TRUE(map.height_amsl(centre, height));
+    EXPECT_NEAR(height, plane_height(centre), 0.05);
+}
+
+TEST(TerrainMap, batch)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+    write_dat(dir, 1000);
+
+    SITL::TerrainMap map;
+    Location locs[4] { centre, centre, centre, centre };
+    locs[1].offset(300, -450);
+    locs[2].offset(-990, 990);
+    locs[3].offset(0, 1500);    // off the map
+    float heights[4];
+
+    // nothing known before the map is loaded
+    EXPECT_EQ(map.height_amsl(locs, heights, 4), 0U);
+    for (const float h : heights) {
+        EXPECT_TRUE(isnan(h));
+    }
+
+    map.load_dat(dir, centre, SPACING, 1000);
+    EXPECT_EQ(map.height_amsl(locs, heights, 4), 3U);
+    for (uint8_t i=0; i<3; i++) {
+        float height;
+        ASSERT_TRUE(map.height_amsl(locs[i], height));
+        EXPECT_FLOAT_EQ(heights[i], height);
+        EXPECT_NEAR(heights[i], plane_height(locs[i]), 0.05);
+    }
+    EXPECT_TRUE(isnan(heights[3]));
+}
+
+TEST(TerrainMap, covers)
+{
+    TempDir tmp;
+    ASSERT_TRUE(tmp.ok);
+    const char *dir = tmp.path;
+    write_dat(dir, 1000);
+
+    SITL::TerrainMap map;
+    EXPECT_FALSE(map.covers(centre, 0));
+    map.load_dat(dir, centre, SPACING, 1000);
+    EXPECT_TRUE(map.covers(centre, 900));
+    EXPECT_FALSE(map.covers(centre, 1100));
+
+    Location loc = centre;
+    loc.offset(0, 800);
+    EXPECT_TRUE(map.covers(loc, 100));
+    EXPECT_FALSE(map.covers(loc, 300));
+    loc.offset(0, 400);
+    EXPECT_FALSE(map.covers(loc, 0));
+}
+
+#endif  // AP_SIM_TERRAIN_MAP_ENABLED && AP_TERRAIN_AVAILABLE
+
+AP_GTEST_MAIN()
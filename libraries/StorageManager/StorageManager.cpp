@@ -26,6 +26,7 @@
 #include <AP_BoardConfig/AP_BoardConfig.h>
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <GCS_MAVLink/GCS.h>
+#include <AP_Common/ExpandingString.h>
 
 #include "StorageManager.h"
 
@@ -34,6 +35,7 @@
 extern const AP_HAL::HAL& hal;
 
 bool StorageManager::last_io_failed;
+uint32_t StorageManager::write_bytes[StorageParamBak+1];
 
 /*
   the layouts below are carefully designed to ensure backwards
@@ -113,6 +115,37 @@ void StorageManager::erase(void)
     }
 }
 
+/*
+  wait for dirty data to be written to the storage device. This is
+  used before a reboot so recent changes are not lost
+ */
+bool StorageManager::flush(uint32_t timeout_ms)
+{
+    const uint32_t start_ms = AP_HAL::millis();
+    while (hal.storage->is_dirty()) {
+        if (AP_HAL::millis() - start_ms >= timeout_ms) {
+            return false;
+        }
+        hal.scheduler->expect_delay_ms(10);
+        hal.scheduler->delay(1);
+        hal.scheduler->expect_delay_ms(0);
+    }
+    return true;
+}
+
+/*
+  report write statistics, for @SYS/storage.txt
+ */
+void StorageManager::storage_info(ExpandingString &str)
+{
+    static const char *names[] { "param", "fence", "rally", "mission", "keys", "bindinfo", "candna", "parambak" };
+    static_assert(ARRAY_SIZE(names) == ARRAY_SIZE(write_bytes), "names must match storage types");
+    for (uint8_t i=0; i<ARRAY_SIZE(write_bytes); i++) {
+        str.printf("%-9s %u bytes\n", names[i], unsigned(write_bytes[i]));
+    }
+    hal.storage->storage_info(str);
+}
+
 /*
   constructor for StorageAccess
  */
@@ -228,6 +261,7 @@ bool StorageAccess::write_block(uint16_t addr, const void *data, size_t n) const
             count = length - addr;
         }
         hal.storage->write_block(addr+offset, b, count);
+        StorageManager::write_bytes[type] += count;
         n -= count;
 
         if (n == 0) {
@@ -23,6 +23,8 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_BoardConfig/AP_BoardConfig_config.h>
 
+class ExpandingString;
+
 /*
   use just one area per storage type for boards with 4k of
   storage. Use larger areas for other boards
@@ -69,9 +71,19 @@ public:
         return last_io_failed;
     }
 
+    // wait up to timeout_ms for pending writes to reach the storage
+    // device. Returns false if writes are still pending
+    static bool flush(uint32_t timeout_ms);
+
+    // report write counters for each storage type and for the device
+    static void storage_info(ExpandingString &str);
+
 private:
     static bool last_io_failed;
 
+    // bytes passed to write_block for each storage type
+    static uint32_t write_bytes[StorageParamBak+1];
+
     struct StorageArea {
         StorageType type;
         uint16_t    offset;